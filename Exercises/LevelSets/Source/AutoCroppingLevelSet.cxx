@@ -0,0 +1,283 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageIOFactory.h"
+#include "itkCommand.h"
+#include "itkAutoCroppingLevelSetEvolution.h"
+#include "itkSparseLevelSetToImageFilter.h"
+#include "itkWhitakerSparseLevelSetImage.h"
+#include "itkShiSparseLevelSetImage.h"
+#include "itkMalcolmSparseLevelSetImage.h"
+#include "itkTimeProbe.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+typedef unsigned char   InputPixelType;
+typedef char            OutputPixelType;
+
+// Print the evolution domain and the time of each chunk.
+template< class TAutoCropping >
+class ChunkReporter : public itk::Command
+{
+public:
+  typedef ChunkReporter               Self;
+  typedef itk::Command                Superclass;
+  typedef itk::SmartPointer< Self >   Pointer;
+
+  itkNewMacro( Self );
+
+  void Execute( const itk::Object* caller, const itk::EventObject& event )
+    {
+    const TAutoCropping* autoCropping = dynamic_cast< const TAutoCropping* >( caller );
+    if( ( autoCropping == NULL ) || !itk::IterationEvent().CheckEvent( &event ) )
+      {
+      return;
+      }
+
+    this->m_TimeProbe.Stop();
+
+    const double fraction =
+      static_cast< double >( autoCropping->GetCropRegion().GetNumberOfPixels() ) /
+      static_cast< double >( autoCropping->GetInput()->GetLargestPossibleRegion().GetNumberOfPixels() );
+
+    std::cout << "Iteration " << autoCropping->GetCurrentIteration() << ": domain "
+              << autoCropping->GetCropRegion().GetSize() << " (" << 100. * fraction
+              << "% of the image), " << this->m_TimeProbe.GetTotal() << " "
+              << this->m_TimeProbe.GetUnit() << std::endl;
+
+    this->m_TimeProbe.Reset();
+    this->m_TimeProbe.Start();
+    }
+
+  void Execute( itk::Object* caller, const itk::EventObject& event )
+    {
+    this->Execute( const_cast< const itk::Object* >( caller ), event );
+    }
+
+  void Start()
+    {
+    this->m_TimeProbe.Start();
+    }
+
+protected:
+  ChunkReporter() {}
+
+private:
+  itk::TimeProbe m_TimeProbe;
+};
+
+template< class TInputImage, class TLevelSet >
+int SegmentAutoCropping( TInputImage* inputImage,
+                         unsigned int numberOfIterations,
+                         const std::vector< itk::OffsetValueType >& seedCenter,
+                         unsigned int seedRadius,
+                         unsigned int margin,
+                         const char* outputFileName )
+{
+  typedef TInputImage                                         InputImageType;
+  typedef itk::Image< OutputPixelType, TInputImage::ImageDimension > OutputImageType;
+
+  typedef itk::AutoCroppingLevelSetEvolution< InputImageType, TLevelSet > AutoCroppingType;
+  typename AutoCroppingType::Pointer autoCropping = AutoCroppingType::New();
+  autoCropping->SetInput( inputImage );
+  autoCropping->SetNumberOfIterations( numberOfIterations );
+  autoCropping->SetMargin( margin );
+
+  // Seed with a box around the given center, or the center of the image
+  const typename InputImageType::RegionType largestRegion = inputImage->GetLargestPossibleRegion();
+  typename InputImageType::RegionType region;
+  for( unsigned int dim = 0; dim < TInputImage::ImageDimension; dim++ )
+    {
+    itk::OffsetValueType center = largestRegion.GetIndex()[dim] +
+      static_cast< itk::OffsetValueType >( largestRegion.GetSize()[dim] / 2 );
+    if( dim < seedCenter.size() )
+      {
+      center = seedCenter[dim];
+      }
+    region.SetIndex( dim, center - static_cast< itk::OffsetValueType >( seedRadius ) );
+    region.SetSize( dim, 2 * seedRadius + 1 );
+    }
+  if( !region.Crop( largestRegion ) )
+    {
+    std::cerr << "The seed is out of the image" << std::endl;
+    return EXIT_FAILURE;
+    }
+  autoCropping->AddSeedRegion( region );
+
+  typedef ChunkReporter< AutoCroppingType > ReporterType;
+  typename ReporterType::Pointer reporter = ReporterType::New();
+  autoCropping->AddObserver( itk::IterationEvent(), reporter );
+
+  itk::TimeProbe timeProbe;
+  timeProbe.Start();
+  reporter->Start();
+
+  try
+    {
+    autoCropping->Update();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  timeProbe.Stop();
+  std::cout << autoCropping->GetNumberOfGrowths() << " growth(s) of the domain" << std::endl;
+  std::cout << "Total: " << timeProbe.GetTotal() << " " << timeProbe.GetUnit() << std::endl;
+
+  typedef itk::SparseLevelSetToImageFilter< TLevelSet, OutputImageType > LevelSetToImageFilterType;
+  typename LevelSetToImageFilterType::Pointer levelSetToImage = LevelSetToImageFilterType::New();
+  levelSetToImage->SetLevelSet( autoCropping->GetLevelSet() );
+  levelSetToImage->SetOutputParametersFromImage( inputImage );
+
+  typedef itk::ImageFileWriter< OutputImageType >     OutputWriterType;
+  typename OutputWriterType::Pointer writer = OutputWriterType::New();
+  writer->SetFileName( outputFileName );
+  writer->SetInput( levelSetToImage->GetOutput() );
+
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cout << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+template< unsigned int VDimension >
+int Run( const char* inputFileName, const char* outputFileName,
+         unsigned int numberOfIterations, const std::vector< itk::OffsetValueType >& seedCenter,
+         unsigned int seedRadius, unsigned int margin, const std::string& representation )
+{
+  typedef itk::Image< InputPixelType, VDimension >  InputImageType;
+
+  typedef itk::ImageFileReader< InputImageType >    ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( inputFileName );
+  reader->Update();
+  typename InputImageType::Pointer inputImage = reader->GetOutput();
+
+  typedef float PixelType;
+
+  if( representation == "Whitaker" )
+    {
+    typedef itk::WhitakerSparseLevelSetImage< PixelType, VDimension > LevelSetType;
+    return SegmentAutoCropping< InputImageType, LevelSetType >( inputImage,
+      numberOfIterations, seedCenter, seedRadius, margin, outputFileName );
+    }
+  if( representation == "Shi" )
+    {
+    typedef itk::ShiSparseLevelSetImage< VDimension > LevelSetType;
+    return SegmentAutoCropping< InputImageType, LevelSetType >( inputImage,
+      numberOfIterations, seedCenter, seedRadius, margin, outputFileName );
+    }
+  if( representation == "Malcolm" )
+    {
+    typedef itk::MalcolmSparseLevelSetImage< VDimension > LevelSetType;
+    return SegmentAutoCropping< InputImageType, LevelSetType >( inputImage,
+      numberOfIterations, seedCenter, seedRadius, margin, outputFileName );
+    }
+
+  std::cerr << "Unknown representation: " << representation << std::endl;
+  return EXIT_FAILURE;
+}
+
+int main( int argc, char* argv[] )
+{
+  if( argc < 4 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << "./AutoCroppingLevelSet " <<std::endl;
+    std::cerr << "1- Input Image (2D or 3D)" <<std::endl;
+    std::cerr << "2- Number of Iterations" <<std::endl;
+    std::cerr << "3- Output" <<std::endl;
+    std::cerr << "4- [Seed center, e.g. 120x80 (default: center of the image)]" <<std::endl;
+    std::cerr << "5- [Seed radius in pixels (default: 5)]" <<std::endl;
+    std::cerr << "6- [Margin of the domain in pixels (default: 10)]" <<std::endl;
+    std::cerr << "7- [Representation: Whitaker (default), Shi or Malcolm]" <<std::endl;
+
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int numberOfIterations = atoi( argv[2] );
+
+  std::vector< itk::OffsetValueType > seedCenter;
+  if( argc > 4 )
+    {
+    std::istringstream center( argv[4] );
+    itk::OffsetValueType coordinate;
+    while( center >> coordinate )
+      {
+      seedCenter.push_back( coordinate );
+      center.ignore( 1 ); // skip the 'x'
+      }
+    }
+
+  unsigned int seedRadius = 5;
+  if( argc > 5 )
+    {
+    seedRadius = atoi( argv[5] );
+    }
+
+  unsigned int margin = 10;
+  if( argc > 6 )
+    {
+    margin = atoi( argv[6] );
+    }
+
+  std::string representation = "Whitaker";
+  if( argc > 7 )
+    {
+    representation = argv[7];
+    }
+
+  // The dimension of the input is only known at run time.
+  itk::ImageIOBase::Pointer imageIO =
+    itk::ImageIOFactory::CreateImageIO( argv[1], itk::ImageIOFactory::ReadMode );
+  if( imageIO.IsNull() )
+    {
+    std::cerr << "Could not read " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+  imageIO->SetFileName( argv[1] );
+  imageIO->ReadImageInformation();
+
+  switch( imageIO->GetNumberOfDimensions() )
+    {
+    case 2:
+      return Run< 2 >( argv[1], argv[3], numberOfIterations, seedCenter,
+                       seedRadius, margin, representation );
+    case 3:
+      return Run< 3 >( argv[1], argv[3], numberOfIterations, seedCenter,
+                       seedRadius, margin, representation );
+    default:
+      std::cerr << "Unsupported dimension: " << imageIO->GetNumberOfDimensions() << std::endl;
+      return EXIT_FAILURE;
+    }
+}
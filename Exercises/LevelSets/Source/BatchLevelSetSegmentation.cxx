@@ -0,0 +1,274 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkLevelSetSegmentationEngine.h"
+#include "itkSparseLevelSetToImageFilter.h"
+#include "itkWhitakerSparseLevelSetImage.h"
+#include "itkShiSparseLevelSetImage.h"
+#include "itkMalcolmSparseLevelSetImage.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkTimeProbe.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+const unsigned int Dimension = 2;
+
+typedef unsigned char                             InputPixelType;
+typedef itk::Image< InputPixelType, Dimension >   InputImageType;
+typedef char                                      OutputPixelType;
+typedef itk::Image< OutputPixelType, Dimension >  OutputImageType;
+
+// True if pattern holds exactly one integer conversion, %d with an
+// optional zero flag and width, besides literal %% signs.
+bool IsValidOutputPattern( const std::string& pattern )
+{
+  unsigned int numberOfConversions = 0;
+
+  for( std::string::size_type i = 0; i < pattern.size(); i++ )
+    {
+    if( pattern[i] != '%' )
+      {
+      continue;
+      }
+    ++i;
+    if( ( i < pattern.size() ) && ( pattern[i] == '%' ) )
+      {
+      continue;
+      }
+    while( ( i < pattern.size() ) && ( pattern[i] >= '0' ) && ( pattern[i] <= '9' ) )
+      {
+      ++i;
+      }
+    if( ( i == pattern.size() ) || ( pattern[i] != 'd' ) )
+      {
+      return false;
+      }
+    ++numberOfConversions;
+    }
+
+  return ( numberOfConversions == 1 );
+}
+
+// File name given by a pattern checked by IsValidOutputPattern.
+std::string FormatOutputFileName( const std::string& pattern, int index )
+{
+  std::vector< char > fileName( pattern.size() + 32 );
+
+  int length = snprintf( &fileName[0], fileName.size(), pattern.c_str(), index );
+  if( ( length >= 0 ) && ( static_cast< size_t >( length ) >= fileName.size() ) )
+    {
+    // wide conversion: retry with the exact size
+    fileName.resize( static_cast< size_t >( length ) + 1 );
+    length = snprintf( &fileName[0], fileName.size(), pattern.c_str(), index );
+    }
+  if( length < 0 )
+    {
+    itkGenericExceptionMacro( << "Could not format the output file name " << pattern );
+    }
+
+  return std::string( &fileName[0] );
+}
+
+// Read the images from a list of files, write each segmentation to the
+// file given by an output pattern such as seg%04d.mha, checked by
+// IsValidOutputPattern.
+template< class TEngine >
+class FileBatch : public TEngine::Batch
+{
+public:
+  typedef typename TEngine::LevelSetType LevelSetType;
+
+  FileBatch( const std::vector< std::string >& inputFileNames, const std::string& outputPattern ) :
+    m_InputFileNames( inputFileNames ),
+    m_OutputPattern( outputPattern ),
+    m_TotalNumberOfIterations( 0 )
+    {}
+
+  itk::SizeValueType GetNumberOfImages() const
+    {
+    return this->m_InputFileNames.size();
+    }
+
+  InputImageType::Pointer GetImage( itk::SizeValueType index )
+    {
+    typedef itk::ImageFileReader< InputImageType > ReaderType;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( this->m_InputFileNames[index] );
+    reader->Update();
+
+    InputImageType::Pointer image = reader->GetOutput();
+    image->DisconnectPipeline();
+    return image;
+    }
+
+  void SetLevelSet( itk::SizeValueType index, InputImageType* image,
+                    LevelSetType* levelSet, unsigned int numberOfIterations )
+    {
+    typedef itk::SparseLevelSetToImageFilter< LevelSetType, OutputImageType > LevelSetToImageFilterType;
+    typename LevelSetToImageFilterType::Pointer levelSetToImage = LevelSetToImageFilterType::New();
+    levelSetToImage->SetLevelSet( levelSet );
+    levelSetToImage->SetOutputParametersFromImage( image );
+
+    const std::string fileName =
+      FormatOutputFileName( this->m_OutputPattern, static_cast< int >( index ) );
+
+    typedef itk::ImageFileWriter< OutputImageType > WriterType;
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( fileName );
+    writer->SetInput( levelSetToImage->GetOutput() );
+    writer->Update();
+
+    this->m_Mutex.Lock();
+    this->m_TotalNumberOfIterations += numberOfIterations;
+    this->m_Mutex.Unlock();
+    }
+
+  itk::SizeValueType GetTotalNumberOfIterations() const
+    {
+    return this->m_TotalNumberOfIterations;
+    }
+
+private:
+  std::vector< std::string >  m_InputFileNames;
+  std::string                 m_OutputPattern;
+
+  itk::SimpleFastMutexLock    m_Mutex;
+  itk::SizeValueType          m_TotalNumberOfIterations;
+};
+
+template< class TLevelSet >
+int SegmentBatch( const std::vector< std::string >& inputFileNames,
+                  const std::string& outputPattern,
+                  unsigned int numberOfIterations,
+                  unsigned int numberOfThreads )
+{
+  // The engine is configured once for the whole batch.
+  typedef itk::LevelSetSegmentationEngine< InputImageType, TLevelSet > EngineType;
+  typename EngineType::Pointer engine = EngineType::New();
+  engine->SetNumberOfIterations( numberOfIterations );
+  engine->SetNumberOfThreads( numberOfThreads );
+
+  FileBatch< EngineType > batch( inputFileNames, outputPattern );
+
+  itk::TimeProbe timeProbe;
+  timeProbe.Start();
+
+  try
+    {
+    engine->Process( &batch );
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  timeProbe.Stop();
+
+  std::cout << inputFileNames.size() << " images segmented in "
+            << timeProbe.GetTotal() << " " << timeProbe.GetUnit()
+            << " with " << engine->GetNumberOfThreads() << " threads" << std::endl;
+  std::cout << batch.GetTotalNumberOfIterations() << " iterations, "
+            << engine->GetNumberOfDomainMapBuilds() << " domain map(s) built" << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+int main( int argc, char* argv[] )
+{
+  if( argc < 4 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << "./BatchLevelSetSegmentation " <<std::endl;
+    std::cerr << "1- File listing the input images, one per line" <<std::endl;
+    std::cerr << "2- Maximum Number of Iterations" <<std::endl;
+    std::cerr << "3- Output file pattern (e.g. seg%04d.mha)" <<std::endl;
+    std::cerr << "4- [Number of images segmented at once (default: 1)]" <<std::endl;
+    std::cerr << "5- [Representation: Whitaker (default), Shi or Malcolm]" <<std::endl;
+
+    return EXIT_FAILURE;
+    }
+
+  std::vector< std::string > inputFileNames;
+  std::ifstream list( argv[1] );
+  std::string line;
+  while( std::getline( list, line ) )
+    {
+    if( !line.empty() )
+      {
+      inputFileNames.push_back( line );
+      }
+    }
+
+  if( inputFileNames.empty() )
+    {
+    std::cerr << "No input image listed in " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int numberOfIterations = atoi( argv[2] );
+  const std::string outputPattern = argv[3];
+  if( !IsValidOutputPattern( outputPattern ) )
+    {
+    std::cerr << "Invalid output file pattern: " << outputPattern
+              << " (expected one %d, e.g. seg%04d.mha)" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  unsigned int numberOfThreads = 1;
+  if( argc > 4 )
+    {
+    numberOfThreads = atoi( argv[4] );
+    }
+
+  std::string representation = "Whitaker";
+  if( argc > 5 )
+    {
+    representation = argv[5];
+    }
+
+  typedef float PixelType;
+
+  if( representation == "Whitaker" )
+    {
+    typedef itk::WhitakerSparseLevelSetImage< PixelType, Dimension > LevelSetType;
+    return SegmentBatch< LevelSetType >( inputFileNames, outputPattern,
+      numberOfIterations, numberOfThreads );
+    }
+  if( representation == "Shi" )
+    {
+    typedef itk::ShiSparseLevelSetImage< Dimension > LevelSetType;
+    return SegmentBatch< LevelSetType >( inputFileNames, outputPattern,
+      numberOfIterations, numberOfThreads );
+    }
+  if( representation == "Malcolm" )
+    {
+    typedef itk::MalcolmSparseLevelSetImage< Dimension > LevelSetType;
+    return SegmentBatch< LevelSetType >( inputFileNames, outputPattern,
+      numberOfIterations, numberOfThreads );
+    }
+
+  std::cerr << "Unknown representation: " << representation << std::endl;
+  return EXIT_FAILURE;
+}
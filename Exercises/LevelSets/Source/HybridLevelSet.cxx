@@ -0,0 +1,270 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageIOFactory.h"
+#include "itkCommand.h"
+#include "itkHybridLevelSetEvolution.h"
+#include "itkSparseLevelSetToImageFilter.h"
+#include "itkWhitakerSparseLevelSetImage.h"
+#include "itkShiSparseLevelSetImage.h"
+#include "itkMalcolmSparseLevelSetImage.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+typedef unsigned char   InputPixelType;
+typedef char            OutputPixelType;
+
+// Print the representation, the front fraction and the time of each chunk.
+template< class THybrid >
+class ChunkReporter : public itk::Command
+{
+public:
+  typedef ChunkReporter               Self;
+  typedef itk::Command                Superclass;
+  typedef itk::SmartPointer< Self >   Pointer;
+
+  itkNewMacro( Self );
+
+  void Execute( const itk::Object* caller, const itk::EventObject& event )
+    {
+    const THybrid* hybrid = dynamic_cast< const THybrid* >( caller );
+    if( ( hybrid == NULL ) || !itk::IterationEvent().CheckEvent( &event ) )
+      {
+      return;
+      }
+
+    this->m_TimeProbe.Stop();
+
+    std::cout << "Iteration " << hybrid->GetCurrentIteration() << ": "
+              << ( hybrid->GetRepresentation() == THybrid::Dense ? "dense" : "sparse" )
+              << ", front fraction " << hybrid->GetFrontFraction() << ", "
+              << this->m_TimeProbe.GetTotal() << " " << this->m_TimeProbe.GetUnit() << std::endl;
+
+    this->m_TimeProbe.Reset();
+    this->m_TimeProbe.Start();
+    }
+
+  void Execute( itk::Object* caller, const itk::EventObject& event )
+    {
+    this->Execute( const_cast< const itk::Object* >( caller ), event );
+    }
+
+  void Start()
+    {
+    this->m_TimeProbe.Start();
+    }
+
+protected:
+  ChunkReporter() {}
+
+private:
+  itk::TimeProbe m_TimeProbe;
+};
+
+template< class TInputImage, class TLevelSet >
+int SegmentHybrid( TInputImage* inputImage,
+                   unsigned int numberOfIterations,
+                   double crossoverFrontFraction,
+                   unsigned int checkPeriod,
+                   unsigned int reinitializationPeriod,
+                   const char* outputFileName )
+{
+  typedef TInputImage                                         InputImageType;
+  typedef itk::Image< OutputPixelType, TInputImage::ImageDimension > OutputImageType;
+
+  typedef itk::HybridLevelSetEvolution< InputImageType, TLevelSet > HybridType;
+  typename HybridType::Pointer hybrid = HybridType::New();
+  hybrid->SetInput( inputImage );
+  hybrid->SetNumberOfIterations( numberOfIterations );
+  hybrid->SetCrossoverFrontFraction( crossoverFrontFraction );
+  hybrid->SetCheckPeriod( checkPeriod );
+  hybrid->SetReinitializationPeriod( reinitializationPeriod );
+
+  // Seed with a box covering the central half of the image
+  typename InputImageType::RegionType region = inputImage->GetLargestPossibleRegion();
+  for( unsigned int dim = 0; dim < TInputImage::ImageDimension; dim++ )
+    {
+    const itk::SizeValueType size = std::max( region.GetSize()[dim] / 2, itk::SizeValueType( 1 ) );
+    region.SetIndex( dim, region.GetIndex()[dim] +
+                     static_cast< itk::OffsetValueType >( ( region.GetSize()[dim] - size ) / 2 ) );
+    region.SetSize( dim, size );
+    }
+  hybrid->AddSeedRegion( region );
+
+  typedef ChunkReporter< HybridType > ReporterType;
+  typename ReporterType::Pointer reporter = ReporterType::New();
+  hybrid->AddObserver( itk::IterationEvent(), reporter );
+
+  itk::TimeProbe timeProbe;
+  timeProbe.Start();
+  reporter->Start();
+
+  try
+    {
+    hybrid->Update();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  timeProbe.Stop();
+  std::cout << hybrid->GetNumberOfConversions() << " conversion(s), "
+            << hybrid->GetReinitializer()->GetNumberOfReinitializations()
+            << " reinitialization(s)" << std::endl;
+  std::cout << "Total: " << timeProbe.GetTotal() << " " << timeProbe.GetUnit() << std::endl;
+
+  typedef itk::SparseLevelSetToImageFilter< TLevelSet, OutputImageType > LevelSetToImageFilterType;
+  typename LevelSetToImageFilterType::Pointer levelSetToImage = LevelSetToImageFilterType::New();
+  levelSetToImage->SetLevelSet( hybrid->GetLevelSet() );
+  levelSetToImage->SetOutputParametersFromImage( inputImage );
+
+  typedef itk::ImageFileWriter< OutputImageType >     OutputWriterType;
+  typename OutputWriterType::Pointer writer = OutputWriterType::New();
+  writer->SetFileName( outputFileName );
+  writer->SetInput( levelSetToImage->GetOutput() );
+
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cout << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+template< unsigned int VDimension >
+int Run( const char* inputFileName, const char* outputFileName,
+         unsigned int numberOfIterations, double crossoverFrontFraction,
+         unsigned int checkPeriod, unsigned int reinitializationPeriod,
+         const std::string& representation )
+{
+  typedef itk::Image< InputPixelType, VDimension >  InputImageType;
+
+  typedef itk::ImageFileReader< InputImageType >    ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( inputFileName );
+  reader->Update();
+  typename InputImageType::Pointer inputImage = reader->GetOutput();
+
+  typedef float PixelType;
+
+  if( representation == "Whitaker" )
+    {
+    typedef itk::WhitakerSparseLevelSetImage< PixelType, VDimension > LevelSetType;
+    return SegmentHybrid< InputImageType, LevelSetType >( inputImage,
+      numberOfIterations, crossoverFrontFraction, checkPeriod,
+      reinitializationPeriod, outputFileName );
+    }
+  if( representation == "Shi" )
+    {
+    typedef itk::ShiSparseLevelSetImage< VDimension > LevelSetType;
+    return SegmentHybrid< InputImageType, LevelSetType >( inputImage,
+      numberOfIterations, crossoverFrontFraction, checkPeriod,
+      reinitializationPeriod, outputFileName );
+    }
+  if( representation == "Malcolm" )
+    {
+    typedef itk::MalcolmSparseLevelSetImage< VDimension > LevelSetType;
+    return SegmentHybrid< InputImageType, LevelSetType >( inputImage,
+      numberOfIterations, crossoverFrontFraction, checkPeriod,
+      reinitializationPeriod, outputFileName );
+    }
+
+  std::cerr << "Unknown representation: " << representation << std::endl;
+  return EXIT_FAILURE;
+}
+
+int main( int argc, char* argv[] )
+{
+  if( argc < 4 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << "./HybridLevelSet " <<std::endl;
+    std::cerr << "1- Input Image (2D or 3D)" <<std::endl;
+    std::cerr << "2- Number of Iterations" <<std::endl;
+    std::cerr << "3- Output" <<std::endl;
+    std::cerr << "4- [Front fraction above which the level-set is dense (default: 0.05)]" <<std::endl;
+    std::cerr << "5- [Iterations between two measures of the front (default: 10)]" <<std::endl;
+    std::cerr << "6- [Sparse representation: Whitaker (default), Shi or Malcolm]" <<std::endl;
+    std::cerr << "7- [Dense iterations between two reinitializations (default: 0, none)]" <<std::endl;
+
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int numberOfIterations = atoi( argv[2] );
+
+  double crossoverFrontFraction = 0.05;
+  if( argc > 4 )
+    {
+    crossoverFrontFraction = atof( argv[4] );
+    }
+
+  unsigned int checkPeriod = 10;
+  if( argc > 5 )
+    {
+    checkPeriod = atoi( argv[5] );
+    }
+
+  std::string representation = "Whitaker";
+  if( argc > 6 )
+    {
+    representation = argv[6];
+    }
+
+  unsigned int reinitializationPeriod = 0;
+  if( argc > 7 )
+    {
+    reinitializationPeriod = atoi( argv[7] );
+    }
+
+  // The dimension of the input is only known at run time.
+  itk::ImageIOBase::Pointer imageIO =
+    itk::ImageIOFactory::CreateImageIO( argv[1], itk::ImageIOFactory::ReadMode );
+  if( imageIO.IsNull() )
+    {
+    std::cerr << "Could not read " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+  imageIO->SetFileName( argv[1] );
+  imageIO->ReadImageInformation();
+
+  switch( imageIO->GetNumberOfDimensions() )
+    {
+    case 2:
+      return Run< 2 >( argv[1], argv[3], numberOfIterations, crossoverFrontFraction,
+                       checkPeriod, reinitializationPeriod, representation );
+    case 3:
+      return Run< 3 >( argv[1], argv[3], numberOfIterations, crossoverFrontFraction,
+                       checkPeriod, reinitializationPeriod, representation );
+    default:
+      std::cerr << "Unsupported dimension: " << imageIO->GetNumberOfDimensions() << std::endl;
+      return EXIT_FAILURE;
+    }
+}
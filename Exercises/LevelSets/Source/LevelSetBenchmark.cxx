@@ -0,0 +1,599 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkLevelSetDomainMapImageFilter.h"
+#include "itkLevelSetContainer.h"
+#include "itkLevelSetEquationChanAndVeseInternalTerm.h"
+#include "itkLevelSetEquationChanAndVeseExternalTerm.h"
+#include "itkLevelSetEquationCurvatureTerm.h"
+#include "itkLevelSetEquationTermContainer.h"
+#include "itkLevelSetEquationContainer.h"
+#include "itkLevelSetEquationTimedTerm.h"
+#include "itkLevelSetTimedEvolution.h"
+#include "itkLevelSetIncrementalLabelMapEvolution.h"
+#include "itkTabulatedHeavisideStepFunction.h"
+#include "itkSeedToSparseLevelSetImageAdaptor.h"
+#include "itkSparseLevelSetLayerTraits.h"
+#include "itkLevelSetEvolutionNumberOfIterationsStoppingCriterion.h"
+#include "itkWhitakerSparseLevelSetImage.h"
+#include "itkShiSparseLevelSetImage.h"
+#include "itkMalcolmSparseLevelSetImage.h"
+#include "itkLevelSetProfilingClock.h"
+#include "itkMemoryProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <list>
+#include <string>
+#include <vector>
+
+typedef unsigned char InputPixelType;
+
+// Results of the benchmark of one configuration. The throughput, the layer
+// sizes and the memory are measured on a first run without timers; the
+// breakdown of the time on a second run of the same iterations, with
+// timers around the terms and the steps of the evolution.
+struct BenchmarkResult
+{
+  unsigned int NumberOfIterations;
+  double       ElapsedTime;
+  double       BaselineMemory;
+  double       PeakMemory;
+
+  std::vector< int >                          LayerIds;
+  std::vector< std::vector< unsigned long > > LayerSizes; // per iteration
+
+  double        ProfiledElapsedTime;
+  double        ClockOverhead;
+  std::string   TermNames[3];
+  double        TermEvaluateTimes[3];
+  double        TermUpdatePixelTimes[3];
+  double        TermUpdateTimes[3];
+  unsigned long TermEvaluations[3];
+  double        ComputeIterationTime;
+  double        UpdateLevelSetsTime;
+  double        UpdateEquationsTime;
+};
+
+// Record the size of the layers and the memory used after each iteration.
+template< class TLevelSet >
+class LayerSizeRecorder : public itk::Command
+{
+public:
+  typedef LayerSizeRecorder           Self;
+  typedef itk::Command                Superclass;
+  typedef itk::SmartPointer< Self >   Pointer;
+
+  itkNewMacro( Self );
+
+  typedef itk::SparseLevelSetLayerTraits< TLevelSet >   LayerTraitsType;
+  typedef typename LayerTraitsType::LayerIdListType     LayerIdListType;
+
+  void Execute( const itk::Object* itkNotUsed( caller ), const itk::EventObject& event )
+    {
+    if( !itk::IterationEvent().CheckEvent( &event ) )
+      {
+      return;
+      }
+
+    const double start = itk::LevelSetProfilingClock::GetTime();
+
+    const LayerIdListType layerIds = LayerTraitsType::GetLayerIds();
+    std::vector< unsigned long > sizes;
+    for( typename LayerIdListType::const_iterator it = layerIds.begin(); it != layerIds.end(); ++it )
+      {
+      sizes.push_back( static_cast< unsigned long >( this->m_LevelSet->GetLayer( *it ).size() ) );
+      }
+    this->m_Result->LayerSizes.push_back( sizes );
+    this->SampleMemory();
+
+    this->m_OwnTime += itk::LevelSetProfilingClock::GetTime() - start;
+    }
+
+  void Execute( itk::Object* caller, const itk::EventObject& event )
+    {
+    this->Execute( const_cast< const itk::Object* >( caller ), event );
+    }
+
+  void SetLevelSet( TLevelSet* levelSet ) { this->m_LevelSet = levelSet; }
+
+  void SetResult( BenchmarkResult* result )
+    {
+    this->m_Result = result;
+
+    const LayerIdListType layerIds = LayerTraitsType::GetLayerIds();
+    this->m_Result->LayerIds.assign( layerIds.begin(), layerIds.end() );
+    this->m_Result->LayerSizes.clear();
+    this->m_Result->BaselineMemory = this->m_MemoryProbe.GetInstantValue();
+    this->m_Result->PeakMemory = this->m_Result->BaselineMemory;
+    }
+
+  void SampleMemory()
+    {
+    this->m_Result->PeakMemory = std::max( this->m_Result->PeakMemory,
+      static_cast< double >( this->m_MemoryProbe.GetInstantValue() ) );
+    }
+
+  // Time spent in Execute, to be subtracted from the evolution time
+  double GetOwnTime() const { return this->m_OwnTime; }
+
+protected:
+  LayerSizeRecorder() : m_Result( NULL ), m_OwnTime( 0. ) {}
+
+private:
+  typename TLevelSet::Pointer m_LevelSet;
+  BenchmarkResult*            m_Result;
+  itk::MemoryProbe            m_MemoryProbe;
+  double                      m_OwnTime;
+};
+
+// Synthetic image of size^VDimension pixels: a bright shape centered in a
+// dark background.
+template< unsigned int VDimension >
+typename itk::Image< InputPixelType, VDimension >::Pointer
+CreateShapeImage( unsigned int size, const std::string& shape )
+{
+  typedef itk::Image< InputPixelType, VDimension > ImageType;
+
+  typename ImageType::IndexType index;
+  index.Fill( 0 );
+  typename ImageType::SizeType imageSize;
+  imageSize.Fill( size );
+
+  typename ImageType::RegionType region;
+  region.SetIndex( index );
+  region.SetSize( imageSize );
+
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+
+  const double center = 0.5 * ( size - 1 );
+  const double radius = 0.35 * size;
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    double distance = 0.;
+    for( unsigned int dim = 0; dim < VDimension; dim++ )
+      {
+      const double d = it.GetIndex()[dim] - center;
+      if( shape == "Box" )
+        {
+        distance = std::max( distance, std::abs( d ) );
+        }
+      else
+        {
+        distance += d * d;
+        }
+      }
+    if( shape != "Box" )
+      {
+      distance = std::sqrt( distance );
+      }
+    it.Set( distance <= radius ? 220 : 20 );
+    }
+
+  return image;
+}
+
+// Evolve a level-set seeded with a box at the center of inputImage for
+// numberOfIterations iterations with a TEvolution. With profile, the terms
+// and the steps of the evolution are timed.
+template< class TInputImage, class TLevelSet, template< class, class > class TEvolution >
+int Evolve( TInputImage* inputImage, unsigned int numberOfIterations,
+            double curvatureCoefficient, bool profile, BenchmarkResult& result )
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+
+  typedef TInputImage                 InputImageType;
+  typedef TLevelSet                   SparseLevelSetType;
+
+  const typename InputImageType::RegionType largestRegion = inputImage->GetLargestPossibleRegion();
+
+  typename InputImageType::RegionType seed;
+  for( unsigned int dim = 0; dim < Dimension; dim++ )
+    {
+    const itk::SizeValueType size = std::max( largestRegion.GetSize()[dim] / 4, itk::SizeValueType( 1 ) );
+    seed.SetIndex( dim, largestRegion.GetIndex()[dim] +
+      static_cast< itk::OffsetValueType >( ( largestRegion.GetSize()[dim] - size ) / 2 ) );
+    seed.SetSize( dim, size );
+    }
+
+  typedef itk::SeedToSparseLevelSetImageAdaptor< SparseLevelSetType > SeedToSparseAdaptorType;
+  typename SeedToSparseAdaptorType::Pointer adaptor = SeedToSparseAdaptorType::New();
+  adaptor->SetReferenceImage( inputImage );
+  adaptor->AddRegion( seed );
+  adaptor->Initialize();
+
+  typename SparseLevelSetType::Pointer levelSet = adaptor->GetLevelSet();
+
+  typedef itk::IdentifierType         IdentifierType;
+  typedef std::list< IdentifierType > IdListType;
+
+  IdListType listIds;
+  listIds.push_back( 1 );
+
+  typedef itk::Image< IdListType, Dimension >               IdListImageType;
+  typename IdListImageType::Pointer idImage = IdListImageType::New();
+  idImage->SetRegions( largestRegion );
+  idImage->Allocate();
+  idImage->FillBuffer( listIds );
+
+  typedef itk::Image< short, Dimension >                     CacheImageType;
+  typedef itk::LevelSetDomainMapImageFilter< IdListImageType, CacheImageType >
+                                                            DomainMapImageFilterType;
+  typename DomainMapImageFilterType::Pointer domainMapFilter = DomainMapImageFilterType::New();
+  domainMapFilter->SetInput( idImage );
+  domainMapFilter->Update();
+
+  typedef typename SparseLevelSetType::OutputRealType LevelSetOutputRealType;
+
+  typedef itk::TabulatedHeavisideStepFunction<
+    LevelSetOutputRealType, LevelSetOutputRealType > HeavisideFunctionBaseType;
+  typename HeavisideFunctionBaseType::Pointer heaviside = HeavisideFunctionBaseType::New();
+  heaviside->SetEpsilon( 1.0 );
+
+  typedef itk::LevelSetContainer< IdentifierType, SparseLevelSetType > LevelSetContainerType;
+
+  typename LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
+  lscontainer->SetHeaviside( heaviside );
+  lscontainer->SetDomainMapFilter( domainMapFilter );
+  lscontainer->AddLevelSet( 0, levelSet );
+
+  typedef itk::LevelSetEquationTimedTerm< itk::LevelSetEquationChanAndVeseInternalTerm<
+    InputImageType, LevelSetContainerType > > InternalTermType;
+  typedef itk::LevelSetEquationTimedTerm< itk::LevelSetEquationChanAndVeseExternalTerm<
+    InputImageType, LevelSetContainerType > > ExternalTermType;
+  typedef itk::LevelSetEquationTimedTerm< itk::LevelSetEquationCurvatureTerm<
+    InputImageType, LevelSetContainerType > > CurvatureTermType;
+
+  typename InternalTermType::Pointer cvInternalTerm = InternalTermType::New();
+  cvInternalTerm->SetInput( inputImage );
+  cvInternalTerm->SetCoefficient( 1.0 );
+  cvInternalTerm->SetCurrentLevelSetId( 0 );
+  cvInternalTerm->SetLevelSetContainer( lscontainer );
+  cvInternalTerm->SetTimingEnabled( profile );
+
+  typename ExternalTermType::Pointer cvExternalTerm = ExternalTermType::New();
+  cvExternalTerm->SetInput( inputImage );
+  cvExternalTerm->SetCoefficient( 1.0 );
+  cvExternalTerm->SetCurrentLevelSetId( 0 );
+  cvExternalTerm->SetLevelSetContainer( lscontainer );
+  cvExternalTerm->SetTimingEnabled( profile );
+
+  typename CurvatureTermType::Pointer curvatureTerm = CurvatureTermType::New();
+  curvatureTerm->SetInput( inputImage );
+  curvatureTerm->SetCoefficient( curvatureCoefficient );
+  curvatureTerm->SetCurrentLevelSetId( 0 );
+  curvatureTerm->SetLevelSetContainer( lscontainer );
+  curvatureTerm->SetTimingEnabled( profile );
+
+  typedef itk::LevelSetEquationTermContainer<
+    InputImageType, LevelSetContainerType > TermContainerType;
+
+  typename TermContainerType::Pointer termContainer = TermContainerType::New();
+  termContainer->SetInput( inputImage );
+  termContainer->SetCurrentLevelSetId( 0 );
+  termContainer->SetLevelSetContainer( lscontainer );
+  termContainer->AddTerm( 0, cvInternalTerm );
+  termContainer->AddTerm( 1, cvExternalTerm );
+  termContainer->AddTerm( 2, curvatureTerm );
+
+  typedef itk::LevelSetEquationContainer< TermContainerType > EquationContainerType;
+  typename EquationContainerType::Pointer equationContainer = EquationContainerType::New();
+  equationContainer->AddEquation( 0, termContainer );
+  equationContainer->SetLevelSetContainer( lscontainer );
+
+  // A fixed number of iterations, so that the runs do the same work.
+  typedef itk::LevelSetEvolutionNumberOfIterationsStoppingCriterion<
+    LevelSetContainerType > StoppingCriterionType;
+
+  typename StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
+  criterion->SetNumberOfIterations( numberOfIterations );
+
+  typedef itk::LevelSetTimedEvolution< EquationContainerType, SparseLevelSetType,
+    TEvolution< EquationContainerType, SparseLevelSetType > > LevelSetEvolutionType;
+
+  typename LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+  evolution->SetStoppingCriterion( criterion );
+  evolution->SetEquationContainer( equationContainer );
+  evolution->SetLevelSetContainer( lscontainer );
+
+  typedef LayerSizeRecorder< SparseLevelSetType > RecorderType;
+  typename RecorderType::Pointer recorder;
+
+  if( !profile )
+    {
+    recorder = RecorderType::New();
+    recorder->SetLevelSet( levelSet );
+    recorder->SetResult( &result );
+    evolution->AddObserver( itk::IterationEvent(), recorder );
+    }
+
+  const double start = itk::LevelSetProfilingClock::GetTime();
+
+  try
+    {
+    evolution->Update();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double elapsedTime = itk::LevelSetProfilingClock::GetTime() - start;
+
+  if( !profile )
+    {
+    recorder->SampleMemory();
+    result.NumberOfIterations = criterion->GetCurrentIteration();
+    result.ElapsedTime = elapsedTime - recorder->GetOwnTime();
+    return EXIT_SUCCESS;
+    }
+
+  result.ProfiledElapsedTime = elapsedTime;
+  result.ClockOverhead = itk::LevelSetProfilingClock::EstimateOverhead();
+
+  result.TermNames[0] = "internal";
+  result.TermEvaluateTimes[0] = cvInternalTerm->GetEvaluateTime();
+  result.TermUpdatePixelTimes[0] = cvInternalTerm->GetUpdatePixelTime();
+  result.TermUpdateTimes[0] = cvInternalTerm->GetUpdateTime();
+  result.TermEvaluations[0] = cvInternalTerm->GetNumberOfEvaluations();
+
+  result.TermNames[1] = "external";
+  result.TermEvaluateTimes[1] = cvExternalTerm->GetEvaluateTime();
+  result.TermUpdatePixelTimes[1] = cvExternalTerm->GetUpdatePixelTime();
+  result.TermUpdateTimes[1] = cvExternalTerm->GetUpdateTime();
+  result.TermEvaluations[1] = cvExternalTerm->GetNumberOfEvaluations();
+
+  result.TermNames[2] = "curvature";
+  result.TermEvaluateTimes[2] = curvatureTerm->GetEvaluateTime();
+  result.TermUpdatePixelTimes[2] = curvatureTerm->GetUpdatePixelTime();
+  result.TermUpdateTimes[2] = curvatureTerm->GetUpdateTime();
+  result.TermEvaluations[2] = curvatureTerm->GetNumberOfEvaluations();
+
+  result.ComputeIterationTime = evolution->GetComputeIterationTime();
+  result.UpdateLevelSetsTime = evolution->GetUpdateLevelSetsTime();
+  result.UpdateEquationsTime = evolution->GetUpdateEquationsTime();
+
+  return EXIT_SUCCESS;
+}
+
+// Evolve with the label map rebuilt at every iteration, as
+// LevelSetEvolution does, or updated incrementally.
+template< class TInputImage, class TLevelSet >
+int Evolve( TInputImage* inputImage, unsigned int numberOfIterations,
+            double curvatureCoefficient, const std::string& labelMapUpdate,
+            bool profile, BenchmarkResult& result )
+{
+  if( labelMapUpdate == "Incremental" )
+    {
+    return Evolve< TInputImage, TLevelSet, itk::LevelSetIncrementalLabelMapEvolution >(
+      inputImage, numberOfIterations, curvatureCoefficient, profile, result );
+    }
+  return Evolve< TInputImage, TLevelSet, itk::LevelSetEvolution >(
+    inputImage, numberOfIterations, curvatureCoefficient, profile, result );
+}
+
+// Write the result as a JSON object.
+void WriteResult( std::ostream& os, const BenchmarkResult& result,
+                  unsigned int dimension, unsigned int size, const std::string& shape,
+                  const std::string& representation, const std::string& labelMapUpdate,
+                  double curvatureCoefficient )
+{
+  os.precision( 9 );
+
+  os << "{" << std::endl;
+  os << "  \"benchmark\": \"LevelSetBenchmark\"," << std::endl;
+  os << "  \"representation\": \"" << representation << "\"," << std::endl;
+  os << "  \"label_map_update\": \"" << labelMapUpdate << "\"," << std::endl;
+  os << "  \"shape\": \"" << shape << "\"," << std::endl;
+  os << "  \"dimension\": " << dimension << "," << std::endl;
+  os << "  \"size\": " << size << "," << std::endl;
+  os << "  \"curvature_coefficient\": " << curvatureCoefficient << "," << std::endl;
+  os << "  \"iterations\": " << result.NumberOfIterations << "," << std::endl;
+  os << "  \"elapsed_seconds\": " << result.ElapsedTime << "," << std::endl;
+  os << "  \"iterations_per_second\": "
+     << ( result.ElapsedTime > 0. ? result.NumberOfIterations / result.ElapsedTime : 0. ) << "," << std::endl;
+  os << "  \"memory_unit\": \"" << itk::MemoryProbe().GetUnit() << "\"," << std::endl;
+  os << "  \"baseline_memory\": " << result.BaselineMemory << "," << std::endl;
+  os << "  \"peak_memory\": " << result.PeakMemory << "," << std::endl;
+
+  os << "  \"profile\": {" << std::endl;
+  os << "    \"elapsed_seconds\": " << result.ProfiledElapsedTime << "," << std::endl;
+  os << "    \"clock_overhead_seconds\": " << result.ClockOverhead << "," << std::endl;
+  os << "    \"compute_iteration_seconds\": " << result.ComputeIterationTime << "," << std::endl;
+  os << "    \"layer_update_seconds\": " << result.UpdateLevelSetsTime << "," << std::endl;
+  os << "    \"equation_update_seconds\": " << result.UpdateEquationsTime << "," << std::endl;
+  os << "    \"terms\": {" << std::endl;
+  for( unsigned int t = 0; t < 3; t++ )
+    {
+    os << "      \"" << result.TermNames[t] << "\": { "
+       << "\"evaluations\": " << result.TermEvaluations[t] << ", "
+       << "\"evaluate_seconds\": " << result.TermEvaluateTimes[t] << ", "
+       << "\"update_pixel_seconds\": " << result.TermUpdatePixelTimes[t] << ", "
+       << "\"update_seconds\": " << result.TermUpdateTimes[t] << " }"
+       << ( t < 2 ? "," : "" ) << std::endl;
+    }
+  os << "    }" << std::endl;
+  os << "  }," << std::endl;
+
+  os << "  \"layers\": {" << std::endl;
+  os << "    \"ids\": [";
+  for( size_t l = 0; l < result.LayerIds.size(); l++ )
+    {
+    os << ( l > 0 ? ", " : "" ) << result.LayerIds[l];
+    }
+  os << "]," << std::endl;
+  os << "    \"sizes\": [" << std::endl;
+  for( size_t i = 0; i < result.LayerSizes.size(); i++ )
+    {
+    os << "      [";
+    for( size_t l = 0; l < result.LayerSizes[i].size(); l++ )
+      {
+      os << ( l > 0 ? ", " : "" ) << result.LayerSizes[i][l];
+      }
+    os << "]" << ( i + 1 < result.LayerSizes.size() ? "," : "" ) << std::endl;
+    }
+  os << "    ]" << std::endl;
+  os << "  }" << std::endl;
+  os << "}" << std::endl;
+}
+
+template< unsigned int VDimension >
+int Run( unsigned int size, unsigned int numberOfIterations, const char* outputFileName,
+         const std::string& shape, const std::string& representation,
+         const std::string& labelMapUpdate, double curvatureCoefficient )
+{
+  typedef itk::Image< InputPixelType, VDimension > InputImageType;
+  typename InputImageType::Pointer inputImage = CreateShapeImage< VDimension >( size, shape );
+
+  typedef float PixelType;
+
+  BenchmarkResult result;
+  int status = EXIT_FAILURE;
+
+  for( unsigned int run = 0; run < 2; run++ )
+    {
+    const bool profile = ( run == 1 );
+
+    if( representation == "Whitaker" )
+      {
+      typedef itk::WhitakerSparseLevelSetImage< PixelType, VDimension > LevelSetType;
+      status = Evolve< InputImageType, LevelSetType >( inputImage, numberOfIterations,
+        curvatureCoefficient, labelMapUpdate, profile, result );
+      }
+    else if( representation == "Shi" )
+      {
+      typedef itk::ShiSparseLevelSetImage< VDimension > LevelSetType;
+      status = Evolve< InputImageType, LevelSetType >( inputImage, numberOfIterations,
+        curvatureCoefficient, labelMapUpdate, profile, result );
+      }
+    else if( representation == "Malcolm" )
+      {
+      typedef itk::MalcolmSparseLevelSetImage< VDimension > LevelSetType;
+      status = Evolve< InputImageType, LevelSetType >( inputImage, numberOfIterations,
+        curvatureCoefficient, labelMapUpdate, profile, result );
+      }
+    else
+      {
+      std::cerr << "Unknown representation: " << representation << std::endl;
+      }
+
+    if( status != EXIT_SUCCESS )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << representation << " (" << labelMapUpdate << "), " << shape << " " << size << "^" << VDimension << ": "
+            << result.NumberOfIterations / result.ElapsedTime << " iterations/s" << std::endl;
+
+  std::ofstream output( outputFileName );
+  if( !output.is_open() )
+    {
+    std::cerr << "Could not write " << outputFileName << std::endl;
+    return EXIT_FAILURE;
+    }
+  WriteResult( output, result, VDimension, size, shape, representation, labelMapUpdate,
+               curvatureCoefficient );
+
+  return EXIT_SUCCESS;
+}
+
+int main( int argc, char* argv[] )
+{
+  if( argc < 5 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << "./LevelSetBenchmark " <<std::endl;
+    std::cerr << "1- Dimension (2 or 3)" <<std::endl;
+    std::cerr << "2- Size of the synthetic image along each axis" <<std::endl;
+    std::cerr << "3- Number of Iterations" <<std::endl;
+    std::cerr << "4- Output JSON file" <<std::endl;
+    std::cerr << "5- [Shape: Sphere (default) or Box]" <<std::endl;
+    std::cerr << "6- [Representation: Whitaker (default), Shi or Malcolm]" <<std::endl;
+    std::cerr << "7- [Curvature term coefficient (default: 0.1)]" <<std::endl;
+    std::cerr << "8- [Label map update: Rebuild (default) or Incremental]" <<std::endl;
+
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int dimension = atoi( argv[1] );
+  const unsigned int size = atoi( argv[2] );
+  const unsigned int numberOfIterations = atoi( argv[3] );
+
+  if( size < 8 )
+    {
+    std::cerr << "The synthetic image must be at least 8 pixels wide" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string shape = "Sphere";
+  if( argc > 5 )
+    {
+    shape = argv[5];
+    }
+  if( ( shape != "Sphere" ) && ( shape != "Box" ) )
+    {
+    std::cerr << "Unknown shape: " << shape << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string representation = "Whitaker";
+  if( argc > 6 )
+    {
+    representation = argv[6];
+    }
+
+  double curvatureCoefficient = 0.1;
+  if( argc > 7 )
+    {
+    curvatureCoefficient = atof( argv[7] );
+    }
+
+  // Incremental only changes the Whitaker layer updates.
+  std::string labelMapUpdate = "Rebuild";
+  if( argc > 8 )
+    {
+    labelMapUpdate = argv[8];
+    }
+  if( ( labelMapUpdate != "Rebuild" ) && ( labelMapUpdate != "Incremental" ) )
+    {
+    std::cerr << "Unknown label map update: " << labelMapUpdate << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  switch( dimension )
+    {
+    case 2:
+      return Run< 2 >( size, numberOfIterations, argv[4], shape, representation,
+                       labelMapUpdate, curvatureCoefficient );
+    case 3:
+      return Run< 3 >( size, numberOfIterations, argv[4], shape, representation,
+                       labelMapUpdate, curvatureCoefficient );
+    default:
+      std::cerr << "Unsupported dimension: " << dimension << std::endl;
+      return EXIT_FAILURE;
+    }
+}
@@ -19,23 +19,28 @@
 #include "itkImage.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
-#include "itkImageRegionIteratorWithIndex.h"
 #include "itkLevelSetDomainMapImageFilter.h"
 #include "itkLevelSetContainer.h"
 #include "itkLevelSetEquationChanAndVeseInternalTerm.h"
 #include "itkLevelSetEquationChanAndVeseExternalTerm.h"
-#include "itkLevelSetEquationTermContainer.h"
+#include "itkLevelSetEquationFusedTermContainer.h"
 #include "itkLevelSetEquationContainer.h"
-#include "itkSinRegularizedHeavisideStepFunction.h"
+#include "itkTabulatedHeavisideStepFunction.h"
 #include "itkLevelSetEvolution.h"
-#include "itkBinaryImageToLevelSetImageAdaptor.h"
+#include "itkSeedToSparseLevelSetImageAdaptor.h"
 #include "itkLevelSetEvolutionNumberOfIterationsStoppingCriterion.h"
-#include "itkNumericTraits.h"
 #include "itkWhitakerSparseLevelSetImage.h"
+#include "itkShiSparseLevelSetImage.h"
+#include "itkMalcolmSparseLevelSetImage.h"
+#include "itkSparseLevelSetToImageFilter.h"
 #include "itkLevelSetEquationCurvatureTerm.h"
 
-#include "itkLevelSetIterationUpdateCommand.h"
+#include "itkLevelSetLayerTraceRecorder.h"
+
+#ifdef LEVELSET_EXERCISES_USE_VTK
+#include "itkLevelSetAsynchronousVisualizationCommand.h"
 #include "vtkVisualize2DSparseLevelSetLayers.h"
+#endif
 
 // ------------------------------------------------------------------------
 //
@@ -47,41 +52,30 @@
 // ------------------------------------------------------------------------
 
 
-int main( int argc, char* argv[] )
-{
-  if( argc < 6 )
-    {
-    std::cerr << "Missing Arguments" << std::endl;
-    std::cerr << "./LevelSetExercise1 " <<std::endl;
-    std::cerr << "1- Input Image" <<std::endl;
-    std::cerr << "2- Number of Iterations" <<std::endl;
-    std::cerr << "3- Curvature Term coefficient" <<std::endl;
-    std::cerr << "4- Visualization (0 or 1)" <<std::endl;
-    std::cerr << "5- Output" <<std::endl;
-
-    return EXIT_FAILURE;
-    }
-
-  // Image Dimension
-  const unsigned int Dimension = 2;
-
-  typedef unsigned char                                     InputPixelType;
-  typedef itk::Image< InputPixelType, Dimension >           InputImageType;
+// Image Dimension
+const unsigned int Dimension = 2;
 
-  // Read input image (to be processed).
-  typedef itk::ImageFileReader< InputImageType >            ReaderType;
-  ReaderType::Pointer reader = ReaderType::New();
-  reader->SetFileName( argv[1] );
-  reader->Update();
-  InputImageType::Pointer inputImage = reader->GetOutput();
+typedef unsigned char                                     InputPixelType;
+typedef itk::Image< InputPixelType, Dimension >           InputImageType;
+typedef itk::Image< char, Dimension >                     OutputImageType;
 
-  // Generate a binary mask that will be used as initialization
-  // of the level set evolution.
-  InputImageType::Pointer binary = InputImageType::New();
-  binary->SetRegions( inputImage->GetLargestPossibleRegion() );
-  binary->CopyInformation( inputImage );
-  binary->Allocate();
-  binary->FillBuffer( itk::NumericTraits<InputPixelType>::Zero );
+// Segment inputImage with a sparse level-set of type TLevelSet; the label
+// map of the final level-set is written into outputImage.
+template< class TLevelSet >
+int SegmentWithSparseLevelSet( InputImageType* inputImage,
+                               unsigned int numberOfIterations,
+                               double curvatureTermCoefficient,
+                               bool visualize,
+                               const std::string& traceFileName,
+                               OutputImageType::Pointer& outputImage )
+{
+  // The initial level set is the box starting at (5, 5) of size 120 x 120.
+  // Its layers are grown directly from the boundary of the box: no binary
+  // image of the size of the input is allocated or scanned.
+  // The representation is given by TLevelSet; e.g. a "Whitaker" sparse
+  // level-set maintains the layers {-2, -1, 0, +1, +2 } around the zero-set,
+  // while "Shi" and "Malcolm" only keep {-1, +1} and {0} respectively.
+  typedef itk::SeedToSparseLevelSetImageAdaptor< TLevelSet > SeedToSparseAdaptorType;
 
   InputImageType::RegionType region;
   InputImageType::IndexType index;
@@ -93,35 +87,16 @@ int main( int argc, char* argv[] )
   region.SetIndex( index );
   region.SetSize( size );
 
-  typedef itk::ImageRegionIteratorWithIndex< InputImageType > InputIteratorType;
-  InputIteratorType iIt( binary, region );
-  iIt.GoToBegin();
-  while( !iIt.IsAtEnd() )
-    {
-    iIt.Set( itk::NumericTraits<InputPixelType>::One );
-    ++iIt;
-    }
-
-  // Convert the binary mask into a level set function.
-  // Here the output level-set will be a "Whitaker" sparse level-set;
-  // i.e. only few layers {-2, -1, 0, +1, +2 } around the zero-set are
-  // maintained, the rest of the domain is either -3 or +3.
-  typedef float PixelType;
-
-  typedef itk::WhitakerSparseLevelSetImage< PixelType, Dimension > WhitakerSparseLevelSetImageType;
-
-  typedef itk::BinaryImageToLevelSetImageAdaptor< InputImageType,
-    WhitakerSparseLevelSetImageType > BinaryToSparseAdaptorType;
-
-  BinaryToSparseAdaptorType::Pointer adaptor = BinaryToSparseAdaptorType::New();
-  adaptor->SetInputImage( binary );
+  typename SeedToSparseAdaptorType::Pointer adaptor = SeedToSparseAdaptorType::New();
+  adaptor->SetReferenceImage( inputImage );
+  adaptor->AddRegion( region );
   adaptor->Initialize();
   std::cout << "Finished converting to sparse format" << std::endl;
 
   // Here get the resulting level-set function
-  typedef BinaryToSparseAdaptorType::LevelSetType SparseLevelSetType;
+  typedef typename SeedToSparseAdaptorType::LevelSetType SparseLevelSetType;
 
-  SparseLevelSetType::Pointer levelSet = adaptor->GetLevelSet();
+  typename SparseLevelSetType::Pointer levelSet = adaptor->GetLevelSet();
 
   // Create here the bounds in which this level-set can evolved.
 
@@ -136,7 +111,7 @@ int main( int argc, char* argv[] )
   // We create one image where for each pixel we provide which level-set exists.
   // In this example the first level-set is defined on the whole image.
   typedef itk::Image< IdListType, Dimension >               IdListImageType;
-  IdListImageType::Pointer id_image = IdListImageType::New();
+  typename IdListImageType::Pointer id_image = IdListImageType::New();
   id_image->SetRegions( inputImage->GetLargestPossibleRegion() );
   id_image->Allocate();
   id_image->FillBuffer( list_ids );
@@ -144,24 +119,24 @@ int main( int argc, char* argv[] )
   typedef itk::Image< short, Dimension >                     CacheImageType;
   typedef itk::LevelSetDomainMapImageFilter< IdListImageType, CacheImageType >
                                                             DomainMapImageFilterType;
-  DomainMapImageFilterType::Pointer domainMapFilter = DomainMapImageFilterType::New();
+  typename DomainMapImageFilterType::Pointer domainMapFilter = DomainMapImageFilterType::New();
   domainMapFilter->SetInput( id_image );
   domainMapFilter->Update();
   std::cout << "Domain map computed" << std::endl;
 
   // Define the Heaviside function
-  typedef SparseLevelSetType::OutputRealType LevelSetOutputRealType;
+  typedef typename SparseLevelSetType::OutputRealType LevelSetOutputRealType;
 
-  typedef itk::SinRegularizedHeavisideStepFunction< LevelSetOutputRealType,
+  typedef itk::TabulatedHeavisideStepFunction< LevelSetOutputRealType,
       LevelSetOutputRealType > HeavisideFunctionBaseType;
-  HeavisideFunctionBaseType::Pointer heaviside = HeavisideFunctionBaseType::New();
+  typename HeavisideFunctionBaseType::Pointer heaviside = HeavisideFunctionBaseType::New();
   heaviside->SetEpsilon( 1.0 );
 
   // Insert the levelsets in a levelset container
   typedef itk::LevelSetContainer< IdentifierType, SparseLevelSetType >
       LevelSetContainerType;
 
-  LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
+  typename LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
   lscontainer->SetHeaviside( heaviside );
   lscontainer->SetDomainMapFilter( domainMapFilter );
 
@@ -175,7 +150,7 @@ int main( int argc, char* argv[] )
   typedef itk::LevelSetEquationChanAndVeseInternalTerm< InputImageType,
       LevelSetContainerType > ChanAndVeseInternalTermType;
 
-  ChanAndVeseInternalTermType::Pointer cvInternalTerm0 = ChanAndVeseInternalTermType::New();
+  typename ChanAndVeseInternalTermType::Pointer cvInternalTerm0 = ChanAndVeseInternalTermType::New();
   cvInternalTerm0->SetInput( inputImage );
   cvInternalTerm0->SetCoefficient( 1.0 );
   cvInternalTerm0->SetCurrentLevelSetId( 0 );
@@ -186,25 +161,20 @@ int main( int argc, char* argv[] )
   typedef itk::LevelSetEquationChanAndVeseExternalTerm< InputImageType,
       LevelSetContainerType > ChanAndVeseExternalTermType;
 
-  ChanAndVeseExternalTermType::Pointer cvExternalTerm0 = ChanAndVeseExternalTermType::New();
+  typename ChanAndVeseExternalTermType::Pointer cvExternalTerm0 = ChanAndVeseExternalTermType::New();
   cvExternalTerm0->SetInput( inputImage );
   cvExternalTerm0->SetCoefficient( 1.0 );
   cvExternalTerm0->SetCurrentLevelSetId( 0 );
   cvExternalTerm0->SetLevelSetContainer( lscontainer );
   std::cout << "Chan and Vese external term created" << std::endl;
 
-  // A good value to try; 4000.0
-  double CurvatureTermCoefficient = atof( argv[3] );
-  std::cout <<"CurvatureTermCoefficient : "
-            << CurvatureTermCoefficient <<std::endl;
-
   // put the curvatre term here!
   typedef itk::LevelSetEquationCurvatureTerm<
     InputImageType, LevelSetContainerType > CurvatureTermType;
 
-  CurvatureTermType::Pointer curvatureTerm = CurvatureTermType::New();
-  curvatureTerm->SetInput( binary );
-  curvatureTerm->SetCoefficient( CurvatureTermCoefficient );
+  typename CurvatureTermType::Pointer curvatureTerm = CurvatureTermType::New();
+  curvatureTerm->SetInput( inputImage );
+  curvatureTerm->SetCoefficient( curvatureTermCoefficient );
   curvatureTerm->SetCurrentLevelSetId( 0 );
   curvatureTerm->SetLevelSetContainer( lscontainer );
 
@@ -212,10 +182,13 @@ int main( int argc, char* argv[] )
   // **************** CREATE ALL EQUATIONS ****************
 
   // Create Term Container which corresponds to the combination of terms in the PDE.
-  typedef itk::LevelSetEquationTermContainer< InputImageType, LevelSetContainerType >
+  // The fused container computes the value and the derivatives of the
+  // level-set required by its terms once per node, and shares them.
+  typedef itk::LevelSetEquationFusedTermContainer< InputImageType, LevelSetContainerType >
                                                             TermContainerType;
-  TermContainerType::Pointer termContainer0 = TermContainerType::New();
+  typename TermContainerType::Pointer termContainer0 = TermContainerType::New();
   termContainer0->SetInput( inputImage );
+  termContainer0->SetCurrentLevelSetId( 0 );
   termContainer0->SetLevelSetContainer( lscontainer );
 
   termContainer0->AddTerm( 0, cvInternalTerm0 );
@@ -226,37 +199,62 @@ int main( int argc, char* argv[] )
 
   typedef itk::LevelSetEquationContainer< TermContainerType >
                                                             EquationContainerType;
-  EquationContainerType::Pointer equationContainer = EquationContainerType::New();
+  typename EquationContainerType::Pointer equationContainer = EquationContainerType::New();
   equationContainer->AddEquation( 0, termContainer0 );
   equationContainer->SetLevelSetContainer( lscontainer );
 
   typedef itk::LevelSetEvolutionNumberOfIterationsStoppingCriterion< LevelSetContainerType >
       StoppingCriterionType;
-  StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
-  criterion->SetNumberOfIterations( atoi( argv[2]) );
+  typename StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
+  criterion->SetNumberOfIterations( numberOfIterations );
 
   typedef itk::LevelSetEvolution< EquationContainerType, SparseLevelSetType > LevelSetEvolutionType;
 
-  LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+  typename LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
 
-  // Create the visualizer
+#ifdef LEVELSET_EXERCISES_USE_VTK
+  // Create the visualizer. The evolution then runs on a worker thread and
+  // the layers are rendered on this one: on each iteration the evolution
+  // only copies the layers if the rendering is waiting for a new frame,
+  // and never waits for the rendering.
   typedef vtkVisualize2DSparseLevelSetLayers< InputImageType, SparseLevelSetType > VisualizationType;
-  VisualizationType::Pointer visualizer = VisualizationType::New();
+  typedef itk::LevelSetAsynchronousVisualizationCommand< LevelSetEvolutionType, VisualizationType >
+                                                            VisualizationCommandType;
+  typename VisualizationCommandType::Pointer visualizationCommand;
 
-  visualizer->SetInputImage( inputImage );
-  visualizer->SetLevelSet( levelSet );
-  visualizer->SetScreenCapture( false );
-  std::cout << "Visualizer created" << std::endl;
+  if( visualize )
+    {
+    typename VisualizationType::Pointer visualizer = VisualizationType::New();
+    visualizer->SetInputImage( inputImage );
+    visualizer->SetScreenCapture( false );
+
+    visualizationCommand = VisualizationCommandType::New();
+    visualizationCommand->SetFilterToUpdate( visualizer );
+    visualizationCommand->SetLevelSet( levelSet );
+    visualizationCommand->SetUpdatePeriod( 1 );
+    std::cout << "Visualizer created" << std::endl;
+    }
+#else
+  if( visualize )
+    {
+    std::cerr << "Built without VTK: visualization is disabled" << std::endl;
+    }
+#endif
 
-  typedef itk::LevelSetIterationUpdateCommand< LevelSetEvolutionType, VisualizationType > IterationUpdateCommandType;
-  IterationUpdateCommandType::Pointer iterationUpdateCommand = IterationUpdateCommandType::New();
-  iterationUpdateCommand->SetFilterToUpdate( visualizer );
-  iterationUpdateCommand->SetUpdatePeriod( 1 );
-  evolution->AddObserver( itk::IterationEvent(), iterationUpdateCommand );
+  // Optionally record the layers of every iteration, to be inspected later
+  // with LevelSetTraceReplay.
+  typedef itk::LevelSetLayerTraceRecorder< SparseLevelSetType > TraceRecorderType;
+  typename TraceRecorderType::Pointer traceRecorder;
 
-  if( atoi( argv[4] ) == 1 )
+  if( !traceFileName.empty() )
     {
-    evolution->AddObserver( itk::IterationEvent(), iterationUpdateCommand );
+    traceRecorder = TraceRecorderType::New();
+    traceRecorder->SetFileName( traceFileName );
+    traceRecorder->SetLevelSet( levelSet );
+    traceRecorder->Open();
+
+    evolution->AddObserver( itk::IterationEvent(), traceRecorder );
+    std::cout << "Recording layers into " << traceFileName << std::endl;
     }
 
   evolution->SetEquationContainer( equationContainer );
@@ -265,7 +263,18 @@ int main( int argc, char* argv[] )
 
   try
     {
+#ifdef LEVELSET_EXERCISES_USE_VTK
+    if( visualize )
+      {
+      visualizationCommand->Evolve( evolution );
+      }
+    else
+      {
+      evolution->Update();
+      }
+#else
     evolution->Update();
+#endif
     }
   catch ( itk::ExceptionObject& err )
     {
@@ -273,24 +282,100 @@ int main( int argc, char* argv[] )
     return EXIT_FAILURE;
     }
 
-  typedef itk::Image< char, Dimension > OutputImageType;
-  OutputImageType::Pointer outputImage = OutputImageType::New();
-  outputImage->SetRegions( inputImage->GetLargestPossibleRegion() );
-  outputImage->CopyInformation( inputImage );
-  outputImage->Allocate();
-  outputImage->FillBuffer( 0 );
+  if( traceRecorder.IsNotNull() )
+    {
+    traceRecorder->Close();
+    }
 
-  typedef itk::ImageRegionIteratorWithIndex< OutputImageType > OutputIteratorType;
-  OutputIteratorType oIt( outputImage, outputImage->GetLargestPossibleRegion() );
-  oIt.GoToBegin();
+  // Rasterize the label map of the level-set, one run-length line at a time.
+  typedef itk::SparseLevelSetToImageFilter< SparseLevelSetType, OutputImageType > LevelSetToImageFilterType;
+  typename LevelSetToImageFilterType::Pointer levelSetToImage = LevelSetToImageFilterType::New();
+  levelSetToImage->SetLevelSet( levelSet );
+  levelSetToImage->SetOutputParametersFromImage( inputImage );
+  levelSetToImage->Update();
 
-  OutputImageType::IndexType idx;
+  outputImage = levelSetToImage->GetOutput();
+  outputImage->DisconnectPipeline();
 
-  while( !oIt.IsAtEnd() )
+  return EXIT_SUCCESS;
+}
+
+int main( int argc, char* argv[] )
+{
+  if( argc < 6 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << "./LevelSetExercise1 " <<std::endl;
+    std::cerr << "1- Input Image" <<std::endl;
+    std::cerr << "2- Number of Iterations" <<std::endl;
+    std::cerr << "3- Curvature Term coefficient" <<std::endl;
+    std::cerr << "4- Visualization (0 or 1)" <<std::endl;
+    std::cerr << "5- Output" <<std::endl;
+    std::cerr << "6- [Representation: Whitaker (default), Shi or Malcolm]" <<std::endl;
+    std::cerr << "7- [Layer trace file]" <<std::endl;
+
+    return EXIT_FAILURE;
+    }
+
+  // Read input image (to be processed).
+  typedef itk::ImageFileReader< InputImageType >            ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+  reader->Update();
+  InputImageType::Pointer inputImage = reader->GetOutput();
+
+  // A good value to try; 4000.0
+  double CurvatureTermCoefficient = atof( argv[3] );
+  std::cout <<"CurvatureTermCoefficient : "
+            << CurvatureTermCoefficient <<std::endl;
+
+  const unsigned int numberOfIterations = atoi( argv[2] );
+  const bool visualize = ( atoi( argv[4] ) == 1 );
+
+  OutputImageType::Pointer outputImage;
+
+  // The sparse representation of the level-set is chosen at run time.
+  std::string representation = "Whitaker";
+  if( argc > 6 )
+    {
+    representation = argv[6];
+    }
+
+  std::string traceFileName;
+  if( argc > 7 )
     {
-    idx = oIt.GetIndex();
-    oIt.Set( levelSet->GetLabelMap()->GetPixel(idx) );
-    ++oIt;
+    traceFileName = argv[7];
+    }
+
+  typedef float PixelType;
+
+  int status = EXIT_FAILURE;
+  if( representation == "Whitaker" )
+    {
+    typedef itk::WhitakerSparseLevelSetImage< PixelType, Dimension > LevelSetType;
+    status = SegmentWithSparseLevelSet< LevelSetType >( inputImage,
+      numberOfIterations, CurvatureTermCoefficient, visualize, traceFileName, outputImage );
+    }
+  else if( representation == "Shi" )
+    {
+    typedef itk::ShiSparseLevelSetImage< Dimension > LevelSetType;
+    status = SegmentWithSparseLevelSet< LevelSetType >( inputImage,
+      numberOfIterations, CurvatureTermCoefficient, visualize, traceFileName, outputImage );
+    }
+  else if( representation == "Malcolm" )
+    {
+    typedef itk::MalcolmSparseLevelSetImage< Dimension > LevelSetType;
+    status = SegmentWithSparseLevelSet< LevelSetType >( inputImage,
+      numberOfIterations, CurvatureTermCoefficient, visualize, traceFileName, outputImage );
+    }
+  else
+    {
+    std::cerr << "Unknown representation: " << representation << std::endl;
+    }
+
+  if( status != EXIT_SUCCESS )
+    {
+    return EXIT_FAILURE;
     }
 
   typedef itk::ImageFileWriter< OutputImageType >     OutputWriterType;
@@ -0,0 +1,242 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImage.h"
+#include "itkImageFileWriter.h"
+#include "itkLevelSetLayerTraceReader.h"
+
+#include <cstdlib>
+#include <vector>
+
+typedef itk::LevelSetLayerTraceReader           TraceReaderType;
+typedef TraceReaderType::NodeListType           NodeListType;
+
+// Give iTo to the pixels of value iFrom connected, by their faces, to the
+// pixels of ioStack. Offsets follow the layout of the image buffer.
+template< unsigned int VDimension >
+void FloodFill( char* ioBuffer, const itk::Size< VDimension >& iSize,
+                std::vector< itk::SizeValueType >& ioStack, char iFrom, char iTo )
+{
+  while( !ioStack.empty() )
+    {
+    const itk::SizeValueType offset = ioStack.back();
+    ioStack.pop_back();
+
+    itk::SizeValueType remainder = offset;
+    itk::SizeValueType stride = 1;
+    for( unsigned int dim = 0; dim < VDimension; dim++ )
+      {
+      const itk::SizeValueType index = remainder % iSize[dim];
+      remainder /= iSize[dim];
+
+      if( ( index > 0 ) && ( ioBuffer[offset - stride] == iFrom ) )
+        {
+        ioBuffer[offset - stride] = iTo;
+        ioStack.push_back( offset - stride );
+        }
+      if( ( index + 1 < iSize[dim] ) && ( ioBuffer[offset + stride] == iFrom ) )
+        {
+        ioBuffer[offset + stride] = iTo;
+        ioStack.push_back( offset + stride );
+        }
+      stride *= iSize[dim];
+      }
+    }
+}
+
+// Write the layer identifier of every node; the pixels enclosed by the
+// layers are set to the identifier preceding the innermost layer, the
+// others to the identifier following the outermost layer.
+//
+// With a layer inside the front, the enclosed pixels are the ones
+// connected to it without crossing the layers: a face neighbor of a node
+// of the innermost layer is either a layer node or inside. With the zero
+// layer only, the outside is the part connected to the border of the
+// region instead: the holes of a front, and the parts of its inside on
+// the border, are then filled wrongly.
+template< unsigned int VDimension >
+int WriteLayers( const TraceReaderType* reader, const NodeListType& nodes, const char* fileName )
+{
+  typedef itk::Image< char, VDimension > OutputImageType;
+
+  typename OutputImageType::RegionType region;
+  for( unsigned int dim = 0; dim < VDimension; dim++ )
+    {
+    region.SetIndex( dim, reader->GetRegionIndex()[dim] );
+    region.SetSize( dim, reader->GetRegionSize()[dim] );
+    }
+  const typename OutputImageType::SizeType size = region.GetSize();
+
+  const std::vector< int > & layerIds = reader->GetLayerIds();
+  const char inside = static_cast< char >( layerIds.front() - 1 );
+  const char outside = static_cast< char >( layerIds.back() + 1 );
+  const bool hasInnerLayer = ( layerIds.front() < 0 );
+
+  typename OutputImageType::Pointer output = OutputImageType::New();
+  output->SetRegions( region );
+  output->Allocate();
+  output->FillBuffer( hasInnerLayer ? outside : inside );
+
+  // Trace offsets follow the layout of the image buffer.
+  char* buffer = output->GetBufferPointer();
+  for( NodeListType::const_iterator it = nodes.begin(); it != nodes.end(); ++it )
+    {
+    buffer[it->first] = static_cast< char >( layerIds[it->second] );
+    }
+
+  std::vector< itk::SizeValueType > stack;
+  if( hasInnerLayer )
+    {
+    for( NodeListType::const_iterator it = nodes.begin(); it != nodes.end(); ++it )
+      {
+      if( it->second == 0 )
+        {
+        stack.push_back( static_cast< itk::SizeValueType >( it->first ) );
+        }
+      }
+    FloodFill< VDimension >( buffer, size, stack, outside, inside );
+    }
+  else
+    {
+    // every pixel of the border of the region which is not a node
+    const itk::SizeValueType numberOfPixels = region.GetNumberOfPixels();
+    for( itk::SizeValueType offset = 0; offset < numberOfPixels; offset++ )
+      {
+      itk::SizeValueType remainder = offset;
+      bool border = false;
+      for( unsigned int dim = 0; dim < VDimension; dim++ )
+        {
+        const itk::SizeValueType index = remainder % size[dim];
+        remainder /= size[dim];
+        border = border || ( index == 0 ) || ( index + 1 == size[dim] );
+        }
+      if( border && ( buffer[offset] == inside ) )
+        {
+        buffer[offset] = outside;
+        stack.push_back( offset );
+        }
+      }
+    FloodFill< VDimension >( buffer, size, stack, inside, outside );
+    }
+
+  typedef itk::ImageFileWriter< OutputImageType > WriterType;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( fileName );
+  writer->SetInput( output );
+
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+int main( int argc, char* argv[] )
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << "./LevelSetTraceReplay " <<std::endl;
+    std::cerr << "1- Layer trace file" <<std::endl;
+    std::cerr << "2- [Iteration (default: last recorded)]" <<std::endl;
+    std::cerr << "3- [Output image of the layers]" <<std::endl;
+
+    return EXIT_FAILURE;
+    }
+
+  TraceReaderType::Pointer reader = TraceReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  try
+    {
+    reader->Open();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const size_t numberOfFrames = reader->GetNumberOfFrames();
+
+  size_t numberOfKeyFrames = 0;
+  for( size_t i = 0; i < numberOfFrames; i++ )
+    {
+    numberOfKeyFrames += ( reader->GetFrame( i ).Type == itk::LevelSetLayerTrace::KeyFrame );
+    }
+
+  std::cout << argv[1] << ": " << reader->GetDimension() << "D, "
+            << reader->GetLayerIds().size() << " layers, "
+            << numberOfFrames << " frames (" << numberOfKeyFrames << " key frames), "
+            << "iterations " << reader->GetFrame( 0 ).Iteration << " to "
+            << reader->GetFrame( numberOfFrames - 1 ).Iteration << ", "
+            << reader->GetFileSize() << " bytes" << std::endl;
+
+  itk::uint64_t iteration = reader->GetFrame( numberOfFrames - 1 ).Iteration;
+  if( argc > 2 )
+    {
+    iteration = static_cast< itk::uint64_t >( atol( argv[2] ) );
+    }
+
+  NodeListType nodes;
+  try
+    {
+    iteration = reader->ReadNodes( iteration, nodes );
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const std::vector< int > & layerIds = reader->GetLayerIds();
+  std::vector< itk::SizeValueType > layerSizes( layerIds.size(), 0 );
+  for( NodeListType::const_iterator it = nodes.begin(); it != nodes.end(); ++it )
+    {
+    ++layerSizes[it->second];
+    }
+
+  std::cout << "Iteration " << iteration << ":";
+  for( size_t i = 0; i < layerIds.size(); i++ )
+    {
+    std::cout << " layer " << layerIds[i] << ": " << layerSizes[i] << " nodes;";
+    }
+  std::cout << std::endl;
+
+  if( argc > 3 )
+    {
+    switch( reader->GetDimension() )
+      {
+      case 2:
+        return WriteLayers< 2 >( reader, nodes, argv[3] );
+      case 3:
+        return WriteLayers< 3 >( reader, nodes, argv[3] );
+      default:
+        std::cerr << "Unsupported dimension: " << reader->GetDimension() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
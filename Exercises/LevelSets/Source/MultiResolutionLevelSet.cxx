@@ -0,0 +1,263 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageIOFactory.h"
+#include "itkCommand.h"
+#include "itkMultiResolutionLevelSetEvolution.h"
+#include "itkSparseLevelSetToImageFilter.h"
+#include "itkWhitakerSparseLevelSetImage.h"
+#include "itkShiSparseLevelSetImage.h"
+#include "itkMalcolmSparseLevelSetImage.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+typedef unsigned char   InputPixelType;
+typedef char            OutputPixelType;
+
+// Print the number of iterations and the time spent on each level.
+template< class TMultiResolution >
+class LevelReporter : public itk::Command
+{
+public:
+  typedef LevelReporter               Self;
+  typedef itk::Command                Superclass;
+  typedef itk::SmartPointer< Self >   Pointer;
+
+  itkNewMacro( Self );
+
+  void Execute( const itk::Object* caller, const itk::EventObject& event )
+    {
+    const TMultiResolution* multiResolution = dynamic_cast< const TMultiResolution* >( caller );
+    if( ( multiResolution == NULL ) || !itk::IterationEvent().CheckEvent( &event ) )
+      {
+      return;
+      }
+
+    this->m_TimeProbe.Stop();
+
+    const unsigned int level = multiResolution->GetCurrentLevel();
+    std::cout << "Level " << level
+              << " (shrink factor " << multiResolution->GetShrinkFactors()[level] << ", "
+              << multiResolution->GetCurrentImage()->GetLargestPossibleRegion().GetSize() << "): "
+              << multiResolution->GetNumberOfIterationsPerLevel()[level] << " iterations, "
+              << this->m_TimeProbe.GetTotal() << " " << this->m_TimeProbe.GetUnit() << std::endl;
+
+    this->m_TimeProbe.Reset();
+    this->m_TimeProbe.Start();
+    }
+
+  void Execute( itk::Object* caller, const itk::EventObject& event )
+    {
+    this->Execute( const_cast< const itk::Object* >( caller ), event );
+    }
+
+  void Start()
+    {
+    this->m_TimeProbe.Start();
+    }
+
+protected:
+  LevelReporter() {}
+
+private:
+  itk::TimeProbe m_TimeProbe;
+};
+
+template< class TInputImage, class TLevelSet >
+int SegmentMultiResolution( TInputImage* inputImage,
+                            unsigned int numberOfIterations,
+                            const std::vector< unsigned int >& shrinkFactors,
+                            const char* outputFileName )
+{
+  typedef TInputImage                                         InputImageType;
+  typedef itk::Image< OutputPixelType, TInputImage::ImageDimension > OutputImageType;
+
+  typedef itk::MultiResolutionLevelSetEvolution< InputImageType, TLevelSet > MultiResolutionType;
+  typename MultiResolutionType::Pointer multiResolution = MultiResolutionType::New();
+  multiResolution->SetInput( inputImage );
+  multiResolution->SetShrinkFactors( shrinkFactors );
+  multiResolution->SetNumberOfIterations( numberOfIterations );
+
+  // Seed with a box covering the central half of the image
+  typename InputImageType::RegionType region = inputImage->GetLargestPossibleRegion();
+  for( unsigned int dim = 0; dim < TInputImage::ImageDimension; dim++ )
+    {
+    const itk::SizeValueType size = std::max( region.GetSize()[dim] / 2, itk::SizeValueType( 1 ) );
+    region.SetIndex( dim, region.GetIndex()[dim] +
+                     static_cast< itk::OffsetValueType >( ( region.GetSize()[dim] - size ) / 2 ) );
+    region.SetSize( dim, size );
+    }
+  multiResolution->AddSeedRegion( region );
+
+  typedef LevelReporter< MultiResolutionType > ReporterType;
+  typename ReporterType::Pointer reporter = ReporterType::New();
+  multiResolution->AddObserver( itk::IterationEvent(), reporter );
+
+  itk::TimeProbe timeProbe;
+  timeProbe.Start();
+  reporter->Start();
+
+  try
+    {
+    multiResolution->Update();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  timeProbe.Stop();
+  std::cout << "Total: " << timeProbe.GetTotal() << " " << timeProbe.GetUnit() << std::endl;
+
+  typedef itk::SparseLevelSetToImageFilter< TLevelSet, OutputImageType > LevelSetToImageFilterType;
+  typename LevelSetToImageFilterType::Pointer levelSetToImage = LevelSetToImageFilterType::New();
+  levelSetToImage->SetLevelSet( multiResolution->GetLevelSet() );
+  levelSetToImage->SetOutputParametersFromImage( inputImage );
+
+  typedef itk::ImageFileWriter< OutputImageType >     OutputWriterType;
+  typename OutputWriterType::Pointer writer = OutputWriterType::New();
+  writer->SetFileName( outputFileName );
+  writer->SetInput( levelSetToImage->GetOutput() );
+
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cout << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+template< unsigned int VDimension >
+int Run( const char* inputFileName, const char* outputFileName,
+         unsigned int numberOfIterations, const std::vector< unsigned int >& shrinkFactors,
+         const std::string& representation )
+{
+  typedef itk::Image< InputPixelType, VDimension >  InputImageType;
+
+  typedef itk::ImageFileReader< InputImageType >    ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( inputFileName );
+  reader->Update();
+  typename InputImageType::Pointer inputImage = reader->GetOutput();
+
+  typedef float PixelType;
+
+  if( representation == "Whitaker" )
+    {
+    typedef itk::WhitakerSparseLevelSetImage< PixelType, VDimension > LevelSetType;
+    return SegmentMultiResolution< InputImageType, LevelSetType >( inputImage,
+      numberOfIterations, shrinkFactors, outputFileName );
+    }
+  if( representation == "Shi" )
+    {
+    typedef itk::ShiSparseLevelSetImage< VDimension > LevelSetType;
+    return SegmentMultiResolution< InputImageType, LevelSetType >( inputImage,
+      numberOfIterations, shrinkFactors, outputFileName );
+    }
+  if( representation == "Malcolm" )
+    {
+    typedef itk::MalcolmSparseLevelSetImage< VDimension > LevelSetType;
+    return SegmentMultiResolution< InputImageType, LevelSetType >( inputImage,
+      numberOfIterations, shrinkFactors, outputFileName );
+    }
+
+  std::cerr << "Unknown representation: " << representation << std::endl;
+  return EXIT_FAILURE;
+}
+
+int main( int argc, char* argv[] )
+{
+  if( argc < 4 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << "./MultiResolutionLevelSet " <<std::endl;
+    std::cerr << "1- Input Image (2D or 3D)" <<std::endl;
+    std::cerr << "2- Maximum Number of Iterations per level" <<std::endl;
+    std::cerr << "3- Output" <<std::endl;
+    std::cerr << "4- [Shrink factors, coarse to fine (default: 4x2x1)]" <<std::endl;
+    std::cerr << "5- [Representation: Whitaker (default), Shi or Malcolm]" <<std::endl;
+
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int numberOfIterations = atoi( argv[2] );
+
+  std::vector< unsigned int > shrinkFactors;
+  if( argc > 4 )
+    {
+    std::istringstream factors( argv[4] );
+    unsigned int factor;
+    while( factors >> factor )
+      {
+      shrinkFactors.push_back( factor );
+      factors.ignore( 1 ); // skip the 'x'
+      }
+    }
+  else
+    {
+    shrinkFactors.push_back( 4 );
+    shrinkFactors.push_back( 2 );
+    shrinkFactors.push_back( 1 );
+    }
+
+  if( shrinkFactors.empty() || ( shrinkFactors.back() != 1 ) )
+    {
+    std::cerr << "Invalid shrink factors: the last one must be 1" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string representation = "Whitaker";
+  if( argc > 5 )
+    {
+    representation = argv[5];
+    }
+
+  // The dimension of the input is only known at run time.
+  itk::ImageIOBase::Pointer imageIO =
+    itk::ImageIOFactory::CreateImageIO( argv[1], itk::ImageIOFactory::ReadMode );
+  if( imageIO.IsNull() )
+    {
+    std::cerr << "Could not read " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+  imageIO->SetFileName( argv[1] );
+  imageIO->ReadImageInformation();
+
+  switch( imageIO->GetNumberOfDimensions() )
+    {
+    case 2:
+      return Run< 2 >( argv[1], argv[3], numberOfIterations, shrinkFactors, representation );
+    case 3:
+      return Run< 3 >( argv[1], argv[3], numberOfIterations, shrinkFactors, representation );
+    default:
+      std::cerr << "Unsupported dimension: " << imageIO->GetNumberOfDimensions() << std::endl;
+      return EXIT_FAILURE;
+    }
+}
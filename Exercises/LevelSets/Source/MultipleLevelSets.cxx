@@ -0,0 +1,1044 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageIOFactory.h"
+#include "itkImageRegionIterator.h"
+#include "itkLevelSetDomainMapImageFilter.h"
+#include "itkLevelSetDomainPartition.h"
+#include "itkLevelSetContainer.h"
+#include "itkLevelSetEquationChanAndVeseInternalTerm.h"
+#include "itkLevelSetEquationChanAndVeseExternalTerm.h"
+#include "itkLevelSetEquationEdgeSpeedTerm.h"
+#include "itkLevelSetEdgeSpeedImageFilter.h"
+#include "itkLevelSetEquationTermContainer.h"
+#include "itkLevelSetEquationContainer.h"
+#include "itkTabulatedHeavisideStepFunction.h"
+#include "itkLevelSetIncrementalLabelMapEvolution.h"
+#include "itkSeedToSparseLevelSetImageAdaptor.h"
+#include "itkLevelSetEvolutionNumberOfIterationsStoppingCriterion.h"
+#include "itkLevelSetCheckpointReader.h"
+#include "itkLevelSetCheckpointWriter.h"
+#include "itkLevelSetEquationCheckpointedTerm.h"
+#include "itkWhitakerSparseLevelSetImage.h"
+#include "itkShiSparseLevelSetImage.h"
+#include "itkMalcolmSparseLevelSetImage.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkTimeProbe.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+typedef unsigned char   InputPixelType;
+typedef unsigned short  LabelPixelType;
+
+// Split the largest possible region of the image into a regular grid of
+// cellsPerAxis^Dimension cells and return the cell of the given level-set.
+template< class TRegion >
+TRegion ComputeCell( const TRegion& region, unsigned int cellsPerAxis, unsigned int levelSetId )
+{
+  TRegion cell;
+  unsigned int remainder = levelSetId;
+
+  for( unsigned int dim = 0; dim < TRegion::ImageDimension; dim++ )
+    {
+    const unsigned int position = remainder % cellsPerAxis;
+    remainder /= cellsPerAxis;
+
+    const itk::SizeValueType size = region.GetSize()[dim];
+    const itk::OffsetValueType begin = region.GetIndex()[dim] + ( position * size ) / cellsPerAxis;
+    const itk::OffsetValueType end = region.GetIndex()[dim] + ( ( position + 1 ) * size ) / cellsPerAxis;
+
+    cell.SetIndex( dim, begin );
+    cell.SetSize( dim, static_cast< itk::SizeValueType >( std::max( end - begin, itk::OffsetValueType( 1 ) ) ) );
+    }
+
+  return cell;
+}
+
+// Smallest region containing all the given regions.
+template< class TRegion >
+TRegion ComputeBoundingRegion( const std::vector< TRegion >& regions )
+{
+  TRegion box = regions[0];
+
+  for( size_t r = 1; r < regions.size(); r++ )
+    {
+    for( unsigned int dim = 0; dim < TRegion::ImageDimension; dim++ )
+      {
+      const itk::OffsetValueType begin =
+        std::min( box.GetIndex()[dim], regions[r].GetIndex()[dim] );
+      const itk::OffsetValueType end =
+        std::max( box.GetIndex()[dim] + static_cast< itk::OffsetValueType >( box.GetSize()[dim] ),
+                  regions[r].GetIndex()[dim] + static_cast< itk::OffsetValueType >( regions[r].GetSize()[dim] ) );
+      box.SetIndex( dim, begin );
+      box.SetSize( dim, static_cast< itk::SizeValueType >( end - begin ) );
+      }
+    }
+
+  return box;
+}
+
+// Level-sets split into independent groups: the level-sets of a group
+// share pixels with each other, never with the level-sets of another group.
+// The groups are evolved concurrently, each one with its own domain map,
+// level-set container, equations and evolution. The level-sets of a group
+// are confined to the bounding region of the domains of the group, so that
+// they never reach the pixels of another group.
+// Each evolution computes its own time step, from the CFL condition of its
+// level-sets only. A group therefore takes steps at least as large as the
+// ones of a single evolution of all the level-sets, which uses the smallest
+// step over all of them: the segmentation may differ slightly from the one
+// computed with one group, but each group stays stable.
+template< class TInputImage, class TLevelSet >
+struct LevelSetGroups
+{
+  typedef TInputImage                                   InputImageType;
+  typedef typename InputImageType::RegionType           RegionType;
+  typedef TLevelSet                                     SparseLevelSetType;
+  typedef typename SparseLevelSetType::Pointer          SparseLevelSetPointer;
+  typedef typename SparseLevelSetType::OutputRealType   LevelSetOutputRealType;
+
+  typedef itk::TabulatedHeavisideStepFunction<
+    LevelSetOutputRealType, LevelSetOutputRealType >    HeavisideFunctionBaseType;
+
+  typedef itk::IdentifierType                           IdentifierType;
+  typedef std::list< IdentifierType >                   IdListType;
+  typedef itk::Image< IdListType, TInputImage::ImageDimension >
+                                                        IdListImageType;
+  typedef itk::Image< short, TInputImage::ImageDimension >
+                                                        CacheImageType;
+  typedef itk::LevelSetDomainMapImageFilter< IdListImageType, CacheImageType >
+                                                        DomainMapImageFilterType;
+  typedef itk::Image< float, TInputImage::ImageDimension >
+                                                        SpeedImageType;
+
+  // 0-based identifiers of the level-sets of a group
+  typedef std::vector< IdentifierType >                 GroupType;
+
+  InputImageType*                                       InputImage;
+  typename HeavisideFunctionBaseType::Pointer           Heaviside;
+  std::vector< SparseLevelSetPointer >                  LevelSets;
+  std::vector< RegionType >                             Domains;
+  std::vector< GroupType >                              Groups;
+  std::vector< RegionType >                             GroupRegions;
+
+  // edge speed, computed once and read by the terms of every group
+  typename SpeedImageType::ConstPointer                 SpeedImage;
+  double                                                EdgeWeight;
+
+  // domain map of all the level-sets, used as is when there is one group
+  typename DomainMapImageFilterType::Pointer            DomainMapFilter;
+
+  unsigned int                                          NumberOfIterations;
+  std::string                                           CheckpointFileName;
+  unsigned int                                          CheckpointPeriod;
+
+  // iteration each group resumed after, and checkpoints it wrote
+  std::vector< unsigned int >                           IterationOffsets;
+  std::vector< itk::SizeValueType >                     NumberOfCheckpoints;
+
+  itk::SimpleFastMutexLock                              Mutex;
+  size_t                                                NextGroup;
+  std::string                                           Error;
+};
+
+// Checkpoint file of a group: one file per group when there are several.
+std::string GroupCheckpointFileName( const std::string& fileName, size_t group, size_t numberOfGroups )
+{
+  if( fileName.empty() || ( numberOfGroups == 1 ) )
+    {
+    return fileName;
+    }
+  std::ostringstream name;
+  name << fileName << "." << group;
+  return name.str();
+}
+
+// Evolve the level-sets of the group iGroup. In the equations of the group
+// the level-sets are numbered from 0, in the order of the group.
+template< class TInputImage, class TLevelSet >
+void EvolveGroup( LevelSetGroups< TInputImage, TLevelSet >& ioGroups, size_t iGroup )
+{
+  typedef LevelSetGroups< TInputImage, TLevelSet >            GroupsType;
+  typedef TInputImage                                         InputImageType;
+  typedef TLevelSet                                           SparseLevelSetType;
+  typedef typename GroupsType::IdListType                     IdListType;
+  typedef typename GroupsType::IdListImageType                IdListImageType;
+  typedef typename GroupsType::DomainMapImageFilterType       DomainMapImageFilterType;
+
+  const typename GroupsType::GroupType & group = ioGroups.Groups[iGroup];
+  const unsigned int numberOfLevelSets = static_cast< unsigned int >( group.size() );
+
+  const std::string checkpointFileName =
+    GroupCheckpointFileName( ioGroups.CheckpointFileName, iGroup, ioGroups.Groups.size() );
+
+  // Resume from the last checkpoint: the seeds are replaced by the
+  // level-sets as they were after the checkpointed iteration, and the
+  // terms get their states back once they are created.
+  typedef itk::LevelSetCheckpointReader< SparseLevelSetType > CheckpointReaderType;
+  typename CheckpointReaderType::Pointer checkpointReader;
+
+  unsigned int iterationOffset = 0;
+  if( !checkpointFileName.empty() && itksys::SystemTools::FileExists( checkpointFileName.c_str() ) )
+    {
+    checkpointReader = CheckpointReaderType::New();
+    checkpointReader->SetFileName( checkpointFileName );
+    checkpointReader->Read();
+
+    for( unsigned int k = 0; k < numberOfLevelSets; k++ )
+      {
+      ioGroups.LevelSets[group[k]] = checkpointReader->GetLevelSet( group[k] );
+      }
+
+    iterationOffset = std::min( static_cast< unsigned int >( checkpointReader->GetIteration() ),
+                                ioGroups.NumberOfIterations );
+    }
+  ioGroups.IterationOffsets[iGroup] = iterationOffset;
+
+  // The level-sets of the group evolve in the bounding region of their
+  // domains: their label maps are restricted to it, as in
+  // AutoCroppingLevelSetEvolution, and the fronts stop at its border. The
+  // terms are then only evaluated at nodes of this region, and the domain
+  // map of the group, which only lists its level-sets, only covers it.
+  const typename GroupsType::RegionType & groupRegion = ioGroups.GroupRegions[iGroup];
+  for( unsigned int k = 0; k < numberOfLevelSets; k++ )
+    {
+    ioGroups.LevelSets[group[k]]->GetLabelMap()->SetRegions( groupRegion );
+    }
+
+  typename DomainMapImageFilterType::Pointer domainMapFilter = ioGroups.DomainMapFilter;
+  if( ioGroups.Groups.size() > 1 )
+    {
+    typename IdListImageType::Pointer idImage = IdListImageType::New();
+    idImage->SetRegions( groupRegion );
+    idImage->Allocate();
+    idImage->FillBuffer( IdListType() );
+
+    for( unsigned int k = 0; k < numberOfLevelSets; k++ )
+      {
+      typedef itk::ImageRegionIterator< IdListImageType > IdIteratorType;
+      IdIteratorType it( idImage, ioGroups.Domains[group[k]] );
+      for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+        {
+        it.Value().push_back( k + 1 );
+        }
+      }
+
+    domainMapFilter = DomainMapImageFilterType::New();
+    domainMapFilter->SetInput( idImage );
+    domainMapFilter->Update();
+    }
+
+  typedef itk::LevelSetContainer< itk::IdentifierType, SparseLevelSetType > LevelSetContainerType;
+
+  typename LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
+  lscontainer->SetHeaviside( ioGroups.Heaviside );
+  lscontainer->SetDomainMapFilter( domainMapFilter );
+
+  for( unsigned int k = 0; k < numberOfLevelSets; k++ )
+    {
+    lscontainer->AddLevelSet( k, ioGroups.LevelSets[group[k]] );
+    }
+
+  // One term container, i.e. one equation, per level-set. The Chan and
+  // Vese terms accumulate their means node by node: their states are
+  // checkpointed with the level-sets, under the identifiers
+  // 2 * level-set and 2 * level-set + 1.
+  typedef itk::LevelSetEquationCheckpointedTerm<
+    itk::LevelSetEquationChanAndVeseInternalTerm<
+      InputImageType, LevelSetContainerType > > InternalTermType;
+  typedef itk::LevelSetEquationCheckpointedTerm<
+    itk::LevelSetEquationChanAndVeseExternalTerm<
+      InputImageType, LevelSetContainerType > > ExternalTermType;
+  typedef itk::LevelSetEquationEdgeSpeedTerm<
+    InputImageType, LevelSetContainerType,
+    typename GroupsType::SpeedImageType > EdgeSpeedTermType;
+  typedef itk::LevelSetEquationTermContainer<
+    InputImageType, LevelSetContainerType > TermContainerType;
+  typedef itk::LevelSetEquationContainer< TermContainerType > EquationContainerType;
+
+  typename EquationContainerType::Pointer equationContainer = EquationContainerType::New();
+  equationContainer->SetLevelSetContainer( lscontainer );
+
+  std::vector< typename InternalTermType::Pointer > internalTerms( numberOfLevelSets );
+  std::vector< typename ExternalTermType::Pointer > externalTerms( numberOfLevelSets );
+
+  for( unsigned int k = 0; k < numberOfLevelSets; k++ )
+    {
+    typename InternalTermType::Pointer cvInternalTerm = InternalTermType::New();
+    cvInternalTerm->SetInput( ioGroups.InputImage );
+    cvInternalTerm->SetCoefficient( 1.0 );
+    cvInternalTerm->SetCurrentLevelSetId( k );
+    cvInternalTerm->SetLevelSetContainer( lscontainer );
+
+    typename ExternalTermType::Pointer cvExternalTerm = ExternalTermType::New();
+    cvExternalTerm->SetInput( ioGroups.InputImage );
+    cvExternalTerm->SetCoefficient( 1.0 );
+    cvExternalTerm->SetCurrentLevelSetId( k );
+    cvExternalTerm->SetLevelSetContainer( lscontainer );
+
+    if( checkpointReader.IsNotNull() )
+      {
+      checkpointReader->RestoreTermState( 2 * group[k], cvInternalTerm );
+      checkpointReader->RestoreTermState( 2 * group[k] + 1, cvExternalTerm );
+      }
+    internalTerms[k] = cvInternalTerm;
+    externalTerms[k] = cvExternalTerm;
+
+    typename TermContainerType::Pointer termContainer = TermContainerType::New();
+    termContainer->SetInput( ioGroups.InputImage );
+    termContainer->SetCurrentLevelSetId( k );
+    termContainer->SetLevelSetContainer( lscontainer );
+    termContainer->AddTerm( 0, cvInternalTerm );
+    termContainer->AddTerm( 1, cvExternalTerm );
+
+    if( ioGroups.SpeedImage.IsNotNull() )
+      {
+      typename EdgeSpeedTermType::Pointer edgeTerm = EdgeSpeedTermType::New();
+      edgeTerm->SetInput( ioGroups.InputImage );
+      edgeTerm->SetCoefficient( ioGroups.EdgeWeight );
+      edgeTerm->SetCurrentLevelSetId( k );
+      edgeTerm->SetLevelSetContainer( lscontainer );
+      edgeTerm->SetSpeedImage( ioGroups.SpeedImage );
+      termContainer->AddTerm( 2, edgeTerm );
+      }
+
+    equationContainer->AddEquation( k, termContainer );
+    }
+
+  typedef itk::LevelSetEvolutionNumberOfIterationsStoppingCriterion<
+    LevelSetContainerType > StoppingCriterionType;
+
+  typename StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
+  criterion->SetNumberOfIterations( ioGroups.NumberOfIterations - iterationOffset );
+
+  // Whitaker label maps are edited at the nodes which changed layer only;
+  // Shi and Malcolm level-sets are updated as by LevelSetEvolution.
+  typedef itk::LevelSetIncrementalLabelMapEvolution<
+    EquationContainerType, SparseLevelSetType > LevelSetEvolutionType;
+
+  typename LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+  evolution->SetEquationContainer( equationContainer );
+  evolution->SetStoppingCriterion( criterion );
+  evolution->SetLevelSetContainer( lscontainer );
+
+  // The checkpoints are encoded between two iterations and written to the
+  // disk by another thread. They keep the identifiers of the level-sets in
+  // the whole segmentation.
+  typedef itk::LevelSetCheckpointWriter< SparseLevelSetType > CheckpointWriterType;
+  typename CheckpointWriterType::Pointer checkpointWriter = CheckpointWriterType::New();
+
+  if( !checkpointFileName.empty() )
+    {
+    checkpointWriter->SetFileName( checkpointFileName );
+    checkpointWriter->SetCheckpointPeriod( ioGroups.CheckpointPeriod );
+    checkpointWriter->SetIterationOffset( iterationOffset );
+    for( unsigned int k = 0; k < numberOfLevelSets; k++ )
+      {
+      checkpointWriter->AddLevelSet( group[k], ioGroups.LevelSets[group[k]] );
+      checkpointWriter->AddTermState( 2 * group[k], internalTerms[k] );
+      checkpointWriter->AddTermState( 2 * group[k] + 1, externalTerms[k] );
+      }
+    evolution->AddObserver( itk::IterationEvent(), checkpointWriter );
+    checkpointWriter->Start();
+    }
+
+  try
+    {
+    evolution->Update();
+    }
+  catch ( itk::ExceptionObject& )
+    {
+    // the failure of the evolution is the one reported
+    try
+      {
+      checkpointWriter->Stop();
+      }
+    catch ( itk::ExceptionObject& )
+      {
+      }
+    throw;
+    }
+
+  checkpointWriter->Stop();
+  ioGroups.NumberOfCheckpoints[iGroup] = checkpointWriter->GetNumberOfCheckpointsWritten();
+
+  for( unsigned int k = 0; k < numberOfLevelSets; k++ )
+    {
+    ioGroups.LevelSets[group[k]]->GetLabelMap()->SetRegions(
+      ioGroups.InputImage->GetLargestPossibleRegion() );
+    }
+}
+
+template< class TInputImage, class TLevelSet >
+ITK_THREAD_RETURN_TYPE EvolveGroupsThreadCallback( void* arg )
+{
+  typedef LevelSetGroups< TInputImage, TLevelSet > GroupsType;
+
+  itk::MultiThreader::ThreadInfoStruct* info = static_cast< itk::MultiThreader::ThreadInfoStruct* >( arg );
+  GroupsType* groups = static_cast< GroupsType* >( info->UserData );
+
+  while( true )
+    {
+    // Take the next group, unless every group is taken or one failed.
+    groups->Mutex.Lock();
+    const size_t index = groups->NextGroup;
+    const bool done = ( index >= groups->Groups.size() ) || !groups->Error.empty();
+    if( !done )
+      {
+      ++groups->NextGroup;
+      }
+    groups->Mutex.Unlock();
+
+    if( done )
+      {
+      break;
+      }
+
+    try
+      {
+      EvolveGroup( *groups, index );
+      }
+    catch( itk::ExceptionObject& err )
+      {
+      groups->Mutex.Lock();
+      if( groups->Error.empty() )
+        {
+        std::ostringstream message;
+        message << "Group " << index << ": " << err.GetDescription();
+        groups->Error = message.str();
+        }
+      groups->Mutex.Unlock();
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// Segment inputImage with numberOfLevelSets coupled sparse level-sets of
+// type TLevelSet; each pixel of labelImage gets the (1-based) identifier of
+// the first level-set containing it, 0 if none. The independent groups of
+// level-sets are evolved on numberOfThreads threads. If checkpointFileName
+// is not empty, the level-sets are saved to it every checkpointPeriod
+// iterations, and the evolution resumes from it when it exists; with
+// several groups, each group has its own file, suffixed by its number.
+// If edgeWeight is not 0, an edge speed term of that weight, computed at
+// the scale edgeSigma, is added to the equation of every level-set.
+template< class TInputImage, class TLevelSet >
+int SegmentWithMultipleLevelSets( TInputImage* inputImage,
+                                  unsigned int numberOfIterations,
+                                  unsigned int numberOfLevelSets,
+                                  unsigned int overlap,
+                                  const std::string& checkpointFileName,
+                                  unsigned int checkpointPeriod,
+                                  unsigned int numberOfThreads,
+                                  double edgeWeight,
+                                  double edgeSigma,
+                                  typename itk::Image< LabelPixelType, TInputImage::ImageDimension >::Pointer& labelImage )
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+
+  typedef TInputImage                                         InputImageType;
+  typedef typename InputImageType::RegionType                 RegionType;
+  typedef TLevelSet                                           SparseLevelSetType;
+  typedef itk::Image< LabelPixelType, Dimension >             LabelImageType;
+
+  typedef LevelSetGroups< InputImageType, SparseLevelSetType > GroupsType;
+
+  GroupsType groups;
+  groups.InputImage = inputImage;
+  groups.NumberOfIterations = numberOfIterations;
+  groups.CheckpointFileName = checkpointFileName;
+  groups.CheckpointPeriod = checkpointPeriod;
+  groups.NextGroup = 0;
+  groups.EdgeWeight = edgeWeight;
+
+  std::vector< typename SparseLevelSetType::Pointer > & levelSets = groups.LevelSets;
+  std::vector< RegionType > & domains = groups.Domains;
+
+  const RegionType largestRegion = inputImage->GetLargestPossibleRegion();
+
+  // The level-sets are laid out on a grid of cells. Each one is seeded
+  // with a box in the middle of its cell, and evolves in its cell grown by
+  // overlap pixels, so that neighboring level-sets share a band of pixels.
+  unsigned int cellsPerAxis = 1;
+  while( std::pow( static_cast< double >( cellsPerAxis ), static_cast< double >( Dimension ) ) <
+         static_cast< double >( numberOfLevelSets ) )
+    {
+    ++cellsPerAxis;
+    }
+
+  typedef itk::SeedToSparseLevelSetImageAdaptor< SparseLevelSetType > SeedToSparseAdaptorType;
+
+  levelSets.resize( numberOfLevelSets );
+  domains.resize( numberOfLevelSets );
+
+  for( unsigned int i = 0; i < numberOfLevelSets; i++ )
+    {
+    const RegionType cell = ComputeCell( largestRegion, cellsPerAxis, i );
+
+    RegionType seed;
+    for( unsigned int dim = 0; dim < Dimension; dim++ )
+      {
+      const itk::SizeValueType size = std::max( cell.GetSize()[dim] / 2, itk::SizeValueType( 1 ) );
+      seed.SetIndex( dim, cell.GetIndex()[dim] + static_cast< itk::OffsetValueType >( ( cell.GetSize()[dim] - size ) / 2 ) );
+      seed.SetSize( dim, size );
+      }
+
+    typename SeedToSparseAdaptorType::Pointer adaptor = SeedToSparseAdaptorType::New();
+    adaptor->SetReferenceImage( inputImage );
+    adaptor->AddRegion( seed );
+    adaptor->Initialize();
+    levelSets[i] = adaptor->GetLevelSet();
+
+    domains[i] = cell;
+    domains[i].PadByRadius( overlap );
+    domains[i].Crop( largestRegion );
+    }
+  std::cout << numberOfLevelSets << " level-sets seeded on a grid of "
+            << cellsPerAxis << "^" << Dimension << " cells" << std::endl;
+
+  // Each pixel only lists the level-sets whose domain covers it. The
+  // domain map groups the pixels with identical lists, and the terms which
+  // couple the level-sets only visit the level-sets of the list of the
+  // pixel: the work per pixel grows with the number of level-sets active
+  // at that pixel, not with the total number of level-sets.
+  typedef typename GroupsType::IdListType                 IdListType;
+  typedef typename GroupsType::IdListImageType            IdListImageType;
+  typedef typename GroupsType::DomainMapImageFilterType   DomainMapImageFilterType;
+
+  typename IdListImageType::Pointer idImage = IdListImageType::New();
+  idImage->SetRegions( largestRegion );
+  idImage->Allocate();
+  idImage->FillBuffer( IdListType() );
+
+  for( unsigned int i = 0; i < numberOfLevelSets; i++ )
+    {
+    typedef itk::ImageRegionIterator< IdListImageType > IdIteratorType;
+    IdIteratorType it( idImage, domains[i] );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      // identifiers of the domain map are 1-based
+      it.Value().push_back( i + 1 );
+      }
+    }
+
+  typename DomainMapImageFilterType::Pointer domainMapFilter = DomainMapImageFilterType::New();
+  domainMapFilter->SetInput( idImage );
+  domainMapFilter->Update();
+  std::cout << "Domain map computed: " << domainMapFilter->GetDomainMap().size()
+            << " distinct domains" << std::endl;
+
+  // Level-sets which never share a pixel are not coupled by the terms:
+  // the groups of coupled level-sets are evolved independently.
+  typedef itk::LevelSetDomainPartition< DomainMapImageFilterType > DomainPartitionType;
+  typename DomainPartitionType::Pointer partition = DomainPartitionType::New();
+  partition->SetDomainMapFilter( domainMapFilter );
+  partition->Update();
+
+  for( itk::SizeValueType g = 0; g < partition->GetNumberOfGroups(); g++ )
+    {
+    const typename DomainPartitionType::IdentifierListType & ids = partition->GetGroup( g );
+
+    typename GroupsType::GroupType group;
+    std::vector< RegionType >      groupDomains;
+    for( size_t k = 0; k < ids.size(); k++ )
+      {
+      group.push_back( ids[k] - 1 );
+      groupDomains.push_back( domains[ids[k] - 1] );
+      }
+    groups.Groups.push_back( group );
+    groups.GroupRegions.push_back( ComputeBoundingRegion( groupDomains ) );
+    }
+  // The cells of the grid are disjoint, so with no overlap (the default)
+  // every level-set is a group of its own, evolved concurrently with the
+  // others in its cell. With a non zero overlap, neighboring cells share a
+  // band of 2 * overlap pixels and all the level-sets of the grid form one
+  // group, evolved by a single thread.
+  std::cout << groups.Groups.size() << " independent group(s) of level-sets" << std::endl;
+
+  // With one group, the domain map of all the level-sets is the one of
+  // the group; otherwise each group computes its own.
+  if( groups.Groups.size() == 1 )
+    {
+    groups.DomainMapFilter = domainMapFilter;
+    }
+  domainMapFilter = NULL;
+  idImage = NULL;
+
+  // Define the Heaviside function, shared by the groups
+  typedef typename GroupsType::HeavisideFunctionBaseType HeavisideFunctionBaseType;
+  groups.Heaviside = HeavisideFunctionBaseType::New();
+  groups.Heaviside->SetEpsilon( 1.0 );
+
+  // The edge speed is computed once, by a threaded filter, rather than
+  // at the nodes by every term and at every iteration.
+  if( edgeWeight != 0. )
+    {
+    typedef itk::LevelSetEdgeSpeedImageFilter< InputImageType,
+      typename GroupsType::SpeedImageType > EdgeSpeedFilterType;
+    typename EdgeSpeedFilterType::Pointer edgeSpeedFilter = EdgeSpeedFilterType::New();
+    edgeSpeedFilter->SetInput( inputImage );
+    edgeSpeedFilter->SetSigma( edgeSigma );
+    edgeSpeedFilter->Update();
+    groups.SpeedImage = edgeSpeedFilter->GetOutput();
+
+    std::cout << "Edge speed computed, edge contrast: "
+              << edgeSpeedFilter->GetComputedEdgeContrast() << std::endl;
+    }
+
+  groups.IterationOffsets.resize( groups.Groups.size(), 0 );
+  groups.NumberOfCheckpoints.resize( groups.Groups.size(), 0 );
+
+  const itk::ThreadIdType threads = static_cast< itk::ThreadIdType >(
+    std::max( std::min( static_cast< size_t >( numberOfThreads ), groups.Groups.size() ), size_t( 1 ) ) );
+
+  itk::TimeProbe timeProbe;
+  timeProbe.Start();
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( threads );
+  threader->SetSingleMethod( EvolveGroupsThreadCallback< InputImageType, SparseLevelSetType >, &groups );
+  threader->SingleMethodExecute();
+
+  timeProbe.Stop();
+
+  if( !groups.Error.empty() )
+    {
+    std::cerr << groups.Error << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::SizeValueType numberOfCheckpoints = 0;
+  for( size_t g = 0; g < groups.Groups.size(); g++ )
+    {
+    if( groups.IterationOffsets[g] > 0 )
+      {
+      std::cout << "Group " << g << " resumed after iteration "
+                << groups.IterationOffsets[g] << std::endl;
+      }
+    numberOfCheckpoints += groups.NumberOfCheckpoints[g];
+    }
+
+  if( !checkpointFileName.empty() )
+    {
+    std::cout << numberOfCheckpoints << " checkpoint(s) written to " << checkpointFileName
+              << ( groups.Groups.size() > 1 ? ".*" : "" ) << std::endl;
+    }
+  std::cout << "Evolution on " << threads << " thread(s): " << timeProbe.GetTotal() << " " << timeProbe.GetUnit()
+            << " (" << timeProbe.GetTotal() / numberOfLevelSets << " per level-set)" << std::endl;
+
+  // Label the inside of every level-set, walking the run-length lines of
+  // the non positive labels of its label map.
+  labelImage = LabelImageType::New();
+  labelImage->SetRegions( largestRegion );
+  labelImage->CopyInformation( inputImage );
+  labelImage->Allocate();
+  labelImage->FillBuffer( 0 );
+
+  typedef typename SparseLevelSetType::LabelMapType           LabelMapType;
+  typedef typename LabelMapType::LabelObjectVectorType        LabelObjectVectorType;
+  typedef typename LabelMapType::LabelObjectType::LineType    LineType;
+
+  for( unsigned int i = 0; i < numberOfLevelSets; i++ )
+    {
+    const LabelObjectVectorType labelObjects = levelSets[i]->GetLabelMap()->GetLabelObjects();
+
+    for( typename LabelObjectVectorType::const_iterator oIt = labelObjects.begin();
+         oIt != labelObjects.end(); ++oIt )
+      {
+      if( ( *oIt )->GetLabel() > 0 )
+        {
+        continue;
+        }
+
+      for( itk::SizeValueType l = 0; l < ( *oIt )->GetNumberOfLines(); l++ )
+        {
+        const LineType & line = ( *oIt )->GetLine( l );
+        LabelPixelType* pixel = labelImage->GetBufferPointer() +
+          labelImage->ComputeOffset( line.GetIndex() );
+
+        for( itk::SizeValueType p = 0; p < line.GetLength(); p++, pixel++ )
+          {
+          if( *pixel == 0 )
+            {
+            *pixel = static_cast< LabelPixelType >( i + 1 );
+            }
+          }
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// Checkpoint files written for fileName: fileName itself with one group,
+// fileName suffixed by the group number with several.
+std::vector< std::string > ListCheckpointFiles( const std::string& fileName )
+{
+  std::vector< std::string > fileNames;
+  if( itksys::SystemTools::FileExists( fileName.c_str() ) )
+    {
+    fileNames.push_back( fileName );
+    }
+  for( size_t g = 0; ; g++ )
+    {
+    std::ostringstream name;
+    name << fileName << "." << g;
+    if( !itksys::SystemTools::FileExists( name.str().c_str() ) )
+      {
+      break;
+      }
+    fileNames.push_back( name.str() );
+    }
+  return fileNames;
+}
+
+// Content of the file fileName
+std::string ReadFileContent( const std::string& fileName )
+{
+  std::ifstream stream( fileName.c_str(), std::ios::in | std::ios::binary );
+  return std::string( std::istreambuf_iterator< char >( stream ), std::istreambuf_iterator< char >() );
+}
+
+// Check that a resumed evolution is the interrupted one: the level-sets are
+// evolved numberOfIterations iterations in one run, then again in two runs,
+// the first one interrupted after half of the iterations and the second
+// one resumed from its checkpoint. Both end with a checkpoint of the last
+// iteration, to checkpointFileName suffixed by ".full" and ".resumed"; the
+// two must be identical byte for byte. labelImage is the one of the run
+// in one go.
+template< class TInputImage, class TLevelSet >
+int CheckResumeWithMultipleLevelSets( TInputImage* inputImage,
+                                      unsigned int numberOfIterations,
+                                      unsigned int numberOfLevelSets,
+                                      unsigned int overlap,
+                                      const std::string& checkpointFileName,
+                                      unsigned int numberOfThreads,
+                                      double edgeWeight,
+                                      double edgeSigma,
+                                      typename itk::Image< LabelPixelType, TInputImage::ImageDimension >::Pointer& labelImage )
+{
+  typedef itk::Image< LabelPixelType, TInputImage::ImageDimension > LabelImageType;
+
+  if( numberOfIterations < 2 )
+    {
+    std::cerr << "The resume check needs at least 2 iterations" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int halfIterations = numberOfIterations / 2;
+  const std::string fullFileName = checkpointFileName + ".full";
+  const std::string resumedFileName = checkpointFileName + ".resumed";
+
+  // Checkpoints left by a previous check would be resumed from.
+  const std::string fileNames[2] = { fullFileName, resumedFileName };
+  for( unsigned int i = 0; i < 2; i++ )
+    {
+    const std::vector< std::string > previousFileNames = ListCheckpointFiles( fileNames[i] );
+    for( size_t f = 0; f < previousFileNames.size(); f++ )
+      {
+      itksys::SystemTools::RemoveFile( previousFileNames[f].c_str() );
+      }
+    }
+
+  std::cout << "Run of " << numberOfIterations << " iterations" << std::endl;
+  if( SegmentWithMultipleLevelSets< TInputImage, TLevelSet >( inputImage,
+        numberOfIterations, numberOfLevelSets, overlap,
+        fullFileName, numberOfIterations, numberOfThreads,
+        edgeWeight, edgeSigma, labelImage ) != EXIT_SUCCESS )
+    {
+    return EXIT_FAILURE;
+    }
+
+  typename LabelImageType::Pointer resumedLabelImage;
+
+  std::cout << "Run interrupted after " << halfIterations << " iterations" << std::endl;
+  if( SegmentWithMultipleLevelSets< TInputImage, TLevelSet >( inputImage,
+        halfIterations, numberOfLevelSets, overlap,
+        resumedFileName, halfIterations, numberOfThreads,
+        edgeWeight, edgeSigma, resumedLabelImage ) != EXIT_SUCCESS )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Run resumed" << std::endl;
+  if( SegmentWithMultipleLevelSets< TInputImage, TLevelSet >( inputImage,
+        numberOfIterations, numberOfLevelSets, overlap,
+        resumedFileName, numberOfIterations - halfIterations, numberOfThreads,
+        edgeWeight, edgeSigma, resumedLabelImage ) != EXIT_SUCCESS )
+    {
+    return EXIT_FAILURE;
+    }
+
+  const std::vector< std::string > fullFileNames = ListCheckpointFiles( fullFileName );
+  const std::vector< std::string > resumedFileNames = ListCheckpointFiles( resumedFileName );
+
+  if( fullFileNames.empty() || ( fullFileNames.size() != resumedFileNames.size() ) )
+    {
+    std::cerr << "Resume check failed: " << fullFileNames.size() << " and "
+              << resumedFileNames.size() << " final checkpoint(s)" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for( size_t f = 0; f < fullFileNames.size(); f++ )
+    {
+    if( ReadFileContent( fullFileNames[f] ) != ReadFileContent( resumedFileNames[f] ) )
+      {
+      std::cerr << "Resume check failed: " << fullFileNames[f] << " and "
+                << resumedFileNames[f] << " differ" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Resume check passed: the run resumed after iteration " << halfIterations
+            << " ends in the state of the run in one go" << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+// Read the input as a VDimension image and run the level-sets of the
+// representation given by its name, or check their resume.
+template< unsigned int VDimension >
+int Run( const char* inputFileName, const char* outputFileName,
+         unsigned int numberOfIterations, unsigned int numberOfLevelSets,
+         const std::string& representation, unsigned int overlap,
+         const std::string& checkpointFileName, unsigned int checkpointPeriod,
+         unsigned int numberOfThreads, double edgeWeight, double edgeSigma,
+         bool checkResume )
+{
+  typedef itk::Image< InputPixelType, VDimension >  InputImageType;
+  typedef itk::Image< LabelPixelType, VDimension >  LabelImageType;
+
+  typedef itk::ImageFileReader< InputImageType >    ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( inputFileName );
+  reader->Update();
+  typename InputImageType::Pointer inputImage = reader->GetOutput();
+
+  typename LabelImageType::Pointer labelImage;
+
+  typedef float PixelType;
+
+  int status = EXIT_FAILURE;
+  if( representation == "Whitaker" )
+    {
+    typedef itk::WhitakerSparseLevelSetImage< PixelType, VDimension > LevelSetType;
+    if( checkResume )
+      {
+      status = CheckResumeWithMultipleLevelSets< InputImageType, LevelSetType >( inputImage,
+        numberOfIterations, numberOfLevelSets, overlap,
+        checkpointFileName, numberOfThreads,
+        edgeWeight, edgeSigma, labelImage );
+      }
+    else
+      {
+      status = SegmentWithMultipleLevelSets< InputImageType, LevelSetType >( inputImage,
+        numberOfIterations, numberOfLevelSets, overlap,
+        checkpointFileName, checkpointPeriod, numberOfThreads,
+        edgeWeight, edgeSigma, labelImage );
+      }
+    }
+  else if( representation == "Shi" )
+    {
+    typedef itk::ShiSparseLevelSetImage< VDimension > LevelSetType;
+    if( checkResume )
+      {
+      status = CheckResumeWithMultipleLevelSets< InputImageType, LevelSetType >( inputImage,
+        numberOfIterations, numberOfLevelSets, overlap,
+        checkpointFileName, numberOfThreads,
+        edgeWeight, edgeSigma, labelImage );
+      }
+    else
+      {
+      status = SegmentWithMultipleLevelSets< InputImageType, LevelSetType >( inputImage,
+        numberOfIterations, numberOfLevelSets, overlap,
+        checkpointFileName, checkpointPeriod, numberOfThreads,
+        edgeWeight, edgeSigma, labelImage );
+      }
+    }
+  else if( representation == "Malcolm" )
+    {
+    typedef itk::MalcolmSparseLevelSetImage< VDimension > LevelSetType;
+    if( checkResume )
+      {
+      status = CheckResumeWithMultipleLevelSets< InputImageType, LevelSetType >( inputImage,
+        numberOfIterations, numberOfLevelSets, overlap,
+        checkpointFileName, numberOfThreads,
+        edgeWeight, edgeSigma, labelImage );
+      }
+    else
+      {
+      status = SegmentWithMultipleLevelSets< InputImageType, LevelSetType >( inputImage,
+        numberOfIterations, numberOfLevelSets, overlap,
+        checkpointFileName, checkpointPeriod, numberOfThreads,
+        edgeWeight, edgeSigma, labelImage );
+      }
+    }
+  else
+    {
+    std::cerr << "Unknown representation: " << representation << std::endl;
+    }
+
+  if( status != EXIT_SUCCESS )
+    {
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageFileWriter< LabelImageType >     OutputWriterType;
+  typename OutputWriterType::Pointer writer = OutputWriterType::New();
+  writer->SetFileName( outputFileName );
+  writer->SetInput( labelImage );
+
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cout << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+int main( int argc, char* argv[] )
+{
+  if( argc < 5 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << "./MultipleLevelSets " <<std::endl;
+    std::cerr << "1- Input Image (2D or 3D)" <<std::endl;
+    std::cerr << "2- Number of Iterations" <<std::endl;
+    std::cerr << "3- Number of Level-Sets" <<std::endl;
+    std::cerr << "4- Output label image" <<std::endl;
+    std::cerr << "5- [Representation: Whitaker (default), Shi or Malcolm]" <<std::endl;
+    std::cerr << "6- [Overlap of the level-set domains, in pixels (default: 0)]" <<std::endl;
+    std::cerr << "7- [Checkpoint file, resumed from if it exists]" <<std::endl;
+    std::cerr << "8- [Checkpoint period, in iterations (default: 50)]" <<std::endl;
+    std::cerr << "9- [Number of threads for the independent groups of level-sets (default: all)]" <<std::endl;
+    std::cerr << "10- [Weight of the edge speed term (default: 0, no edge term)]" <<std::endl;
+    std::cerr << "11- [Scale of the edge speed, in physical units (default: 1)]" <<std::endl;
+    std::cerr << "12- [Check the resume: 1 to compare a run in one go with a run resumed" <<std::endl;
+    std::cerr << "     after half of the iterations, through checkpoints next to 7 (default: 0)]" <<std::endl;
+
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int numberOfIterations = atoi( argv[2] );
+  const unsigned int numberOfLevelSets = atoi( argv[3] );
+
+  if( ( numberOfLevelSets == 0 ) ||
+      ( numberOfLevelSets >= itk::NumericTraits< LabelPixelType >::max() ) )
+    {
+    std::cerr << "Invalid number of level-sets: " << argv[3] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string representation = "Whitaker";
+  if( argc > 5 )
+    {
+    representation = argv[5];
+    }
+
+  unsigned int overlap = 0;
+  if( argc > 6 )
+    {
+    overlap = atoi( argv[6] );
+    }
+
+  std::string checkpointFileName;
+  if( argc > 7 )
+    {
+    checkpointFileName = argv[7];
+    }
+
+  unsigned int checkpointPeriod = 50;
+  if( argc > 8 )
+    {
+    checkpointPeriod = atoi( argv[8] );
+    }
+
+  unsigned int numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  if( argc > 9 )
+    {
+    numberOfThreads = atoi( argv[9] );
+    }
+
+  double edgeWeight = 0.;
+  if( argc > 10 )
+    {
+    edgeWeight = atof( argv[10] );
+    }
+
+  double edgeSigma = 1.;
+  if( argc > 11 )
+    {
+    edgeSigma = atof( argv[11] );
+    }
+
+  bool checkResume = false;
+  if( argc > 12 )
+    {
+    checkResume = ( atoi( argv[12] ) != 0 );
+    }
+
+  if( checkResume && checkpointFileName.empty() )
+    {
+    std::cerr << "The resume check needs a checkpoint file" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The dimension of the input is only known at run time.
+  itk::ImageIOBase::Pointer imageIO =
+    itk::ImageIOFactory::CreateImageIO( argv[1], itk::ImageIOFactory::ReadMode );
+  if( imageIO.IsNull() )
+    {
+    std::cerr << "Could not read " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+  imageIO->SetFileName( argv[1] );
+  imageIO->ReadImageInformation();
+
+  switch( imageIO->GetNumberOfDimensions() )
+    {
+    case 2:
+      return Run< 2 >( argv[1], argv[4], numberOfIterations, numberOfLevelSets,
+                       representation, overlap, checkpointFileName, checkpointPeriod,
+                       numberOfThreads, edgeWeight, edgeSigma, checkResume );
+    case 3:
+      return Run< 3 >( argv[1], argv[4], numberOfIterations, numberOfLevelSets,
+                       representation, overlap, checkpointFileName, checkpointPeriod,
+                       numberOfThreads, edgeWeight, edgeSigma, checkResume );
+    default:
+      std::cerr << "Unsupported dimension: " << imageIO->GetNumberOfDimensions() << std::endl;
+      return EXIT_FAILURE;
+    }
+}
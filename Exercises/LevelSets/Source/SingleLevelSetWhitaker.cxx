@@ -19,56 +19,70 @@
 #include "itkImage.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
-#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
 #include "itkLevelSetDomainMapImageFilter.h"
 #include "itkLevelSetContainer.h"
 #include "itkLevelSetEquationChanAndVeseInternalTerm.h"
 #include "itkLevelSetEquationChanAndVeseExternalTerm.h"
 #include "itkLevelSetEquationTermContainer.h"
 #include "itkLevelSetEquationContainer.h"
-#include "itkSinRegularizedHeavisideStepFunction.h"
-#include "itkLevelSetEvolution.h"
-#include "itkBinaryImageToLevelSetImageAdaptor.h"
+#include "itkTabulatedHeavisideStepFunction.h"
+#include "itkLevelSetAdaptiveTimeStepEvolution.h"
+#include "itkSeedToSparseLevelSetImageAdaptor.h"
 #include "itkLevelSetEvolutionNumberOfIterationsStoppingCriterion.h"
-#include "itkNumericTraits.h"
-
-#include "itkLevelSetIterationUpdateCommand.h"
+#include "itkLevelSetEvolutionRMSChangeStoppingCriterion.h"
+#include "itkLevelSetEvolutionFrontSizeStoppingCriterion.h"
+#include "itkLevelSetEvolutionChanAndVeseEnergyStoppingCriterion.h"
+#include "itkLevelSetEvolutionCompositeStoppingCriterion.h"
+#include "itkWhitakerSparseLevelSetImage.h"
+#include "itkShiSparseLevelSetImage.h"
+#include "itkMalcolmSparseLevelSetImage.h"
+#include "itkSparseLevelSetToImageFilter.h"
+#include "itkTimeProbe.h"
+#include "itkMemoryProbe.h"
+
+#include "itkLevelSetLayerTraceRecorder.h"
+
+#ifdef LEVELSET_EXERCISES_USE_VTK
+#include "itkLevelSetAsynchronousVisualizationCommand.h"
 #include "vtkVisualize2DSparseLevelSetLayers.h"
+#endif
 
-int main( int argc, char* argv[] )
-{
-  if( argc < 5 )
-    {
-    std::cerr << "Missing Arguments" << std::endl;
-    std::cerr << "./SingleLevelSetWhitaker " <<std::endl;
-    std::cerr << "1- Input Image" <<std::endl;
-    std::cerr << "2- Number of Iterations" <<std::endl;
-    std::cerr << "3- Visualization (0 or 1)" <<std::endl;
-    std::cerr << "4- Output" <<std::endl;
-
-    return EXIT_FAILURE;
-    }
-
-  // Image Dimension
-  const unsigned int Dimension = 2;
+// Image Dimension
+const unsigned int Dimension = 2;
 
-  typedef unsigned char                                     InputPixelType;
-  typedef itk::Image< InputPixelType, Dimension >           InputImageType;
+typedef unsigned char                                     InputPixelType;
+typedef itk::Image< InputPixelType, Dimension >           InputImageType;
+typedef itk::Image< char, Dimension >                     OutputImageType;
 
-  // Read input image (to be processed).
-  typedef itk::ImageFileReader< InputImageType >            ReaderType;
-  ReaderType::Pointer reader = ReaderType::New();
-  reader->SetFileName( argv[1] );
-  reader->Update();
-  InputImageType::Pointer inputImage = reader->GetOutput();
+// Timing and memory footprint of one level-set evolution.
+struct LevelSetRunStatistics
+{
+  unsigned int NumberOfIterations;
+  double       ElapsedTime;
+  double       MemoryUsage;
+};
+
+// Segment inputImage with a sparse level-set of type TLevelSet; the label
+// map of the final level-set is written into outputImage.
+template< class TLevelSet >
+int SegmentWithSparseLevelSet( InputImageType* inputImage,
+                               unsigned int numberOfIterations,
+                               bool visualize,
+                               const std::string& traceFileName,
+                               OutputImageType::Pointer& outputImage,
+                               LevelSetRunStatistics& statistics )
+{
+  itk::MemoryProbe memoryProbe;
+  memoryProbe.Start();
 
-  // Generate a binary mask that will be used as initialization
-  // of the level set evolution.
-  InputImageType::Pointer binaryImage = InputImageType::New();
-  binaryImage->SetRegions( inputImage->GetLargestPossibleRegion() );
-  binaryImage->CopyInformation( inputImage );
-  binaryImage->Allocate();
-  binaryImage->FillBuffer( itk::NumericTraits<InputPixelType>::Zero );
+  // The initial level set is the box starting at (5, 5) of size 120 x 120.
+  // Its layers are grown directly from the boundary of the box: no binary
+  // image of the size of the input is allocated or scanned.
+  // The representation is given by TLevelSet; e.g. a "Whitaker" sparse
+  // level-set maintains the layers {-2, -1, 0, +1, +2 } around the zero-set,
+  // while "Shi" and "Malcolm" only keep {-1, +1} and {0} respectively.
+  typedef itk::SeedToSparseLevelSetImageAdaptor< TLevelSet > SeedToSparseAdaptorType;
 
   InputImageType::RegionType region;
   InputImageType::IndexType index;
@@ -80,36 +94,16 @@ int main( int argc, char* argv[] )
   region.SetIndex( index );
   region.SetSize( size );
 
-  typedef itk::ImageRegionIteratorWithIndex< InputImageType > InputIteratorType;
-  InputIteratorType iIt( binaryImage, region );
-  iIt.GoToBegin();
-  while( !iIt.IsAtEnd() )
-    {
-    iIt.Set( itk::NumericTraits<InputPixelType>::One );
-    ++iIt;
-    }
-
-  // Convert the binaryImage mask into a level set function.
-  // Here the output level-set will be a "Whitaker" sparse level-set;
-  // i.e. only few layers {-2, -1, 0, +1, +2 } around the zero-set are
-  // maintained, the rest of the domain is either -3 or +3.
-  typedef float PixelType;
-
-  typedef itk::WhitakerSparseLevelSetImage<
-    PixelType, Dimension > WhitakerSparseLevelSetImageType;
-
-  typedef itk::BinaryImageToLevelSetImageAdaptor<
-   InputImageType, WhitakerSparseLevelSetImageType > BinaryToSparseAdaptorType;
-
-  BinaryToSparseAdaptorType::Pointer adaptor = BinaryToSparseAdaptorType::New();
-  adaptor->SetInputImage( binaryImage );
+  typename SeedToSparseAdaptorType::Pointer adaptor = SeedToSparseAdaptorType::New();
+  adaptor->SetReferenceImage( inputImage );
+  adaptor->AddRegion( region );
   adaptor->Initialize();
   std::cout << "Finished converting to sparse format" << std::endl;
 
   // Here get the resulting level-set function
-  typedef BinaryToSparseAdaptorType::LevelSetType SparseLevelSetType;
+  typedef typename SeedToSparseAdaptorType::LevelSetType SparseLevelSetType;
 
-  SparseLevelSetType::Pointer levelSet = adaptor->GetLevelSet();
+  typename SparseLevelSetType::Pointer levelSet = adaptor->GetLevelSet();
 
   // Create here the bounds in which this level-set can evolved.
 
@@ -124,7 +118,7 @@ int main( int argc, char* argv[] )
   // We create one image where for each pixel we provide which level-set exists.
   // In this example the first level-set is defined on the whole image.
   typedef itk::Image< IdListType, Dimension >               IdListImageType;
-  IdListImageType::Pointer idImage = IdListImageType::New();
+  typename IdListImageType::Pointer idImage = IdListImageType::New();
   idImage->SetRegions( inputImage->GetLargestPossibleRegion() );
   idImage->Allocate();
   idImage->FillBuffer( listIds );
@@ -132,24 +126,24 @@ int main( int argc, char* argv[] )
   typedef itk::Image< short, Dimension >                     CacheImageType;
   typedef itk::LevelSetDomainMapImageFilter< IdListImageType, CacheImageType >
                                                             DomainMapImageFilterType;
-  DomainMapImageFilterType::Pointer domainMapFilter = DomainMapImageFilterType::New();
+  typename DomainMapImageFilterType::Pointer domainMapFilter = DomainMapImageFilterType::New();
   domainMapFilter->SetInput( idImage );
   domainMapFilter->Update();
   std::cout << "Domain map computed" << std::endl;
 
   // Define the Heaviside function
-  typedef SparseLevelSetType::OutputRealType LevelSetOutputRealType;
+  typedef typename SparseLevelSetType::OutputRealType LevelSetOutputRealType;
 
-  typedef itk::SinRegularizedHeavisideStepFunction<
+  typedef itk::TabulatedHeavisideStepFunction<
     LevelSetOutputRealType, LevelSetOutputRealType > HeavisideFunctionBaseType;
-  HeavisideFunctionBaseType::Pointer heaviside = HeavisideFunctionBaseType::New();
+  typename HeavisideFunctionBaseType::Pointer heaviside = HeavisideFunctionBaseType::New();
   heaviside->SetEpsilon( 1.0 );
 
   // Insert the levelsets in a levelset container
   typedef itk::LevelSetContainer<
     IdentifierType, SparseLevelSetType > LevelSetContainerType;
 
-  LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
+  typename LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
   lscontainer->SetHeaviside( heaviside );
   lscontainer->SetDomainMapFilter( domainMapFilter );
 
@@ -163,7 +157,7 @@ int main( int argc, char* argv[] )
   typedef itk::LevelSetEquationChanAndVeseInternalTerm<
     InputImageType, LevelSetContainerType > InternalTermType;
 
-  InternalTermType::Pointer cvInternalTerm0 = InternalTermType::New();
+  typename InternalTermType::Pointer cvInternalTerm0 = InternalTermType::New();
   cvInternalTerm0->SetInput( inputImage );
   cvInternalTerm0->SetCoefficient( 1.0 );
   cvInternalTerm0->SetCurrentLevelSetId( 0 );
@@ -174,7 +168,7 @@ int main( int argc, char* argv[] )
   typedef itk::LevelSetEquationChanAndVeseExternalTerm<
     InputImageType, LevelSetContainerType > ExternalTermType;
 
-  ExternalTermType::Pointer cvExternalTerm0 = ExternalTermType::New();
+  typename ExternalTermType::Pointer cvExternalTerm0 = ExternalTermType::New();
   cvExternalTerm0->SetInput( inputImage );
   cvExternalTerm0->SetCoefficient( 1.0 );
   cvExternalTerm0->SetCurrentLevelSetId( 0 );
@@ -187,7 +181,7 @@ int main( int argc, char* argv[] )
   typedef itk::LevelSetEquationTermContainer<
     InputImageType, LevelSetContainerType > TermContainerType;
 
-  TermContainerType::Pointer termContainer0 = TermContainerType::New();
+  typename TermContainerType::Pointer termContainer0 = TermContainerType::New();
   termContainer0->SetInput( inputImage );
   termContainer0->SetLevelSetContainer( lscontainer );
 
@@ -197,39 +191,104 @@ int main( int argc, char* argv[] )
   std::cout << "Term container 0 created" << std::endl;
 
   typedef itk::LevelSetEquationContainer< TermContainerType > EquationContainerType;
-  EquationContainerType::Pointer equationContainer = EquationContainerType::New();
+  typename EquationContainerType::Pointer equationContainer = EquationContainerType::New();
   equationContainer->AddEquation( 0, termContainer0 );
   equationContainer->SetLevelSetContainer( lscontainer );
 
+  // Stop after numberOfIterations iterations at most, or as soon as the
+  // evolution has converged: small RMS change, stable front size or flat
+  // Chan and Vese energy.
   typedef itk::LevelSetEvolutionNumberOfIterationsStoppingCriterion<
-    LevelSetContainerType > StoppingCriterionType;
+    LevelSetContainerType > NumberOfIterationsCriterionType;
 
-  StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
-  criterion->SetNumberOfIterations( atoi( argv[2]) );
+  typename NumberOfIterationsCriterionType::Pointer numberOfIterationsCriterion =
+    NumberOfIterationsCriterionType::New();
+  numberOfIterationsCriterion->SetNumberOfIterations( numberOfIterations );
 
-  typedef itk::LevelSetEvolution< EquationContainerType, SparseLevelSetType > LevelSetEvolutionType;
+  typedef itk::LevelSetEvolutionRMSChangeStoppingCriterion<
+    LevelSetContainerType > RMSChangeCriterionType;
 
-  LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+  typename RMSChangeCriterionType::Pointer rmsChangeCriterion = RMSChangeCriterionType::New();
+  rmsChangeCriterion->SetRMSChangeThreshold( 1e-3 );
+  rmsChangeCriterion->SetNumberOfConsecutiveIterations( 3 );
 
-  // Create the visualizer
-  typedef vtkVisualize2DSparseLevelSetLayers< InputImageType, SparseLevelSetType > VisualizationType;
-  VisualizationType::Pointer visualizer = VisualizationType::New();
+  typedef itk::LevelSetEvolutionFrontSizeStoppingCriterion<
+    LevelSetContainerType > FrontSizeCriterionType;
+
+  typename FrontSizeCriterionType::Pointer frontSizeCriterion = FrontSizeCriterionType::New();
+  frontSizeCriterion->SetRelativeSizeChangeThreshold( 0. );
+  frontSizeCriterion->SetNumberOfConsecutiveIterations( 5 );
 
-  visualizer->SetInputImage( inputImage );
-  visualizer->SetLevelSet( levelSet );
-  visualizer->SetScreenCapture( false );
-  std::cout << "Visualizer created" << std::endl;
+  typedef itk::LevelSetEvolutionChanAndVeseEnergyStoppingCriterion<
+    InputImageType, LevelSetContainerType > EnergyCriterionType;
 
+  typename EnergyCriterionType::Pointer energyCriterion = EnergyCriterionType::New();
+  energyCriterion->SetInput( inputImage );
+  energyCriterion->SetInternalTerm( cvInternalTerm0 );
+  energyCriterion->SetExternalTerm( cvExternalTerm0 );
+  energyCriterion->SetWindowSize( 5 );
+  energyCriterion->SetRelativeEnergyTolerance( 1e-4 );
 
-  typedef itk::LevelSetIterationUpdateCommand< LevelSetEvolutionType, VisualizationType > IterationUpdateCommandType;
+  typedef itk::LevelSetEvolutionCompositeStoppingCriterion<
+    LevelSetContainerType > StoppingCriterionType;
+
+  typename StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
+  criterion->SetLevelSetContainer( lscontainer );
+  criterion->AddCriterion( numberOfIterationsCriterion );
+  criterion->AddCriterion( rmsChangeCriterion );
+  criterion->AddCriterion( frontSizeCriterion );
+  criterion->AddCriterion( energyCriterion );
+
+  // The time step of each iteration is the largest stable one for its
+  // updates, rather than a bound on the speed of the terms.
+  typedef itk::LevelSetAdaptiveTimeStepEvolution< EquationContainerType, SparseLevelSetType >
+                                                            LevelSetEvolutionType;
+
+  typename LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+
+#ifdef LEVELSET_EXERCISES_USE_VTK
+  // Create the visualizer. The evolution then runs on a worker thread and
+  // the layers are rendered on this one: on each iteration the evolution
+  // only copies the layers if the rendering is waiting for a new frame,
+  // and never waits for the rendering.
+  typedef vtkVisualize2DSparseLevelSetLayers< InputImageType, SparseLevelSetType > VisualizationType;
+  typedef itk::LevelSetAsynchronousVisualizationCommand< LevelSetEvolutionType, VisualizationType >
+                                                            VisualizationCommandType;
+  typename VisualizationCommandType::Pointer visualizationCommand;
+
+  if( visualize )
+    {
+    typename VisualizationType::Pointer visualizer = VisualizationType::New();
+    visualizer->SetInputImage( inputImage );
+    visualizer->SetScreenCapture( false );
+
+    visualizationCommand = VisualizationCommandType::New();
+    visualizationCommand->SetFilterToUpdate( visualizer );
+    visualizationCommand->SetLevelSet( levelSet );
+    visualizationCommand->SetUpdatePeriod( 1 );
+    std::cout << "Visualizer created" << std::endl;
+    }
+#else
+  if( visualize )
+    {
+    std::cerr << "Built without VTK: visualization is disabled" << std::endl;
+    }
+#endif
 
-  IterationUpdateCommandType::Pointer iterationUpdateCommand = IterationUpdateCommandType::New();
-  iterationUpdateCommand->SetFilterToUpdate( visualizer );
-  iterationUpdateCommand->SetUpdatePeriod( 1 );
+  // Optionally record the layers of every iteration, to be inspected later
+  // with LevelSetTraceReplay.
+  typedef itk::LevelSetLayerTraceRecorder< SparseLevelSetType > TraceRecorderType;
+  typename TraceRecorderType::Pointer traceRecorder;
 
-  if( atoi( argv[3] ) == 1 )
+  if( !traceFileName.empty() )
     {
-    evolution->AddObserver( itk::IterationEvent(), iterationUpdateCommand );
+    traceRecorder = TraceRecorderType::New();
+    traceRecorder->SetFileName( traceFileName );
+    traceRecorder->SetLevelSet( levelSet );
+    traceRecorder->Open();
+
+    evolution->AddObserver( itk::IterationEvent(), traceRecorder );
+    std::cout << "Recording layers into " << traceFileName << std::endl;
     }
 
   evolution->SetStoppingCriterion( criterion );
@@ -237,9 +296,23 @@ int main( int argc, char* argv[] )
   evolution->SetEquationContainer( equationContainer );
   evolution->SetLevelSetContainer( lscontainer );
 
+  itk::TimeProbe timeProbe;
+  timeProbe.Start();
+
   try
     {
+#ifdef LEVELSET_EXERCISES_USE_VTK
+    if( visualize )
+      {
+      visualizationCommand->Evolve( evolution );
+      }
+    else
+      {
+      evolution->Update();
+      }
+#else
     evolution->Update();
+#endif
     }
   catch ( itk::ExceptionObject& err )
     {
@@ -247,24 +320,222 @@ int main( int argc, char* argv[] )
     return EXIT_FAILURE;
     }
 
-  typedef itk::Image< char, Dimension > OutputImageType;
-  OutputImageType::Pointer outputImage = OutputImageType::New();
-  outputImage->SetRegions( inputImage->GetLargestPossibleRegion() );
-  outputImage->CopyInformation( inputImage );
-  outputImage->Allocate();
-  outputImage->FillBuffer( 0 );
+  timeProbe.Stop();
+  memoryProbe.Stop();
+
+  if( traceRecorder.IsNotNull() )
+    {
+    traceRecorder->Close();
+    }
+
+  std::cout << "Stopped after " << criterion->GetCurrentIteration() << " iterations ("
+            << criterion->GetDescription() << ")" << std::endl;
+
+  // Log the time steps, so that the run can be reproduced
+  const typename LevelSetEvolutionType::TimeStepListType & timeSteps = evolution->GetTimeSteps();
+  if( !timeSteps.empty() )
+    {
+    std::cout << "Time steps:";
+    for( size_t i = 0; i < timeSteps.size(); i++ )
+      {
+      std::cout << " " << timeSteps[i];
+      }
+    std::cout << std::endl;
+    }
+
+  statistics.NumberOfIterations = criterion->GetCurrentIteration();
+  statistics.ElapsedTime = timeProbe.GetTotal();
+  statistics.MemoryUsage = memoryProbe.GetTotal();
+
+  // Rasterize the label map of the level-set, one run-length line at a time.
+  typedef itk::SparseLevelSetToImageFilter< SparseLevelSetType, OutputImageType > LevelSetToImageFilterType;
+  typename LevelSetToImageFilterType::Pointer levelSetToImage = LevelSetToImageFilterType::New();
+  levelSetToImage->SetLevelSet( levelSet );
+  levelSetToImage->SetOutputParametersFromImage( inputImage );
+  levelSetToImage->Update();
+
+  outputImage = levelSetToImage->GetOutput();
+  outputImage->DisconnectPipeline();
+
+  return EXIT_SUCCESS;
+}
+
+// Run the segmentation with the representation given by its name.
+int SegmentWithSparseLevelSet( const std::string& representation,
+                               InputImageType* inputImage,
+                               unsigned int numberOfIterations,
+                               bool visualize,
+                               const std::string& traceFileName,
+                               OutputImageType::Pointer& outputImage,
+                               LevelSetRunStatistics& statistics )
+{
+  typedef float PixelType;
+
+  if( representation == "Whitaker" )
+    {
+    typedef itk::WhitakerSparseLevelSetImage< PixelType, Dimension > LevelSetType;
+    return SegmentWithSparseLevelSet< LevelSetType >( inputImage,
+      numberOfIterations, visualize, traceFileName, outputImage, statistics );
+    }
+  if( representation == "Shi" )
+    {
+    typedef itk::ShiSparseLevelSetImage< Dimension > LevelSetType;
+    return SegmentWithSparseLevelSet< LevelSetType >( inputImage,
+      numberOfIterations, visualize, traceFileName, outputImage, statistics );
+    }
+  if( representation == "Malcolm" )
+    {
+    typedef itk::MalcolmSparseLevelSetImage< Dimension > LevelSetType;
+    return SegmentWithSparseLevelSet< LevelSetType >( inputImage,
+      numberOfIterations, visualize, traceFileName, outputImage, statistics );
+    }
+
+  std::cerr << "Unknown representation: " << representation << std::endl;
+  return EXIT_FAILURE;
+}
+
+// Dice coefficient between the inside (label <= 0) of a segmentation and
+// the foreground (non-zero) of a reference; when the reference is itself a
+// level-set output, its inside is used instead.
+template< class TReferenceImage >
+double ComputeDiceCoefficient( const OutputImageType* segmentation,
+                               const TReferenceImage* reference,
+                               bool referenceIsLevelSet )
+{
+  typedef itk::ImageRegionConstIterator< OutputImageType > SegmentationIteratorType;
+  typedef itk::ImageRegionConstIterator< TReferenceImage > ReferenceIteratorType;
+
+  SegmentationIteratorType sIt( segmentation, segmentation->GetLargestPossibleRegion() );
+  ReferenceIteratorType    rIt( reference, segmentation->GetLargestPossibleRegion() );
+
+  itk::SizeValueType segmentationSize = 0;
+  itk::SizeValueType referenceSize = 0;
+  itk::SizeValueType overlapSize = 0;
+
+  for( sIt.GoToBegin(), rIt.GoToBegin(); !sIt.IsAtEnd(); ++sIt, ++rIt )
+    {
+    const bool inSegmentation = ( sIt.Get() <= 0 );
+    const bool inReference = referenceIsLevelSet ?
+      ( rIt.Get() <= 0 ) : ( rIt.Get() != 0 );
+
+    segmentationSize += inSegmentation;
+    referenceSize += inReference;
+    overlapSize += ( inSegmentation && inReference );
+    }
+
+  if( segmentationSize + referenceSize == 0 )
+    {
+    return 1.;
+    }
+  return 2. * static_cast< double >( overlapSize ) /
+    static_cast< double >( segmentationSize + referenceSize );
+}
+
+int main( int argc, char* argv[] )
+{
+  if( argc < 5 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << "./SingleLevelSetWhitaker " <<std::endl;
+    std::cerr << "1- Input Image" <<std::endl;
+    std::cerr << "2- Maximum Number of Iterations" <<std::endl;
+    std::cerr << "3- Visualization (0 or 1)" <<std::endl;
+    std::cerr << "4- Output" <<std::endl;
+    std::cerr << "5- [Representation: Whitaker (default), Shi, Malcolm or Benchmark]" <<std::endl;
+    std::cerr << "6- [Benchmark: reference segmentation for the Dice score," <<std::endl;
+    std::cerr << "    otherwise: layer trace file]" <<std::endl;
+
+    return EXIT_FAILURE;
+    }
+
+  // Read input image (to be processed).
+  typedef itk::ImageFileReader< InputImageType >            ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+  reader->Update();
+  InputImageType::Pointer inputImage = reader->GetOutput();
+
+  const unsigned int numberOfIterations = atoi( argv[2] );
+  const bool visualize = ( atoi( argv[3] ) == 1 );
 
-  typedef itk::ImageRegionIteratorWithIndex< OutputImageType > OutputIteratorType;
-  OutputIteratorType oIt( outputImage, outputImage->GetLargestPossibleRegion() );
-  oIt.GoToBegin();
+  std::string representation = "Whitaker";
+  if( argc > 5 )
+    {
+    representation = argv[5];
+    }
 
-  OutputImageType::IndexType idx;
+  OutputImageType::Pointer outputImage;
 
-  while( !oIt.IsAtEnd() )
+  if( representation == "Benchmark" )
+    {
+    // Run every representation on the same input, without visualization,
+    // and compare their speed, memory footprint and accuracy.
+    const char * representations[] = { "Whitaker", "Shi", "Malcolm" };
+    const unsigned int numberOfRepresentations = 3;
+
+    InputImageType::Pointer referenceImage;
+    if( argc > 6 )
+      {
+      ReaderType::Pointer referenceReader = ReaderType::New();
+      referenceReader->SetFileName( argv[6] );
+      referenceReader->Update();
+      referenceImage = referenceReader->GetOutput();
+      }
+
+    // Without a reference segmentation, the Whitaker result is used.
+    OutputImageType::Pointer whitakerImage;
+
+    std::cout << "Representation\tIterations/s\tMemory (" << itk::MemoryProbe().GetUnit()
+              << ")\tDice" << std::endl;
+
+    for( unsigned int i = 0; i < numberOfRepresentations; i++ )
+      {
+      OutputImageType::Pointer segmentation;
+
+      LevelSetRunStatistics statistics;
+      if( SegmentWithSparseLevelSet( representations[i], inputImage,
+            numberOfIterations, false, "", segmentation, statistics ) != EXIT_SUCCESS )
+        {
+        return EXIT_FAILURE;
+        }
+
+      if( i == 0 )
+        {
+        whitakerImage = segmentation;
+        outputImage = segmentation;
+        }
+
+      double dice;
+      if( referenceImage.IsNotNull() )
+        {
+        dice = ComputeDiceCoefficient( segmentation.GetPointer(), referenceImage.GetPointer(), false );
+        }
+      else
+        {
+        dice = ComputeDiceCoefficient( segmentation.GetPointer(), whitakerImage.GetPointer(), true );
+        }
+
+      const double iterationsPerSecond = ( statistics.ElapsedTime > 0. ) ?
+        statistics.NumberOfIterations / statistics.ElapsedTime : 0.;
+
+      std::cout << representations[i] << "\t" << iterationsPerSecond << "\t"
+                << statistics.MemoryUsage << "\t" << dice << std::endl;
+      }
+    }
+  else
     {
-    idx = oIt.GetIndex();
-    oIt.Set( levelSet->GetLabelMap()->GetPixel(idx) );
-    ++oIt;
+    std::string traceFileName;
+    if( argc > 6 )
+      {
+      traceFileName = argv[6];
+      }
+
+    LevelSetRunStatistics statistics;
+    if( SegmentWithSparseLevelSet( representation, inputImage,
+          numberOfIterations, visualize, traceFileName, outputImage, statistics ) != EXIT_SUCCESS )
+      {
+      return EXIT_FAILURE;
+      }
     }
 
   typedef itk::ImageFileWriter< OutputImageType >     OutputWriterType;
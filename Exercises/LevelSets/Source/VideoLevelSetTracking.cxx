@@ -0,0 +1,221 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#include "itkImage.h"
+#include "itkVideoStream.h"
+#include "itkVideoFileReader.h"
+#include "itkVideoFileWriter.h"
+#include "itkFileListVideoIOFactory.h"
+#include "itkVideoLevelSetTrackingFilter.h"
+#include "itkWhitakerSparseLevelSetImage.h"
+#include "itkShiSparseLevelSetImage.h"
+#include "itkMalcolmSparseLevelSetImage.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+const unsigned int Dimension = 2;
+
+typedef unsigned char                             PixelType;
+typedef itk::Image< PixelType, Dimension >        FrameType;
+typedef itk::VideoStream< FrameType >             VideoType;
+
+template< class TLevelSet >
+int TrackWithSparseLevelSet( const char* inputFileName,
+                             const char* outputFileName,
+                             unsigned int numberOfIterations,
+                             unsigned int numberOfInitialIterations,
+                             const std::vector< itk::OffsetValueType >& seedBox,
+                             bool predictMotion )
+{
+  typedef itk::VideoFileReader< VideoType >   ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( inputFileName );
+
+  try
+    {
+    reader->UpdateOutputInformation();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::VideoLevelSetTrackingFilter< VideoType, VideoType, TLevelSet > TrackingFilterType;
+  typename TrackingFilterType::Pointer tracking = TrackingFilterType::New();
+  tracking->SetInput( reader->GetOutput() );
+  tracking->SetNumberOfIterations( numberOfIterations );
+  tracking->SetNumberOfInitialIterations( numberOfInitialIterations );
+  tracking->SetPredictMotion( predictMotion );
+
+  // Seed with the given box, or a box covering the central half of the
+  // first frame
+  const VideoType* video = reader->GetOutput();
+  const FrameType::RegionType frameRegion = video->GetFrameLargestPossibleSpatialRegion(
+    video->GetLargestPossibleTemporalRegion().GetFrameStart() );
+
+  FrameType::RegionType region = frameRegion;
+  if( seedBox.size() == 2 * Dimension )
+    {
+    for( unsigned int dim = 0; dim < Dimension; dim++ )
+      {
+      region.SetIndex( dim, seedBox[dim] );
+      region.SetSize( dim, static_cast< itk::SizeValueType >( seedBox[Dimension + dim] ) );
+      }
+    }
+  else
+    {
+    for( unsigned int dim = 0; dim < Dimension; dim++ )
+      {
+      const itk::SizeValueType size = std::max( region.GetSize()[dim] / 2, itk::SizeValueType( 1 ) );
+      region.SetIndex( dim, region.GetIndex()[dim] +
+                       static_cast< itk::OffsetValueType >( ( region.GetSize()[dim] - size ) / 2 ) );
+      region.SetSize( dim, size );
+      }
+    }
+  if( !region.Crop( frameRegion ) )
+    {
+    std::cerr << "The seed box is out of the frames" << std::endl;
+    return EXIT_FAILURE;
+    }
+  tracking->AddSeedRegion( region );
+
+  typedef itk::VideoFileWriter< VideoType >   WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( outputFileName );
+  writer->SetInput( tracking->GetOutput() );
+
+  itk::TimeProbe timeProbe;
+  timeProbe.Start();
+
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject& err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  timeProbe.Stop();
+
+  typedef typename TrackingFilterType::FrameIterationMapType FrameIterationMapType;
+  const FrameIterationMapType & iterations = tracking->GetNumberOfIterationsPerFrame();
+
+  for( typename FrameIterationMapType::const_iterator it = iterations.begin(); it != iterations.end(); ++it )
+    {
+    std::cout << "Frame " << it->first << ": " << it->second << " iterations" << std::endl;
+    }
+
+  std::cout << "Total: " << timeProbe.GetTotal() << " " << timeProbe.GetUnit();
+  if( timeProbe.GetTotal() > 0. )
+    {
+    std::cout << " (" << iterations.size() / timeProbe.GetTotal() << " frames/"
+              << timeProbe.GetUnit() << ")";
+    }
+  std::cout << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+int main( int argc, char* argv[] )
+{
+  if( argc < 4 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << "./VideoLevelSetTracking " <<std::endl;
+    std::cerr << "1- Input video, e.g. a comma separated list of 2D frames" <<std::endl;
+    std::cerr << "2- Output video of masks" <<std::endl;
+    std::cerr << "3- Maximum Number of Iterations per frame" <<std::endl;
+    std::cerr << "4- [Maximum Number of Iterations of the first frame (default: 100)]" <<std::endl;
+    std::cerr << "5- [Seed box: index and size, e.g. 10x20x40x30 (default: central half)]" <<std::endl;
+    std::cerr << "6- [Predict the motion of the object (0 or 1, default: 0)]" <<std::endl;
+    std::cerr << "7- [Representation: Whitaker (default), Shi or Malcolm]" <<std::endl;
+
+    return EXIT_FAILURE;
+    }
+
+  // Read and write videos as lists of image files
+  itk::ObjectFactoryBase::RegisterFactory( itk::FileListVideoIOFactory::New() );
+
+  const unsigned int numberOfIterations = atoi( argv[3] );
+
+  unsigned int numberOfInitialIterations = 100;
+  if( argc > 4 )
+    {
+    numberOfInitialIterations = atoi( argv[4] );
+    }
+
+  std::vector< itk::OffsetValueType > seedBox;
+  if( argc > 5 )
+    {
+    std::istringstream box( argv[5] );
+    itk::OffsetValueType value;
+    while( box >> value )
+      {
+      seedBox.push_back( value );
+      box.ignore( 1 ); // skip the 'x'
+      }
+    if( seedBox.size() != 2 * Dimension )
+      {
+      std::cerr << "Invalid seed box: " << argv[5] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  bool predictMotion = false;
+  if( argc > 6 )
+    {
+    predictMotion = ( atoi( argv[6] ) == 1 );
+    }
+
+  std::string representation = "Whitaker";
+  if( argc > 7 )
+    {
+    representation = argv[7];
+    }
+
+  if( representation == "Whitaker" )
+    {
+    typedef itk::WhitakerSparseLevelSetImage< float, Dimension > LevelSetType;
+    return TrackWithSparseLevelSet< LevelSetType >( argv[1], argv[2],
+      numberOfIterations, numberOfInitialIterations, seedBox, predictMotion );
+    }
+  if( representation == "Shi" )
+    {
+    typedef itk::ShiSparseLevelSetImage< Dimension > LevelSetType;
+    return TrackWithSparseLevelSet< LevelSetType >( argv[1], argv[2],
+      numberOfIterations, numberOfInitialIterations, seedBox, predictMotion );
+    }
+  if( representation == "Malcolm" )
+    {
+    typedef itk::MalcolmSparseLevelSetImage< Dimension > LevelSetType;
+    return TrackWithSparseLevelSet< LevelSetType >( argv[1], argv[2],
+      numberOfIterations, numberOfInitialIterations, seedBox, predictMotion );
+    }
+
+  std::cerr << "Unknown representation: " << representation << std::endl;
+  return EXIT_FAILURE;
+}
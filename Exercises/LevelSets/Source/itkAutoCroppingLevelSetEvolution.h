@@ -0,0 +1,174 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkAutoCroppingLevelSetEvolution_h
+#define __itkAutoCroppingLevelSetEvolution_h
+
+#include "itkObject.h"
+#include "itkImage.h"
+#include "itkSeedToSparseLevelSetImageAdaptor.h"
+#include "itkSparseLevelSetLayerTraits.h"
+
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class AutoCroppingLevelSetEvolution
+ *  \brief Evolve a sparse level-set in a box around its front, grown as the
+ *  front moves, instead of over the whole image.
+ *
+ *  The evolution domain starts as the bounding box of the seeds grown by
+ *  Margin pixels. The input is cropped to it, and the domain map, its cache
+ *  image and the statistics of the Chan and Vese terms only cover it, so
+ *  that time and memory follow the size of the object rather than the size
+ *  of the image. The exterior statistics are thus those of the margin
+ *  around the object.
+ *
+ *  The level-set is evolved by chunks of CheckPeriod iterations. A sparse
+ *  front moves by at most one pixel per iteration: after each chunk, if the
+ *  bounding box of the layers is closer than CheckPeriod + 1 pixels to a
+ *  side of the domain which is not a side of the image, the domain is
+ *  grown to the bounding box of the layers plus Margin + CheckPeriod
+ *  pixels. The domain never shrinks. As the pixels out of the label map of
+ *  the level-set are exterior, the level-set is kept as is and only its
+ *  region is grown.
+ *
+ *  Once Update() has returned, the level-set covers the whole input.
+ *
+ *  An IterationEvent is invoked at the end of each chunk.
+ *
+ *  \tparam TInputImage Input image type
+ *  \tparam TLevelSet Whitaker, Shi or Malcolm sparse level-set image
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TInputImage, class TLevelSet >
+class AutoCroppingLevelSetEvolution : public Object
+{
+public:
+  typedef AutoCroppingLevelSetEvolution Self;
+  typedef Object                        Superclass;
+  typedef SmartPointer< Self >          Pointer;
+  typedef SmartPointer< const Self >    ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( AutoCroppingLevelSetEvolution, Object );
+
+  typedef TInputImage                               InputImageType;
+  typedef typename InputImageType::Pointer          InputImagePointer;
+  typedef typename InputImageType::ConstPointer     InputImageConstPointer;
+  typedef typename InputImageType::RegionType       RegionType;
+  typedef typename InputImageType::IndexType        IndexType;
+
+  typedef TLevelSet                                 LevelSetType;
+  typedef typename LevelSetType::Pointer            LevelSetPointer;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, InputImageType::ImageDimension );
+
+  typedef SeedToSparseLevelSetImageAdaptor< LevelSetType >  SeedAdaptorType;
+  typedef typename SeedAdaptorType::Pointer                 SeedAdaptorPointer;
+  typedef SparseLevelSetLayerTraits< LevelSetType >         LayerTraitsType;
+
+  /** Input image */
+  itkSetConstObjectMacro( Input, InputImageType );
+  itkGetConstObjectMacro( Input, InputImageType );
+
+  /** Seed boxes, in the index space of the input */
+  void AddSeedRegion( const RegionType& iRegion );
+  void ClearSeedRegions();
+
+  /** Number of iterations. Default is 100. */
+  itkSetMacro( NumberOfIterations, unsigned int );
+  itkGetConstMacro( NumberOfIterations, unsigned int );
+
+  /** Number of iterations between two checks of the domain. Default is
+   * 10. */
+  itkSetClampMacro( CheckPeriod, unsigned int, 1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro( CheckPeriod, unsigned int );
+
+  /** Pixels kept between the layers and the sides of the domain. Default
+   * is 10. */
+  itkSetMacro( Margin, unsigned int );
+  itkGetConstMacro( Margin, unsigned int );
+
+  /** Evolve the level-set */
+  void Update();
+
+  /** Number of iterations run so far */
+  itkGetConstMacro( CurrentIteration, unsigned int );
+
+  /** Current evolution domain */
+  itkGetConstReferenceMacro( CropRegion, RegionType );
+
+  /** Number of times the domain was grown */
+  itkGetConstMacro( NumberOfGrowths, unsigned int );
+
+  /** Resulting level-set, over the whole input once Update() has
+   * returned */
+  itkGetObjectMacro( LevelSet, LevelSetType );
+
+protected:
+  AutoCroppingLevelSetEvolution();
+  virtual ~AutoCroppingLevelSetEvolution() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** iRegion grown by iRadius pixels, and cropped to the input */
+  RegionType PadRegion( const RegionType& iRegion, SizeValueType iRadius ) const;
+
+  /** Bounding box of two regions */
+  static RegionType MergeRegions( const RegionType& iRegion1, const RegionType& iRegion2 );
+
+  /** Bounding box of the layer nodes of iLevelSet; false if it has none */
+  bool ComputeLayerBoundingBox( LevelSetType* iLevelSet, RegionType& oBox ) const;
+
+  /** Input restricted to iRegion, in the index space of the input */
+  InputImagePointer CropInput( const RegionType& iRegion ) const;
+
+  /** Evolve ioLevelSet on iImage for iNumberOfIterations */
+  void EvolveChunk( InputImageType* iImage, LevelSetType* ioLevelSet,
+                    unsigned int iNumberOfIterations ) const;
+
+private:
+  AutoCroppingLevelSetEvolution( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  InputImageConstPointer      m_Input;
+  std::vector< RegionType >   m_SeedRegions;
+
+  unsigned int                m_NumberOfIterations;
+  unsigned int                m_CheckPeriod;
+  unsigned int                m_Margin;
+
+  LevelSetPointer             m_LevelSet;
+  RegionType                  m_CropRegion;
+
+  unsigned int                m_CurrentIteration;
+  unsigned int                m_NumberOfGrowths;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkAutoCroppingLevelSetEvolution.hxx"
+#endif
+
+#endif // __itkAutoCroppingLevelSetEvolution_h
@@ -0,0 +1,359 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkAutoCroppingLevelSetEvolution_hxx
+#define __itkAutoCroppingLevelSetEvolution_hxx
+
+#include "itkAutoCroppingLevelSetEvolution.h"
+
+#include "itkExtractImageFilter.h"
+#include "itkLevelSetDomainMapImageFilter.h"
+#include "itkLevelSetContainer.h"
+#include "itkLevelSetEquationChanAndVeseInternalTerm.h"
+#include "itkLevelSetEquationChanAndVeseExternalTerm.h"
+#include "itkLevelSetEquationTermContainer.h"
+#include "itkLevelSetEquationContainer.h"
+#include "itkTabulatedHeavisideStepFunction.h"
+#include "itkLevelSetEvolution.h"
+#include "itkLevelSetEvolutionNumberOfIterationsStoppingCriterion.h"
+
+#include <algorithm>
+#include <list>
+
+namespace itk
+{
+template< class TInputImage, class TLevelSet >
+AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >
+::AutoCroppingLevelSetEvolution() :
+  m_NumberOfIterations( 100 ),
+  m_CheckPeriod( 10 ),
+  m_Margin( 10 ),
+  m_CurrentIteration( 0 ),
+  m_NumberOfGrowths( 0 )
+{
+}
+
+template< class TInputImage, class TLevelSet >
+void
+AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >
+::AddSeedRegion( const RegionType& iRegion )
+{
+  this->m_SeedRegions.push_back( iRegion );
+  this->Modified();
+}
+
+template< class TInputImage, class TLevelSet >
+void
+AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >
+::ClearSeedRegions()
+{
+  this->m_SeedRegions.clear();
+  this->Modified();
+}
+
+template< class TInputImage, class TLevelSet >
+typename AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >::RegionType
+AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >
+::PadRegion( const RegionType& iRegion, SizeValueType iRadius ) const
+{
+  RegionType region = iRegion;
+  region.PadByRadius( static_cast< OffsetValueType >( iRadius ) );
+  region.Crop( this->m_Input->GetLargestPossibleRegion() );
+  return region;
+}
+
+template< class TInputImage, class TLevelSet >
+typename AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >::RegionType
+AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >
+::MergeRegions( const RegionType& iRegion1, const RegionType& iRegion2 )
+{
+  RegionType region;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    const OffsetValueType first = std::min( iRegion1.GetIndex()[dim], iRegion2.GetIndex()[dim] );
+    const OffsetValueType end = std::max(
+      iRegion1.GetIndex()[dim] + static_cast< OffsetValueType >( iRegion1.GetSize()[dim] ),
+      iRegion2.GetIndex()[dim] + static_cast< OffsetValueType >( iRegion2.GetSize()[dim] ) );
+    region.SetIndex( dim, first );
+    region.SetSize( dim, static_cast< SizeValueType >( end - first ) );
+    }
+  return region;
+}
+
+template< class TInputImage, class TLevelSet >
+bool
+AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >
+::ComputeLayerBoundingBox( LevelSetType* iLevelSet, RegionType& oBox ) const
+{
+  typedef typename LevelSetType::LayerType          LayerType;
+  typedef typename LayerTraitsType::LayerIdListType LayerIdListType;
+
+  IndexType first;
+  IndexType last;
+  bool empty = true;
+
+  const LayerIdListType layerIds = LayerTraitsType::GetLayerIds();
+
+  for( size_t l = 0; l < layerIds.size(); l++ )
+    {
+    const LayerType & layer = iLevelSet->GetLayer( layerIds[l] );
+
+    for( typename LayerType::const_iterator nIt = layer.begin(); nIt != layer.end(); ++nIt )
+      {
+      if( empty )
+        {
+        first = nIt->first;
+        last = nIt->first;
+        empty = false;
+        continue;
+        }
+      for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+        {
+        first[dim] = std::min( first[dim], nIt->first[dim] );
+        last[dim] = std::max( last[dim], nIt->first[dim] );
+        }
+      }
+    }
+
+  if( empty )
+    {
+    return false;
+    }
+
+  oBox.SetIndex( first );
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    oBox.SetSize( dim, static_cast< SizeValueType >( last[dim] - first[dim] + 1 ) );
+    }
+  return true;
+}
+
+template< class TInputImage, class TLevelSet >
+typename AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >::InputImagePointer
+AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >
+::CropInput( const RegionType& iRegion ) const
+{
+  if( iRegion == this->m_Input->GetLargestPossibleRegion() )
+    {
+    // the terms take a non const input, but never modify it
+    return const_cast< InputImageType* >( this->m_Input.GetPointer() );
+    }
+
+  // The extracted image keeps the index of the region, so that the
+  // level-set needs no translation.
+  typedef ExtractImageFilter< InputImageType, InputImageType > ExtractFilterType;
+  typename ExtractFilterType::Pointer extractFilter = ExtractFilterType::New();
+  extractFilter->SetInput( this->m_Input );
+  extractFilter->SetExtractionRegion( iRegion );
+  extractFilter->SetDirectionCollapseToSubmatrix();
+  extractFilter->Update();
+
+  InputImagePointer output = extractFilter->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+
+template< class TInputImage, class TLevelSet >
+void
+AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >
+::EvolveChunk( InputImageType* iImage, LevelSetType* ioLevelSet,
+               unsigned int iNumberOfIterations ) const
+{
+  const unsigned int Dimension = ImageDimension;
+
+  typedef std::list< IdentifierType > IdListType;
+
+  IdListType listIds;
+  listIds.push_back( 1 );
+
+  // One domain over the crop only
+  typedef Image< IdListType, Dimension >  IdListImageType;
+  typename IdListImageType::Pointer idImage = IdListImageType::New();
+  idImage->SetRegions( iImage->GetLargestPossibleRegion() );
+  idImage->Allocate();
+  idImage->FillBuffer( listIds );
+
+  typedef Image< short, Dimension >       CacheImageType;
+  typedef LevelSetDomainMapImageFilter< IdListImageType, CacheImageType > DomainMapImageFilterType;
+  typename DomainMapImageFilterType::Pointer domainMapFilter = DomainMapImageFilterType::New();
+  domainMapFilter->SetInput( idImage );
+  domainMapFilter->Update();
+
+  typedef typename LevelSetType::OutputRealType LevelSetOutputRealType;
+
+  typedef TabulatedHeavisideStepFunction<
+    LevelSetOutputRealType, LevelSetOutputRealType > HeavisideFunctionBaseType;
+  typename HeavisideFunctionBaseType::Pointer heaviside = HeavisideFunctionBaseType::New();
+  heaviside->SetEpsilon( 1.0 );
+
+  typedef LevelSetContainer< IdentifierType, LevelSetType > LevelSetContainerType;
+  typename LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
+  lscontainer->SetHeaviside( heaviside );
+  lscontainer->SetDomainMapFilter( domainMapFilter );
+  lscontainer->AddLevelSet( 0, ioLevelSet );
+
+  typedef LevelSetEquationChanAndVeseInternalTerm<
+    InputImageType, LevelSetContainerType > InternalTermType;
+  typename InternalTermType::Pointer cvInternalTerm = InternalTermType::New();
+  cvInternalTerm->SetInput( iImage );
+  cvInternalTerm->SetCoefficient( 1.0 );
+  cvInternalTerm->SetCurrentLevelSetId( 0 );
+  cvInternalTerm->SetLevelSetContainer( lscontainer );
+
+  typedef LevelSetEquationChanAndVeseExternalTerm<
+    InputImageType, LevelSetContainerType > ExternalTermType;
+  typename ExternalTermType::Pointer cvExternalTerm = ExternalTermType::New();
+  cvExternalTerm->SetInput( iImage );
+  cvExternalTerm->SetCoefficient( 1.0 );
+  cvExternalTerm->SetCurrentLevelSetId( 0 );
+  cvExternalTerm->SetLevelSetContainer( lscontainer );
+
+  typedef LevelSetEquationTermContainer< InputImageType, LevelSetContainerType > TermContainerType;
+  typename TermContainerType::Pointer termContainer = TermContainerType::New();
+  termContainer->SetInput( iImage );
+  termContainer->SetCurrentLevelSetId( 0 );
+  termContainer->SetLevelSetContainer( lscontainer );
+  termContainer->AddTerm( 0, cvInternalTerm );
+  termContainer->AddTerm( 1, cvExternalTerm );
+
+  typedef LevelSetEquationContainer< TermContainerType > EquationContainerType;
+  typename EquationContainerType::Pointer equationContainer = EquationContainerType::New();
+  equationContainer->SetLevelSetContainer( lscontainer );
+  equationContainer->AddEquation( 0, termContainer );
+
+  typedef LevelSetEvolutionNumberOfIterationsStoppingCriterion<
+    LevelSetContainerType > StoppingCriterionType;
+  typename StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
+  criterion->SetNumberOfIterations( iNumberOfIterations );
+
+  typedef LevelSetEvolution< EquationContainerType, LevelSetType > LevelSetEvolutionType;
+  typename LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+  evolution->SetEquationContainer( equationContainer );
+  evolution->SetStoppingCriterion( criterion );
+  evolution->SetLevelSetContainer( lscontainer );
+  evolution->Update();
+}
+
+template< class TInputImage, class TLevelSet >
+void
+AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >
+::Update()
+{
+  if( this->m_Input.IsNull() )
+    {
+    itkExceptionMacro( << "Input is not set" );
+    }
+  if( this->m_SeedRegions.empty() )
+    {
+    itkExceptionMacro( << "No seed region" );
+    }
+
+  const RegionType largestRegion = this->m_Input->GetLargestPossibleRegion();
+
+  // The domain starts around the seeds.
+  RegionType seedBox = this->m_SeedRegions[0];
+  for( size_t i = 1; i < this->m_SeedRegions.size(); i++ )
+    {
+    seedBox = MergeRegions( seedBox, this->m_SeedRegions[i] );
+    }
+
+  this->m_CropRegion = this->PadRegion( seedBox, this->m_Margin );
+  this->m_CurrentIteration = 0;
+  this->m_NumberOfGrowths = 0;
+
+  InputImagePointer image = this->CropInput( this->m_CropRegion );
+
+  SeedAdaptorPointer adaptor = SeedAdaptorType::New();
+  adaptor->SetReferenceImage( image );
+  for( size_t i = 0; i < this->m_SeedRegions.size(); i++ )
+    {
+    adaptor->AddRegion( this->m_SeedRegions[i] );
+    }
+  adaptor->Initialize();
+  this->m_LevelSet = adaptor->GetLevelSet();
+
+  // The front moves by at most one pixel per iteration: the layers must be
+  // farther than a chunk from the sides of the domain.
+  const OffsetValueType clearance = static_cast< OffsetValueType >( this->m_CheckPeriod ) + 1;
+
+  while( this->m_CurrentIteration < this->m_NumberOfIterations )
+    {
+    const unsigned int numberOfIterations =
+      std::min( this->m_CheckPeriod, this->m_NumberOfIterations - this->m_CurrentIteration );
+
+    this->EvolveChunk( image, this->m_LevelSet, numberOfIterations );
+    this->m_CurrentIteration += numberOfIterations;
+
+    RegionType layerBox;
+    if( this->ComputeLayerBoundingBox( this->m_LevelSet, layerBox ) )
+      {
+      bool grow = false;
+      for( unsigned int dim = 0; ( dim < ImageDimension ) && !grow; dim++ )
+        {
+        const OffsetValueType cropFirst = this->m_CropRegion.GetIndex()[dim];
+        const OffsetValueType cropLast =
+          cropFirst + static_cast< OffsetValueType >( this->m_CropRegion.GetSize()[dim] ) - 1;
+        const OffsetValueType imageFirst = largestRegion.GetIndex()[dim];
+        const OffsetValueType imageLast =
+          imageFirst + static_cast< OffsetValueType >( largestRegion.GetSize()[dim] ) - 1;
+        const OffsetValueType layerFirst = layerBox.GetIndex()[dim];
+        const OffsetValueType layerLast =
+          layerFirst + static_cast< OffsetValueType >( layerBox.GetSize()[dim] ) - 1;
+
+        grow = ( ( cropFirst > imageFirst ) && ( layerFirst - cropFirst < clearance ) ) ||
+               ( ( cropLast < imageLast ) && ( cropLast - layerLast < clearance ) );
+        }
+
+      if( grow )
+        {
+        // never shrink: the interior lines must stay in the domain
+        this->m_CropRegion = MergeRegions( this->m_CropRegion,
+          this->PadRegion( layerBox, this->m_Margin + this->m_CheckPeriod ) );
+
+        // The new pixels are exterior, i.e. background of the label map,
+        // and the layers are away from the old sides: only the region of
+        // the level-set changes.
+        this->m_LevelSet->GetLabelMap()->SetRegions( this->m_CropRegion );
+        image = this->CropInput( this->m_CropRegion );
+        ++this->m_NumberOfGrowths;
+        }
+      }
+
+    this->InvokeEvent( IterationEvent() );
+    }
+
+  this->m_LevelSet->GetLabelMap()->SetRegions( largestRegion );
+}
+
+template< class TInputImage, class TLevelSet >
+void
+AutoCroppingLevelSetEvolution< TInputImage, TLevelSet >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfIterations: " << this->m_NumberOfIterations << std::endl;
+  os << indent << "CheckPeriod: " << this->m_CheckPeriod << std::endl;
+  os << indent << "Margin: " << this->m_Margin << std::endl;
+  os << indent << "NumberOfSeedRegions: " << this->m_SeedRegions.size() << std::endl;
+  os << indent << "CurrentIteration: " << this->m_CurrentIteration << std::endl;
+  os << indent << "CropRegion: " << this->m_CropRegion << std::endl;
+  os << indent << "NumberOfGrowths: " << this->m_NumberOfGrowths << std::endl;
+}
+
+}
+#endif // __itkAutoCroppingLevelSetEvolution_hxx
@@ -0,0 +1,233 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkHybridLevelSetEvolution_h
+#define __itkHybridLevelSetEvolution_h
+
+#include "itkObject.h"
+#include "itkImage.h"
+#include "itkMultiThreader.h"
+#include "itkLevelSetDenseImage.h"
+#include "itkLevelSetDomainMapImageFilter.h"
+#include "itkLevelSetFastSweepingReinitializer.h"
+#include "itkTabulatedHeavisideStepFunction.h"
+#include "itkSeedToSparseLevelSetImageAdaptor.h"
+#include "itkSparseLevelSetLayerTraits.h"
+
+#include <list>
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class HybridLevelSetEvolution
+ *  \brief Evolve a level-set, switching between a sparse and a dense
+ *  representation as the density of its front changes.
+ *
+ *  The layers of a sparse level-set are only worth their bookkeeping while
+ *  the front covers a small part of the image; when a large, ragged front
+ *  sweeps the image, updating every pixel of a dense level-set is cheaper.
+ *
+ *  The level-set is seeded sparse and evolved with a Chan and Vese
+ *  equation by chunks of CheckPeriod iterations. After each chunk the
+ *  front fraction, i.e. the number of front pixels over the number of
+ *  pixels of the image, is measured. The next chunk runs dense once this
+ *  fraction is above CrossoverFrontFraction, and sparse again once it
+ *  falls below CrossoverFrontFraction * Hysteresis, so that a front
+ *  hovering around the crossover does not convert at every chunk.
+ *
+ *  Both conversions are threaded passes over the image: the sparse
+ *  level-set is rasterized with its layer values by
+ *  SparseLevelSetToImageFilter, and the interior of the dense level-set is
+ *  thresholded and run-length encoded by image to label map filters, from
+ *  which the layers are rebuilt as from seeds. Going back to sparse thus
+ *  keeps the interior, not the sub-pixel values of the front.
+ *
+ *  A dense level-set drifts away from a signed distance function. With a
+ *  ReinitializationPeriod, it is reset by LevelSetFastSweepingReinitializer
+ *  right after the conversion from sparse, then every
+ *  ReinitializationPeriod dense iterations.
+ *
+ *  An IterationEvent is invoked at the end of each chunk.
+ *
+ *  \tparam TInputImage Input image type
+ *  \tparam TLevelSet Whitaker, Shi or Malcolm sparse level-set image
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TInputImage, class TLevelSet >
+class HybridLevelSetEvolution : public Object
+{
+public:
+  typedef HybridLevelSetEvolution     Self;
+  typedef Object                      Superclass;
+  typedef SmartPointer< Self >        Pointer;
+  typedef SmartPointer< const Self >  ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( HybridLevelSetEvolution, Object );
+
+  typedef TInputImage                               InputImageType;
+  typedef typename InputImageType::Pointer          InputImagePointer;
+  typedef typename InputImageType::ConstPointer     InputImageConstPointer;
+  typedef typename InputImageType::RegionType       RegionType;
+
+  typedef TLevelSet                                 LevelSetType;
+  typedef typename LevelSetType::Pointer            LevelSetPointer;
+  typedef typename LevelSetType::OutputRealType     LevelSetOutputRealType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, InputImageType::ImageDimension );
+
+  typedef Image< LevelSetOutputRealType, ImageDimension >   DenseImageType;
+  typedef LevelSetDenseImage< DenseImageType >              DenseLevelSetType;
+  typedef typename DenseLevelSetType::Pointer               DenseLevelSetPointer;
+  typedef LevelSetFastSweepingReinitializer< DenseLevelSetType >
+                                                            ReinitializerType;
+
+  typedef SeedToSparseLevelSetImageAdaptor< LevelSetType >  SeedAdaptorType;
+  typedef typename SeedAdaptorType::Pointer                 SeedAdaptorPointer;
+  typedef SparseLevelSetLayerTraits< LevelSetType >         LayerTraitsType;
+
+  typedef TabulatedHeavisideStepFunction<
+    LevelSetOutputRealType, LevelSetOutputRealType >        HeavisideType;
+
+  typedef std::list< IdentifierType >                       IdListType;
+  typedef Image< IdListType, ImageDimension >               IdListImageType;
+  typedef Image< short, ImageDimension >                    CacheImageType;
+  typedef LevelSetDomainMapImageFilter< IdListImageType, CacheImageType >
+                                                            DomainMapImageFilterType;
+
+  /** Representation of the level-set */
+  enum RepresentationType { Sparse, Dense };
+
+  /** Input image */
+  itkSetConstObjectMacro( Input, InputImageType );
+  itkGetConstObjectMacro( Input, InputImageType );
+
+  /** Seed boxes, in the index space of the input */
+  void AddSeedRegion( const RegionType& iRegion );
+  void ClearSeedRegions();
+
+  /** Number of iterations. Default is 100. */
+  itkSetMacro( NumberOfIterations, unsigned int );
+  itkGetConstMacro( NumberOfIterations, unsigned int );
+
+  /** Number of iterations between two measures of the front. Default
+   * is 10. */
+  itkSetClampMacro( CheckPeriod, unsigned int, 1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro( CheckPeriod, unsigned int );
+
+  /** Front fraction above which the level-set is evolved dense. Default
+   * is 0.05. */
+  itkSetMacro( CrossoverFrontFraction, double );
+  itkGetConstMacro( CrossoverFrontFraction, double );
+
+  /** A dense level-set goes back to sparse below
+   * CrossoverFrontFraction * Hysteresis. Default is 0.5. */
+  itkSetClampMacro( Hysteresis, double, 0.0, 1.0 );
+  itkGetConstMacro( Hysteresis, double );
+
+  /** Reinitialize the dense level-set every ReinitializationPeriod
+   * iterations, never if 0. Default is 0. */
+  itkSetMacro( ReinitializationPeriod, unsigned int );
+  itkGetConstMacro( ReinitializationPeriod, unsigned int );
+
+  /** Reinitialization of the dense level-set, to set its band */
+  itkGetObjectMacro( Reinitializer, ReinitializerType );
+
+  /** Evolve the level-set */
+  void Update();
+
+  /** Number of iterations run so far */
+  itkGetConstMacro( CurrentIteration, unsigned int );
+
+  /** Representation of the last chunk */
+  itkGetConstMacro( Representation, RepresentationType );
+
+  /** Front fraction at the end of the last chunk */
+  itkGetConstMacro( FrontFraction, double );
+
+  /** Number of conversions, in both directions */
+  itkGetConstMacro( NumberOfConversions, unsigned int );
+
+  /** Resulting level-set, always sparse once Update() has returned */
+  itkGetObjectMacro( LevelSet, LevelSetType );
+
+protected:
+  HybridLevelSetEvolution();
+  virtual ~HybridLevelSetEvolution() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Evolve ioLevelSet, dense or sparse, for iNumberOfIterations */
+  template< class TLevelSetImage >
+  void EvolveChunk( TLevelSetImage* ioLevelSet, unsigned int iNumberOfIterations );
+
+  /** Number of front pixels over the number of pixels of the input */
+  double ComputeFrontFraction( LevelSetType* iLevelSet ) const;
+  double ComputeFrontFraction( DenseLevelSetType* iLevelSet ) const;
+
+  /** Conversions between the representations */
+  DenseLevelSetPointer SparseToDense( LevelSetType* iLevelSet ) const;
+  LevelSetPointer DenseToSparse( DenseLevelSetType* iLevelSet ) const;
+
+  /** Pixels of the piece of a dense level-set counted by a thread */
+  struct FrontCount
+  {
+    const DenseImageType*         Image;
+    std::vector< SizeValueType >  Counts;
+  };
+
+  static ITK_THREAD_RETURN_TYPE FrontCountThreadCallback( void* arg );
+
+private:
+  HybridLevelSetEvolution( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  InputImageConstPointer      m_Input;
+  std::vector< RegionType >   m_SeedRegions;
+
+  unsigned int                m_NumberOfIterations;
+  unsigned int                m_CheckPeriod;
+  double                      m_CrossoverFrontFraction;
+  double                      m_Hysteresis;
+  unsigned int                m_ReinitializationPeriod;
+
+  typename ReinitializerType::Pointer         m_Reinitializer;
+
+  typename HeavisideType::Pointer             m_Heaviside;
+  typename DomainMapImageFilterType::Pointer  m_DomainMapFilter;
+
+  LevelSetPointer             m_LevelSet;
+  DenseLevelSetPointer        m_DenseLevelSet;
+  RepresentationType          m_Representation;
+
+  unsigned int                m_CurrentIteration;
+  double                      m_FrontFraction;
+  unsigned int                m_NumberOfConversions;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkHybridLevelSetEvolution.hxx"
+#endif
+
+#endif // __itkHybridLevelSetEvolution_h
@@ -0,0 +1,399 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkHybridLevelSetEvolution_hxx
+#define __itkHybridLevelSetEvolution_hxx
+
+#include "itkHybridLevelSetEvolution.h"
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkLabelImageToLabelMapFilter.h"
+#include "itkSparseLevelSetToImageFilter.h"
+#include "itkLevelSetContainer.h"
+#include "itkLevelSetEquationChanAndVeseInternalTerm.h"
+#include "itkLevelSetEquationChanAndVeseExternalTerm.h"
+#include "itkLevelSetEquationTermContainer.h"
+#include "itkLevelSetEquationContainer.h"
+#include "itkLevelSetAdaptiveTimeStepEvolution.h"
+#include "itkLevelSetEvolutionNumberOfIterationsStoppingCriterion.h"
+
+#include <algorithm>
+
+namespace itk
+{
+template< class TInputImage, class TLevelSet >
+HybridLevelSetEvolution< TInputImage, TLevelSet >
+::HybridLevelSetEvolution() :
+  m_NumberOfIterations( 100 ),
+  m_CheckPeriod( 10 ),
+  m_CrossoverFrontFraction( 0.05 ),
+  m_Hysteresis( 0.5 ),
+  m_ReinitializationPeriod( 0 ),
+  m_Representation( Sparse ),
+  m_CurrentIteration( 0 ),
+  m_FrontFraction( 0. ),
+  m_NumberOfConversions( 0 )
+{
+  this->m_Reinitializer = ReinitializerType::New();
+}
+
+template< class TInputImage, class TLevelSet >
+void
+HybridLevelSetEvolution< TInputImage, TLevelSet >
+::AddSeedRegion( const RegionType& iRegion )
+{
+  this->m_SeedRegions.push_back( iRegion );
+  this->Modified();
+}
+
+template< class TInputImage, class TLevelSet >
+void
+HybridLevelSetEvolution< TInputImage, TLevelSet >
+::ClearSeedRegions()
+{
+  this->m_SeedRegions.clear();
+  this->Modified();
+}
+
+template< class TInputImage, class TLevelSet >
+template< class TLevelSetImage >
+void
+HybridLevelSetEvolution< TInputImage, TLevelSet >
+::EvolveChunk( TLevelSetImage* ioLevelSet, unsigned int iNumberOfIterations )
+{
+  // the terms take a non const input, but never modify it
+  InputImageType* input = const_cast< InputImageType* >( this->m_Input.GetPointer() );
+
+  typedef LevelSetContainer< IdentifierType, TLevelSetImage > LevelSetContainerType;
+  typename LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
+  lscontainer->SetHeaviside( this->m_Heaviside );
+  lscontainer->SetDomainMapFilter( this->m_DomainMapFilter );
+  lscontainer->AddLevelSet( 0, ioLevelSet );
+
+  typedef LevelSetEquationChanAndVeseInternalTerm<
+    InputImageType, LevelSetContainerType > InternalTermType;
+  typename InternalTermType::Pointer cvInternalTerm = InternalTermType::New();
+  cvInternalTerm->SetInput( input );
+  cvInternalTerm->SetCoefficient( 1.0 );
+  cvInternalTerm->SetCurrentLevelSetId( 0 );
+  cvInternalTerm->SetLevelSetContainer( lscontainer );
+
+  typedef LevelSetEquationChanAndVeseExternalTerm<
+    InputImageType, LevelSetContainerType > ExternalTermType;
+  typename ExternalTermType::Pointer cvExternalTerm = ExternalTermType::New();
+  cvExternalTerm->SetInput( input );
+  cvExternalTerm->SetCoefficient( 1.0 );
+  cvExternalTerm->SetCurrentLevelSetId( 0 );
+  cvExternalTerm->SetLevelSetContainer( lscontainer );
+
+  typedef LevelSetEquationTermContainer< InputImageType, LevelSetContainerType > TermContainerType;
+  typename TermContainerType::Pointer termContainer = TermContainerType::New();
+  termContainer->SetInput( input );
+  termContainer->SetCurrentLevelSetId( 0 );
+  termContainer->SetLevelSetContainer( lscontainer );
+  termContainer->AddTerm( 0, cvInternalTerm );
+  termContainer->AddTerm( 1, cvExternalTerm );
+
+  typedef LevelSetEquationContainer< TermContainerType > EquationContainerType;
+  typename EquationContainerType::Pointer equationContainer = EquationContainerType::New();
+  equationContainer->SetLevelSetContainer( lscontainer );
+  equationContainer->AddEquation( 0, termContainer );
+
+  typedef LevelSetEvolutionNumberOfIterationsStoppingCriterion<
+    LevelSetContainerType > StoppingCriterionType;
+  typename StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
+  criterion->SetNumberOfIterations( iNumberOfIterations );
+
+  // the largest stable time step, dense or Whitaker
+  typedef LevelSetAdaptiveTimeStepEvolution< EquationContainerType, TLevelSetImage > LevelSetEvolutionType;
+  typename LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+  evolution->SetEquationContainer( equationContainer );
+  evolution->SetStoppingCriterion( criterion );
+  evolution->SetLevelSetContainer( lscontainer );
+
+  if( ( this->m_Representation == Dense ) && ( this->m_ReinitializationPeriod > 0 ) )
+    {
+    evolution->AddObserver( IterationEvent(), this->m_Reinitializer );
+    }
+
+  evolution->Update();
+}
+
+template< class TInputImage, class TLevelSet >
+double
+HybridLevelSetEvolution< TInputImage, TLevelSet >
+::ComputeFrontFraction( LevelSetType* iLevelSet ) const
+{
+  const SizeValueType numberOfPixels = this->m_Input->GetLargestPossibleRegion().GetNumberOfPixels();
+  return static_cast< double >( iLevelSet->GetLayer( LayerTraitsType::GetFrontLayerId() ).size() ) /
+    static_cast< double >( numberOfPixels );
+}
+
+template< class TInputImage, class TLevelSet >
+ITK_THREAD_RETURN_TYPE
+HybridLevelSetEvolution< TInputImage, TLevelSet >
+::FrontCountThreadCallback( void* arg )
+{
+  MultiThreader::ThreadInfoStruct* info = static_cast< MultiThreader::ThreadInfoStruct* >( arg );
+  FrontCount* frontCount = static_cast< FrontCount* >( info->UserData );
+
+  const DenseImageType* image = frontCount->Image;
+  const RegionType largestRegion = image->GetLargestPossibleRegion();
+
+  // Each thread takes a slab of the image along the last axis.
+  const unsigned int last = ImageDimension - 1;
+  const SizeValueType length = largestRegion.GetSize()[last];
+  const SizeValueType begin = ( length * info->ThreadID ) / info->NumberOfThreads;
+  const SizeValueType end = ( length * ( info->ThreadID + 1 ) ) / info->NumberOfThreads;
+
+  SizeValueType count = 0;
+
+  if( end > begin )
+    {
+    RegionType region = largestRegion;
+    region.SetIndex( last, largestRegion.GetIndex()[last] + static_cast< OffsetValueType >( begin ) );
+    region.SetSize( last, end - begin );
+
+    // The front is made of the interior pixels with an exterior neighbor
+    // along one of the axes, as the layers of the seeds.
+    ImageRegionConstIteratorWithIndex< DenseImageType > it( image, region );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      if( it.Get() > NumericTraits< LevelSetOutputRealType >::Zero )
+        {
+        continue;
+        }
+
+      bool front = false;
+      for( unsigned int dim = 0; ( dim < ImageDimension ) && !front; dim++ )
+        {
+        typename DenseImageType::IndexType neighbor = it.GetIndex();
+        for( int step = -1; ( step <= 1 ) && !front; step += 2 )
+          {
+          neighbor[dim] = it.GetIndex()[dim] + step;
+          front = largestRegion.IsInside( neighbor ) &&
+            ( image->GetPixel( neighbor ) > NumericTraits< LevelSetOutputRealType >::Zero );
+          }
+        }
+      if( front )
+        {
+        ++count;
+        }
+      }
+    }
+
+  frontCount->Counts[info->ThreadID] = count;
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TLevelSet >
+double
+HybridLevelSetEvolution< TInputImage, TLevelSet >
+::ComputeFrontFraction( DenseLevelSetType* iLevelSet ) const
+{
+  MultiThreader::Pointer threader = MultiThreader::New();
+
+  FrontCount frontCount;
+  frontCount.Image = iLevelSet->GetImage();
+  frontCount.Counts.resize( threader->GetNumberOfThreads(), 0 );
+
+  threader->SetSingleMethod( FrontCountThreadCallback, &frontCount );
+  threader->SingleMethodExecute();
+
+  SizeValueType count = 0;
+  for( size_t i = 0; i < frontCount.Counts.size(); i++ )
+    {
+    count += frontCount.Counts[i];
+    }
+
+  const SizeValueType numberOfPixels = this->m_Input->GetLargestPossibleRegion().GetNumberOfPixels();
+  return static_cast< double >( count ) / static_cast< double >( numberOfPixels );
+}
+
+template< class TInputImage, class TLevelSet >
+typename HybridLevelSetEvolution< TInputImage, TLevelSet >::DenseLevelSetPointer
+HybridLevelSetEvolution< TInputImage, TLevelSet >
+::SparseToDense( LevelSetType* iLevelSet ) const
+{
+  // The label of the interior and exterior pixels, and the values of the
+  // layer nodes, in one threaded pass.
+  typedef SparseLevelSetToImageFilter< LevelSetType, DenseImageType > LevelSetToImageFilterType;
+  typename LevelSetToImageFilterType::Pointer levelSetToImage = LevelSetToImageFilterType::New();
+  levelSetToImage->SetLevelSet( iLevelSet );
+  levelSetToImage->SetOutputParametersFromImage( this->m_Input );
+  levelSetToImage->ExportLayerValuesOn();
+  levelSetToImage->Update();
+
+  typename DenseImageType::Pointer image = levelSetToImage->GetOutput();
+  image->DisconnectPipeline();
+
+  DenseLevelSetPointer levelSet = DenseLevelSetType::New();
+  levelSet->SetImage( image );
+  return levelSet;
+}
+
+template< class TInputImage, class TLevelSet >
+typename HybridLevelSetEvolution< TInputImage, TLevelSet >::LevelSetPointer
+HybridLevelSetEvolution< TInputImage, TLevelSet >
+::DenseToSparse( DenseLevelSetType* iLevelSet ) const
+{
+  typedef Image< unsigned char, ImageDimension > BinaryImageType;
+
+  typedef BinaryThresholdImageFilter< DenseImageType, BinaryImageType > ThresholdFilterType;
+  typename ThresholdFilterType::Pointer threshold = ThresholdFilterType::New();
+  threshold->SetInput( iLevelSet->GetImage() );
+  threshold->SetLowerThreshold( NumericTraits< LevelSetOutputRealType >::NonpositiveMin() );
+  threshold->SetUpperThreshold( NumericTraits< LevelSetOutputRealType >::Zero );
+  threshold->SetInsideValue( 1 );
+  threshold->SetOutsideValue( 0 );
+
+  // run-length lines of the interior, the seeds of the sparse level-set
+  typedef LabelImageToLabelMapFilter< BinaryImageType > LabelMapFilterType;
+  typename LabelMapFilterType::Pointer labelMapFilter = LabelMapFilterType::New();
+  labelMapFilter->SetInput( threshold->GetOutput() );
+  labelMapFilter->SetBackgroundValue( 0 );
+  labelMapFilter->Update();
+
+  SeedAdaptorPointer adaptor = SeedAdaptorType::New();
+  adaptor->SetReferenceImage( this->m_Input );
+  adaptor->AddLabelMap( labelMapFilter->GetOutput() );
+  adaptor->Initialize();
+  return adaptor->GetLevelSet();
+}
+
+template< class TInputImage, class TLevelSet >
+void
+HybridLevelSetEvolution< TInputImage, TLevelSet >
+::Update()
+{
+  if( this->m_Input.IsNull() )
+    {
+    itkExceptionMacro( << "Input is not set" );
+    }
+  if( this->m_SeedRegions.empty() )
+    {
+    itkExceptionMacro( << "No seed region" );
+    }
+
+  const RegionType largestRegion = this->m_Input->GetLargestPossibleRegion();
+
+  // One domain over the whole image, shared by both representations
+  IdListType listIds;
+  listIds.push_back( 1 );
+
+  typename IdListImageType::Pointer idImage = IdListImageType::New();
+  idImage->SetRegions( largestRegion );
+  idImage->Allocate();
+  idImage->FillBuffer( listIds );
+
+  this->m_DomainMapFilter = DomainMapImageFilterType::New();
+  this->m_DomainMapFilter->SetInput( idImage );
+  this->m_DomainMapFilter->Update();
+
+  this->m_Heaviside = HeavisideType::New();
+  this->m_Heaviside->SetEpsilon( 1.0 );
+
+  SeedAdaptorPointer adaptor = SeedAdaptorType::New();
+  adaptor->SetReferenceImage( this->m_Input );
+  for( size_t i = 0; i < this->m_SeedRegions.size(); i++ )
+    {
+    adaptor->AddRegion( this->m_SeedRegions[i] );
+    }
+  adaptor->Initialize();
+
+  this->m_LevelSet = adaptor->GetLevelSet();
+  this->m_DenseLevelSet = NULL;
+  this->m_Representation = Sparse;
+  this->m_CurrentIteration = 0;
+  this->m_NumberOfConversions = 0;
+  this->m_FrontFraction = this->ComputeFrontFraction( this->m_LevelSet.GetPointer() );
+
+  while( this->m_CurrentIteration < this->m_NumberOfIterations )
+    {
+    if( ( this->m_Representation == Sparse ) &&
+        ( this->m_FrontFraction > this->m_CrossoverFrontFraction ) )
+      {
+      this->m_DenseLevelSet = this->SparseToDense( this->m_LevelSet );
+      this->m_LevelSet = NULL;
+      this->m_Representation = Dense;
+      ++this->m_NumberOfConversions;
+
+      if( this->m_ReinitializationPeriod > 0 )
+        {
+        this->m_Reinitializer->SetLevelSet( this->m_DenseLevelSet );
+        this->m_Reinitializer->SetPeriod( this->m_ReinitializationPeriod );
+        this->m_Reinitializer->Reinitialize();
+        }
+      }
+    else if( ( this->m_Representation == Dense ) &&
+             ( this->m_FrontFraction < this->m_CrossoverFrontFraction * this->m_Hysteresis ) )
+      {
+      this->m_LevelSet = this->DenseToSparse( this->m_DenseLevelSet );
+      this->m_DenseLevelSet = NULL;
+      this->m_Representation = Sparse;
+      ++this->m_NumberOfConversions;
+      }
+
+    const unsigned int numberOfIterations =
+      std::min( this->m_CheckPeriod, this->m_NumberOfIterations - this->m_CurrentIteration );
+
+    if( this->m_Representation == Sparse )
+      {
+      this->EvolveChunk( this->m_LevelSet.GetPointer(), numberOfIterations );
+      this->m_FrontFraction = this->ComputeFrontFraction( this->m_LevelSet.GetPointer() );
+      }
+    else
+      {
+      this->EvolveChunk( this->m_DenseLevelSet.GetPointer(), numberOfIterations );
+      this->m_FrontFraction = this->ComputeFrontFraction( this->m_DenseLevelSet.GetPointer() );
+      }
+
+    this->m_CurrentIteration += numberOfIterations;
+
+    this->InvokeEvent( IterationEvent() );
+    }
+
+  if( this->m_Representation == Dense )
+    {
+    this->m_LevelSet = this->DenseToSparse( this->m_DenseLevelSet );
+    this->m_DenseLevelSet = NULL;
+    }
+}
+
+template< class TInputImage, class TLevelSet >
+void
+HybridLevelSetEvolution< TInputImage, TLevelSet >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfIterations: " << this->m_NumberOfIterations << std::endl;
+  os << indent << "CheckPeriod: " << this->m_CheckPeriod << std::endl;
+  os << indent << "CrossoverFrontFraction: " << this->m_CrossoverFrontFraction << std::endl;
+  os << indent << "Hysteresis: " << this->m_Hysteresis << std::endl;
+  os << indent << "ReinitializationPeriod: " << this->m_ReinitializationPeriod << std::endl;
+  os << indent << "NumberOfSeedRegions: " << this->m_SeedRegions.size() << std::endl;
+  os << indent << "CurrentIteration: " << this->m_CurrentIteration << std::endl;
+  os << indent << "Representation: " << ( this->m_Representation == Dense ? "Dense" : "Sparse" ) << std::endl;
+  os << indent << "FrontFraction: " << this->m_FrontFraction << std::endl;
+  os << indent << "NumberOfConversions: " << this->m_NumberOfConversions << std::endl;
+}
+
+}
+#endif // __itkHybridLevelSetEvolution_hxx
@@ -0,0 +1,295 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkIncrementalUpdateWhitakerSparseLevelSet_h
+#define __itkIncrementalUpdateWhitakerSparseLevelSet_h
+
+#include "itkObject.h"
+#include "itkImage.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class IncrementalUpdateWhitakerSparseLevelSet
+ *  \brief Update the layers of a Whitaker level-set in place, and bring its
+ *  label map up to date with the nodes which changed layer only.
+ *
+ *  UpdateWhitakerSparseLevelSet converts the whole label map to a label
+ *  image, moves the nodes, and converts the whole label image back to a
+ *  label map, at every iteration. Here the label image, called the status
+ *  image, is kept from one iteration to the next, and the label map is
+ *  only edited where nodes changed label.
+ *
+ *  The layers are updated by the sparse field method, as in
+ *  SparseFieldLevelSetImageFilter:
+ *  - the zero layer is moved by the updates, clamped to half a layer;
+ *  nodes leaving it are put in status lists;
+ *  - the status lists are processed outwards from the zero layer: each
+ *  node moves by one layer, and its neighbors in the layer it comes
+ *  from follow it into the next list;
+ *  - the values of the layers -1, +1, -2 and +2 are recomputed, in this
+ *  order, from their neighbors one layer closer to the front. Nodes with
+ *  no such neighbor move one layer away from the front.
+ *
+ *  Every node whose label changed is recorded once. The run-length lines
+ *  of each label object are indexed by their first pixel, in the order of
+ *  the image buffer; a change looks up the line at its node by a binary
+ *  search and edits it in place: it grows, shrinks, is split in two, or is
+ *  merged with its neighbor on the row. The other lines are not visited, so
+ *  the label map costs O(changes log lines) per Update(). A line emptied by
+ *  a change keeps its slot, with a length of 0, until a new line reuses
+ *  it; the label object is compacted once most of its lines are empty. The
+ *  status image and the line indices are rebuilt from the label map, which
+ *  is the only full pass over the image, on the first Update() and
+ *  whenever the label map was changed by someone else.
+ *
+ *  The neighbors are the 2 * ImageDimension face neighbors. Every value
+ *  change is passed to the UpdatePixel() method of the terms.
+ *
+ *  \tparam TEquationContainer Container of the level-set equations
+ *  \tparam TLevelSet Whitaker sparse level-set image
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TEquationContainer, class TLevelSet >
+class IncrementalUpdateWhitakerSparseLevelSet : public Object
+{
+public:
+  typedef IncrementalUpdateWhitakerSparseLevelSet Self;
+  typedef Object                                  Superclass;
+  typedef SmartPointer< Self >                    Pointer;
+  typedef SmartPointer< const Self >              ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( IncrementalUpdateWhitakerSparseLevelSet, Object );
+
+  typedef TLevelSet                                       LevelSetType;
+  typedef typename LevelSetType::Pointer                  LevelSetPointer;
+  typedef typename LevelSetType::InputType                IndexType;
+  typedef typename LevelSetType::OffsetType               OffsetType;
+  typedef typename LevelSetType::OutputType               LevelSetOutputType;
+  typedef typename LevelSetType::OutputRealType           LevelSetOutputRealType;
+  typedef typename LevelSetType::LayerIdType              LayerIdType;
+  typedef typename LevelSetType::LayerType                LayerType;
+  typedef typename LayerType::iterator                    LayerIterator;
+  typedef typename LayerType::const_iterator              LayerConstIterator;
+  typedef typename LevelSetType::LabelMapType             LabelMapType;
+  typedef typename LabelMapType::Pointer                  LabelMapPointer;
+  typedef typename LabelMapType::RegionType               RegionType;
+  typedef typename LabelMapType::LabelObjectType          LabelObjectType;
+  typedef typename LabelObjectType::LineType              LineType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, LevelSetType::Dimension );
+
+  typedef Image< LayerIdType, ImageDimension >            StatusImageType;
+  typedef typename StatusImageType::Pointer               StatusImagePointer;
+
+  typedef TEquationContainer                              EquationContainerType;
+  typedef typename EquationContainerType::Pointer         EquationContainerPointer;
+  typedef typename EquationContainerType::TermContainerType TermContainerType;
+
+  /** Equations of the level-sets */
+  itkSetObjectMacro( EquationContainer, EquationContainerType );
+  itkGetObjectMacro( EquationContainer, EquationContainerType );
+
+  /** Identifier of the level-set, and of its equation */
+  itkSetMacro( CurrentLevelSetId, IdentifierType );
+  itkGetConstMacro( CurrentLevelSetId, IdentifierType );
+
+  /** Time step the updates are scaled by */
+  itkSetMacro( TimeStep, LevelSetOutputRealType );
+  itkGetConstMacro( TimeStep, LevelSetOutputRealType );
+
+  /** Update the layers and the label map of ioLevelSet by iUpdate, the
+   * updates of the nodes of its zero layer */
+  void Update( LevelSetType* ioLevelSet, const LayerType& iUpdate );
+
+  /** RMS change of the zero layer nodes at the last Update() */
+  itkGetConstMacro( RMSChangeAccumulator, LevelSetOutputRealType );
+
+  /** Number of nodes which changed label at the last Update() */
+  itkGetConstMacro( NumberOfLabelChanges, SizeValueType );
+
+  /** Number of times the status image was built from the label map */
+  itkGetConstMacro( NumberOfStatusImageBuilds, SizeValueType );
+
+protected:
+  IncrementalUpdateWhitakerSparseLevelSet();
+  virtual ~IncrementalUpdateWhitakerSparseLevelSet() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  typedef std::pair< IndexType, LevelSetOutputType >  NodeType;
+  typedef std::vector< NodeType >                     NodeListType;
+  typedef std::pair< IndexType, LayerIdType >         LabelChangeType;
+  typedef std::vector< LabelChangeType >              LabelChangeListType;
+  typedef std::vector< LineType >                     LineListType;
+
+  /** Markers of the status image for the nodes being moved; they are out
+   * of the range of the labels */
+  static LayerIdType ChangingUpStatus() { return 4; }
+  static LayerIdType ChangingDownStatus() { return 5; }
+  static LayerIdType ChangingStatus() { return 6; }
+
+  /** Build the status image from the label map */
+  void InitializeStatusImage( LabelMapType* iLabelMap );
+
+  /** Face neighbors of iIndex in the region; returns their number */
+  unsigned int GetNeighbors( const IndexType& iIndex, IndexType* oNeighbors ) const;
+
+  /** Set the status of iIndex, recording its label the first time */
+  void SetStatus( const IndexType& iIndex, LayerIdType iStatus );
+
+  /** Pass a value change to the terms */
+  void UpdatePixel( const IndexType& iIndex, LevelSetOutputType iOldValue,
+                    LevelSetOutputType iNewValue );
+
+  /** Move the zero layer by iUpdate; the nodes leaving it are put in
+   * oUpList and oDownList */
+  void UpdateZeroLayer( const LayerType& iUpdate, NodeListType& oUpList, NodeListType& oDownList );
+
+  /** Move the nodes of ioInputList to the layer iChangeTo, and put their
+   * neighbors of status iSearchFor in oOutputList */
+  void ProcessStatusList( NodeListType& ioInputList, NodeListType& oOutputList,
+                          LayerIdType iChangeTo, LayerIdType iSearchFor );
+
+  /** Move the nodes of ioInputList, coming from the interior or the
+   * exterior, to the layer iChangeTo */
+  void ProcessOutsideList( NodeListType& ioInputList, LayerIdType iChangeTo );
+
+  /** Recompute the values of the layer iTo from its neighbors in the
+   * layer iFrom; the nodes without such neighbors move to iPromote */
+  void PropagateLayerValues( LayerIdType iFrom, LayerIdType iTo, LayerIdType iPromote );
+
+  /** Edit the label map with the label changes */
+  void UpdateLabelMap( LabelMapType* ioLabelMap );
+
+  /** Order of the image buffer, as a functor */
+  struct IndexCompare
+  {
+    bool operator()( const IndexType& iA, const IndexType& iB ) const
+      {
+      return Self::IndexLess( iA, iB );
+      }
+  };
+
+  /** Lines of a label object: the position of each non empty line in the
+   * object, by its first pixel, and the positions of the empty ones */
+  typedef std::map< IndexType, SizeValueType, IndexCompare > LineStartMapType;
+  typedef typename LineStartMapType::iterator                LineStartIterator;
+
+  struct LabelLinesType
+  {
+    LabelLinesType() : m_Valid( false ) {}
+
+    bool                          m_Valid;
+    LineStartMapType              m_Starts;
+    std::vector< SizeValueType >  m_FreeLines;
+  };
+
+  /** Index the lines of iLabelObject */
+  void InitializeLabelLines( LabelObjectType* iLabelObject, LabelLinesType& oLines );
+
+  /** Line of ioLabelObject starting at iStart, in a free slot if any */
+  void AddLine( LabelObjectType* ioLabelObject, LabelLinesType& ioLines,
+                const IndexType& iStart, SizeValueType iLength );
+
+  /** Empty the line iLine, and free its slot */
+  void RemoveLine( LabelObjectType* ioLabelObject, LabelLinesType& ioLines,
+                   LineStartIterator iLine );
+
+  /** Add iIndex to ioLabelObject, growing or merging the lines next to it */
+  void AddPixel( LabelObjectType* ioLabelObject, LabelLinesType& ioLines, const IndexType& iIndex );
+
+  /** Remove iIndex from ioLabelObject, shrinking or splitting its line */
+  void RemovePixel( LabelObjectType* ioLabelObject, LabelLinesType& ioLines, const IndexType& iIndex );
+
+  /** Rewrite the lines of ioLabelObject without the empty ones, in the
+   * order of the image buffer */
+  void CompactLabelObject( LabelObjectType* ioLabelObject, LabelLinesType& ioLines );
+
+  /** Edit the lines of ioLabelObject: add iAdded and remove iRemoved */
+  void UpdateLabelObject( LabelObjectType* ioLabelObject, LabelLinesType& ioLines,
+                          const std::vector< IndexType >& iAdded,
+                          const std::vector< IndexType >& iRemoved );
+
+  /** Order of the image buffer on the rows, i.e. on all the dimensions but
+   * the first */
+  static bool RowLess( const IndexType& iA, const IndexType& iB );
+
+  /** Order of the image buffer */
+  static bool IndexLess( const IndexType& iA, const IndexType& iB );
+
+  /** Whether iA and iB are on the same row */
+  static bool SameRow( const IndexType& iA, const IndexType& iB )
+    {
+    return !RowLess( iA, iB ) && !RowLess( iB, iA );
+    }
+
+  /** Order of the label changes on their index only, so that a stable sort
+   * keeps the first record of a node first */
+  static bool LabelChangeLess( const LabelChangeType& iA, const LabelChangeType& iB );
+
+private:
+  IncrementalUpdateWhitakerSparseLevelSet( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  EquationContainerPointer  m_EquationContainer;
+  TermContainerType*        m_TermContainer;
+  IdentifierType            m_CurrentLevelSetId;
+  LevelSetOutputRealType    m_TimeStep;
+
+  LevelSetType*             m_LevelSet;
+  OffsetType                m_Offset;
+
+  // status image, and what it was built from
+  StatusImagePointer        m_StatusImage;
+  RegionType                m_Region;
+  LevelSetPointer           m_StatusLevelSet;
+  LabelMapPointer           m_StatusLabelMap;
+  unsigned long             m_StatusLabelMapTime;
+
+  LevelSetOutputRealType    m_RMSChangeAccumulator;
+  SizeValueType             m_NumberOfLabelChanges;
+  SizeValueType             m_NumberOfStatusImageBuilds;
+
+  // kept from one Update() to the next to reuse their memory
+  NodeListType              m_UpLists[2];
+  NodeListType              m_DownLists[2];
+  LabelChangeListType       m_LabelChanges;
+  std::vector< IndexType >  m_Added;
+  std::vector< IndexType >  m_Removed;
+  LineListType              m_Lines;
+
+  // line indices of the labels -3 to 3, valid for the status image
+  LabelLinesType            m_LabelLines[7];
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkIncrementalUpdateWhitakerSparseLevelSet.hxx"
+#endif
+
+#endif // __itkIncrementalUpdateWhitakerSparseLevelSet_h
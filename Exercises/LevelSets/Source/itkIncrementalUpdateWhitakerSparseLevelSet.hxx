@@ -0,0 +1,808 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkIncrementalUpdateWhitakerSparseLevelSet_hxx
+#define __itkIncrementalUpdateWhitakerSparseLevelSet_hxx
+
+#include "itkIncrementalUpdateWhitakerSparseLevelSet.h"
+
+#include "itkLabelMapToLabelImageFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+template< class TEquationContainer, class TLevelSet >
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::IncrementalUpdateWhitakerSparseLevelSet() :
+  m_TermContainer( NULL ),
+  m_CurrentLevelSetId( NumericTraits< IdentifierType >::Zero ),
+  m_TimeStep( NumericTraits< LevelSetOutputRealType >::One ),
+  m_LevelSet( NULL ),
+  m_StatusLabelMapTime( 0 ),
+  m_RMSChangeAccumulator( NumericTraits< LevelSetOutputRealType >::Zero ),
+  m_NumberOfLabelChanges( 0 ),
+  m_NumberOfStatusImageBuilds( 0 )
+{
+  this->m_Offset.Fill( 0 );
+}
+
+template< class TEquationContainer, class TLevelSet >
+bool
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::RowLess( const IndexType& iA, const IndexType& iB )
+{
+  for( unsigned int dim = ImageDimension - 1; dim > 0; dim-- )
+    {
+    if( iA[dim] != iB[dim] )
+      {
+      return iA[dim] < iB[dim];
+      }
+    }
+  return false;
+}
+
+template< class TEquationContainer, class TLevelSet >
+bool
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::IndexLess( const IndexType& iA, const IndexType& iB )
+{
+  if( RowLess( iA, iB ) )
+    {
+    return true;
+    }
+  if( RowLess( iB, iA ) )
+    {
+    return false;
+    }
+  return iA[0] < iB[0];
+}
+
+template< class TEquationContainer, class TLevelSet >
+bool
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::LabelChangeLess( const LabelChangeType& iA, const LabelChangeType& iB )
+{
+  return IndexLess( iA.first, iB.first );
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::InitializeStatusImage( LabelMapType* iLabelMap )
+{
+  typedef LabelMapToLabelImageFilter< LabelMapType, StatusImageType > LabelMapToStatusFilterType;
+  typename LabelMapToStatusFilterType::Pointer labelMapToStatus = LabelMapToStatusFilterType::New();
+  labelMapToStatus->SetInput( iLabelMap );
+  labelMapToStatus->Update();
+
+  this->m_StatusImage = labelMapToStatus->GetOutput();
+  this->m_StatusImage->DisconnectPipeline();
+  this->m_Region = this->m_StatusImage->GetBufferedRegion();
+
+  ++this->m_NumberOfStatusImageBuilds;
+}
+
+template< class TEquationContainer, class TLevelSet >
+unsigned int
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::GetNeighbors( const IndexType& iIndex, IndexType* oNeighbors ) const
+{
+  const IndexType & first = this->m_Region.GetIndex();
+  const typename RegionType::SizeType & size = this->m_Region.GetSize();
+
+  unsigned int numberOfNeighbors = 0;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    if( iIndex[dim] > first[dim] )
+      {
+      oNeighbors[numberOfNeighbors] = iIndex;
+      --oNeighbors[numberOfNeighbors][dim];
+      ++numberOfNeighbors;
+      }
+    if( iIndex[dim] + 1 < first[dim] + static_cast< OffsetValueType >( size[dim] ) )
+      {
+      oNeighbors[numberOfNeighbors] = iIndex;
+      ++oNeighbors[numberOfNeighbors][dim];
+      ++numberOfNeighbors;
+      }
+    }
+  return numberOfNeighbors;
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::SetStatus( const IndexType& iIndex, LayerIdType iStatus )
+{
+  const LayerIdType status = this->m_StatusImage->GetPixel( iIndex );
+
+  // a label, not a marker: this is the first change of the node
+  if( ( status >= LevelSetType::MinusThreeLayer() ) && ( status <= LevelSetType::PlusThreeLayer() ) )
+    {
+    this->m_LabelChanges.push_back( LabelChangeType( iIndex, status ) );
+    }
+  this->m_StatusImage->SetPixel( iIndex, iStatus );
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::UpdatePixel( const IndexType& iIndex, LevelSetOutputType iOldValue, LevelSetOutputType iNewValue )
+{
+  // the terms work in the index space of the input
+  this->m_TermContainer->UpdatePixel( iIndex + this->m_Offset, iOldValue, iNewValue );
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::UpdateZeroLayer( const LayerType& iUpdate, NodeListType& oUpList, NodeListType& oDownList )
+{
+  LayerType & zeroLayer = this->m_LevelSet->GetLayer( LevelSetType::ZeroLayer() );
+  LayerType & minusOneLayer = this->m_LevelSet->GetLayer( LevelSetType::MinusOneLayer() );
+  LayerType & plusOneLayer = this->m_LevelSet->GetLayer( LevelSetType::PlusOneLayer() );
+
+  const LevelSetOutputType half = static_cast< LevelSetOutputType >( 0.5 );
+  const LevelSetOutputType one = NumericTraits< LevelSetOutputType >::One;
+
+  const SizeValueType numberOfNodes = static_cast< SizeValueType >( zeroLayer.size() );
+  LevelSetOutputRealType sumOfSquaredChanges = NumericTraits< LevelSetOutputRealType >::Zero;
+
+  IndexType neighbors[2 * ImageDimension];
+
+  LayerConstIterator uIt = iUpdate.begin();
+  LayerIterator nIt = zeroLayer.begin();
+
+  while( nIt != zeroLayer.end() )
+    {
+    const IndexType index = nIt->first;
+    const LevelSetOutputType value = nIt->second;
+
+    LevelSetOutputType change = static_cast< LevelSetOutputType >( this->m_TimeStep * uIt->second );
+    change = std::max( -half, std::min( half, change ) );
+    ++uIt;
+
+    const LevelSetOutputType newValue = value + change;
+
+    if( ( newValue >= -half ) && ( newValue <= half ) )
+      {
+      sumOfSquaredChanges += change * change;
+      this->UpdatePixel( index, value, newValue );
+      nIt->second = newValue;
+      ++nIt;
+      continue;
+      }
+
+    // The node leaves the zero layer, unless a neighbor just left it in the
+    // opposite direction: the front would then skip a pixel.
+    const bool up = ( newValue > half );
+    const LayerIdType opposite = up ? ChangingDownStatus() : ChangingUpStatus();
+    const unsigned int numberOfNeighbors = this->GetNeighbors( index, neighbors );
+
+    bool blocked = false;
+    for( unsigned int n = 0; n < numberOfNeighbors; n++ )
+      {
+      if( this->m_StatusImage->GetPixel( neighbors[n] ) == opposite )
+        {
+        blocked = true;
+        break;
+        }
+      }
+    if( blocked )
+      {
+      ++nIt;
+      continue;
+      }
+
+    sumOfSquaredChanges += change * change;
+    this->UpdatePixel( index, value, newValue );
+
+    // The neighbors on the other side will replace it in the zero layer:
+    // give them the value closest to zero they can take.
+    LayerType & otherSide = up ? minusOneLayer : plusOneLayer;
+    const LayerIdType otherSideId = up ? LevelSetType::MinusOneLayer() : LevelSetType::PlusOneLayer();
+    const LevelSetOutputType candidate = up ? newValue - one : newValue + one;
+
+    for( unsigned int n = 0; n < numberOfNeighbors; n++ )
+      {
+      if( this->m_StatusImage->GetPixel( neighbors[n] ) != otherSideId )
+        {
+        continue;
+        }
+      LayerIterator oIt = otherSide.find( neighbors[n] );
+      if( oIt == otherSide.end() )
+        {
+        continue;
+        }
+      const bool notYetMoved = up ? ( oIt->second < -half ) : ( oIt->second > half );
+      if( notYetMoved || ( std::abs( candidate ) < std::abs( oIt->second ) ) )
+        {
+        this->UpdatePixel( neighbors[n], oIt->second, candidate );
+        oIt->second = candidate;
+        }
+      }
+
+    if( up )
+      {
+      this->SetStatus( index, ChangingUpStatus() );
+      oUpList.push_back( NodeType( index, newValue ) );
+      }
+    else
+      {
+      this->SetStatus( index, ChangingDownStatus() );
+      oDownList.push_back( NodeType( index, newValue ) );
+      }
+    zeroLayer.erase( nIt++ );
+    }
+
+  this->m_RMSChangeAccumulator = NumericTraits< LevelSetOutputRealType >::Zero;
+  if( numberOfNodes > 0 )
+    {
+    this->m_RMSChangeAccumulator = std::sqrt( sumOfSquaredChanges / numberOfNodes );
+    }
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::ProcessStatusList( NodeListType& ioInputList, NodeListType& oOutputList,
+                     LayerIdType iChangeTo, LayerIdType iSearchFor )
+{
+  LayerType & changeToLayer = this->m_LevelSet->GetLayer( iChangeTo );
+
+  // the interior and the exterior have no layer
+  const bool searchInLayer = ( iSearchFor > LevelSetType::MinusThreeLayer() ) &&
+                             ( iSearchFor < LevelSetType::PlusThreeLayer() );
+  LayerType * searchLayer = searchInLayer ? &this->m_LevelSet->GetLayer( iSearchFor ) : NULL;
+
+  IndexType neighbors[2 * ImageDimension];
+
+  oOutputList.clear();
+
+  for( typename NodeListType::const_iterator it = ioInputList.begin(); it != ioInputList.end(); ++it )
+    {
+    this->SetStatus( it->first, iChangeTo );
+    changeToLayer.insert( *it );
+
+    const unsigned int numberOfNeighbors = this->GetNeighbors( it->first, neighbors );
+    for( unsigned int n = 0; n < numberOfNeighbors; n++ )
+      {
+      if( this->m_StatusImage->GetPixel( neighbors[n] ) != iSearchFor )
+        {
+        continue;
+        }
+
+      // marked, so that it is not taken twice
+      this->SetStatus( neighbors[n], ChangingStatus() );
+
+      LevelSetOutputType value = static_cast< LevelSetOutputType >( iSearchFor );
+      if( searchInLayer )
+        {
+        LayerIterator sIt = searchLayer->find( neighbors[n] );
+        if( sIt != searchLayer->end() )
+          {
+          value = sIt->second;
+          searchLayer->erase( sIt );
+          }
+        }
+      oOutputList.push_back( NodeType( neighbors[n], value ) );
+      }
+    }
+
+  ioInputList.clear();
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::ProcessOutsideList( NodeListType& ioInputList, LayerIdType iChangeTo )
+{
+  LayerType & changeToLayer = this->m_LevelSet->GetLayer( iChangeTo );
+
+  for( typename NodeListType::const_iterator it = ioInputList.begin(); it != ioInputList.end(); ++it )
+    {
+    // the value is set when the layer is propagated
+    this->SetStatus( it->first, iChangeTo );
+    changeToLayer.insert( *it );
+    }
+
+  ioInputList.clear();
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::PropagateLayerValues( LayerIdType iFrom, LayerIdType iTo, LayerIdType iPromote )
+{
+  LayerType & fromLayer = this->m_LevelSet->GetLayer( iFrom );
+  LayerType & toLayer = this->m_LevelSet->GetLayer( iTo );
+
+  const bool inside = ( iTo < LevelSetType::ZeroLayer() );
+  const bool promoteToLayer = ( iPromote > LevelSetType::MinusThreeLayer() ) &&
+                              ( iPromote < LevelSetType::PlusThreeLayer() );
+  LayerType * promoteLayer = promoteToLayer ? &this->m_LevelSet->GetLayer( iPromote ) : NULL;
+
+  const LevelSetOutputType one = NumericTraits< LevelSetOutputType >::One;
+
+  IndexType neighbors[2 * ImageDimension];
+
+  LayerIterator nIt = toLayer.begin();
+  while( nIt != toLayer.end() )
+    {
+    const IndexType index = nIt->first;
+    const LevelSetOutputType value = nIt->second;
+
+    // value of the neighbor of iFrom closest to the front
+    bool found = false;
+    LevelSetOutputType closest = NumericTraits< LevelSetOutputType >::Zero;
+
+    const unsigned int numberOfNeighbors = this->GetNeighbors( index, neighbors );
+    for( unsigned int n = 0; n < numberOfNeighbors; n++ )
+      {
+      if( this->m_StatusImage->GetPixel( neighbors[n] ) != iFrom )
+        {
+        continue;
+        }
+      LayerConstIterator fIt = fromLayer.find( neighbors[n] );
+      if( fIt == fromLayer.end() )
+        {
+        continue;
+        }
+      if( !found )
+        {
+        closest = fIt->second;
+        found = true;
+        }
+      else
+        {
+        closest = inside ? std::max( closest, fIt->second ) : std::min( closest, fIt->second );
+        }
+      }
+
+    if( found )
+      {
+      const LevelSetOutputType newValue = inside ? closest - one : closest + one;
+      if( newValue != value )
+        {
+        this->UpdatePixel( index, value, newValue );
+        nIt->second = newValue;
+        }
+      ++nIt;
+      continue;
+      }
+
+    // Nothing closer to the front around: the node moves away from it.
+    this->SetStatus( index, iPromote );
+    if( promoteToLayer )
+      {
+      promoteLayer->insert( NodeType( index, value ) );
+      }
+    else
+      {
+      this->UpdatePixel( index, value, static_cast< LevelSetOutputType >( iPromote ) );
+      }
+    toLayer.erase( nIt++ );
+    }
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::InitializeLabelLines( LabelObjectType* iLabelObject, LabelLinesType& oLines )
+{
+  oLines.m_Starts.clear();
+  oLines.m_FreeLines.clear();
+
+  const SizeValueType numberOfLines = iLabelObject->GetNumberOfLines();
+  for( SizeValueType i = 0; i < numberOfLines; i++ )
+    {
+    const LineType & line = iLabelObject->GetLine( i );
+    if( line.GetLength() > 0 )
+      {
+      oLines.m_Starts.insert( typename LineStartMapType::value_type( line.GetIndex(), i ) );
+      }
+    else
+      {
+      oLines.m_FreeLines.push_back( i );
+      }
+    }
+  oLines.m_Valid = true;
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::AddLine( LabelObjectType* ioLabelObject, LabelLinesType& ioLines,
+           const IndexType& iStart, SizeValueType iLength )
+{
+  SizeValueType position;
+  if( !ioLines.m_FreeLines.empty() )
+    {
+    position = ioLines.m_FreeLines.back();
+    ioLines.m_FreeLines.pop_back();
+
+    LineType & line = ioLabelObject->GetLine( position );
+    line.SetIndex( iStart );
+    line.SetLength( iLength );
+    }
+  else
+    {
+    position = ioLabelObject->GetNumberOfLines();
+    ioLabelObject->AddLine( iStart, iLength );
+    }
+  ioLines.m_Starts.insert( typename LineStartMapType::value_type( iStart, position ) );
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::RemoveLine( LabelObjectType* ioLabelObject, LabelLinesType& ioLines, LineStartIterator iLine )
+{
+  ioLabelObject->GetLine( iLine->second ).SetLength( 0 );
+  ioLines.m_FreeLines.push_back( iLine->second );
+  ioLines.m_Starts.erase( iLine );
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::AddPixel( LabelObjectType* ioLabelObject, LabelLinesType& ioLines, const IndexType& iIndex )
+{
+  // first line starting after iIndex, and the line before it
+  LineStartIterator next = ioLines.m_Starts.upper_bound( iIndex );
+  LineStartIterator previous = next;
+
+  bool hasPrevious = false;
+  if( previous != ioLines.m_Starts.begin() )
+    {
+    --previous;
+    if( SameRow( previous->first, iIndex ) )
+      {
+      const LineType & line = ioLabelObject->GetLine( previous->second );
+      const OffsetValueType end = line.GetIndex()[0] + static_cast< OffsetValueType >( line.GetLength() );
+      if( end > iIndex[0] )
+        {
+        // already in the object
+        return;
+        }
+      hasPrevious = ( end == iIndex[0] );
+      }
+    }
+
+  const bool hasNext = ( next != ioLines.m_Starts.end() ) &&
+    SameRow( next->first, iIndex ) && ( next->first[0] == iIndex[0] + 1 );
+
+  if( hasPrevious && hasNext )
+    {
+    // iIndex joins the two lines
+    const SizeValueType nextLength = ioLabelObject->GetLine( next->second ).GetLength();
+    LineType & line = ioLabelObject->GetLine( previous->second );
+    line.SetLength( line.GetLength() + 1 + nextLength );
+    this->RemoveLine( ioLabelObject, ioLines, next );
+    }
+  else if( hasPrevious )
+    {
+    LineType & line = ioLabelObject->GetLine( previous->second );
+    line.SetLength( line.GetLength() + 1 );
+    }
+  else if( hasNext )
+    {
+    // the next line starts one pixel earlier: its key changes
+    const SizeValueType position = next->second;
+    ioLines.m_Starts.erase( next );
+
+    LineType & line = ioLabelObject->GetLine( position );
+    line.SetIndex( iIndex );
+    line.SetLength( line.GetLength() + 1 );
+    ioLines.m_Starts.insert( typename LineStartMapType::value_type( iIndex, position ) );
+    }
+  else
+    {
+    this->AddLine( ioLabelObject, ioLines, iIndex, 1 );
+    }
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::RemovePixel( LabelObjectType* ioLabelObject, LabelLinesType& ioLines, const IndexType& iIndex )
+{
+  // last line starting at or before iIndex
+  LineStartIterator it = ioLines.m_Starts.upper_bound( iIndex );
+  if( it == ioLines.m_Starts.begin() )
+    {
+    return;
+    }
+  --it;
+  if( !SameRow( it->first, iIndex ) )
+    {
+    return;
+    }
+
+  const SizeValueType position = it->second;
+  LineType & line = ioLabelObject->GetLine( position );
+  const OffsetValueType start = line.GetIndex()[0];
+  const OffsetValueType end = start + static_cast< OffsetValueType >( line.GetLength() );
+
+  if( iIndex[0] >= end )
+    {
+    // not in the object
+    return;
+    }
+
+  if( end - start == 1 )
+    {
+    this->RemoveLine( ioLabelObject, ioLines, it );
+    }
+  else if( iIndex[0] == start )
+    {
+    // the line starts one pixel later: its key changes
+    IndexType newStart = iIndex;
+    newStart[0] = start + 1;
+    ioLines.m_Starts.erase( it );
+
+    line.SetIndex( newStart );
+    line.SetLength( static_cast< SizeValueType >( end - start - 1 ) );
+    ioLines.m_Starts.insert( typename LineStartMapType::value_type( newStart, position ) );
+    }
+  else if( iIndex[0] == end - 1 )
+    {
+    line.SetLength( static_cast< SizeValueType >( end - start - 1 ) );
+    }
+  else
+    {
+    // split in two around iIndex
+    line.SetLength( static_cast< SizeValueType >( iIndex[0] - start ) );
+
+    IndexType after = iIndex;
+    after[0] = iIndex[0] + 1;
+    this->AddLine( ioLabelObject, ioLines, after, static_cast< SizeValueType >( end - after[0] ) );
+    }
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::CompactLabelObject( LabelObjectType* ioLabelObject, LabelLinesType& ioLines )
+{
+  this->m_Lines.clear();
+  for( LineStartIterator it = ioLines.m_Starts.begin(); it != ioLines.m_Starts.end(); ++it )
+    {
+    this->m_Lines.push_back( ioLabelObject->GetLine( it->second ) );
+    }
+
+  ioLabelObject->Clear();
+
+  SizeValueType position = 0;
+  for( LineStartIterator it = ioLines.m_Starts.begin(); it != ioLines.m_Starts.end(); ++it, ++position )
+    {
+    ioLabelObject->AddLine( this->m_Lines[position] );
+    it->second = position;
+    }
+  ioLines.m_FreeLines.clear();
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::UpdateLabelObject( LabelObjectType* ioLabelObject, LabelLinesType& ioLines,
+                     const std::vector< IndexType >& iAdded,
+                     const std::vector< IndexType >& iRemoved )
+{
+  if( !ioLines.m_Valid )
+    {
+    this->InitializeLabelLines( ioLabelObject, ioLines );
+    }
+
+  // A node is either added to or removed from a given label: the order of
+  // the edits does not matter.
+  for( typename std::vector< IndexType >::const_iterator it = iRemoved.begin(); it != iRemoved.end(); ++it )
+    {
+    this->RemovePixel( ioLabelObject, ioLines, *it );
+    }
+  for( typename std::vector< IndexType >::const_iterator it = iAdded.begin(); it != iAdded.end(); ++it )
+    {
+    this->AddPixel( ioLabelObject, ioLines, *it );
+    }
+
+  // Compacting costs one pass over the lines, once at least as many lines
+  // were emptied.
+  const SizeValueType numberOfFreeLines = static_cast< SizeValueType >( ioLines.m_FreeLines.size() );
+  if( ( numberOfFreeLines > 64 ) && ( 2 * numberOfFreeLines > ioLabelObject->GetNumberOfLines() ) )
+    {
+    this->CompactLabelObject( ioLabelObject, ioLines );
+    }
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::UpdateLabelMap( LabelMapType* ioLabelMap )
+{
+  this->m_NumberOfLabelChanges = 0;
+
+  if( this->m_LabelChanges.empty() )
+    {
+    return;
+    }
+
+  // Sorted, keeping the first record, i.e. the label before the
+  // update, of the nodes changed more than once.
+  std::stable_sort( this->m_LabelChanges.begin(), this->m_LabelChanges.end(), LabelChangeLess );
+
+  typename LabelChangeListType::iterator last = this->m_LabelChanges.begin();
+  IndexType previous;
+  for( typename LabelChangeListType::const_iterator it = this->m_LabelChanges.begin();
+       it != this->m_LabelChanges.end(); ++it )
+    {
+    const bool repeated = ( it != this->m_LabelChanges.begin() ) && !IndexLess( previous, it->first );
+    previous = it->first;
+    if( repeated )
+      {
+      continue;
+      }
+    // nodes back to their label are not changed
+    if( this->m_StatusImage->GetPixel( it->first ) != it->second )
+      {
+      *last = *it;
+      ++last;
+      }
+    }
+  this->m_LabelChanges.erase( last, this->m_LabelChanges.end() );
+  this->m_NumberOfLabelChanges = static_cast< SizeValueType >( this->m_LabelChanges.size() );
+
+  // Every label but the background one, which is not stored.
+  const LayerIdType background = static_cast< LayerIdType >( ioLabelMap->GetBackgroundValue() );
+
+  for( LayerIdType label = LevelSetType::MinusThreeLayer(); label <= LevelSetType::PlusThreeLayer(); label++ )
+    {
+    if( label == background )
+      {
+      continue;
+      }
+
+    this->m_Added.clear();
+    this->m_Removed.clear();
+    for( typename LabelChangeListType::const_iterator it = this->m_LabelChanges.begin();
+         it != this->m_LabelChanges.end(); ++it )
+      {
+      if( it->second == label )
+        {
+        this->m_Removed.push_back( it->first );
+        }
+      else if( this->m_StatusImage->GetPixel( it->first ) == label )
+        {
+        this->m_Added.push_back( it->first );
+        }
+      }
+
+    if( this->m_Added.empty() && this->m_Removed.empty() )
+      {
+      continue;
+      }
+
+    LabelLinesType & lines = this->m_LabelLines[label - LevelSetType::MinusThreeLayer()];
+
+    if( !ioLabelMap->HasLabel( label ) )
+      {
+      typename LabelObjectType::Pointer labelObject = LabelObjectType::New();
+      labelObject->SetLabel( label );
+      ioLabelMap->AddLabelObject( labelObject );
+      lines.m_Valid = false;
+      }
+
+    this->UpdateLabelObject( ioLabelMap->GetLabelObject( label ), lines, this->m_Added, this->m_Removed );
+    }
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::Update( LevelSetType* ioLevelSet, const LayerType& iUpdate )
+{
+  if( ioLevelSet == NULL )
+    {
+    itkExceptionMacro( << "The level-set is NULL" );
+    }
+  if( this->m_EquationContainer.IsNull() )
+    {
+    itkExceptionMacro( << "The equation container is NULL" );
+    }
+  if( iUpdate.size() != ioLevelSet->GetLayer( LevelSetType::ZeroLayer() ).size() )
+    {
+    itkExceptionMacro( << "The update has " << iUpdate.size() << " nodes, the zero layer "
+                       << ioLevelSet->GetLayer( LevelSetType::ZeroLayer() ).size() );
+    }
+
+  this->m_LevelSet = ioLevelSet;
+  this->m_TermContainer = this->m_EquationContainer->GetEquation( this->m_CurrentLevelSetId );
+  this->m_Offset = ioLevelSet->GetDomainOffset();
+
+  // The status image is only valid for the label map it was built from, as
+  // left by the last Update().
+  LabelMapType* labelMap = ioLevelSet->GetLabelMap();
+
+  if( ( this->m_StatusImage.IsNull() ) ||
+      ( this->m_StatusLevelSet.GetPointer() != ioLevelSet ) ||
+      ( this->m_StatusLabelMap.GetPointer() != labelMap ) ||
+      ( this->m_StatusLabelMapTime != labelMap->GetMTime() ) )
+    {
+    this->InitializeStatusImage( labelMap );
+    this->m_StatusLevelSet = ioLevelSet;
+    this->m_StatusLabelMap = labelMap;
+
+    for( unsigned int i = 0; i < 7; i++ )
+      {
+      this->m_LabelLines[i].m_Valid = false;
+      }
+    }
+
+  this->m_LabelChanges.clear();
+
+  NodeListType & up0 = this->m_UpLists[0];
+  NodeListType & up1 = this->m_UpLists[1];
+  NodeListType & down0 = this->m_DownLists[0];
+  NodeListType & down1 = this->m_DownLists[1];
+  up0.clear();
+  down0.clear();
+
+  this->UpdateZeroLayer( iUpdate, up0, down0 );
+
+  // The nodes leaving the zero layer upwards are replaced by their
+  // neighbors of the layer -1, which are replaced by their neighbors of
+  // the layer -2, which are replaced by interior pixels; downwards alike.
+  this->ProcessStatusList( up0, up1, LevelSetType::PlusOneLayer(), LevelSetType::MinusOneLayer() );
+  this->ProcessStatusList( down0, down1, LevelSetType::MinusOneLayer(), LevelSetType::PlusOneLayer() );
+
+  this->ProcessStatusList( up1, up0, LevelSetType::ZeroLayer(), LevelSetType::MinusTwoLayer() );
+  this->ProcessStatusList( down1, down0, LevelSetType::ZeroLayer(), LevelSetType::PlusTwoLayer() );
+
+  this->ProcessStatusList( up0, up1, LevelSetType::MinusOneLayer(), LevelSetType::MinusThreeLayer() );
+  this->ProcessStatusList( down0, down1, LevelSetType::PlusOneLayer(), LevelSetType::PlusThreeLayer() );
+
+  this->ProcessOutsideList( up1, LevelSetType::MinusTwoLayer() );
+  this->ProcessOutsideList( down1, LevelSetType::PlusTwoLayer() );
+
+  this->PropagateLayerValues( LevelSetType::ZeroLayer(), LevelSetType::MinusOneLayer(), LevelSetType::MinusTwoLayer() );
+  this->PropagateLayerValues( LevelSetType::ZeroLayer(), LevelSetType::PlusOneLayer(), LevelSetType::PlusTwoLayer() );
+  this->PropagateLayerValues( LevelSetType::MinusOneLayer(), LevelSetType::MinusTwoLayer(), LevelSetType::MinusThreeLayer() );
+  this->PropagateLayerValues( LevelSetType::PlusOneLayer(), LevelSetType::PlusTwoLayer(), LevelSetType::PlusThreeLayer() );
+
+  this->UpdateLabelMap( labelMap );
+
+  labelMap->Modified();
+  this->m_StatusLabelMapTime = labelMap->GetMTime();
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "CurrentLevelSetId: " << this->m_CurrentLevelSetId << std::endl;
+  os << indent << "TimeStep: " << this->m_TimeStep << std::endl;
+  os << indent << "RMSChangeAccumulator: " << this->m_RMSChangeAccumulator << std::endl;
+  os << indent << "NumberOfLabelChanges: " << this->m_NumberOfLabelChanges << std::endl;
+  os << indent << "NumberOfStatusImageBuilds: " << this->m_NumberOfStatusImageBuilds << std::endl;
+}
+
+}
+#endif // __itkIncrementalUpdateWhitakerSparseLevelSet_hxx
@@ -0,0 +1,144 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetAdaptiveTimeStepEvolution_h
+#define __itkLevelSetAdaptiveTimeStepEvolution_h
+
+#include "itkLevelSetEvolution.h"
+#include "itkLevelSetDenseImage.h"
+#include "itkWhitakerSparseLevelSetImage.h"
+#include "itkShiSparseLevelSetImage.h"
+#include "itkMalcolmSparseLevelSetImage.h"
+
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class LevelSetAdaptiveTimeStepEvolution
+ *  \brief Evolution taking, at each iteration, the largest stable time step
+ *  for the updates just computed.
+ *
+ *  The time step of LevelSetEvolution comes from the CFL contributions of
+ *  the terms, which bound the speed everywhere and are conservative where
+ *  the front is slow. Here the time step is computed from the update
+ *  buffer, once the updates of the iteration are known, as the largest
+ *  step for which no value changes by more than:
+ *  - half a layer for a Whitaker level-set, whose front nodes must not
+ *  cross more than one layer per iteration;
+ *  - the smallest spacing for a dense level-set, whose zero set must not
+ *  move by more than one pixel per iteration;
+ *  scaled by SafetyFactor. If every update is zero, the time step is kept.
+ *
+ *  A time step given with SetTimeStep() is honoured: it is then used for
+ *  every iteration, as in LevelSetEvolution, and is not adapted.
+ *
+ *  Shi and Malcolm level-sets only use the sign of the updates: their time
+ *  step is left to LevelSetEvolution.
+ *
+ *  Every time step taken is kept, so that a run can be reproduced with a
+ *  fixed time step schedule.
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TEquationContainer, class TLevelSet >
+class LevelSetAdaptiveTimeStepEvolution :
+  public LevelSetEvolution< TEquationContainer, TLevelSet >
+{
+public:
+  typedef LevelSetAdaptiveTimeStepEvolution                  Self;
+  typedef LevelSetEvolution< TEquationContainer, TLevelSet > Superclass;
+  typedef SmartPointer< Self >                              Pointer;
+  typedef SmartPointer< const Self >                        ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetAdaptiveTimeStepEvolution, LevelSetEvolution );
+
+  typedef typename Superclass::LevelSetOutputRealType       LevelSetOutputRealType;
+  typedef std::vector< LevelSetOutputRealType >             TimeStepListType;
+
+  /** Fraction of the largest stable time step taken. Default is 0.9. */
+  itkSetClampMacro( SafetyFactor, double, NumericTraits< double >::epsilon(), 1.0 );
+  itkGetConstMacro( SafetyFactor, double );
+
+  /** Time step of the last iteration */
+  LevelSetOutputRealType GetTimeStep() const
+    {
+    return this->m_Dt;
+    }
+
+  /** Time step of every iteration, since the last Update() */
+  const TimeStepListType& GetTimeSteps() const
+    {
+    return this->m_TimeSteps;
+    }
+
+protected:
+  LevelSetAdaptiveTimeStepEvolution();
+  virtual ~LevelSetAdaptiveTimeStepEvolution() {}
+
+  virtual void AllocateUpdateBuffer();
+
+  virtual void ComputeTimeStepForNextIteration();
+
+  /** Largest update magnitude in the update buffer, and the largest change
+   * of value it may cause; false if the time step is not adapted to the
+   * updates */
+  template< typename TOutput, unsigned int VDimension >
+  bool ComputeMaximumUpdate( WhitakerSparseLevelSetImage< TOutput, VDimension >*,
+                             LevelSetOutputRealType& oMaximumUpdate,
+                             LevelSetOutputRealType& oMaximumChange ) const;
+  template< class TImage >
+  bool ComputeMaximumUpdate( LevelSetDenseImage< TImage >*,
+                             LevelSetOutputRealType& oMaximumUpdate,
+                             LevelSetOutputRealType& oMaximumChange ) const;
+  /** Largest update magnitude of a map from level-set identifiers to
+   * layers of updates */
+  template< class TLayerMap >
+  static LevelSetOutputRealType ComputeMaximumLayerUpdate( const TLayerMap& iLayers );
+
+  template< unsigned int VDimension >
+  bool ComputeMaximumUpdate( ShiSparseLevelSetImage< VDimension >*,
+                             LevelSetOutputRealType&, LevelSetOutputRealType& ) const
+    {
+    return false;
+    }
+  template< unsigned int VDimension >
+  bool ComputeMaximumUpdate( MalcolmSparseLevelSetImage< VDimension >*,
+                             LevelSetOutputRealType&, LevelSetOutputRealType& ) const
+    {
+    return false;
+    }
+
+private:
+  LevelSetAdaptiveTimeStepEvolution( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  double            m_SafetyFactor;
+  TimeStepListType  m_TimeSteps;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetAdaptiveTimeStepEvolution.hxx"
+#endif
+
+#endif // __itkLevelSetAdaptiveTimeStepEvolution_h
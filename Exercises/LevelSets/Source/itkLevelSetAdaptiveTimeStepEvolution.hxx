@@ -0,0 +1,155 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef __itkLevelSetAdaptiveTimeStepEvolution_hxx
+#define __itkLevelSetAdaptiveTimeStepEvolution_hxx
+
+#include "itkLevelSetAdaptiveTimeStepEvolution.h"
+
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace itk
+{
+template< class TEquationContainer, class TLevelSet >
+LevelSetAdaptiveTimeStepEvolution< TEquationContainer, TLevelSet >
+::LevelSetAdaptiveTimeStepEvolution() :
+  m_SafetyFactor( 0.9 )
+{
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+LevelSetAdaptiveTimeStepEvolution< TEquationContainer, TLevelSet >
+::AllocateUpdateBuffer()
+{
+  // called once at the beginning of each evolution
+  Superclass::AllocateUpdateBuffer();
+  this->m_TimeSteps.clear();
+}
+
+template< class TEquationContainer, class TLevelSet >
+template< class TLayerMap >
+typename LevelSetAdaptiveTimeStepEvolution< TEquationContainer, TLevelSet >::LevelSetOutputRealType
+LevelSetAdaptiveTimeStepEvolution< TEquationContainer, TLevelSet >
+::ComputeMaximumLayerUpdate( const TLayerMap& iLayers )
+{
+  // the layers are held by pointer
+  typedef typename std::iterator_traits< typename TLayerMap::mapped_type >::value_type LayerType;
+
+  LevelSetOutputRealType maximumUpdate = NumericTraits< LevelSetOutputRealType >::Zero;
+
+  for( typename TLayerMap::const_iterator lIt = iLayers.begin(); lIt != iLayers.end(); ++lIt )
+    {
+    for( typename LayerType::const_iterator nIt = lIt->second->begin();
+         nIt != lIt->second->end(); ++nIt )
+      {
+      maximumUpdate = std::max( maximumUpdate,
+        static_cast< LevelSetOutputRealType >( std::abs( nIt->second ) ) );
+      }
+    }
+
+  return maximumUpdate;
+}
+
+template< class TEquationContainer, class TLevelSet >
+template< typename TOutput, unsigned int VDimension >
+bool
+LevelSetAdaptiveTimeStepEvolution< TEquationContainer, TLevelSet >
+::ComputeMaximumUpdate( WhitakerSparseLevelSetImage< TOutput, VDimension >*,
+                        LevelSetOutputRealType& oMaximumUpdate,
+                        LevelSetOutputRealType& oMaximumChange ) const
+{
+  // The updates of the zero layer nodes, in [-0.5, 0.5], must not take
+  // them further than the next layer.
+  oMaximumUpdate = ComputeMaximumLayerUpdate( this->m_UpdateBuffer );
+  oMaximumChange = 0.5;
+  return true;
+}
+
+template< class TEquationContainer, class TLevelSet >
+template< class TImage >
+bool
+LevelSetAdaptiveTimeStepEvolution< TEquationContainer, TLevelSet >
+::ComputeMaximumUpdate( LevelSetDenseImage< TImage >*,
+                        LevelSetOutputRealType& oMaximumUpdate,
+                        LevelSetOutputRealType& oMaximumChange ) const
+{
+  typedef typename Superclass::LevelSetContainerType LevelSetContainerType;
+
+  oMaximumUpdate = NumericTraits< LevelSetOutputRealType >::Zero;
+  oMaximumChange = NumericTraits< LevelSetOutputRealType >::max();
+
+  for( typename LevelSetContainerType::Iterator it = this->m_UpdateBuffer->Begin();
+       it != this->m_UpdateBuffer->End(); ++it )
+    {
+    const TImage* update = it->GetLevelSet()->GetImage();
+
+    ImageRegionConstIterator< TImage > uIt( update, update->GetBufferedRegion() );
+    for( uIt.GoToBegin(); !uIt.IsAtEnd(); ++uIt )
+      {
+      oMaximumUpdate = std::max( oMaximumUpdate,
+        static_cast< LevelSetOutputRealType >( std::abs( uIt.Get() ) ) );
+      }
+
+    for( unsigned int dim = 0; dim < TImage::ImageDimension; dim++ )
+      {
+      oMaximumChange = std::min( oMaximumChange,
+        static_cast< LevelSetOutputRealType >( update->GetSpacing()[dim] ) );
+      }
+    }
+
+  return true;
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+LevelSetAdaptiveTimeStepEvolution< TEquationContainer, TLevelSet >
+::ComputeTimeStepForNextIteration()
+{
+  // a time step set by the user is kept
+  if( this->m_UserGloballyDefinedTimeStep )
+    {
+    this->m_TimeSteps.push_back( this->m_Dt );
+    return;
+    }
+
+  LevelSetOutputRealType maximumUpdate = NumericTraits< LevelSetOutputRealType >::Zero;
+  LevelSetOutputRealType maximumChange = NumericTraits< LevelSetOutputRealType >::Zero;
+
+  if( !this->ComputeMaximumUpdate( static_cast< TLevelSet* >( NULL ), maximumUpdate, maximumChange ) )
+    {
+    Superclass::ComputeTimeStepForNextIteration();
+    return;
+    }
+
+  if( maximumUpdate > NumericTraits< LevelSetOutputRealType >::epsilon() )
+    {
+    this->m_Dt = static_cast< LevelSetOutputRealType >( this->m_SafetyFactor ) *
+      maximumChange / maximumUpdate;
+    }
+
+  this->m_TimeSteps.push_back( this->m_Dt );
+}
+
+}
+#endif // __itkLevelSetAdaptiveTimeStepEvolution_hxx
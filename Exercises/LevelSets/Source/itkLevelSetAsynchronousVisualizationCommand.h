@@ -0,0 +1,150 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetAsynchronousVisualizationCommand_h
+#define __itkLevelSetAsynchronousVisualizationCommand_h
+
+#include "itkCommand.h"
+#include "itkMultiThreader.h"
+#include "itkConditionVariable.h"
+#include "itkSimpleMutexLock.h"
+#include "itkLevelSetSnapshotMailbox.h"
+#include "itkSparseLevelSetLayerTraits.h"
+
+namespace itk
+{
+/**
+ *  \class LevelSetAsynchronousVisualizationCommand
+ *  \brief Render the layers of an evolving sparse level-set without making
+ *  the evolution wait for the rendering.
+ *
+ *  Unlike LevelSetIterationUpdateCommand, the visualization is not updated
+ *  from the IterationEvent handler. Evolve() runs the Update() of the
+ *  evolution on a worker thread, and renders on the thread which called
+ *  it: render windows are not guaranteed to work on another thread than
+ *  the main one, and do not on Mac OS X. The calling thread asks for a
+ *  snapshot, renders it with FilterToUpdate, and asks for the next one.
+ *  On IterationEvent, on the worker thread, the command copies the layers
+ *  of the level-set into a snapshot only if a snapshot was asked for;
+ *  otherwise the frame is dropped and the evolution continues right away.
+ *  Snapshots go through a lock-free LevelSetSnapshotMailbox; the calling
+ *  thread sleeps on a condition variable until one is published.
+ *
+ *  Once the evolution is over, the worker thread hands over the final
+ *  layers, which are rendered before Evolve() returns. An exception thrown
+ *  by the evolution is rethrown by Evolve().
+ *
+ *  \tparam TIteratingFilter Level-set evolution, source of IterationEvent
+ *  \tparam TFilterToUpdate  Visualization, with SetLevelSet() and Update()
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TIteratingFilter, class TFilterToUpdate >
+class LevelSetAsynchronousVisualizationCommand : public Command
+{
+public:
+  typedef LevelSetAsynchronousVisualizationCommand  Self;
+  typedef Command                                   Superclass;
+  typedef SmartPointer< Self >                      Pointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetAsynchronousVisualizationCommand, Command );
+
+  typedef TIteratingFilter                          IteratingFilterType;
+  typedef TFilterToUpdate                           FilterToUpdateType;
+
+  typedef typename IteratingFilterType::LevelSetType LevelSetType;
+  typedef typename LevelSetType::Pointer            LevelSetPointer;
+
+  typedef SparseLevelSetLayerTraits< LevelSetType > LayerTraitsType;
+  typedef LevelSetSnapshotMailbox< LevelSetType >   MailboxType;
+
+  /** Visualization, only used from the thread calling Evolve() */
+  itkSetObjectMacro( FilterToUpdate, FilterToUpdateType );
+  itkGetObjectMacro( FilterToUpdate, FilterToUpdateType );
+
+  /** Level-set being evolved */
+  itkSetObjectMacro( LevelSet, LevelSetType );
+  itkGetObjectMacro( LevelSet, LevelSetType );
+
+  /** Offer a snapshot every UpdatePeriod iterations. Default is 1. */
+  itkSetMacro( UpdatePeriod, IdentifierType );
+  itkGetConstMacro( UpdatePeriod, IdentifierType );
+
+  /** Number of snapshots handed to the rendering */
+  itkGetConstMacro( NumberOfPublishedSnapshots, SizeValueType );
+
+  /** Update iFilter on a worker thread, observing its IterationEvent, and
+   * render its level-set on this thread until it is over */
+  void Evolve( IteratingFilterType* iFilter );
+
+  virtual void Execute( const Object* caller, const EventObject& event );
+
+  virtual void Execute( Object* caller, const EventObject& event );
+
+protected:
+  LevelSetAsynchronousVisualizationCommand();
+  virtual ~LevelSetAsynchronousVisualizationCommand() {}
+
+  /** Copy the layers of the level-set */
+  LevelSetPointer CreateSnapshot() const;
+
+  /** Hand a copy of the layers to the rendering, and wake it */
+  void PublishSnapshot();
+
+  /** Render the snapshots until the evolution is over */
+  void Render();
+
+  /** Body of the worker thread */
+  static ITK_THREAD_RETURN_TYPE EvolutionThreadCallback( void* arg );
+
+private:
+  LevelSetAsynchronousVisualizationCommand( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  typename FilterToUpdateType::Pointer  m_FilterToUpdate;
+  LevelSetPointer                       m_LevelSet;
+  IdentifierType                        m_UpdatePeriod;
+  IdentifierType                        m_NumberOfIterations;
+  SizeValueType                         m_NumberOfPublishedSnapshots;
+
+  MailboxType                           m_Mailbox;
+  MultiThreader::Pointer                m_Threader;
+  IteratingFilterType*                  m_IteratingFilter;
+  bool                                  m_Evolving;
+
+  // failure of the evolution, rethrown by Evolve()
+  bool                                  m_HasError;
+  ExceptionObject                       m_Error;
+
+  // the rendering waits on m_WakeCondition, under m_WakeLock, for a
+  // snapshot or m_Stopping
+  SimpleMutexLock                       m_WakeLock;
+  ConditionVariable::Pointer            m_WakeCondition;
+  bool                                  m_Stopping;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetAsynchronousVisualizationCommand.hxx"
+#endif
+
+#endif // __itkLevelSetAsynchronousVisualizationCommand_h
@@ -0,0 +1,234 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetAsynchronousVisualizationCommand_hxx
+#define __itkLevelSetAsynchronousVisualizationCommand_hxx
+
+#include "itkLevelSetAsynchronousVisualizationCommand.h"
+
+namespace itk
+{
+template< class TIteratingFilter, class TFilterToUpdate >
+LevelSetAsynchronousVisualizationCommand< TIteratingFilter, TFilterToUpdate >
+::LevelSetAsynchronousVisualizationCommand() :
+  m_UpdatePeriod( 1 ),
+  m_NumberOfIterations( 0 ),
+  m_NumberOfPublishedSnapshots( 0 ),
+  m_IteratingFilter( NULL ),
+  m_Evolving( false ),
+  m_HasError( false ),
+  m_Stopping( false )
+{
+  this->m_Threader = MultiThreader::New();
+  this->m_WakeCondition = ConditionVariable::New();
+}
+
+template< class TIteratingFilter, class TFilterToUpdate >
+void
+LevelSetAsynchronousVisualizationCommand< TIteratingFilter, TFilterToUpdate >
+::Evolve( IteratingFilterType* iFilter )
+{
+  if( iFilter == NULL )
+    {
+    itkExceptionMacro( << "iFilter is NULL" );
+    }
+  if( this->m_FilterToUpdate.IsNull() )
+    {
+    itkExceptionMacro( << "m_FilterToUpdate is NULL" );
+    }
+  if( this->m_LevelSet.IsNull() )
+    {
+    itkExceptionMacro( << "m_LevelSet is NULL" );
+    }
+
+  this->m_IteratingFilter = iFilter;
+  this->m_NumberOfIterations = 0;
+  this->m_NumberOfPublishedSnapshots = 0;
+  this->m_HasError = false;
+  this->m_Stopping = false;
+
+  // The first frame shows the initial level-set.
+  this->PublishSnapshot();
+
+  const unsigned long tag = iFilter->AddObserver( IterationEvent(), this );
+  this->m_Evolving = true;
+
+  const int threadId = this->m_Threader->SpawnThread( EvolutionThreadCallback, this );
+
+  // The evolution never waits for the rendering: if the rendering fails,
+  // it still runs to its end before the worker thread is joined.
+  bool renderFailed = false;
+  ExceptionObject renderError;
+  try
+    {
+    this->Render();
+    }
+  catch( ExceptionObject& err )
+    {
+    renderError = err;
+    renderFailed = true;
+    }
+
+  this->m_Threader->TerminateThread( threadId );
+  this->m_Evolving = false;
+  iFilter->RemoveObserver( tag );
+  this->m_IteratingFilter = NULL;
+
+  if( this->m_HasError )
+    {
+    throw this->m_Error;
+    }
+  if( renderFailed )
+    {
+    throw renderError;
+    }
+}
+
+template< class TIteratingFilter, class TFilterToUpdate >
+ITK_THREAD_RETURN_TYPE
+LevelSetAsynchronousVisualizationCommand< TIteratingFilter, TFilterToUpdate >
+::EvolutionThreadCallback( void* arg )
+{
+  MultiThreader::ThreadInfoStruct* info = static_cast< MultiThreader::ThreadInfoStruct* >( arg );
+  Self* self = static_cast< Self* >( info->UserData );
+
+  try
+    {
+    self->m_IteratingFilter->Update();
+    }
+  catch( ExceptionObject& err )
+    {
+    self->m_Error = err;
+    self->m_HasError = true;
+    }
+
+  // The final layers are published before m_Stopping is raised, and the
+  // rendering only returns once it finds the slot empty with m_Stopping
+  // raised: they are rendered.
+  self->PublishSnapshot();
+
+  self->m_WakeLock.Lock();
+  self->m_Stopping = true;
+  self->m_WakeCondition->Signal();
+  self->m_WakeLock.Unlock();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TIteratingFilter, class TFilterToUpdate >
+typename LevelSetAsynchronousVisualizationCommand< TIteratingFilter, TFilterToUpdate >::LevelSetPointer
+LevelSetAsynchronousVisualizationCommand< TIteratingFilter, TFilterToUpdate >
+::CreateSnapshot() const
+{
+  typedef typename LayerTraitsType::LayerIdListType LayerIdListType;
+  const LayerIdListType layerIds = LayerTraitsType::GetLayerIds();
+
+  const LevelSetType* levelSet = this->m_LevelSet.GetPointer();
+
+  LevelSetPointer snapshot = LevelSetType::New();
+  for( typename LayerIdListType::const_iterator it = layerIds.begin(); it != layerIds.end(); ++it )
+    {
+    snapshot->SetLayer( *it, levelSet->GetLayer( *it ) );
+    }
+  return snapshot;
+}
+
+template< class TIteratingFilter, class TFilterToUpdate >
+void
+LevelSetAsynchronousVisualizationCommand< TIteratingFilter, TFilterToUpdate >
+::PublishSnapshot()
+{
+  this->m_Mailbox.Publish( this->CreateSnapshot() );
+  ++this->m_NumberOfPublishedSnapshots;
+
+  // Signaling under the lock cannot be missed: the rendering checks the
+  // slot and waits under the same lock.
+  this->m_WakeLock.Lock();
+  this->m_WakeCondition->Signal();
+  this->m_WakeLock.Unlock();
+}
+
+template< class TIteratingFilter, class TFilterToUpdate >
+void
+LevelSetAsynchronousVisualizationCommand< TIteratingFilter, TFilterToUpdate >
+::Render()
+{
+  this->m_WakeLock.Lock();
+  while( true )
+    {
+    LevelSetPointer snapshot = this->m_Mailbox.Take();
+
+    if( snapshot.IsNotNull() )
+      {
+      this->m_WakeLock.Unlock();
+
+      this->m_FilterToUpdate->SetLevelSet( snapshot );
+      this->m_FilterToUpdate->Update();
+
+      // ready for the next frame
+      this->m_Mailbox.Request();
+
+      this->m_WakeLock.Lock();
+      continue;
+      }
+
+    // the slot is empty: return once stopped, sleep otherwise
+    if( this->m_Stopping )
+      {
+      break;
+      }
+    this->m_WakeCondition->Wait( &this->m_WakeLock );
+    }
+  this->m_WakeLock.Unlock();
+}
+
+template< class TIteratingFilter, class TFilterToUpdate >
+void
+LevelSetAsynchronousVisualizationCommand< TIteratingFilter, TFilterToUpdate >
+::Execute( const Object* itkNotUsed( caller ), const EventObject& event )
+{
+  if( !IterationEvent().CheckEvent( &event ) || !this->m_Evolving )
+    {
+    return;
+    }
+
+  ++this->m_NumberOfIterations;
+  if( ( this->m_UpdatePeriod > 1 ) && ( this->m_NumberOfIterations % this->m_UpdatePeriod != 0 ) )
+    {
+    return;
+    }
+
+  // The previous frame is still being rendered: drop this one.
+  if( !this->m_Mailbox.TakeRequest() )
+    {
+    return;
+    }
+
+  this->PublishSnapshot();
+}
+
+template< class TIteratingFilter, class TFilterToUpdate >
+void
+LevelSetAsynchronousVisualizationCommand< TIteratingFilter, TFilterToUpdate >
+::Execute( Object* caller, const EventObject& event )
+{
+  this->Execute( const_cast< const Object* >( caller ), event );
+}
+
+}
+#endif // __itkLevelSetAsynchronousVisualizationCommand_hxx
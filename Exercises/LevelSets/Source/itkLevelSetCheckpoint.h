@@ -0,0 +1,94 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetCheckpoint_h
+#define __itkLevelSetCheckpoint_h
+
+#include "itkLevelSetLayerTrace.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace itk
+{
+/**
+ *  \class LevelSetCheckpoint
+ *  \brief Binary format of the checkpoints of sparse level-set evolutions.
+ *
+ *  A checkpoint holds the complete state of a set of sparse level-sets,
+ *  and of the terms of their equations, after a given iteration, in host
+ *  byte order:
+ *
+ *  - header: the 8 characters "LSCHECK2", uint32 image dimension D, uint32
+ *    size in bytes of a level-set value, uint64 iteration, uint32 number
+ *    of level-sets and uint64 payload size in bytes.
+ *  - payload, for each level-set: varint identifier; D int64 region index,
+ *    D uint64 region size, D double spacing, D double origin and D x D
+ *    double direction of its label map; then varint number of layers and
+ *    for each layer its int8 identifier, its nodes and their raw values;
+ *    then varint number of label objects and for each object its int8
+ *    label, the offsets of the first pixel of its lines and the varint
+ *    lengths of these lines.
+ *  - end of the payload: varint number of term states and for each one
+ *    its varint identifier, its varint size in bytes and the bytes written
+ *    by its LevelSetCheckpointTermState::EncodeState().
+ *
+ *  Nodes and line starts are lists of sorted offsets, encoded as in
+ *  LevelSetLayerTrace. Values are stored bit for bit.
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+class LevelSetCheckpoint
+{
+public:
+  typedef LevelSetLayerTrace::OffsetType      OffsetType;
+  typedef LevelSetLayerTrace::OffsetListType  OffsetListType;
+  typedef LevelSetLayerTrace::BufferType      BufferType;
+
+  static const char * GetFileMagic() { return "LSCHECK2"; }
+
+  /** Size in bytes of the header */
+  static size_t GetHeaderSize()
+    {
+    return 8 + 3 * sizeof( uint32_t ) + 2 * sizeof( uint64_t );
+    }
+
+  /** Append the bytes of iValue to ioBuffer */
+  template< class T >
+  static void EncodeRaw( const T& iValue, BufferType& ioBuffer )
+    {
+    const size_t size = ioBuffer.size();
+    ioBuffer.resize( size + sizeof( T ) );
+    std::memcpy( &ioBuffer[size], &iValue, sizeof( T ) );
+    }
+
+  /** Read the bytes of oValue from ioPosition */
+  template< class T >
+  static void DecodeRaw( const unsigned char*& ioPosition, const unsigned char* iEnd, T& oValue )
+    {
+    if( iEnd - ioPosition < static_cast< std::ptrdiff_t >( sizeof( T ) ) )
+      {
+      itkGenericExceptionMacro( << "Corrupted level-set checkpoint: truncated value" );
+      }
+    std::memcpy( &oValue, ioPosition, sizeof( T ) );
+    ioPosition += sizeof( T );
+    }
+};
+}
+
+#endif // __itkLevelSetCheckpoint_h
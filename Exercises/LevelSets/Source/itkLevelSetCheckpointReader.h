@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetCheckpointReader_h
+#define __itkLevelSetCheckpointReader_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkLevelSetCheckpoint.h"
+#include "itkLevelSetCheckpointTermState.h"
+#include "itkSparseLevelSetLayerTraits.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class LevelSetCheckpointReader
+ *  \brief Restore sparse level-sets from a checkpoint.
+ *
+ *  Reads a checkpoint written by LevelSetCheckpointWriter and rebuilds its
+ *  level-sets: the values of the layer nodes are restored bit for bit, and
+ *  the label maps line by line. The saved states of the terms are kept,
+ *  and restored by RestoreTermState() into the terms of the resumed
+ *  evolution, once they are created. Evolving the restored level-sets for
+ *  the remaining iterations resumes the interrupted evolution bit for bit.
+ *
+ *  \sa LevelSetCheckpoint, LevelSetCheckpointWriter
+ *
+ *  \tparam TLevelSet Whitaker, Shi or Malcolm sparse level-set image
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TLevelSet >
+class LevelSetCheckpointReader : public Object
+{
+public:
+  typedef LevelSetCheckpointReader    Self;
+  typedef Object                      Superclass;
+  typedef SmartPointer< Self >        Pointer;
+  typedef SmartPointer< const Self >  ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetCheckpointReader, Object );
+
+  typedef TLevelSet                                 LevelSetType;
+  typedef typename LevelSetType::Pointer            LevelSetPointer;
+  typedef typename LevelSetType::OutputType         LevelSetOutputType;
+  typedef typename LevelSetType::LayerType          LayerType;
+  typedef typename LevelSetType::LabelMapType       LabelMapType;
+  typedef typename LabelMapType::Pointer            LabelMapPointer;
+  typedef typename LabelMapType::RegionType         RegionType;
+  typedef typename LabelMapType::IndexType          IndexType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, LevelSetType::Dimension );
+
+  typedef SparseLevelSetLayerTraits< LevelSetType > LayerTraitsType;
+  typedef LevelSetCheckpoint::OffsetType            OffsetType;
+  typedef LevelSetCheckpoint::OffsetListType        OffsetListType;
+  typedef LevelSetCheckpoint::BufferType            BufferType;
+  typedef LevelSetCheckpointTermState               TermStateType;
+
+  typedef std::vector< IdentifierType >             IdentifierListType;
+
+  itkSetStringMacro( FileName );
+  itkGetStringMacro( FileName );
+
+  /** Read the checkpoint and rebuild its level-sets */
+  void Read();
+
+  /** Iteration after which the checkpoint was saved */
+  itkGetConstMacro( Iteration, IdentifierType );
+
+  /** Identifiers of the level-sets, in the order they were saved */
+  const IdentifierListType & GetIdentifiers() const { return this->m_Identifiers; }
+
+  /** Restored level-set of identifier iId */
+  LevelSetType* GetLevelSet( IdentifierType iId ) const;
+
+  /** Restore the saved state of the term of identifier iId into iTerm */
+  void RestoreTermState( IdentifierType iId, TermStateType* iTerm ) const;
+
+protected:
+  LevelSetCheckpointReader();
+  virtual ~LevelSetCheckpointReader() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Rebuild one level-set from ioPosition */
+  LevelSetPointer DecodeLevelSet( const unsigned char*& ioPosition, const unsigned char* iEnd,
+                                  IdentifierType& oId ) const;
+
+private:
+  LevelSetCheckpointReader( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  typedef std::map< IdentifierType, LevelSetPointer > LevelSetMapType;
+  typedef std::map< IdentifierType, BufferType >      TermStateMapType;
+
+  std::string         m_FileName;
+  IdentifierType      m_Iteration;
+  IdentifierListType  m_Identifiers;
+  LevelSetMapType     m_LevelSets;
+  TermStateMapType    m_TermStates;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetCheckpointReader.hxx"
+#endif
+
+#endif // __itkLevelSetCheckpointReader_h
@@ -0,0 +1,300 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetCheckpointReader_hxx
+#define __itkLevelSetCheckpointReader_hxx
+
+#include "itkLevelSetCheckpointReader.h"
+
+#include <fstream>
+#include <iterator>
+
+namespace itk
+{
+template< class TLevelSet >
+LevelSetCheckpointReader< TLevelSet >
+::LevelSetCheckpointReader() :
+  m_Iteration( 0 )
+{}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointReader< TLevelSet >
+::Read()
+{
+  this->m_Iteration = 0;
+  this->m_Identifiers.clear();
+  this->m_LevelSets.clear();
+  this->m_TermStates.clear();
+
+  std::ifstream stream( this->m_FileName.c_str(), std::ios::in | std::ios::binary );
+  if( !stream.is_open() )
+    {
+    itkExceptionMacro( << "Could not open " << this->m_FileName );
+    }
+
+  BufferType buffer;
+  buffer.assign( std::istreambuf_iterator< char >( stream ), std::istreambuf_iterator< char >() );
+
+  if( ( buffer.size() < LevelSetCheckpoint::GetHeaderSize() ) ||
+      ( std::memcmp( &buffer[0], LevelSetCheckpoint::GetFileMagic(), 8 ) != 0 ) )
+    {
+    itkExceptionMacro( << this->m_FileName << " is not a level-set checkpoint" );
+    }
+
+  const unsigned char* position = &buffer[0] + 8;
+  const unsigned char* end = &buffer[0] + buffer.size();
+
+  uint32_t dimension;
+  uint32_t valueSize;
+  uint64_t iteration;
+  uint32_t numberOfLevelSets;
+  uint64_t payloadSize;
+  LevelSetCheckpoint::DecodeRaw( position, end, dimension );
+  LevelSetCheckpoint::DecodeRaw( position, end, valueSize );
+  LevelSetCheckpoint::DecodeRaw( position, end, iteration );
+  LevelSetCheckpoint::DecodeRaw( position, end, numberOfLevelSets );
+  LevelSetCheckpoint::DecodeRaw( position, end, payloadSize );
+
+  if( ( dimension != ImageDimension ) || ( valueSize != sizeof( LevelSetOutputType ) ) )
+    {
+    itkExceptionMacro( << this->m_FileName << " holds " << dimension
+                       << "D level-sets with " << valueSize << " byte values, expected "
+                       << ImageDimension << "D level-sets with "
+                       << sizeof( LevelSetOutputType ) << " byte values" );
+    }
+  if( payloadSize != static_cast< uint64_t >( end - position ) )
+    {
+    itkExceptionMacro( << "Corrupted level-set checkpoint: " << this->m_FileName
+                       << " is truncated" );
+    }
+
+  for( uint32_t i = 0; i < numberOfLevelSets; i++ )
+    {
+    IdentifierType id;
+    LevelSetPointer levelSet = this->DecodeLevelSet( position, end, id );
+    this->m_Identifiers.push_back( id );
+    this->m_LevelSets[id] = levelSet;
+    }
+
+  const OffsetType numberOfTermStates = LevelSetLayerTrace::DecodeVarint( position, end );
+  for( OffsetType t = 0; t < numberOfTermStates; t++ )
+    {
+    const IdentifierType id = static_cast< IdentifierType >( LevelSetLayerTrace::DecodeVarint( position, end ) );
+    const OffsetType size = LevelSetLayerTrace::DecodeVarint( position, end );
+    if( size > static_cast< OffsetType >( end - position ) )
+      {
+      itkExceptionMacro( << "Corrupted level-set checkpoint: truncated term state" );
+      }
+    this->m_TermStates[id].assign( position, position + size );
+    position += size;
+    }
+
+  this->m_Iteration = static_cast< IdentifierType >( iteration );
+}
+
+template< class TLevelSet >
+typename LevelSetCheckpointReader< TLevelSet >::LevelSetPointer
+LevelSetCheckpointReader< TLevelSet >
+::DecodeLevelSet( const unsigned char*& ioPosition, const unsigned char* iEnd,
+                  IdentifierType& oId ) const
+{
+  oId = static_cast< IdentifierType >( LevelSetLayerTrace::DecodeVarint( ioPosition, iEnd ) );
+
+  // Geometry of the label map
+  RegionType region;
+  typename LabelMapType::SpacingType spacing;
+  typename LabelMapType::PointType origin;
+  typename LabelMapType::DirectionType direction;
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    int64_t start;
+    LevelSetCheckpoint::DecodeRaw( ioPosition, iEnd, start );
+    region.SetIndex( dim, static_cast< OffsetValueType >( start ) );
+    }
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    uint64_t size;
+    LevelSetCheckpoint::DecodeRaw( ioPosition, iEnd, size );
+    region.SetSize( dim, static_cast< SizeValueType >( size ) );
+    }
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    double value;
+    LevelSetCheckpoint::DecodeRaw( ioPosition, iEnd, value );
+    spacing[dim] = value;
+    }
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    double value;
+    LevelSetCheckpoint::DecodeRaw( ioPosition, iEnd, value );
+    origin[dim] = value;
+    }
+  for( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    for( unsigned int j = 0; j < ImageDimension; j++ )
+      {
+      double value;
+      LevelSetCheckpoint::DecodeRaw( ioPosition, iEnd, value );
+      direction[i][j] = value;
+      }
+    }
+
+  const OffsetType numberOfPixels = static_cast< OffsetType >( region.GetNumberOfPixels() );
+
+  // Offsets in the region back to indices
+  const IndexType & start = region.GetIndex();
+  OffsetType strides[ImageDimension];
+  OffsetType stride = 1;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    strides[dim] = stride;
+    stride *= static_cast< OffsetType >( region.GetSize()[dim] );
+    }
+
+  LevelSetPointer levelSet = LevelSetType::New();
+
+  OffsetListType offsets;
+
+  // Layers
+  const OffsetType numberOfLayers = LevelSetLayerTrace::DecodeVarint( ioPosition, iEnd );
+  for( OffsetType l = 0; l < numberOfLayers; l++ )
+    {
+    int8_t layerId;
+    LevelSetCheckpoint::DecodeRaw( ioPosition, iEnd, layerId );
+    LevelSetLayerTrace::DecodeOffsets( ioPosition, iEnd, offsets );
+
+    LayerType & layer = levelSet->GetLayer( static_cast< typename LevelSetType::LayerIdType >( layerId ) );
+    layer.clear();
+
+    for( size_t i = 0; i < offsets.size(); i++ )
+      {
+      if( offsets[i] >= numberOfPixels )
+        {
+        itkExceptionMacro( << "Corrupted level-set checkpoint: node out of the region" );
+        }
+
+      IndexType index;
+      OffsetType remainder = offsets[i];
+      for( int dim = ImageDimension - 1; dim >= 0; dim-- )
+        {
+        index[dim] = start[dim] + static_cast< OffsetValueType >( remainder / strides[dim] );
+        remainder %= strides[dim];
+        }
+
+      LevelSetOutputType value;
+      LevelSetCheckpoint::DecodeRaw( ioPosition, iEnd, value );
+      layer.insert( typename LayerType::value_type( index, value ) );
+      }
+    }
+
+  // Label map
+  LabelMapPointer labelMap = LabelMapType::New();
+  labelMap->SetRegions( region );
+  labelMap->SetSpacing( spacing );
+  labelMap->SetOrigin( origin );
+  labelMap->SetDirection( direction );
+  labelMap->SetBackgroundValue( LayerTraitsType::GetExteriorLabel() );
+
+  typedef typename LabelMapType::LabelObjectType  LabelObjectType;
+  typedef typename LabelObjectType::Pointer       LabelObjectPointer;
+
+  const OffsetType numberOfObjects = LevelSetLayerTrace::DecodeVarint( ioPosition, iEnd );
+  for( OffsetType o = 0; o < numberOfObjects; o++ )
+    {
+    int8_t label;
+    LevelSetCheckpoint::DecodeRaw( ioPosition, iEnd, label );
+    LevelSetLayerTrace::DecodeOffsets( ioPosition, iEnd, offsets );
+
+    LabelObjectPointer labelObject = LabelObjectType::New();
+    labelObject->SetLabel( static_cast< typename LabelObjectType::LabelType >( label ) );
+
+    for( size_t i = 0; i < offsets.size(); i++ )
+      {
+      const OffsetType length = LevelSetLayerTrace::DecodeVarint( ioPosition, iEnd );
+      if( ( offsets[i] >= numberOfPixels ) || ( length > numberOfPixels - offsets[i] ) )
+        {
+        itkExceptionMacro( << "Corrupted level-set checkpoint: line out of the region" );
+        }
+
+      IndexType index;
+      OffsetType remainder = offsets[i];
+      for( int dim = ImageDimension - 1; dim >= 0; dim-- )
+        {
+        index[dim] = start[dim] + static_cast< OffsetValueType >( remainder / strides[dim] );
+        remainder %= strides[dim];
+        }
+      labelObject->AddLine( index, static_cast< SizeValueType >( length ) );
+      }
+
+    labelMap->AddLabelObject( labelObject );
+    }
+
+  levelSet->SetLabelMap( labelMap );
+
+  return levelSet;
+}
+
+template< class TLevelSet >
+typename LevelSetCheckpointReader< TLevelSet >::LevelSetType*
+LevelSetCheckpointReader< TLevelSet >
+::GetLevelSet( IdentifierType iId ) const
+{
+  typename LevelSetMapType::const_iterator it = this->m_LevelSets.find( iId );
+  if( it == this->m_LevelSets.end() )
+    {
+    itkExceptionMacro( << "No level-set " << iId << " in " << this->m_FileName );
+    }
+  return it->second.GetPointer();
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointReader< TLevelSet >
+::RestoreTermState( IdentifierType iId, TermStateType* iTerm ) const
+{
+  if( iTerm == NULL )
+    {
+    itkExceptionMacro( << "iTerm is NULL" );
+    }
+
+  typename TermStateMapType::const_iterator it = this->m_TermStates.find( iId );
+  if( it == this->m_TermStates.end() )
+    {
+    itkExceptionMacro( << "No state of the term " << iId << " in " << this->m_FileName );
+    }
+
+  const unsigned char* begin = it->second.empty() ? NULL : &it->second[0];
+  iTerm->DecodeState( begin, begin + it->second.size() );
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointReader< TLevelSet >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "FileName: " << this->m_FileName << std::endl;
+  os << indent << "Iteration: " << this->m_Iteration << std::endl;
+  os << indent << "NumberOfLevelSets: " << this->m_Identifiers.size() << std::endl;
+  os << indent << "NumberOfTermStates: " << this->m_TermStates.size() << std::endl;
+}
+
+}
+#endif // __itkLevelSetCheckpointReader_hxx
@@ -0,0 +1,59 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef __itkLevelSetCheckpointTermState_h
+#define __itkLevelSetCheckpointTermState_h
+
+#include "itkLevelSetCheckpoint.h"
+
+namespace itk
+{
+/**
+ *  \class LevelSetCheckpointTermState
+ *  \brief Interface of the terms whose accumulated state is checkpointed.
+ *
+ *  Some terms accumulate statistics over the evolution, e.g. the totals
+ *  and the mean of the Chan and Vese terms, which are updated node by node
+ *  as the level-set changes. An evolution resumed from a checkpoint would
+ *  recompute them from scratch, and round them differently. The terms
+ *  implementing this interface are saved by LevelSetCheckpointWriter and
+ *  restored by LevelSetCheckpointReader as they were, so that the resumed
+ *  evolution is bit for bit the interrupted one.
+ *
+ *  \sa LevelSetEquationCheckpointedTerm
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+class LevelSetCheckpointTermState
+{
+public:
+  typedef LevelSetCheckpoint::BufferType BufferType;
+
+  virtual ~LevelSetCheckpointTermState() {}
+
+  /** Append the accumulated state of the term to ioBuffer */
+  virtual void EncodeState( BufferType& ioBuffer ) const = 0;
+
+  /** Restore the state encoded in [iBegin, iEnd). It replaces the state
+   * the evolution computes when it starts. */
+  virtual void DecodeState( const unsigned char* iBegin, const unsigned char* iEnd ) = 0;
+};
+}
+
+#endif // __itkLevelSetCheckpointTermState_h
@@ -0,0 +1,194 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetCheckpointWriter_h
+#define __itkLevelSetCheckpointWriter_h
+
+#include "itkCommand.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkSimpleMutexLock.h"
+#include "itkConditionVariable.h"
+#include "itkLevelSetCheckpoint.h"
+#include "itkLevelSetCheckpointTermState.h"
+#include "itkSparseLevelSetSortedLayer.h"
+#include "itkSparseLevelSetLayerTraits.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class LevelSetCheckpointWriter
+ *  \brief Periodically save the state of sparse level-sets being evolved.
+ *
+ *  Observes the IterationEvent of a LevelSetEvolution. Every
+ *  CheckpointPeriod iterations, the layers and the label maps of the
+ *  level-sets are encoded in memory, which only costs a pass over the
+ *  layer nodes and the label map lines. The encoded checkpoint is then
+ *  handed to a writing thread, so that the evolution never waits for the
+ *  disk. If a new checkpoint is ready before the previous one is written,
+ *  only the new one is written. The writing thread sleeps on a condition
+ *  variable until a checkpoint is pending, and Stop() returns once the
+ *  last pending checkpoint is written. A checkpoint the writing thread
+ *  fails to write does not interrupt the evolution: the first failure is
+ *  kept and thrown by Stop(), in the calling thread.
+ *
+ *  The terms added with AddTermState() are saved with the level-sets.
+ *
+ *  The file is written next to FileName and renamed to it once complete,
+ *  so that FileName always holds a complete checkpoint.
+ *
+ *  \sa LevelSetCheckpoint, LevelSetCheckpointReader
+ *
+ *  \tparam TLevelSet Whitaker, Shi or Malcolm sparse level-set image
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TLevelSet >
+class LevelSetCheckpointWriter : public Command
+{
+public:
+  typedef LevelSetCheckpointWriter  Self;
+  typedef Command                   Superclass;
+  typedef SmartPointer< Self >      Pointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetCheckpointWriter, Command );
+
+  typedef TLevelSet                                 LevelSetType;
+  typedef typename LevelSetType::Pointer            LevelSetPointer;
+  typedef typename LevelSetType::OutputType         LevelSetOutputType;
+  typedef typename LevelSetType::LayerType          LayerType;
+  typedef typename LayerType::const_iterator        LayerConstIterator;
+  typedef typename LevelSetType::LabelMapType       LabelMapType;
+  typedef typename LabelMapType::RegionType         RegionType;
+  typedef typename LabelMapType::IndexType          IndexType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, LevelSetType::Dimension );
+
+  typedef SparseLevelSetLayerTraits< LevelSetType > LayerTraitsType;
+  typedef SparseLevelSetSortedLayer< LevelSetType > SortedLayerType;
+  typedef LevelSetCheckpoint::OffsetType            OffsetType;
+  typedef LevelSetCheckpoint::BufferType            BufferType;
+  typedef LevelSetCheckpointTermState               TermStateType;
+
+  /** File the checkpoints are written to */
+  itkSetStringMacro( FileName );
+  itkGetStringMacro( FileName );
+
+  /** Save a checkpoint every CheckpointPeriod iterations. Default is 50. */
+  itkSetMacro( CheckpointPeriod, IdentifierType );
+  itkGetConstMacro( CheckpointPeriod, IdentifierType );
+
+  /** Iteration of the first iteration observed, minus one: the iteration
+   * of the checkpoint an evolution was resumed from */
+  itkSetMacro( IterationOffset, IdentifierType );
+  itkGetConstMacro( IterationOffset, IdentifierType );
+
+  /** Level-set to save, with its identifier */
+  void AddLevelSet( IdentifierType iId, LevelSetType* iLevelSet );
+
+  /** Term to save, with an identifier unique among the terms of the
+   * checkpoint. The term must outlive the writer. */
+  void AddTermState( IdentifierType iId, TermStateType* iTerm );
+
+  /** Number of checkpoints written so far */
+  itkGetConstMacro( NumberOfCheckpointsWritten, SizeValueType );
+
+  /** Start the writing thread */
+  void Start();
+
+  /** Write the pending checkpoint, if any, and stop the writing thread.
+   * Throws the first failure of the writing thread. */
+  void Stop();
+
+  /** Encode and write a checkpoint of the current state, in the calling
+   * thread */
+  void Write();
+
+  virtual void Execute( const Object* caller, const EventObject& event );
+  virtual void Execute( Object* caller, const EventObject& event );
+
+protected:
+  LevelSetCheckpointWriter();
+  virtual ~LevelSetCheckpointWriter();
+
+  /** Encode the state of the level-sets after iIteration */
+  void Encode( IdentifierType iIteration, BufferType& oBuffer ) const;
+
+  /** Encode one level-set */
+  void EncodeLevelSet( IdentifierType iId, LevelSetType* iLevelSet, BufferType& ioBuffer ) const;
+
+  /** Write an encoded checkpoint to FileName */
+  void WriteFile( const BufferType& iBuffer );
+
+  /** Raise m_Stopping, wake the writing thread and join it */
+  void StopWriterThread();
+
+  static ITK_THREAD_RETURN_TYPE WriterThreadCallback( void* arg );
+
+private:
+  LevelSetCheckpointWriter( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  typedef std::pair< IdentifierType, LevelSetPointer >  LevelSetEntryType;
+  typedef std::vector< LevelSetEntryType >              LevelSetListType;
+  typedef std::pair< IdentifierType, TermStateType* >   TermStateEntryType;
+  typedef std::vector< TermStateEntryType >             TermStateListType;
+
+  std::string           m_FileName;
+  LevelSetListType      m_LevelSets;
+  TermStateListType     m_TermStates;
+
+  IdentifierType        m_CheckpointPeriod;
+  IdentifierType        m_IterationOffset;
+  IdentifierType        m_NumberOfIterations;
+  SizeValueType         m_NumberOfCheckpointsWritten;
+
+  MultiThreader::Pointer  m_Threader;
+  ThreadIdType            m_WriterThreadId;
+  bool                    m_WriterThreadRunning;
+
+  /** Checkpoint waiting for the writing thread, which waits on
+   * m_PendingCondition for it or for m_Stopping */
+  SimpleMutexLock             m_PendingMutex;
+  ConditionVariable::Pointer  m_PendingCondition;
+  BufferType                  m_Pending;
+  bool                        m_HasPending;
+  bool                        m_Stopping;
+
+  /** First failure of the writing thread, thrown by Stop() */
+  bool                        m_HasWriteError;
+  ExceptionObject             m_WriteError;
+
+  /** Serializes the writes to FileName */
+  SimpleFastMutexLock     m_FileMutex;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetCheckpointWriter.hxx"
+#endif
+
+#endif // __itkLevelSetCheckpointWriter_h
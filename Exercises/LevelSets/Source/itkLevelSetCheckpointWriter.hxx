@@ -0,0 +1,436 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetCheckpointWriter_hxx
+#define __itkLevelSetCheckpointWriter_hxx
+
+#include "itkLevelSetCheckpointWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace itk
+{
+template< class TLevelSet >
+LevelSetCheckpointWriter< TLevelSet >
+::LevelSetCheckpointWriter() :
+  m_CheckpointPeriod( 50 ),
+  m_IterationOffset( 0 ),
+  m_NumberOfIterations( 0 ),
+  m_NumberOfCheckpointsWritten( 0 ),
+  m_WriterThreadId( 0 ),
+  m_WriterThreadRunning( false ),
+  m_HasPending( false ),
+  m_Stopping( false ),
+  m_HasWriteError( false )
+{
+  this->m_Threader = MultiThreader::New();
+  this->m_PendingCondition = ConditionVariable::New();
+}
+
+template< class TLevelSet >
+LevelSetCheckpointWriter< TLevelSet >
+::~LevelSetCheckpointWriter()
+{
+  if( this->m_WriterThreadRunning )
+    {
+    this->StopWriterThread();
+    }
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointWriter< TLevelSet >
+::AddLevelSet( IdentifierType iId, LevelSetType* iLevelSet )
+{
+  if( iLevelSet == NULL )
+    {
+    itkExceptionMacro( << "iLevelSet is NULL" );
+    }
+  this->m_LevelSets.push_back( LevelSetEntryType( iId, iLevelSet ) );
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointWriter< TLevelSet >
+::AddTermState( IdentifierType iId, TermStateType* iTerm )
+{
+  if( iTerm == NULL )
+    {
+    itkExceptionMacro( << "iTerm is NULL" );
+    }
+  this->m_TermStates.push_back( TermStateEntryType( iId, iTerm ) );
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointWriter< TLevelSet >
+::Start()
+{
+  if( this->m_FileName.empty() )
+    {
+    itkExceptionMacro( << "FileName is empty" );
+    }
+  if( this->m_WriterThreadRunning )
+    {
+    return;
+    }
+
+  this->m_NumberOfIterations = 0;
+  this->m_Stopping = false;
+  this->m_HasWriteError = false;
+  this->m_WriterThreadId = this->m_Threader->SpawnThread( WriterThreadCallback, this );
+  this->m_WriterThreadRunning = true;
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointWriter< TLevelSet >
+::Stop()
+{
+  if( !this->m_WriterThreadRunning )
+    {
+    return;
+    }
+
+  this->StopWriterThread();
+  this->m_WriterThreadRunning = false;
+
+  // The writing thread has returned: its failure can be read unlocked.
+  if( this->m_HasWriteError )
+    {
+    this->m_HasWriteError = false;
+    throw this->m_WriteError;
+    }
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointWriter< TLevelSet >
+::StopWriterThread()
+{
+  // The writing thread checks m_HasPending before m_Stopping, under the
+  // same lock: it writes the pending checkpoint before it returns.
+  this->m_PendingMutex.Lock();
+  this->m_Stopping = true;
+  this->m_PendingCondition->Signal();
+  this->m_PendingMutex.Unlock();
+
+  this->m_Threader->TerminateThread( this->m_WriterThreadId );
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointWriter< TLevelSet >
+::Write()
+{
+  BufferType buffer;
+  this->Encode( this->m_IterationOffset + this->m_NumberOfIterations, buffer );
+  this->WriteFile( buffer );
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointWriter< TLevelSet >
+::Encode( IdentifierType iIteration, BufferType& oBuffer ) const
+{
+  oBuffer.clear();
+
+  const char* magic = LevelSetCheckpoint::GetFileMagic();
+  oBuffer.insert( oBuffer.end(), magic, magic + 8 );
+
+  LevelSetCheckpoint::EncodeRaw( static_cast< uint32_t >( ImageDimension ), oBuffer );
+  LevelSetCheckpoint::EncodeRaw( static_cast< uint32_t >( sizeof( LevelSetOutputType ) ), oBuffer );
+  LevelSetCheckpoint::EncodeRaw( static_cast< uint64_t >( iIteration ), oBuffer );
+  LevelSetCheckpoint::EncodeRaw( static_cast< uint32_t >( this->m_LevelSets.size() ), oBuffer );
+
+  // payload size, known once the level-sets are encoded
+  const size_t payloadSizePosition = oBuffer.size();
+  LevelSetCheckpoint::EncodeRaw( static_cast< uint64_t >( 0 ), oBuffer );
+
+  for( typename LevelSetListType::const_iterator it = this->m_LevelSets.begin();
+       it != this->m_LevelSets.end(); ++it )
+    {
+    this->EncodeLevelSet( it->first, it->second, oBuffer );
+    }
+
+  LevelSetLayerTrace::EncodeVarint( static_cast< OffsetType >( this->m_TermStates.size() ), oBuffer );
+
+  BufferType state;
+  for( typename TermStateListType::const_iterator it = this->m_TermStates.begin();
+       it != this->m_TermStates.end(); ++it )
+    {
+    state.clear();
+    it->second->EncodeState( state );
+
+    LevelSetLayerTrace::EncodeVarint( static_cast< OffsetType >( it->first ), oBuffer );
+    LevelSetLayerTrace::EncodeVarint( static_cast< OffsetType >( state.size() ), oBuffer );
+    oBuffer.insert( oBuffer.end(), state.begin(), state.end() );
+    }
+
+  const uint64_t payloadSize = static_cast< uint64_t >( oBuffer.size() - LevelSetCheckpoint::GetHeaderSize() );
+  std::memcpy( &oBuffer[payloadSizePosition], &payloadSize, sizeof( uint64_t ) );
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointWriter< TLevelSet >
+::EncodeLevelSet( IdentifierType iId, LevelSetType* iLevelSet, BufferType& ioBuffer ) const
+{
+  LabelMapType* labelMap = iLevelSet->GetLabelMap();
+  const RegionType region = labelMap->GetLargestPossibleRegion();
+  const IndexType & start = region.GetIndex();
+
+  LevelSetLayerTrace::EncodeVarint( static_cast< OffsetType >( iId ), ioBuffer );
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    LevelSetCheckpoint::EncodeRaw( static_cast< int64_t >( start[dim] ), ioBuffer );
+    }
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    LevelSetCheckpoint::EncodeRaw( static_cast< uint64_t >( region.GetSize()[dim] ), ioBuffer );
+    }
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    LevelSetCheckpoint::EncodeRaw( static_cast< double >( labelMap->GetSpacing()[dim] ), ioBuffer );
+    }
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    LevelSetCheckpoint::EncodeRaw( static_cast< double >( labelMap->GetOrigin()[dim] ), ioBuffer );
+    }
+  for( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    for( unsigned int j = 0; j < ImageDimension; j++ )
+      {
+      LevelSetCheckpoint::EncodeRaw( static_cast< double >( labelMap->GetDirection()[i][j] ), ioBuffer );
+      }
+    }
+
+  OffsetType strides[ImageDimension];
+  OffsetType stride = 1;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    strides[dim] = stride;
+    stride *= static_cast< OffsetType >( region.GetSize()[dim] );
+    }
+
+  // Layers: sorted offsets of the nodes, then their values in that order
+  typedef typename LayerTraitsType::LayerIdListType LayerIdListType;
+  const LayerIdListType layerIds = LayerTraitsType::GetLayerIds();
+
+  LevelSetLayerTrace::EncodeVarint( static_cast< OffsetType >( layerIds.size() ), ioBuffer );
+
+  SortedLayerType sortedLayer;
+  sortedLayer.SetRegion( region );
+
+  for( typename LayerIdListType::const_iterator lIt = layerIds.begin(); lIt != layerIds.end(); ++lIt )
+    {
+    sortedLayer.Assign( iLevelSet, *lIt );
+
+    const typename SortedLayerType::OffsetListType & nodeOffsets = sortedLayer.GetOffsets();
+    const typename SortedLayerType::ValueListType & nodeValues = sortedLayer.GetValues();
+
+    LevelSetCheckpoint::EncodeRaw( static_cast< int8_t >( *lIt ), ioBuffer );
+    LevelSetLayerTrace::EncodeOffsets( nodeOffsets.begin(), nodeOffsets.end(), ioBuffer );
+    for( size_t i = 0; i < nodeValues.size(); i++ )
+      {
+      LevelSetCheckpoint::EncodeRaw( nodeValues[i], ioBuffer );
+      }
+    }
+
+  std::vector< OffsetType > offsets;
+
+  // Label objects: sorted offsets of the line starts, then their lengths
+  typedef typename LabelMapType::LabelObjectVectorType  LabelObjectVectorType;
+  typedef typename LabelMapType::LabelObjectType        LabelObjectType;
+  typedef typename LabelObjectType::LineType            LineType;
+
+  const LabelObjectVectorType labelObjects = labelMap->GetLabelObjects();
+  LevelSetLayerTrace::EncodeVarint( static_cast< OffsetType >( labelObjects.size() ), ioBuffer );
+
+  typedef std::pair< OffsetType, OffsetType > LineEntryType;
+  std::vector< LineEntryType > lines;
+
+  for( typename LabelObjectVectorType::const_iterator oIt = labelObjects.begin();
+       oIt != labelObjects.end(); ++oIt )
+    {
+    lines.clear();
+    for( SizeValueType l = 0; l < ( *oIt )->GetNumberOfLines(); l++ )
+      {
+      const LineType & line = ( *oIt )->GetLine( l );
+      OffsetType offset = 0;
+      for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+        {
+        offset += static_cast< OffsetType >( line.GetIndex()[dim] - start[dim] ) * strides[dim];
+        }
+      lines.push_back( LineEntryType( offset, static_cast< OffsetType >( line.GetLength() ) ) );
+      }
+    std::sort( lines.begin(), lines.end() );
+
+    offsets.resize( lines.size() );
+    for( size_t i = 0; i < lines.size(); i++ )
+      {
+      offsets[i] = lines[i].first;
+      }
+
+    LevelSetCheckpoint::EncodeRaw( static_cast< int8_t >( ( *oIt )->GetLabel() ), ioBuffer );
+    LevelSetLayerTrace::EncodeOffsets( offsets.begin(), offsets.end(), ioBuffer );
+    for( size_t i = 0; i < lines.size(); i++ )
+      {
+      LevelSetLayerTrace::EncodeVarint( lines[i].second, ioBuffer );
+      }
+    }
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointWriter< TLevelSet >
+::WriteFile( const BufferType& iBuffer )
+{
+  this->m_FileMutex.Lock();
+
+  const std::string temporaryFileName = this->m_FileName + ".tmp";
+
+  std::ofstream file( temporaryFileName.c_str(), std::ios::binary | std::ios::trunc );
+  if( iBuffer.size() > 0 )
+    {
+    file.write( reinterpret_cast< const char* >( &iBuffer[0] ), iBuffer.size() );
+    }
+  file.close();
+
+  bool written = !file.fail();
+  if( written )
+    {
+#ifdef _WIN32
+    // rename does not replace an existing file on Windows
+    std::remove( this->m_FileName.c_str() );
+#endif
+    written = ( std::rename( temporaryFileName.c_str(), this->m_FileName.c_str() ) == 0 );
+    }
+
+  if( written )
+    {
+    ++this->m_NumberOfCheckpointsWritten;
+    }
+
+  this->m_FileMutex.Unlock();
+
+  if( !written )
+    {
+    itkExceptionMacro( << "Could not write the checkpoint " << this->m_FileName );
+    }
+}
+
+template< class TLevelSet >
+ITK_THREAD_RETURN_TYPE
+LevelSetCheckpointWriter< TLevelSet >
+::WriterThreadCallback( void* arg )
+{
+  MultiThreader::ThreadInfoStruct* info = static_cast< MultiThreader::ThreadInfoStruct* >( arg );
+  Self* self = static_cast< Self* >( info->UserData );
+
+  BufferType buffer;
+
+  self->m_PendingMutex.Lock();
+  while( true )
+    {
+    if( self->m_HasPending )
+      {
+      buffer.swap( self->m_Pending );
+      self->m_HasPending = false;
+      self->m_PendingMutex.Unlock();
+
+      try
+        {
+        self->WriteFile( buffer );
+        }
+      catch( ExceptionObject& err )
+        {
+        // The next checkpoint may succeed and the evolution goes on; the
+        // first failure is thrown by Stop().
+        self->m_PendingMutex.Lock();
+        if( !self->m_HasWriteError )
+          {
+          self->m_WriteError = err;
+          self->m_HasWriteError = true;
+          }
+        self->m_PendingMutex.Unlock();
+        }
+
+      self->m_PendingMutex.Lock();
+      continue;
+      }
+
+    // nothing pending: return once stopped, sleep otherwise
+    if( self->m_Stopping )
+      {
+      break;
+      }
+    self->m_PendingCondition->Wait( &self->m_PendingMutex );
+    }
+  self->m_PendingMutex.Unlock();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointWriter< TLevelSet >
+::Execute( const Object* itkNotUsed( caller ), const EventObject& event )
+{
+  if( !IterationEvent().CheckEvent( &event ) )
+    {
+    return;
+    }
+
+  ++this->m_NumberOfIterations;
+  if( ( this->m_CheckpointPeriod == 0 ) ||
+      ( this->m_NumberOfIterations % this->m_CheckpointPeriod != 0 ) )
+    {
+    return;
+    }
+
+  BufferType buffer;
+  this->Encode( this->m_IterationOffset + this->m_NumberOfIterations, buffer );
+
+  if( !this->m_WriterThreadRunning )
+    {
+    this->WriteFile( buffer );
+    return;
+    }
+
+  // Replaces a checkpoint the writing thread has not taken yet.
+  this->m_PendingMutex.Lock();
+  this->m_Pending.swap( buffer );
+  this->m_HasPending = true;
+  this->m_PendingCondition->Signal();
+  this->m_PendingMutex.Unlock();
+}
+
+template< class TLevelSet >
+void
+LevelSetCheckpointWriter< TLevelSet >
+::Execute( Object* caller, const EventObject& event )
+{
+  this->Execute( const_cast< const Object* >( caller ), event );
+}
+
+}
+#endif // __itkLevelSetCheckpointWriter_hxx
@@ -0,0 +1,120 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetDomainPartition_h
+#define __itkLevelSetDomainPartition_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+
+#include <map>
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class LevelSetDomainPartition
+ *  \brief Split the level-sets of a domain map into independent groups.
+ *
+ *  Two level-sets are coupled when they are both active on some pixel,
+ *  i.e. when they appear in the identifier list of the same domain of the
+ *  map computed by LevelSetDomainMapImageFilter. The groups are the
+ *  connected components of this relation, found with a union-find over
+ *  the identifier lists of the domains: the cost depends on the number of
+ *  domains, not on the number of pixels.
+ *
+ *  The domains of level-sets of different groups never overlap. As long
+ *  as each level-set is kept in the domains of its group, e.g. by
+ *  restricting its label map to their bounding region when the bounding
+ *  regions of the groups are disjoint, the terms coupling the level-sets
+ *  never relate two groups, and each group can be evolved on its own,
+ *  concurrently with the others. Groups only appear when some domains are
+ *  disjoint from all the others: domains which chain through shared
+ *  pixels form a single group. Each evolution then computes its own time
+ *  step, which may be larger than the one of a single evolution of all the
+ *  level-sets.
+ *
+ *  \tparam TDomainMapImageFilter LevelSetDomainMapImageFilter type
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TDomainMapImageFilter >
+class LevelSetDomainPartition : public Object
+{
+public:
+  typedef LevelSetDomainPartition     Self;
+  typedef Object                      Superclass;
+  typedef SmartPointer< Self >        Pointer;
+  typedef SmartPointer< const Self >  ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetDomainPartition, Object );
+
+  typedef TDomainMapImageFilter                             DomainMapImageFilterType;
+  typedef typename DomainMapImageFilterType::DomainMapType  DomainMapType;
+  typedef typename DomainMapImageFilterType::InputImageType IdListImageType;
+  typedef typename IdListImageType::PixelType               IdListType;
+
+  typedef std::vector< IdentifierType >                     IdentifierListType;
+
+  /** Domain map to partition; it must be up to date */
+  itkSetConstObjectMacro( DomainMapFilter, DomainMapImageFilterType );
+  itkGetConstObjectMacro( DomainMapFilter, DomainMapImageFilterType );
+
+  /** Compute the groups */
+  void Update();
+
+  /** Number of independent groups of level-sets */
+  SizeValueType GetNumberOfGroups() const { return this->m_Groups.size(); }
+
+  /** Identifiers of the level-sets of a group, as they appear in the
+   * identifier lists, sorted. Groups are sorted by their first identifier. */
+  const IdentifierListType & GetGroup( SizeValueType iGroup ) const
+    {
+    return this->m_Groups[iGroup];
+    }
+
+protected:
+  LevelSetDomainPartition() {}
+  virtual ~LevelSetDomainPartition() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  typedef std::map< IdentifierType, IdentifierType >  ParentMapType;
+
+  /** Representative of the group of iId */
+  static IdentifierType FindRoot( ParentMapType& ioParents, IdentifierType iId );
+
+private:
+  LevelSetDomainPartition( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  typename DomainMapImageFilterType::ConstPointer m_DomainMapFilter;
+
+  std::vector< IdentifierListType >   m_Groups;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetDomainPartition.hxx"
+#endif
+
+#endif // __itkLevelSetDomainPartition_h
@@ -0,0 +1,127 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetDomainPartition_hxx
+#define __itkLevelSetDomainPartition_hxx
+
+#include "itkLevelSetDomainPartition.h"
+
+#include <algorithm>
+
+namespace itk
+{
+template< class TDomainMapImageFilter >
+IdentifierType
+LevelSetDomainPartition< TDomainMapImageFilter >
+::FindRoot( ParentMapType& ioParents, IdentifierType iId )
+{
+  IdentifierType root = iId;
+  while( ioParents[root] != root )
+    {
+    root = ioParents[root];
+    }
+
+  // path compression
+  while( ioParents[iId] != root )
+    {
+    const IdentifierType next = ioParents[iId];
+    ioParents[iId] = root;
+    iId = next;
+    }
+
+  return root;
+}
+
+template< class TDomainMapImageFilter >
+void
+LevelSetDomainPartition< TDomainMapImageFilter >
+::Update()
+{
+  if( this->m_DomainMapFilter.IsNull() )
+    {
+    itkExceptionMacro( << "m_DomainMapFilter is NULL" );
+    }
+
+  this->m_Groups.clear();
+
+  const DomainMapType & domainMap = this->m_DomainMapFilter->GetDomainMap();
+
+  // Join the level-sets listed in the same domain.
+  ParentMapType parents;
+
+  for( typename DomainMapType::const_iterator dIt = domainMap.begin(); dIt != domainMap.end(); ++dIt )
+    {
+    const IdListType* idList = dIt->second.GetIdList();
+    if( idList->empty() )
+      {
+      continue;
+      }
+
+    for( typename IdListType::const_iterator lIt = idList->begin(); lIt != idList->end(); ++lIt )
+      {
+      parents.insert( typename ParentMapType::value_type( *lIt, *lIt ) );
+      }
+
+    const IdentifierType first = FindRoot( parents, idList->front() );
+    for( typename IdListType::const_iterator lIt = idList->begin(); lIt != idList->end(); ++lIt )
+      {
+      const IdentifierType root = FindRoot( parents, *lIt );
+      if( root != first )
+        {
+        // the smallest identifier represents the group
+        parents[std::max( root, first )] = std::min( root, first );
+        }
+      }
+    }
+
+  // The map visits the identifiers in increasing order: a group is created
+  // by its smallest identifier, which is its own root.
+  std::map< IdentifierType, SizeValueType > groupOfRoot;
+
+  for( typename ParentMapType::const_iterator it = parents.begin(); it != parents.end(); ++it )
+    {
+    const IdentifierType root = FindRoot( parents, it->first );
+
+    typename std::map< IdentifierType, SizeValueType >::const_iterator gIt = groupOfRoot.find( root );
+    if( gIt == groupOfRoot.end() )
+      {
+      gIt = groupOfRoot.insert( std::make_pair( root, this->m_Groups.size() ) ).first;
+      this->m_Groups.push_back( IdentifierListType() );
+      }
+    this->m_Groups[gIt->second].push_back( it->first );
+    }
+
+  this->Modified();
+}
+
+template< class TDomainMapImageFilter >
+void
+LevelSetDomainPartition< TDomainMapImageFilter >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfGroups: " << this->m_Groups.size() << std::endl;
+  for( size_t i = 0; i < this->m_Groups.size(); i++ )
+    {
+    os << indent << "Group " << i << ": " << this->m_Groups[i].size()
+       << " level-set(s)" << std::endl;
+    }
+}
+
+}
+#endif // __itkLevelSetDomainPartition_hxx
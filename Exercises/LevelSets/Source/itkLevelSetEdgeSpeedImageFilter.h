@@ -0,0 +1,147 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEdgeSpeedImageFilter_h
+#define __itkLevelSetEdgeSpeedImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+namespace itk
+{
+namespace Functor
+{
+/**
+ *  \class LevelSetEdgeSpeed
+ *  \brief Edge stopping function 1 / ( 1 + ( x / K )^2 ) of a gradient
+ *  magnitude x, for an edge contrast K.
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TInput, class TOutput >
+class LevelSetEdgeSpeed
+{
+public:
+  LevelSetEdgeSpeed() : m_InverseSquaredContrast( 1. ) {}
+  ~LevelSetEdgeSpeed() {}
+
+  void SetEdgeContrast( const double& iContrast )
+    {
+    this->m_InverseSquaredContrast = 1. / ( iContrast * iContrast );
+    }
+
+  bool operator != ( const LevelSetEdgeSpeed& iOther ) const
+    {
+    return this->m_InverseSquaredContrast != iOther.m_InverseSquaredContrast;
+    }
+
+  bool operator == ( const LevelSetEdgeSpeed& iOther ) const
+    {
+    return !( *this != iOther );
+    }
+
+  inline TOutput operator()( const TInput& iGradientMagnitude ) const
+    {
+    const double x = static_cast< double >( iGradientMagnitude );
+    return static_cast< TOutput >( 1. / ( 1. + x * x * this->m_InverseSquaredContrast ) );
+    }
+
+private:
+  double m_InverseSquaredContrast;
+};
+}
+
+/**
+ *  \class LevelSetEdgeSpeedImageFilter
+ *  \brief Compute the edge speed image of LevelSetEquationEdgeSpeedTerm.
+ *
+ *  The speed is 1 / ( 1 + ( |grad G_sigma * I| / K )^2 ): close to 1 in
+ *  homogeneous regions, close to 0 on the edges of the input. The gradient
+ *  magnitude is computed by GradientMagnitudeRecursiveGaussianImageFilter
+ *  and mapped to the speed by a UnaryFunctorImageFilter, both threaded.
+ *
+ *  If EdgeContrast K is not positive, the mean gradient magnitude of the
+ *  input is used.
+ *
+ *  The speed image is computed once, before the evolution, and is then
+ *  only read by the terms.
+ *
+ *  \tparam TInputImage Input image type
+ *  \tparam TOutputImage Real speed image type
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TInputImage, class TOutputImage >
+class LevelSetEdgeSpeedImageFilter :
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  typedef LevelSetEdgeSpeedImageFilter                      Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage >   Superclass;
+  typedef SmartPointer< Self >                              Pointer;
+  typedef SmartPointer< const Self >                        ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetEdgeSpeedImageFilter, ImageToImageFilter );
+
+  typedef TInputImage                           InputImageType;
+  typedef TOutputImage                          OutputImageType;
+  typedef typename OutputImageType::PixelType   OutputPixelType;
+
+  /** Scale of the Gaussian derivatives, in physical units. Default is
+   * 1. */
+  itkSetMacro( Sigma, double );
+  itkGetConstMacro( Sigma, double );
+
+  /** Gradient magnitude at which the speed is 1/2. Default is 0, i.e. the
+   * mean gradient magnitude of the input. */
+  itkSetMacro( EdgeContrast, double );
+  itkGetConstMacro( EdgeContrast, double );
+
+  /** Edge contrast used by the last update */
+  itkGetConstMacro( ComputedEdgeContrast, double );
+
+protected:
+  LevelSetEdgeSpeedImageFilter();
+  virtual ~LevelSetEdgeSpeedImageFilter() {}
+
+  /** The recursive Gaussian filters need the whole input */
+  void GenerateInputRequestedRegion();
+  void EnlargeOutputRequestedRegion( DataObject* output );
+
+  void GenerateData();
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+  LevelSetEdgeSpeedImageFilter( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  double m_Sigma;
+  double m_EdgeContrast;
+  double m_ComputedEdgeContrast;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetEdgeSpeedImageFilter.hxx"
+#endif
+
+#endif // __itkLevelSetEdgeSpeedImageFilter_h
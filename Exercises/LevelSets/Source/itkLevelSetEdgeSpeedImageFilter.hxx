@@ -0,0 +1,119 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEdgeSpeedImageFilter_hxx
+#define __itkLevelSetEdgeSpeedImageFilter_hxx
+
+#include "itkLevelSetEdgeSpeedImageFilter.h"
+
+#include "itkGradientMagnitudeRecursiveGaussianImageFilter.h"
+#include "itkStatisticsImageFilter.h"
+#include "itkUnaryFunctorImageFilter.h"
+
+namespace itk
+{
+template< class TInputImage, class TOutputImage >
+LevelSetEdgeSpeedImageFilter< TInputImage, TOutputImage >
+::LevelSetEdgeSpeedImageFilter() :
+  m_Sigma( 1.0 ),
+  m_EdgeContrast( 0.0 ),
+  m_ComputedEdgeContrast( 0.0 )
+{
+}
+
+template< class TInputImage, class TOutputImage >
+void
+LevelSetEdgeSpeedImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType* input = const_cast< InputImageType* >( this->GetInput() );
+  if( input )
+    {
+    input->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+LevelSetEdgeSpeedImageFilter< TInputImage, TOutputImage >
+::EnlargeOutputRequestedRegion( DataObject* output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template< class TInputImage, class TOutputImage >
+void
+LevelSetEdgeSpeedImageFilter< TInputImage, TOutputImage >
+::GenerateData()
+{
+  typedef GradientMagnitudeRecursiveGaussianImageFilter< InputImageType, OutputImageType >
+                                                              GradientFilterType;
+  typedef Functor::LevelSetEdgeSpeed< OutputPixelType, OutputPixelType >
+                                                              SpeedFunctorType;
+  typedef UnaryFunctorImageFilter< OutputImageType, OutputImageType, SpeedFunctorType >
+                                                              SpeedFilterType;
+
+  typename GradientFilterType::Pointer gradient = GradientFilterType::New();
+  gradient->SetInput( this->GetInput() );
+  gradient->SetSigma( this->m_Sigma );
+  gradient->SetNumberOfThreads( this->GetNumberOfThreads() );
+  gradient->Update();
+
+  this->m_ComputedEdgeContrast = this->m_EdgeContrast;
+  if( this->m_ComputedEdgeContrast <= 0. )
+    {
+    typedef StatisticsImageFilter< OutputImageType > StatisticsFilterType;
+    typename StatisticsFilterType::Pointer statistics = StatisticsFilterType::New();
+    statistics->SetInput( gradient->GetOutput() );
+    statistics->SetNumberOfThreads( this->GetNumberOfThreads() );
+    statistics->Update();
+
+    this->m_ComputedEdgeContrast = statistics->GetMean();
+    if( this->m_ComputedEdgeContrast <= 0. )
+      {
+      // constant input: the speed is 1 everywhere
+      this->m_ComputedEdgeContrast = 1.;
+      }
+    }
+
+  typename SpeedFilterType::Pointer speed = SpeedFilterType::New();
+  speed->SetInput( gradient->GetOutput() );
+  speed->GetFunctor().SetEdgeContrast( this->m_ComputedEdgeContrast );
+  speed->SetNumberOfThreads( this->GetNumberOfThreads() );
+  speed->GraftOutput( this->GetOutput() );
+  speed->Update();
+
+  this->GraftOutput( speed->GetOutput() );
+}
+
+template< class TInputImage, class TOutputImage >
+void
+LevelSetEdgeSpeedImageFilter< TInputImage, TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Sigma: " << this->m_Sigma << std::endl;
+  os << indent << "EdgeContrast: " << this->m_EdgeContrast << std::endl;
+  os << indent << "ComputedEdgeContrast: " << this->m_ComputedEdgeContrast << std::endl;
+}
+
+}
+#endif // __itkLevelSetEdgeSpeedImageFilter_hxx
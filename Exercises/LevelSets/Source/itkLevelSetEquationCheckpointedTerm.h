@@ -0,0 +1,130 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef __itkLevelSetEquationCheckpointedTerm_h
+#define __itkLevelSetEquationCheckpointedTerm_h
+
+#include "itkLevelSetCheckpointTermState.h"
+
+namespace itk
+{
+/**
+ *  \class LevelSetEquationCheckpointedTerm
+ *  \brief Chan and Vese term whose accumulated state is checkpointed.
+ *
+ *  Behaves as TTerm, and saves and restores its total of the input values,
+ *  its total of the Heaviside, its mean and its CFL contribution through
+ *  LevelSetCheckpointTermState.
+ *
+ *  The evolution initializes the terms when it starts: InitializeParameters()
+ *  resets the totals, which are accumulated over the image, and Update()
+ *  derives the mean from them. A restored state is kept until this first
+ *  Update(), which sets it as is instead.
+ *
+ *  \tparam TTerm LevelSetEquationChanAndVeseInternalTerm or
+ *  LevelSetEquationChanAndVeseExternalTerm
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TTerm >
+class LevelSetEquationCheckpointedTerm : public TTerm, public LevelSetCheckpointTermState
+{
+public:
+  typedef LevelSetEquationCheckpointedTerm  Self;
+  typedef TTerm                             Superclass;
+  typedef SmartPointer< Self >              Pointer;
+  typedef SmartPointer< const Self >        ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetEquationCheckpointedTerm, TTerm );
+
+  typedef typename Superclass::InputPixelRealType       InputPixelRealType;
+  typedef typename Superclass::LevelSetOutputRealType   LevelSetOutputRealType;
+  typedef LevelSetCheckpointTermState::BufferType       BufferType;
+
+  virtual void EncodeState( BufferType& ioBuffer ) const
+    {
+    LevelSetCheckpoint::EncodeRaw( this->m_TotalValue, ioBuffer );
+    LevelSetCheckpoint::EncodeRaw( this->m_TotalH, ioBuffer );
+    LevelSetCheckpoint::EncodeRaw( this->m_Mean, ioBuffer );
+    LevelSetCheckpoint::EncodeRaw( this->m_CFLContribution, ioBuffer );
+    }
+
+  virtual void DecodeState( const unsigned char* iBegin, const unsigned char* iEnd )
+    {
+    const unsigned char* position = iBegin;
+    LevelSetCheckpoint::DecodeRaw( position, iEnd, this->m_RestoredTotalValue );
+    LevelSetCheckpoint::DecodeRaw( position, iEnd, this->m_RestoredTotalH );
+    LevelSetCheckpoint::DecodeRaw( position, iEnd, this->m_RestoredMean );
+    LevelSetCheckpoint::DecodeRaw( position, iEnd, this->m_RestoredCFLContribution );
+    if( position != iEnd )
+      {
+      itkExceptionMacro( << "Corrupted level-set checkpoint: unexpected term state size" );
+      }
+    this->m_HasRestoredState = true;
+    }
+
+  virtual void InitializeParameters()
+    {
+    Superclass::InitializeParameters();
+    this->m_Initializing = true;
+    }
+
+  virtual void Update()
+    {
+    if( this->m_Initializing && this->m_HasRestoredState )
+      {
+      this->m_TotalValue = this->m_RestoredTotalValue;
+      this->m_TotalH = this->m_RestoredTotalH;
+      this->m_Mean = this->m_RestoredMean;
+      this->m_CFLContribution = this->m_RestoredCFLContribution;
+      this->m_HasRestoredState = false;
+      this->m_Initializing = false;
+      return;
+      }
+    this->m_Initializing = false;
+    Superclass::Update();
+    }
+
+protected:
+  LevelSetEquationCheckpointedTerm() :
+    m_HasRestoredState( false ),
+    m_Initializing( false )
+    {}
+
+  virtual ~LevelSetEquationCheckpointedTerm() {}
+
+private:
+  LevelSetEquationCheckpointedTerm( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  bool                    m_HasRestoredState;
+  bool                    m_Initializing;
+
+  InputPixelRealType      m_RestoredTotalValue;
+  LevelSetOutputRealType  m_RestoredTotalH;
+  InputPixelRealType      m_RestoredMean;
+  LevelSetOutputRealType  m_RestoredCFLContribution;
+};
+}
+
+#endif // __itkLevelSetEquationCheckpointedTerm_h
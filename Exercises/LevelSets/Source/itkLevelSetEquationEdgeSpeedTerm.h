@@ -0,0 +1,119 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEquationEdgeSpeedTerm_h
+#define __itkLevelSetEquationEdgeSpeedTerm_h
+
+#include "itkLevelSetEquationTermBase.h"
+#include "itkImage.h"
+
+namespace itk
+{
+/**
+ *  \class LevelSetEquationEdgeSpeedTerm
+ *  \brief Geodesic propagation term driven by a precomputed speed image.
+ *
+ *  \f$ -g(p) \cdot | \nabla \phi(p) | \f$, where g is a speed image, e.g.
+ *  the output of LevelSetEdgeSpeedImageFilter, close to 1 in homogeneous
+ *  regions and to 0 on edges: with a positive coefficient the front grows
+ *  and stops on the edges of the input.
+ *
+ *  The speed image is computed once, before the evolution, and only read
+ *  by the term. It may thus be shared by the terms of any number of
+ *  level-sets, equations and threads: the value at a node is a single
+ *  look-up times the upwind norm of the gradient, which comes from the
+ *  forward and backward gradients shared by the terms of the node.
+ *
+ *  \tparam TInput Input image type
+ *  \tparam TLevelSetContainer Level-set container type
+ *  \tparam TSpeedImage Real image type of the speed, on the grid of the
+ *  level-sets
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TInput, class TLevelSetContainer,
+          class TSpeedImage = Image< float, TInput::ImageDimension > >
+class LevelSetEquationEdgeSpeedTerm :
+  public LevelSetEquationTermBase< TInput, TLevelSetContainer >
+{
+public:
+  typedef LevelSetEquationEdgeSpeedTerm                           Self;
+  typedef LevelSetEquationTermBase< TInput, TLevelSetContainer >  Superclass;
+  typedef SmartPointer< Self >                                    Pointer;
+  typedef SmartPointer< const Self >                              ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetEquationEdgeSpeedTerm, LevelSetEquationTermBase );
+
+  typedef typename Superclass::InputImageType           InputImageType;
+  typedef typename Superclass::LevelSetOutputRealType   LevelSetOutputRealType;
+  typedef typename Superclass::LevelSetInputIndexType   LevelSetInputIndexType;
+  typedef typename Superclass::LevelSetGradientType     LevelSetGradientType;
+  typedef typename Superclass::LevelSetDataType         LevelSetDataType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, InputImageType::ImageDimension );
+
+  typedef TSpeedImage                                   SpeedImageType;
+  typedef typename SpeedImageType::ConstPointer         SpeedImageConstPointer;
+
+  /** Precomputed speed image, shared read-only */
+  void SetSpeedImage( const SpeedImageType* iSpeedImage );
+  itkGetConstObjectMacro( SpeedImage, SpeedImageType );
+
+  /** Check that the speed image is set */
+  virtual void InitializeParameters();
+
+  /** Nothing to do: the term has no statistics */
+  virtual void Initialize( const LevelSetInputIndexType& ) {}
+  virtual void Update() {}
+  virtual void UpdatePixel( const LevelSetInputIndexType&,
+                            const LevelSetOutputRealType&,
+                            const LevelSetOutputRealType& ) {}
+
+protected:
+  LevelSetEquationEdgeSpeedTerm();
+  virtual ~LevelSetEquationEdgeSpeedTerm() {}
+
+  /** Value of the term at iP */
+  virtual LevelSetOutputRealType Value( const LevelSetInputIndexType& iP );
+
+  /** Value of the term at iP, from the gradients of the level-set at iP */
+  virtual LevelSetOutputRealType Value( const LevelSetInputIndexType& iP,
+                                        const LevelSetDataType& iData );
+
+  /** -iSpeed times the upwind norm of the gradient */
+  LevelSetOutputRealType UpwindValue( const LevelSetOutputRealType& iSpeed,
+                                      const LevelSetGradientType& iBackwardGradient,
+                                      const LevelSetGradientType& iForwardGradient ) const;
+
+private:
+  LevelSetEquationEdgeSpeedTerm( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  SpeedImageConstPointer  m_SpeedImage;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetEquationEdgeSpeedTerm.hxx"
+#endif
+
+#endif // __itkLevelSetEquationEdgeSpeedTerm_h
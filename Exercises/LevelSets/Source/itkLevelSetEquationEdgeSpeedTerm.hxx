@@ -0,0 +1,123 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEquationEdgeSpeedTerm_hxx
+#define __itkLevelSetEquationEdgeSpeedTerm_hxx
+
+#include "itkLevelSetEquationEdgeSpeedTerm.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+template< class TInput, class TLevelSetContainer, class TSpeedImage >
+LevelSetEquationEdgeSpeedTerm< TInput, TLevelSetContainer, TSpeedImage >
+::LevelSetEquationEdgeSpeedTerm()
+{
+  this->m_TermName = "Edge speed term";
+  this->m_RequiredData.insert( "BackwardGradient" );
+  this->m_RequiredData.insert( "ForwardGradient" );
+}
+
+template< class TInput, class TLevelSetContainer, class TSpeedImage >
+void
+LevelSetEquationEdgeSpeedTerm< TInput, TLevelSetContainer, TSpeedImage >
+::SetSpeedImage( const SpeedImageType* iSpeedImage )
+{
+  if( this->m_SpeedImage != iSpeedImage )
+    {
+    this->m_SpeedImage = iSpeedImage;
+    this->Modified();
+    }
+}
+
+template< class TInput, class TLevelSetContainer, class TSpeedImage >
+void
+LevelSetEquationEdgeSpeedTerm< TInput, TLevelSetContainer, TSpeedImage >
+::InitializeParameters()
+{
+  if( this->m_SpeedImage.IsNull() )
+    {
+    itkExceptionMacro( << "m_SpeedImage is NULL" );
+    }
+  this->SetUp();
+}
+
+template< class TInput, class TLevelSetContainer, class TSpeedImage >
+typename LevelSetEquationEdgeSpeedTerm< TInput, TLevelSetContainer, TSpeedImage >::LevelSetOutputRealType
+LevelSetEquationEdgeSpeedTerm< TInput, TLevelSetContainer, TSpeedImage >
+::UpwindValue( const LevelSetOutputRealType& iSpeed,
+               const LevelSetGradientType& iBackwardGradient,
+               const LevelSetGradientType& iForwardGradient ) const
+{
+  const LevelSetOutputRealType zero = NumericTraits< LevelSetOutputRealType >::Zero;
+
+  // the front moves outwards where the coefficient times the speed is
+  // positive: the differences are taken on the side it comes from
+  const bool outwards = ( this->m_Coefficient * iSpeed > zero );
+
+  LevelSetOutputRealType squaredNorm = zero;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    LevelSetOutputRealType backward = iBackwardGradient[dim];
+    LevelSetOutputRealType forward = iForwardGradient[dim];
+    if( outwards )
+      {
+      backward = std::max( backward, zero );
+      forward = std::min( forward, zero );
+      }
+    else
+      {
+      backward = std::min( backward, zero );
+      forward = std::max( forward, zero );
+      }
+    squaredNorm += backward * backward + forward * forward;
+    }
+
+  return -iSpeed * static_cast< LevelSetOutputRealType >( std::sqrt( squaredNorm ) );
+}
+
+template< class TInput, class TLevelSetContainer, class TSpeedImage >
+typename LevelSetEquationEdgeSpeedTerm< TInput, TLevelSetContainer, TSpeedImage >::LevelSetOutputRealType
+LevelSetEquationEdgeSpeedTerm< TInput, TLevelSetContainer, TSpeedImage >
+::Value( const LevelSetInputIndexType& iP )
+{
+  const LevelSetOutputRealType speed =
+    static_cast< LevelSetOutputRealType >( this->m_SpeedImage->GetPixel( iP ) );
+
+  return this->UpwindValue( speed,
+                            this->m_CurrentLevelSetPointer->EvaluateBackwardGradient( iP ),
+                            this->m_CurrentLevelSetPointer->EvaluateForwardGradient( iP ) );
+}
+
+template< class TInput, class TLevelSetContainer, class TSpeedImage >
+typename LevelSetEquationEdgeSpeedTerm< TInput, TLevelSetContainer, TSpeedImage >::LevelSetOutputRealType
+LevelSetEquationEdgeSpeedTerm< TInput, TLevelSetContainer, TSpeedImage >
+::Value( const LevelSetInputIndexType& iP, const LevelSetDataType& iData )
+{
+  const LevelSetOutputRealType speed =
+    static_cast< LevelSetOutputRealType >( this->m_SpeedImage->GetPixel( iP ) );
+
+  return this->UpwindValue( speed,
+                            iData.BackwardGradient.m_Value,
+                            iData.ForwardGradient.m_Value );
+}
+
+}
+#endif // __itkLevelSetEquationEdgeSpeedTerm_hxx
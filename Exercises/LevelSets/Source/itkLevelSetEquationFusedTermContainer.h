@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEquationFusedTermContainer_h
+#define __itkLevelSetEquationFusedTermContainer_h
+
+#include "itkLevelSetEquationTermContainer.h"
+
+namespace itk
+{
+/**
+ *  \class LevelSetEquationFusedTermContainer
+ *  \brief Term container computing the data shared by its terms at once.
+ *
+ *  Each term declares the data it requires at a node (value, gradients,
+ *  Hessian, Laplacian, gradient norm, mean curvature). This container
+ *  keeps the union of these requirements, reads the level-set values of
+ *  the stencil of the node once, derives every required quantity from
+ *  them by finite differences, and gives the filled LevelSetDataType to
+ *  all the terms. The level-set is read 1 + 2 * Dimension times per node,
+ *  plus 2 * Dimension * ( Dimension - 1 ) times when second derivatives
+ *  are required, whatever the number of terms.
+ *
+ *  It is used in place of LevelSetEquationTermContainer, as the term
+ *  container type of LevelSetEquationContainer.
+ *
+ *  \tparam TInputImage Input image type
+ *  \tparam TLevelSetContainer Level-set container type
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TInputImage, class TLevelSetContainer >
+class LevelSetEquationFusedTermContainer :
+  public LevelSetEquationTermContainer< TInputImage, TLevelSetContainer >
+{
+public:
+  typedef LevelSetEquationFusedTermContainer                            Self;
+  typedef LevelSetEquationTermContainer< TInputImage, TLevelSetContainer > Superclass;
+  typedef SmartPointer< Self >                                          Pointer;
+  typedef SmartPointer< const Self >                                    ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetEquationFusedTermContainer, LevelSetEquationTermContainer );
+
+  typedef typename Superclass::TermIdType               TermIdType;
+  typedef typename Superclass::TermType                 TermType;
+  typedef typename Superclass::LevelSetContainerType    LevelSetContainerType;
+  typedef typename Superclass::LevelSetType             LevelSetType;
+  typedef typename Superclass::LevelSetInputIndexType   LevelSetInputIndexType;
+  typedef typename Superclass::LevelSetOutputRealType   LevelSetOutputRealType;
+  typedef typename Superclass::LevelSetDataType         LevelSetDataType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, LevelSetType::Dimension );
+
+  /** Add a term, and its required data to the data computed per node */
+  void AddTerm( const TermIdType& iId, TermType* iTerm );
+
+  /** Update the terms, and the level-set and grid spacing used to compute
+   * the data */
+  void Update();
+
+  /** Fill ioData with the union of the data required by the terms */
+  void ComputeRequiredData( const LevelSetInputIndexType& iP, LevelSetDataType& ioData );
+
+  /** Evaluate the equation at iP, computing the shared data once */
+  LevelSetOutputRealType Evaluate( const LevelSetInputIndexType& iP );
+
+  /** Evaluate the equation at iP with data already computed */
+  LevelSetOutputRealType Evaluate( const LevelSetInputIndexType& iP,
+                                   const LevelSetDataType& iData );
+
+protected:
+  LevelSetEquationFusedTermContainer();
+  virtual ~LevelSetEquationFusedTermContainer() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Level-set of the current identifier, its region and the inverse of
+   * its spacing */
+  void CacheLevelSet();
+
+  /** Level-set value at iP, or iCenterValue outside of the level-set */
+  LevelSetOutputRealType EvaluateNeighbor( const LevelSetInputIndexType& iP,
+                                           const LevelSetOutputRealType& iCenterValue ) const
+    {
+    return this->m_Region.IsInside( iP ) ?
+      static_cast< LevelSetOutputRealType >( this->m_LevelSet->Evaluate( iP ) ) : iCenterValue;
+    }
+
+private:
+  LevelSetEquationFusedTermContainer( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  /** Union of the data required by the terms */
+  bool m_RequiresValue;
+  bool m_RequiresGradient;
+  bool m_RequiresForwardGradient;
+  bool m_RequiresBackwardGradient;
+  bool m_RequiresGradientNorm;
+  bool m_RequiresLaplacian;
+  bool m_RequiresHessian;
+  bool m_RequiresMeanCurvature;
+
+  typename LevelSetType::Pointer                  m_LevelSet;
+  typename LevelSetType::LabelMapType::RegionType m_Region;
+  LevelSetOutputRealType                          m_Scales[ImageDimension];
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetEquationFusedTermContainer.hxx"
+#endif
+
+#endif // __itkLevelSetEquationFusedTermContainer_h
@@ -0,0 +1,339 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEquationFusedTermContainer_hxx
+#define __itkLevelSetEquationFusedTermContainer_hxx
+
+#include "itkLevelSetEquationFusedTermContainer.h"
+#include "vnl/vnl_math.h"
+
+#include <cmath>
+
+namespace itk
+{
+template< class TInputImage, class TLevelSetContainer >
+LevelSetEquationFusedTermContainer< TInputImage, TLevelSetContainer >
+::LevelSetEquationFusedTermContainer() :
+  m_RequiresValue( false ),
+  m_RequiresGradient( false ),
+  m_RequiresForwardGradient( false ),
+  m_RequiresBackwardGradient( false ),
+  m_RequiresGradientNorm( false ),
+  m_RequiresLaplacian( false ),
+  m_RequiresHessian( false ),
+  m_RequiresMeanCurvature( false )
+{
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    this->m_Scales[dim] = NumericTraits< LevelSetOutputRealType >::One;
+    }
+}
+
+template< class TInputImage, class TLevelSetContainer >
+void
+LevelSetEquationFusedTermContainer< TInputImage, TLevelSetContainer >
+::AddTerm( const TermIdType& iId, TermType* iTerm )
+{
+  this->Superclass::AddTerm( iId, iTerm );
+
+  typedef typename TermType::RequiredDataType RequiredDataType;
+  const RequiredDataType & requiredData = iTerm->GetRequiredData();
+
+  for( typename RequiredDataType::const_iterator it = requiredData.begin();
+       it != requiredData.end(); ++it )
+    {
+    if( *it == "Value" )
+      {
+      this->m_RequiresValue = true;
+      }
+    else if( *it == "Gradient" )
+      {
+      this->m_RequiresGradient = true;
+      }
+    else if( *it == "ForwardGradient" )
+      {
+      this->m_RequiresForwardGradient = true;
+      }
+    else if( *it == "BackwardGradient" )
+      {
+      this->m_RequiresBackwardGradient = true;
+      }
+    else if( *it == "GradientNorm" )
+      {
+      this->m_RequiresGradientNorm = true;
+      }
+    else if( *it == "Laplacian" )
+      {
+      this->m_RequiresLaplacian = true;
+      }
+    else if( *it == "Hessian" )
+      {
+      this->m_RequiresHessian = true;
+      }
+    else if( *it == "MeanCurvature" )
+      {
+      this->m_RequiresMeanCurvature = true;
+      }
+    else
+      {
+      itkExceptionMacro( << "Unknown required data: " << *it );
+      }
+    }
+}
+
+template< class TInputImage, class TLevelSetContainer >
+void
+LevelSetEquationFusedTermContainer< TInputImage, TLevelSetContainer >
+::Update()
+{
+  this->Superclass::Update();
+  this->CacheLevelSet();
+}
+
+template< class TInputImage, class TLevelSetContainer >
+void
+LevelSetEquationFusedTermContainer< TInputImage, TLevelSetContainer >
+::CacheLevelSet()
+{
+  this->m_LevelSet = this->GetLevelSetContainer()->GetLevelSet( this->GetCurrentLevelSetId() );
+  if( this->m_LevelSet.IsNull() )
+    {
+    itkExceptionMacro( << "No level-set " << this->GetCurrentLevelSetId() << " in the container" );
+    }
+
+  typename LevelSetType::LabelMapType* labelMap = this->m_LevelSet->GetLabelMap();
+  this->m_Region = labelMap->GetLargestPossibleRegion();
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    this->m_Scales[dim] = NumericTraits< LevelSetOutputRealType >::One /
+      static_cast< LevelSetOutputRealType >( labelMap->GetSpacing()[dim] );
+    }
+}
+
+template< class TInputImage, class TLevelSetContainer >
+void
+LevelSetEquationFusedTermContainer< TInputImage, TLevelSetContainer >
+::ComputeRequiredData( const LevelSetInputIndexType& iP, LevelSetDataType& ioData )
+{
+  if( this->m_LevelSet.IsNull() )
+    {
+    this->CacheLevelSet();
+    }
+
+  const unsigned int Dimension = ImageDimension;
+
+  const LevelSetOutputRealType value =
+    static_cast< LevelSetOutputRealType >( this->m_LevelSet->Evaluate( iP ) );
+
+  if( this->m_RequiresValue )
+    {
+    ioData.Value.m_Value = value;
+    ioData.Value.m_Computed = true;
+    }
+
+  const bool requiresSecondOrder = this->m_RequiresHessian || this->m_RequiresMeanCurvature;
+  const bool requiresFirstOrder = requiresSecondOrder || this->m_RequiresLaplacian ||
+    this->m_RequiresGradient || this->m_RequiresGradientNorm ||
+    this->m_RequiresForwardGradient || this->m_RequiresBackwardGradient;
+
+  if( !requiresFirstOrder )
+    {
+    return;
+    }
+
+  // Values on both sides of the node along each axis
+  LevelSetOutputRealType plus[Dimension];
+  LevelSetOutputRealType minus[Dimension];
+
+  LevelSetInputIndexType neighbor = iP;
+  for( unsigned int dim = 0; dim < Dimension; dim++ )
+    {
+    neighbor[dim] = iP[dim] + 1;
+    plus[dim] = this->EvaluateNeighbor( neighbor, value );
+    neighbor[dim] = iP[dim] - 1;
+    minus[dim] = this->EvaluateNeighbor( neighbor, value );
+    neighbor[dim] = iP[dim];
+    }
+
+  LevelSetOutputRealType gradient[Dimension];
+  LevelSetOutputRealType squaredNorm = NumericTraits< LevelSetOutputRealType >::Zero;
+
+  for( unsigned int dim = 0; dim < Dimension; dim++ )
+    {
+    gradient[dim] = 0.5 * ( plus[dim] - minus[dim] ) * this->m_Scales[dim];
+    squaredNorm += gradient[dim] * gradient[dim];
+    }
+
+  if( this->m_RequiresGradient )
+    {
+    for( unsigned int dim = 0; dim < Dimension; dim++ )
+      {
+      ioData.Gradient.m_Value[dim] = gradient[dim];
+      }
+    ioData.Gradient.m_Computed = true;
+    }
+
+  if( this->m_RequiresForwardGradient )
+    {
+    for( unsigned int dim = 0; dim < Dimension; dim++ )
+      {
+      ioData.ForwardGradient.m_Value[dim] = ( plus[dim] - value ) * this->m_Scales[dim];
+      }
+    ioData.ForwardGradient.m_Computed = true;
+    }
+
+  if( this->m_RequiresBackwardGradient )
+    {
+    for( unsigned int dim = 0; dim < Dimension; dim++ )
+      {
+      ioData.BackwardGradient.m_Value[dim] = ( value - minus[dim] ) * this->m_Scales[dim];
+      }
+    ioData.BackwardGradient.m_Computed = true;
+    }
+
+  const LevelSetOutputRealType gradientNorm = std::sqrt( squaredNorm );
+
+  if( this->m_RequiresGradientNorm )
+    {
+    ioData.GradientNorm.m_Value = gradientNorm;
+    ioData.GradientNorm.m_Computed = true;
+    }
+
+  LevelSetOutputRealType hessian[Dimension][Dimension];
+  LevelSetOutputRealType laplacian = NumericTraits< LevelSetOutputRealType >::Zero;
+
+  for( unsigned int dim = 0; dim < Dimension; dim++ )
+    {
+    hessian[dim][dim] = ( plus[dim] - 2. * value + minus[dim] ) *
+      this->m_Scales[dim] * this->m_Scales[dim];
+    laplacian += hessian[dim][dim];
+    }
+
+  if( this->m_RequiresLaplacian )
+    {
+    ioData.Laplacian.m_Value = laplacian;
+    ioData.Laplacian.m_Computed = true;
+    }
+
+  if( !requiresSecondOrder )
+    {
+    return;
+    }
+
+  // Mixed derivatives from the four diagonal neighbors of each plane
+  for( unsigned int i = 0; i < Dimension; i++ )
+    {
+    for( unsigned int j = i + 1; j < Dimension; j++ )
+      {
+      neighbor = iP;
+
+      neighbor[i] = iP[i] + 1;
+      neighbor[j] = iP[j] + 1;
+      const LevelSetOutputRealType plusPlus = this->EvaluateNeighbor( neighbor, value );
+      neighbor[j] = iP[j] - 1;
+      const LevelSetOutputRealType plusMinus = this->EvaluateNeighbor( neighbor, value );
+      neighbor[i] = iP[i] - 1;
+      const LevelSetOutputRealType minusMinus = this->EvaluateNeighbor( neighbor, value );
+      neighbor[j] = iP[j] + 1;
+      const LevelSetOutputRealType minusPlus = this->EvaluateNeighbor( neighbor, value );
+
+      hessian[i][j] = 0.25 * ( plusPlus - plusMinus - minusPlus + minusMinus ) *
+        this->m_Scales[i] * this->m_Scales[j];
+      hessian[j][i] = hessian[i][j];
+      }
+    }
+
+  if( this->m_RequiresHessian )
+    {
+    for( unsigned int i = 0; i < Dimension; i++ )
+      {
+      for( unsigned int j = 0; j < Dimension; j++ )
+        {
+        ioData.Hessian.m_Value[i][j] = hessian[i][j];
+        }
+      }
+    ioData.Hessian.m_Computed = true;
+    }
+
+  if( this->m_RequiresMeanCurvature )
+    {
+    LevelSetOutputRealType curvature = NumericTraits< LevelSetOutputRealType >::Zero;
+
+    for( unsigned int i = 0; i < Dimension; i++ )
+      {
+      for( unsigned int j = 0; j < Dimension; j++ )
+        {
+        if( j != i )
+          {
+          curvature += gradient[i] * gradient[i] * hessian[j][j] -
+            gradient[i] * gradient[j] * hessian[i][j];
+          }
+        }
+      }
+
+    if( gradientNorm > vnl_math::eps )
+      {
+      curvature /= gradientNorm * gradientNorm * gradientNorm;
+      }
+    else
+      {
+      curvature = NumericTraits< LevelSetOutputRealType >::Zero;
+      }
+
+    ioData.MeanCurvature.m_Value = curvature;
+    ioData.MeanCurvature.m_Computed = true;
+    }
+}
+
+template< class TInputImage, class TLevelSetContainer >
+typename LevelSetEquationFusedTermContainer< TInputImage, TLevelSetContainer >::LevelSetOutputRealType
+LevelSetEquationFusedTermContainer< TInputImage, TLevelSetContainer >
+::Evaluate( const LevelSetInputIndexType& iP )
+{
+  LevelSetDataType data;
+  this->ComputeRequiredData( iP, data );
+  return this->Superclass::Evaluate( iP, data );
+}
+
+template< class TInputImage, class TLevelSetContainer >
+typename LevelSetEquationFusedTermContainer< TInputImage, TLevelSetContainer >::LevelSetOutputRealType
+LevelSetEquationFusedTermContainer< TInputImage, TLevelSetContainer >
+::Evaluate( const LevelSetInputIndexType& iP, const LevelSetDataType& iData )
+{
+  return this->Superclass::Evaluate( iP, iData );
+}
+
+template< class TInputImage, class TLevelSetContainer >
+void
+LevelSetEquationFusedTermContainer< TInputImage, TLevelSetContainer >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "RequiresValue: " << this->m_RequiresValue << std::endl;
+  os << indent << "RequiresGradient: " << this->m_RequiresGradient << std::endl;
+  os << indent << "RequiresForwardGradient: " << this->m_RequiresForwardGradient << std::endl;
+  os << indent << "RequiresBackwardGradient: " << this->m_RequiresBackwardGradient << std::endl;
+  os << indent << "RequiresGradientNorm: " << this->m_RequiresGradientNorm << std::endl;
+  os << indent << "RequiresLaplacian: " << this->m_RequiresLaplacian << std::endl;
+  os << indent << "RequiresHessian: " << this->m_RequiresHessian << std::endl;
+  os << indent << "RequiresMeanCurvature: " << this->m_RequiresMeanCurvature << std::endl;
+}
+
+}
+#endif // __itkLevelSetEquationFusedTermContainer_hxx
@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEquationTimedTerm_h
+#define __itkLevelSetEquationTimedTerm_h
+
+#include "itkLevelSetProfilingClock.h"
+
+namespace itk
+{
+/**
+ *  \class LevelSetEquationTimedTerm
+ *  \brief Term measuring the time spent in another term.
+ *
+ *  Behaves as TTerm, and accumulates the time spent in its evaluations at
+ *  the nodes (Evaluate), in the updates of its statistics when a node
+ *  changes (UpdatePixel) and once per iteration (Update). The estimated
+ *  cost of reading the clock is subtracted from the totals.
+ *
+ *  Timing is off by default, in which case the term only adds one call.
+ *
+ *  \tparam TTerm Level-set equation term, e.g.
+ *  LevelSetEquationChanAndVeseInternalTerm
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TTerm >
+class LevelSetEquationTimedTerm : public TTerm
+{
+public:
+  typedef LevelSetEquationTimedTerm   Self;
+  typedef TTerm                       Superclass;
+  typedef SmartPointer< Self >        Pointer;
+  typedef SmartPointer< const Self >  ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetEquationTimedTerm, TTerm );
+
+  typedef typename Superclass::LevelSetInputIndexType   LevelSetInputIndexType;
+  typedef typename Superclass::LevelSetOutputRealType   LevelSetOutputRealType;
+  typedef typename Superclass::LevelSetDataType         LevelSetDataType;
+
+  /** Accumulate the times spent in the term. Default is off. */
+  itkSetMacro( TimingEnabled, bool );
+  itkGetConstMacro( TimingEnabled, bool );
+  itkBooleanMacro( TimingEnabled );
+
+  /** Reset the times and the counts */
+  void ResetTimes()
+    {
+    this->m_EvaluateTime = 0.;
+    this->m_UpdatePixelTime = 0.;
+    this->m_UpdateTime = 0.;
+    this->m_NumberOfEvaluations = 0;
+    this->m_NumberOfPixelUpdates = 0;
+    }
+
+  /** Seconds spent in Evaluate */
+  double GetEvaluateTime() const
+    {
+    return this->m_EvaluateTime - this->m_NumberOfEvaluations * this->m_ClockOverhead;
+    }
+
+  /** Seconds spent in UpdatePixel */
+  double GetUpdatePixelTime() const
+    {
+    return this->m_UpdatePixelTime - this->m_NumberOfPixelUpdates * this->m_ClockOverhead;
+    }
+
+  /** Seconds spent in Update */
+  double GetUpdateTime() const { return this->m_UpdateTime; }
+
+  SizeValueType GetNumberOfEvaluations() const { return this->m_NumberOfEvaluations; }
+  SizeValueType GetNumberOfPixelUpdates() const { return this->m_NumberOfPixelUpdates; }
+
+  virtual LevelSetOutputRealType Evaluate( const LevelSetInputIndexType& iP )
+    {
+    if( !this->m_TimingEnabled )
+      {
+      return Superclass::Evaluate( iP );
+      }
+    const double start = LevelSetProfilingClock::GetTime();
+    const LevelSetOutputRealType value = Superclass::Evaluate( iP );
+    this->m_EvaluateTime += LevelSetProfilingClock::GetTime() - start;
+    ++this->m_NumberOfEvaluations;
+    return value;
+    }
+
+  virtual LevelSetOutputRealType Evaluate( const LevelSetInputIndexType& iP,
+                                           const LevelSetDataType& iData )
+    {
+    if( !this->m_TimingEnabled )
+      {
+      return Superclass::Evaluate( iP, iData );
+      }
+    const double start = LevelSetProfilingClock::GetTime();
+    const LevelSetOutputRealType value = Superclass::Evaluate( iP, iData );
+    this->m_EvaluateTime += LevelSetProfilingClock::GetTime() - start;
+    ++this->m_NumberOfEvaluations;
+    return value;
+    }
+
+  virtual void UpdatePixel( const LevelSetInputIndexType& iP,
+                            const LevelSetOutputRealType& oldValue,
+                            const LevelSetOutputRealType& newValue )
+    {
+    if( !this->m_TimingEnabled )
+      {
+      Superclass::UpdatePixel( iP, oldValue, newValue );
+      return;
+      }
+    const double start = LevelSetProfilingClock::GetTime();
+    Superclass::UpdatePixel( iP, oldValue, newValue );
+    this->m_UpdatePixelTime += LevelSetProfilingClock::GetTime() - start;
+    ++this->m_NumberOfPixelUpdates;
+    }
+
+  virtual void Update()
+    {
+    if( !this->m_TimingEnabled )
+      {
+      Superclass::Update();
+      return;
+      }
+    const double start = LevelSetProfilingClock::GetTime();
+    Superclass::Update();
+    this->m_UpdateTime += LevelSetProfilingClock::GetTime() - start;
+    }
+
+protected:
+  LevelSetEquationTimedTerm() :
+    m_TimingEnabled( false )
+    {
+    this->m_ClockOverhead = LevelSetProfilingClock::EstimateOverhead();
+    this->ResetTimes();
+    }
+
+  virtual ~LevelSetEquationTimedTerm() {}
+
+private:
+  LevelSetEquationTimedTerm( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  bool          m_TimingEnabled;
+  double        m_ClockOverhead;
+
+  double        m_EvaluateTime;
+  double        m_UpdatePixelTime;
+  double        m_UpdateTime;
+  SizeValueType m_NumberOfEvaluations;
+  SizeValueType m_NumberOfPixelUpdates;
+};
+}
+
+#endif // __itkLevelSetEquationTimedTerm_h
@@ -0,0 +1,166 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEvolutionChanAndVeseEnergyStoppingCriterion_h
+#define __itkLevelSetEvolutionChanAndVeseEnergyStoppingCriterion_h
+
+#include "itkLevelSetEvolutionStoppingCriterion.h"
+#include "itkLevelSetEquationChanAndVeseInternalTerm.h"
+#include "itkLevelSetEquationChanAndVeseExternalTerm.h"
+#include "itkSparseLevelSetLayerTraits.h"
+#include "itkTabulatedHeavisideStepFunction.h"
+
+#include <deque>
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class LevelSetEvolutionChanAndVeseEnergyStoppingCriterion
+ *  \brief Stop once the Chan and Vese energy reaches a plateau.
+ *
+ *  The data part of the Chan and Vese energy,
+ *  \f$ E = \sum_{in} (I - c_1)^2 + \sum_{out} (I - c_2)^2 \f$,
+ *  is evaluated after each iteration as
+ *  \f$ E = \sum I^2 - n_{in} c_1^2 - n_{out} c_2^2 \f$, where \f$ \sum I^2 \f$
+ *  is computed once from the input image, \f$ c_1 \f$, \f$ c_2 \f$ are the
+ *  means already maintained by the internal and external terms, and
+ *  \f$ n_{in} \f$ is the inside weight the terms use for these means: the
+ *  size of the interior, read from the run-length lines of the label map,
+ *  plus \f$ H(-\phi) \f$ summed over the nodes of the layers, where H is the
+ *  Heaviside of the level-set container. Only the layers are visited during
+ *  the evolution. Their values are gathered in a buffer kept from one
+ *  iteration to the next, and a TabulatedHeavisideStepFunction evaluates
+ *  the whole buffer at once.
+ *
+ *  The criterion is satisfied when the last WindowSize energies lie within
+ *  RelativeEnergyTolerance of the last energy, or when NumberOfIterations
+ *  is reached.
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TInput, class TLevelSetContainer >
+class LevelSetEvolutionChanAndVeseEnergyStoppingCriterion :
+  public LevelSetEvolutionStoppingCriterion< TLevelSetContainer >
+{
+public:
+  typedef LevelSetEvolutionChanAndVeseEnergyStoppingCriterion     Self;
+  typedef LevelSetEvolutionStoppingCriterion< TLevelSetContainer > Superclass;
+  typedef SmartPointer< Self >                                    Pointer;
+  typedef SmartPointer< const Self >                              ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetEvolutionChanAndVeseEnergyStoppingCriterion, LevelSetEvolutionStoppingCriterion );
+
+  typedef TInput                                      InputImageType;
+  typedef typename InputImageType::ConstPointer       InputImageConstPointer;
+
+  typedef typename Superclass::LevelSetContainerType  LevelSetContainerType;
+  typedef typename LevelSetContainerType::LevelSetIdentifierType LevelSetIdentifierType;
+  typedef typename LevelSetContainerType::LevelSetType LevelSetType;
+  typedef typename LevelSetType::LabelMapType         LabelMapType;
+  typedef typename Superclass::IterationIdType        IterationIdType;
+
+  typedef SparseLevelSetLayerTraits< LevelSetType >   LayerTraitsType;
+  typedef typename LayerTraitsType::LayerIdListType   LayerIdListType;
+
+  typedef typename LevelSetContainerType::HeavisideType HeavisideType;
+  typedef typename HeavisideType::InputType           HeavisideInputType;
+  typedef typename HeavisideType::OutputType          HeavisideOutputType;
+  typedef TabulatedHeavisideStepFunction< HeavisideInputType, HeavisideOutputType >
+                                                      TabulatedHeavisideType;
+
+  typedef LevelSetEquationChanAndVeseInternalTerm< InputImageType, LevelSetContainerType >
+                                                      InternalTermType;
+  typedef LevelSetEquationChanAndVeseExternalTerm< InputImageType, LevelSetContainerType >
+                                                      ExternalTermType;
+
+  /** Input image; its sum of squares is computed here, once */
+  void SetInput( const InputImageType* iImage );
+
+  /** Terms providing the means inside and outside the level-set */
+  itkSetObjectMacro( InternalTerm, InternalTermType );
+  itkSetObjectMacro( ExternalTerm, ExternalTermType );
+
+  /** Level-set whose energy is monitored. Default is 0. */
+  itkSetMacro( LevelSetId, LevelSetIdentifierType );
+  itkGetConstMacro( LevelSetId, LevelSetIdentifierType );
+
+  /** Number of iterations of the plateau. Default is 5. */
+  itkSetMacro( WindowSize, IterationIdType );
+  itkGetConstMacro( WindowSize, IterationIdType );
+
+  /** Largest spread of the energies in the window, relative to the last
+   * energy. Default is 1e-4. */
+  itkSetMacro( RelativeEnergyTolerance, double );
+  itkGetConstMacro( RelativeEnergyTolerance, double );
+
+  /** Energy after the last iteration */
+  itkGetConstMacro( Energy, double );
+
+  /** Evaluates the energy after the iteration which just ended */
+  virtual void SetCurrentIteration( const IterationIdType iIteration );
+
+  bool IsSatisfied() const;
+
+  std::string GetDescription() const;
+
+protected:
+  LevelSetEvolutionChanAndVeseEnergyStoppingCriterion();
+  virtual ~LevelSetEvolutionChanAndVeseEnergyStoppingCriterion() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Weight of the pixels inside the level-set: its interior, and the
+   * Heaviside of its layers */
+  double ComputeInsideWeight();
+
+  /** Spread of the energies in the window, relative to the last one */
+  double GetRelativeSpread() const;
+
+private:
+  LevelSetEvolutionChanAndVeseEnergyStoppingCriterion( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  typename InternalTermType::Pointer  m_InternalTerm;
+  typename ExternalTermType::Pointer  m_ExternalTerm;
+
+  LevelSetIdentifierType  m_LevelSetId;
+  IterationIdType         m_WindowSize;
+  double                  m_RelativeEnergyTolerance;
+
+  double                  m_SumOfSquares;
+  SizeValueType           m_NumberOfPixels;
+
+  double                  m_Energy;
+  std::deque< double >    m_Energies;
+
+  // buffers of the layer values and of their Heaviside
+  std::vector< HeavisideInputType >   m_LayerValues;
+  std::vector< HeavisideOutputType >  m_LayerWeights;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetEvolutionChanAndVeseEnergyStoppingCriterion.hxx"
+#endif
+
+#endif // __itkLevelSetEvolutionChanAndVeseEnergyStoppingCriterion_h
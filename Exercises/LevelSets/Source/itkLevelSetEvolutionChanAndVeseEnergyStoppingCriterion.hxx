@@ -0,0 +1,243 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEvolutionChanAndVeseEnergyStoppingCriterion_hxx
+#define __itkLevelSetEvolutionChanAndVeseEnergyStoppingCriterion_hxx
+
+#include "itkLevelSetEvolutionChanAndVeseEnergyStoppingCriterion.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace itk
+{
+template< class TInput, class TLevelSetContainer >
+LevelSetEvolutionChanAndVeseEnergyStoppingCriterion< TInput, TLevelSetContainer >
+::LevelSetEvolutionChanAndVeseEnergyStoppingCriterion() :
+  m_LevelSetId( NumericTraits< LevelSetIdentifierType >::Zero ),
+  m_WindowSize( 5 ),
+  m_RelativeEnergyTolerance( 1e-4 ),
+  m_SumOfSquares( 0. ),
+  m_NumberOfPixels( 0 ),
+  m_Energy( 0. )
+{
+  this->m_NumberOfIterations = NumericTraits< IterationIdType >::max();
+}
+
+template< class TInput, class TLevelSetContainer >
+void
+LevelSetEvolutionChanAndVeseEnergyStoppingCriterion< TInput, TLevelSetContainer >
+::SetInput( const InputImageType* iImage )
+{
+  if( iImage == NULL )
+    {
+    itkExceptionMacro( << "iImage is NULL" );
+    }
+
+  this->m_SumOfSquares = 0.;
+
+  typedef ImageRegionConstIterator< InputImageType > IteratorType;
+  IteratorType it( iImage, iImage->GetLargestPossibleRegion() );
+  it.GoToBegin();
+  while( !it.IsAtEnd() )
+    {
+    const double value = static_cast< double >( it.Get() );
+    this->m_SumOfSquares += value * value;
+    ++it;
+    }
+
+  this->m_NumberOfPixels = iImage->GetLargestPossibleRegion().GetNumberOfPixels();
+  this->Modified();
+}
+
+template< class TInput, class TLevelSetContainer >
+double
+LevelSetEvolutionChanAndVeseEnergyStoppingCriterion< TInput, TLevelSetContainer >
+::ComputeInsideWeight()
+{
+  const LevelSetType* levelSet = this->m_LevelSetContainer->GetLevelSet( this->m_LevelSetId );
+  const LabelMapType* labelMap = levelSet->GetLabelMap();
+
+  double insideWeight = 0.;
+  if( labelMap->HasLabel( LayerTraitsType::GetInteriorLabel() ) )
+    {
+    insideWeight = static_cast< double >(
+      labelMap->GetLabelObject( LayerTraitsType::GetInteriorLabel() )->Size() );
+    }
+
+  const HeavisideType* heaviside = this->m_LevelSetContainer->GetHeaviside();
+  const TabulatedHeavisideType* tabulatedHeaviside =
+    dynamic_cast< const TabulatedHeavisideType* >( heaviside );
+
+  const LayerIdListType layerIds = LayerTraitsType::GetLayerIds();
+  for( typename LayerIdListType::const_iterator idIt = layerIds.begin();
+       idIt != layerIds.end(); ++idIt )
+    {
+    typedef typename LevelSetType::LayerType LayerType;
+    const LayerType & layer = levelSet->GetLayer( *idIt );
+    const SizeValueType size = static_cast< SizeValueType >( layer.size() );
+
+    if( size == 0 )
+      {
+      continue;
+      }
+
+    if( heaviside == NULL )
+      {
+      // Without Heaviside, the nodes of the inner layers count as inside
+      if( *idIt <= 0 )
+        {
+        insideWeight += static_cast< double >( size );
+        }
+      continue;
+      }
+
+    this->m_LayerValues.resize( size );
+    this->m_LayerWeights.resize( size );
+
+    SizeValueType k = 0;
+    for( typename LayerType::const_iterator it = layer.begin(); it != layer.end(); ++it, ++k )
+      {
+      this->m_LayerValues[k] = -static_cast< HeavisideInputType >( it->second );
+      }
+
+    if( tabulatedHeaviside != NULL )
+      {
+      tabulatedHeaviside->Evaluate( &this->m_LayerValues[0], &this->m_LayerWeights[0], size );
+      }
+    else
+      {
+      for( k = 0; k < size; k++ )
+        {
+        this->m_LayerWeights[k] = heaviside->Evaluate( this->m_LayerValues[k] );
+        }
+      }
+
+    for( k = 0; k < size; k++ )
+      {
+      insideWeight += static_cast< double >( this->m_LayerWeights[k] );
+      }
+    }
+
+  return insideWeight;
+}
+
+template< class TInput, class TLevelSetContainer >
+void
+LevelSetEvolutionChanAndVeseEnergyStoppingCriterion< TInput, TLevelSetContainer >
+::SetCurrentIteration( const IterationIdType iIteration )
+{
+  if( ( iIteration == 0 ) || ( iIteration < this->m_CurrentIteration ) )
+    {
+    this->m_Energies.clear();
+    }
+
+  Superclass::SetCurrentIteration( iIteration );
+
+  if( ( iIteration == 0 ) || this->m_LevelSetContainer.IsNull() ||
+      this->m_InternalTerm.IsNull() || this->m_ExternalTerm.IsNull() )
+    {
+    return;
+    }
+
+  const double insideMean = static_cast< double >( this->m_InternalTerm->GetMean() );
+  const double outsideMean = static_cast< double >( this->m_ExternalTerm->GetMean() );
+
+  const double insideWeight = this->ComputeInsideWeight();
+  const double outsideWeight =
+    std::max( static_cast< double >( this->m_NumberOfPixels ) - insideWeight, 0. );
+
+  this->m_Energy = this->m_SumOfSquares
+    - insideWeight * insideMean * insideMean
+    - outsideWeight * outsideMean * outsideMean;
+
+  this->m_Energies.push_back( this->m_Energy );
+  while( this->m_Energies.size() > this->m_WindowSize )
+    {
+    this->m_Energies.pop_front();
+    }
+}
+
+template< class TInput, class TLevelSetContainer >
+double
+LevelSetEvolutionChanAndVeseEnergyStoppingCriterion< TInput, TLevelSetContainer >
+::GetRelativeSpread() const
+{
+  if( this->m_Energies.empty() )
+    {
+    return NumericTraits< double >::max();
+    }
+
+  const double minimum = *std::min_element( this->m_Energies.begin(), this->m_Energies.end() );
+  const double maximum = *std::max_element( this->m_Energies.begin(), this->m_Energies.end() );
+
+  return ( maximum - minimum ) /
+    std::max( std::abs( this->m_Energy ), NumericTraits< double >::epsilon() );
+}
+
+template< class TInput, class TLevelSetContainer >
+bool
+LevelSetEvolutionChanAndVeseEnergyStoppingCriterion< TInput, TLevelSetContainer >
+::IsSatisfied() const
+{
+  if( this->m_CurrentIteration >= this->m_NumberOfIterations )
+    {
+    return true;
+    }
+
+  return ( this->m_WindowSize > 0 ) &&
+    ( this->m_Energies.size() >= this->m_WindowSize ) &&
+    ( this->GetRelativeSpread() <= this->m_RelativeEnergyTolerance );
+}
+
+template< class TInput, class TLevelSetContainer >
+std::string
+LevelSetEvolutionChanAndVeseEnergyStoppingCriterion< TInput, TLevelSetContainer >
+::GetDescription() const
+{
+  std::ostringstream description;
+  if( this->m_CurrentIteration >= this->m_NumberOfIterations )
+    {
+    description << "Current Iteration Number >= Maximum Number Of Iterations";
+    }
+  else
+    {
+    description << "Chan and Vese energy " << this->m_Energy << " within "
+                << this->m_RelativeEnergyTolerance << " over the last "
+                << this->m_Energies.size() << " / " << this->m_WindowSize << " iterations";
+    }
+  return description.str();
+}
+
+template< class TInput, class TLevelSetContainer >
+void
+LevelSetEvolutionChanAndVeseEnergyStoppingCriterion< TInput, TLevelSetContainer >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "LevelSetId: " << this->m_LevelSetId << std::endl;
+  os << indent << "WindowSize: " << this->m_WindowSize << std::endl;
+  os << indent << "RelativeEnergyTolerance: " << this->m_RelativeEnergyTolerance << std::endl;
+  os << indent << "SumOfSquares: " << this->m_SumOfSquares << std::endl;
+  os << indent << "Energy: " << this->m_Energy << std::endl;
+}
+
+}
+#endif // __itkLevelSetEvolutionChanAndVeseEnergyStoppingCriterion_hxx
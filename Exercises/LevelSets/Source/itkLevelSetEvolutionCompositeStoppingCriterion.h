@@ -0,0 +1,95 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEvolutionCompositeStoppingCriterion_h
+#define __itkLevelSetEvolutionCompositeStoppingCriterion_h
+
+#include "itkLevelSetEvolutionStoppingCriterion.h"
+
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class LevelSetEvolutionCompositeStoppingCriterion
+ *  \brief Stop as soon as one of several criteria is satisfied.
+ *
+ *  The current iteration, the RMS change and the level-set container given
+ *  by the evolution are forwarded to every criterion added with
+ *  AddCriterion(). GetSatisfiedCriterion() and GetDescription() tell which
+ *  criterion stopped the evolution.
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TLevelSetContainer >
+class LevelSetEvolutionCompositeStoppingCriterion :
+  public LevelSetEvolutionStoppingCriterion< TLevelSetContainer >
+{
+public:
+  typedef LevelSetEvolutionCompositeStoppingCriterion             Self;
+  typedef LevelSetEvolutionStoppingCriterion< TLevelSetContainer > Superclass;
+  typedef SmartPointer< Self >                                    Pointer;
+  typedef SmartPointer< const Self >                              ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetEvolutionCompositeStoppingCriterion, LevelSetEvolutionStoppingCriterion );
+
+  typedef typename Superclass::LevelSetContainerType  LevelSetContainerType;
+  typedef typename Superclass::OutputRealType         OutputRealType;
+  typedef typename Superclass::IterationIdType        IterationIdType;
+
+  typedef Superclass                                  CriterionType;
+  typedef typename CriterionType::Pointer             CriterionPointer;
+  typedef std::vector< CriterionPointer >             CriterionListType;
+
+  /** Add one criterion */
+  void AddCriterion( CriterionType* iCriterion );
+
+  /** Criterion which is satisfied, NULL if none */
+  const CriterionType* GetSatisfiedCriterion() const;
+
+  virtual void SetLevelSetContainer( LevelSetContainerType* iContainer );
+  virtual void SetRMSChangeAccumulator( const OutputRealType iRMSChange );
+  virtual void SetCurrentIteration( const IterationIdType iIteration );
+
+  bool IsSatisfied() const;
+
+  std::string GetDescription() const;
+
+protected:
+  LevelSetEvolutionCompositeStoppingCriterion();
+  virtual ~LevelSetEvolutionCompositeStoppingCriterion() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+  LevelSetEvolutionCompositeStoppingCriterion( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  CriterionListType m_Criteria;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetEvolutionCompositeStoppingCriterion.hxx"
+#endif
+
+#endif // __itkLevelSetEvolutionCompositeStoppingCriterion_h
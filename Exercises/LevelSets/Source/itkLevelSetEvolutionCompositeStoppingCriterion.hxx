@@ -0,0 +1,151 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEvolutionCompositeStoppingCriterion_hxx
+#define __itkLevelSetEvolutionCompositeStoppingCriterion_hxx
+
+#include "itkLevelSetEvolutionCompositeStoppingCriterion.h"
+
+namespace itk
+{
+template< class TLevelSetContainer >
+LevelSetEvolutionCompositeStoppingCriterion< TLevelSetContainer >
+::LevelSetEvolutionCompositeStoppingCriterion()
+{
+  this->m_NumberOfIterations = NumericTraits< IterationIdType >::max();
+}
+
+template< class TLevelSetContainer >
+void
+LevelSetEvolutionCompositeStoppingCriterion< TLevelSetContainer >
+::AddCriterion( CriterionType* iCriterion )
+{
+  if( iCriterion == NULL )
+    {
+    itkExceptionMacro( << "iCriterion is NULL" );
+    }
+
+  if( this->m_LevelSetContainer.IsNotNull() )
+    {
+    iCriterion->SetLevelSetContainer( this->m_LevelSetContainer );
+    }
+  this->m_Criteria.push_back( iCriterion );
+  this->Modified();
+}
+
+template< class TLevelSetContainer >
+const typename LevelSetEvolutionCompositeStoppingCriterion< TLevelSetContainer >::CriterionType*
+LevelSetEvolutionCompositeStoppingCriterion< TLevelSetContainer >
+::GetSatisfiedCriterion() const
+{
+  for( typename CriterionListType::const_iterator it = this->m_Criteria.begin();
+       it != this->m_Criteria.end(); ++it )
+    {
+    if( ( *it )->IsSatisfied() )
+      {
+      return it->GetPointer();
+      }
+    }
+  return NULL;
+}
+
+template< class TLevelSetContainer >
+void
+LevelSetEvolutionCompositeStoppingCriterion< TLevelSetContainer >
+::SetLevelSetContainer( LevelSetContainerType* iContainer )
+{
+  Superclass::SetLevelSetContainer( iContainer );
+
+  for( typename CriterionListType::iterator it = this->m_Criteria.begin();
+       it != this->m_Criteria.end(); ++it )
+    {
+    ( *it )->SetLevelSetContainer( iContainer );
+    }
+}
+
+template< class TLevelSetContainer >
+void
+LevelSetEvolutionCompositeStoppingCriterion< TLevelSetContainer >
+::SetRMSChangeAccumulator( const OutputRealType iRMSChange )
+{
+  Superclass::SetRMSChangeAccumulator( iRMSChange );
+
+  for( typename CriterionListType::iterator it = this->m_Criteria.begin();
+       it != this->m_Criteria.end(); ++it )
+    {
+    ( *it )->SetRMSChangeAccumulator( iRMSChange );
+    }
+}
+
+template< class TLevelSetContainer >
+void
+LevelSetEvolutionCompositeStoppingCriterion< TLevelSetContainer >
+::SetCurrentIteration( const IterationIdType iIteration )
+{
+  Superclass::SetCurrentIteration( iIteration );
+
+  for( typename CriterionListType::iterator it = this->m_Criteria.begin();
+       it != this->m_Criteria.end(); ++it )
+    {
+    ( *it )->SetCurrentIteration( iIteration );
+    }
+}
+
+template< class TLevelSetContainer >
+bool
+LevelSetEvolutionCompositeStoppingCriterion< TLevelSetContainer >
+::IsSatisfied() const
+{
+  return ( this->m_CurrentIteration >= this->m_NumberOfIterations ) ||
+    ( this->GetSatisfiedCriterion() != NULL );
+}
+
+template< class TLevelSetContainer >
+std::string
+LevelSetEvolutionCompositeStoppingCriterion< TLevelSetContainer >
+::GetDescription() const
+{
+  const CriterionType* criterion = this->GetSatisfiedCriterion();
+  if( criterion != NULL )
+    {
+    return std::string( criterion->GetNameOfClass() ) + ": " + criterion->GetDescription();
+    }
+  if( this->m_CurrentIteration >= this->m_NumberOfIterations )
+    {
+    return "Current Iteration Number >= Maximum Number Of Iterations";
+    }
+  return "No criterion satisfied";
+}
+
+template< class TLevelSetContainer >
+void
+LevelSetEvolutionCompositeStoppingCriterion< TLevelSetContainer >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfCriteria: " << this->m_Criteria.size() << std::endl;
+  for( typename CriterionListType::const_iterator it = this->m_Criteria.begin();
+       it != this->m_Criteria.end(); ++it )
+    {
+    os << indent.GetNextIndent() << ( *it )->GetNameOfClass() << ": "
+       << ( *it )->GetDescription() << std::endl;
+    }
+}
+
+}
+#endif // __itkLevelSetEvolutionCompositeStoppingCriterion_hxx
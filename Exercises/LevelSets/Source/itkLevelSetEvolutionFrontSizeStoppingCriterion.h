@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEvolutionFrontSizeStoppingCriterion_h
+#define __itkLevelSetEvolutionFrontSizeStoppingCriterion_h
+
+#include "itkLevelSetEvolutionStoppingCriterion.h"
+#include "itkSparseLevelSetLayerTraits.h"
+
+namespace itk
+{
+/**
+ *  \class LevelSetEvolutionFrontSizeStoppingCriterion
+ *  \brief Stop once the number of front nodes of a sparse level-set settles.
+ *
+ *  After each iteration the size of the front layer (the zero layer for
+ *  Whitaker and Malcolm, the -1 layer for Shi) of the level-set LevelSetId
+ *  is compared to its size after the previous iteration. The criterion is
+ *  satisfied when the relative net change has been at most
+ *  RelativeSizeChangeThreshold for NumberOfConsecutiveIterations iterations
+ *  in a row, or when NumberOfIterations is reached. Reading the size of a
+ *  layer is constant time.
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TLevelSetContainer >
+class LevelSetEvolutionFrontSizeStoppingCriterion :
+  public LevelSetEvolutionStoppingCriterion< TLevelSetContainer >
+{
+public:
+  typedef LevelSetEvolutionFrontSizeStoppingCriterion             Self;
+  typedef LevelSetEvolutionStoppingCriterion< TLevelSetContainer > Superclass;
+  typedef SmartPointer< Self >                                    Pointer;
+  typedef SmartPointer< const Self >                              ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetEvolutionFrontSizeStoppingCriterion, LevelSetEvolutionStoppingCriterion );
+
+  typedef typename Superclass::LevelSetContainerType          LevelSetContainerType;
+  typedef typename LevelSetContainerType::LevelSetIdentifierType LevelSetIdentifierType;
+  typedef typename LevelSetContainerType::LevelSetType        LevelSetType;
+  typedef typename Superclass::IterationIdType                IterationIdType;
+
+  typedef SparseLevelSetLayerTraits< LevelSetType >           LayerTraitsType;
+
+  /** Level-set whose front is monitored. Default is 0. */
+  itkSetMacro( LevelSetId, LevelSetIdentifierType );
+  itkGetConstMacro( LevelSetId, LevelSetIdentifierType );
+
+  /** Largest |size(t) - size(t-1)| / size(t) considered as converged.
+   * Default is 0, i.e. no net change. */
+  itkSetMacro( RelativeSizeChangeThreshold, double );
+  itkGetConstMacro( RelativeSizeChangeThreshold, double );
+
+  /** Number of consecutive iterations below the threshold. Default is 3. */
+  itkSetMacro( NumberOfConsecutiveIterations, IterationIdType );
+  itkGetConstMacro( NumberOfConsecutiveIterations, IterationIdType );
+
+  /** Size of the front after the last iteration */
+  itkGetConstMacro( FrontSize, SizeValueType );
+
+  /** Samples the size of the front after the iteration which just ended */
+  virtual void SetCurrentIteration( const IterationIdType iIteration );
+
+  bool IsSatisfied() const;
+
+  std::string GetDescription() const;
+
+protected:
+  LevelSetEvolutionFrontSizeStoppingCriterion();
+  virtual ~LevelSetEvolutionFrontSizeStoppingCriterion() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+  LevelSetEvolutionFrontSizeStoppingCriterion( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  LevelSetIdentifierType  m_LevelSetId;
+  double                  m_RelativeSizeChangeThreshold;
+  IterationIdType         m_NumberOfConsecutiveIterations;
+  IterationIdType         m_NumberOfConvergedIterations;
+  SizeValueType           m_FrontSize;
+  double                  m_RelativeSizeChange;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetEvolutionFrontSizeStoppingCriterion.hxx"
+#endif
+
+#endif // __itkLevelSetEvolutionFrontSizeStoppingCriterion_h
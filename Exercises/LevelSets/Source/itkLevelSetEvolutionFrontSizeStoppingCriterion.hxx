@@ -0,0 +1,130 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEvolutionFrontSizeStoppingCriterion_hxx
+#define __itkLevelSetEvolutionFrontSizeStoppingCriterion_hxx
+
+#include "itkLevelSetEvolutionFrontSizeStoppingCriterion.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace itk
+{
+template< class TLevelSetContainer >
+LevelSetEvolutionFrontSizeStoppingCriterion< TLevelSetContainer >
+::LevelSetEvolutionFrontSizeStoppingCriterion() :
+  m_LevelSetId( NumericTraits< LevelSetIdentifierType >::Zero ),
+  m_RelativeSizeChangeThreshold( 0. ),
+  m_NumberOfConsecutiveIterations( 3 ),
+  m_NumberOfConvergedIterations( 0 ),
+  m_FrontSize( 0 ),
+  m_RelativeSizeChange( 1. )
+{
+  this->m_NumberOfIterations = NumericTraits< IterationIdType >::max();
+}
+
+template< class TLevelSetContainer >
+void
+LevelSetEvolutionFrontSizeStoppingCriterion< TLevelSetContainer >
+::SetCurrentIteration( const IterationIdType iIteration )
+{
+  const bool restart = ( iIteration == 0 ) || ( iIteration < this->m_CurrentIteration );
+
+  Superclass::SetCurrentIteration( iIteration );
+
+  if( this->m_LevelSetContainer.IsNull() )
+    {
+    return;
+    }
+
+  const SizeValueType frontSize = static_cast< SizeValueType >(
+    this->m_LevelSetContainer->GetLevelSet( this->m_LevelSetId )->GetLayer(
+      LayerTraitsType::GetFrontLayerId() ).size() );
+
+  if( restart )
+    {
+    this->m_NumberOfConvergedIterations = 0;
+    this->m_RelativeSizeChange = 1.;
+    this->m_FrontSize = frontSize;
+    return;
+    }
+
+  const double change = ( frontSize > this->m_FrontSize ) ?
+    static_cast< double >( frontSize - this->m_FrontSize ) :
+    static_cast< double >( this->m_FrontSize - frontSize );
+
+  this->m_RelativeSizeChange = change / static_cast< double >( std::max( frontSize, SizeValueType( 1 ) ) );
+  this->m_FrontSize = frontSize;
+
+  if( this->m_RelativeSizeChange <= this->m_RelativeSizeChangeThreshold )
+    {
+    ++this->m_NumberOfConvergedIterations;
+    }
+  else
+    {
+    this->m_NumberOfConvergedIterations = 0;
+    }
+}
+
+template< class TLevelSetContainer >
+bool
+LevelSetEvolutionFrontSizeStoppingCriterion< TLevelSetContainer >
+::IsSatisfied() const
+{
+  return ( this->m_CurrentIteration >= this->m_NumberOfIterations ) ||
+    ( this->m_NumberOfConvergedIterations >= this->m_NumberOfConsecutiveIterations );
+}
+
+template< class TLevelSetContainer >
+std::string
+LevelSetEvolutionFrontSizeStoppingCriterion< TLevelSetContainer >
+::GetDescription() const
+{
+  std::ostringstream description;
+  if( this->m_CurrentIteration >= this->m_NumberOfIterations )
+    {
+    description << "Current Iteration Number >= Maximum Number Of Iterations";
+    }
+  else
+    {
+    description << LayerTraitsType::GetName() << " front size change <= "
+                << this->m_RelativeSizeChangeThreshold << " during "
+                << this->m_NumberOfConvergedIterations << " / "
+                << this->m_NumberOfConsecutiveIterations << " iterations (front: "
+                << this->m_FrontSize << " nodes, last change: "
+                << this->m_RelativeSizeChange << ")";
+    }
+  return description.str();
+}
+
+template< class TLevelSetContainer >
+void
+LevelSetEvolutionFrontSizeStoppingCriterion< TLevelSetContainer >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "LevelSetId: " << this->m_LevelSetId << std::endl;
+  os << indent << "RelativeSizeChangeThreshold: " << this->m_RelativeSizeChangeThreshold << std::endl;
+  os << indent << "NumberOfConsecutiveIterations: " << this->m_NumberOfConsecutiveIterations << std::endl;
+  os << indent << "NumberOfConvergedIterations: " << this->m_NumberOfConvergedIterations << std::endl;
+  os << indent << "FrontSize: " << this->m_FrontSize << std::endl;
+}
+
+}
+#endif // __itkLevelSetEvolutionFrontSizeStoppingCriterion_hxx
@@ -0,0 +1,93 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEvolutionRMSChangeStoppingCriterion_h
+#define __itkLevelSetEvolutionRMSChangeStoppingCriterion_h
+
+#include "itkLevelSetEvolutionStoppingCriterion.h"
+
+namespace itk
+{
+/**
+ *  \class LevelSetEvolutionRMSChangeStoppingCriterion
+ *  \brief Stop once the RMS change of the level-set update stays small.
+ *
+ *  The evolution reports the RMS change of each iteration through
+ *  SetRMSChangeAccumulator() before SetCurrentIteration(). The criterion is
+ *  satisfied when this change has been below RMSChangeThreshold for
+ *  NumberOfConsecutiveIterations iterations in a row, or when
+ *  NumberOfIterations is reached.
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TLevelSetContainer >
+class LevelSetEvolutionRMSChangeStoppingCriterion :
+  public LevelSetEvolutionStoppingCriterion< TLevelSetContainer >
+{
+public:
+  typedef LevelSetEvolutionRMSChangeStoppingCriterion             Self;
+  typedef LevelSetEvolutionStoppingCriterion< TLevelSetContainer > Superclass;
+  typedef SmartPointer< Self >                                    Pointer;
+  typedef SmartPointer< const Self >                              ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetEvolutionRMSChangeStoppingCriterion, LevelSetEvolutionStoppingCriterion );
+
+  typedef typename Superclass::LevelSetContainerType  LevelSetContainerType;
+  typedef typename Superclass::OutputRealType         OutputRealType;
+  typedef typename Superclass::IterationIdType        IterationIdType;
+
+  /** Largest RMS change considered as converged. Default is 1e-3. */
+  itkSetMacro( RMSChangeThreshold, OutputRealType );
+  itkGetConstMacro( RMSChangeThreshold, OutputRealType );
+
+  /** Number of consecutive iterations below the threshold. Default is 3. */
+  itkSetMacro( NumberOfConsecutiveIterations, IterationIdType );
+  itkGetConstMacro( NumberOfConsecutiveIterations, IterationIdType );
+
+  /** Records the RMS change of the iteration which just ended */
+  virtual void SetCurrentIteration( const IterationIdType iIteration );
+
+  bool IsSatisfied() const;
+
+  std::string GetDescription() const;
+
+protected:
+  LevelSetEvolutionRMSChangeStoppingCriterion();
+  virtual ~LevelSetEvolutionRMSChangeStoppingCriterion() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+  LevelSetEvolutionRMSChangeStoppingCriterion( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  OutputRealType  m_RMSChangeThreshold;
+  IterationIdType m_NumberOfConsecutiveIterations;
+  IterationIdType m_NumberOfConvergedIterations;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetEvolutionRMSChangeStoppingCriterion.hxx"
+#endif
+
+#endif // __itkLevelSetEvolutionRMSChangeStoppingCriterion_h
@@ -0,0 +1,107 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetEvolutionRMSChangeStoppingCriterion_hxx
+#define __itkLevelSetEvolutionRMSChangeStoppingCriterion_hxx
+
+#include "itkLevelSetEvolutionRMSChangeStoppingCriterion.h"
+
+#include <sstream>
+
+namespace itk
+{
+template< class TLevelSetContainer >
+LevelSetEvolutionRMSChangeStoppingCriterion< TLevelSetContainer >
+::LevelSetEvolutionRMSChangeStoppingCriterion() :
+  m_RMSChangeThreshold( static_cast< OutputRealType >( 1e-3 ) ),
+  m_NumberOfConsecutiveIterations( 3 ),
+  m_NumberOfConvergedIterations( 0 )
+{
+  this->m_NumberOfIterations = NumericTraits< IterationIdType >::max();
+}
+
+template< class TLevelSetContainer >
+void
+LevelSetEvolutionRMSChangeStoppingCriterion< TLevelSetContainer >
+::SetCurrentIteration( const IterationIdType iIteration )
+{
+  if( ( iIteration == 0 ) || ( iIteration < this->m_CurrentIteration ) )
+    {
+    // a new evolution starts
+    this->m_NumberOfConvergedIterations = 0;
+    }
+
+  Superclass::SetCurrentIteration( iIteration );
+
+  if( iIteration == 0 )
+    {
+    return;
+    }
+
+  if( this->m_RMSChangeAccumulator < this->m_RMSChangeThreshold )
+    {
+    ++this->m_NumberOfConvergedIterations;
+    }
+  else
+    {
+    this->m_NumberOfConvergedIterations = 0;
+    }
+}
+
+template< class TLevelSetContainer >
+bool
+LevelSetEvolutionRMSChangeStoppingCriterion< TLevelSetContainer >
+::IsSatisfied() const
+{
+  return ( this->m_CurrentIteration >= this->m_NumberOfIterations ) ||
+    ( this->m_NumberOfConvergedIterations >= this->m_NumberOfConsecutiveIterations );
+}
+
+template< class TLevelSetContainer >
+std::string
+LevelSetEvolutionRMSChangeStoppingCriterion< TLevelSetContainer >
+::GetDescription() const
+{
+  std::ostringstream description;
+  if( this->m_CurrentIteration >= this->m_NumberOfIterations )
+    {
+    description << "Current Iteration Number >= Maximum Number Of Iterations";
+    }
+  else
+    {
+    description << "RMS change < " << this->m_RMSChangeThreshold << " during "
+                << this->m_NumberOfConvergedIterations << " / "
+                << this->m_NumberOfConsecutiveIterations << " iterations (last: "
+                << this->m_RMSChangeAccumulator << ")";
+    }
+  return description.str();
+}
+
+template< class TLevelSetContainer >
+void
+LevelSetEvolutionRMSChangeStoppingCriterion< TLevelSetContainer >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "RMSChangeThreshold: " << this->m_RMSChangeThreshold << std::endl;
+  os << indent << "NumberOfConsecutiveIterations: " << this->m_NumberOfConsecutiveIterations << std::endl;
+  os << indent << "NumberOfConvergedIterations: " << this->m_NumberOfConvergedIterations << std::endl;
+}
+
+}
+#endif // __itkLevelSetEvolutionRMSChangeStoppingCriterion_hxx
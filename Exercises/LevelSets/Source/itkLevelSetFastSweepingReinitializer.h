@@ -0,0 +1,206 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetFastSweepingReinitializer_h
+#define __itkLevelSetFastSweepingReinitializer_h
+
+#include "itkCommand.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class LevelSetFastSweepingReinitializer
+ *  \brief Reset a dense level-set to a signed distance function, in a band
+ *  around its zero set.
+ *
+ *  The pixels with a neighbor of the other sign along one of the axes keep
+ *  the distance to the zero set interpolated linearly between them. The
+ *  distance is then propagated from these pixels by fast sweeping: each
+ *  sweep visits the pixels in one of the 2^D axis orders and lowers every
+ *  pixel to the Godunov upwind solution of |grad u| = 1. The 2^D sweeps run
+ *  in parallel, one per thread, on copies of the distances which are merged
+ *  by taking their minimum; NumberOfRounds rounds are enough for a band of
+ *  a few pixels.
+ *
+ *  Distances are clamped to BandWidth pixels. They are stored for the
+ *  bounding box of the zero set grown by the band, but the sweeps and the
+ *  merges only visit the band itself: the pixels within BandWidth of the
+ *  zero set along every axis, listed as spans of the rows of the box. The
+ *  pixels outside the band are set to plus or minus the band. The sign of
+ *  every pixel is kept, so the zero set does not move.
+ *
+ *  Observes the IterationEvent of a LevelSetEvolution to reinitialize the
+ *  level-set every Period iterations; Reinitialize() can also be called
+ *  directly.
+ *
+ *  \tparam TLevelSet LevelSetDenseImage type
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TLevelSet >
+class LevelSetFastSweepingReinitializer : public Command
+{
+public:
+  typedef LevelSetFastSweepingReinitializer Self;
+  typedef Command                           Superclass;
+  typedef SmartPointer< Self >              Pointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetFastSweepingReinitializer, Command );
+
+  typedef TLevelSet                                 LevelSetType;
+  typedef typename LevelSetType::Pointer            LevelSetPointer;
+  typedef typename LevelSetType::ImageType          ImageType;
+  typedef typename ImageType::PixelType             ValueType;
+  typedef typename ImageType::RegionType            RegionType;
+  typedef typename ImageType::IndexType             IndexType;
+  typedef typename ImageType::SizeType              SizeType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, ImageType::ImageDimension );
+
+  /** Dense level-set to reinitialize */
+  itkSetObjectMacro( LevelSet, LevelSetType );
+  itkGetObjectMacro( LevelSet, LevelSetType );
+
+  /** Reinitialize every Period iterations, never if 0. Default is 10. */
+  itkSetMacro( Period, unsigned int );
+  itkGetConstMacro( Period, unsigned int );
+
+  /** Half width of the band, in pixels of the smallest spacing. Default
+   * is 3. */
+  itkSetMacro( BandWidth, double );
+  itkGetConstMacro( BandWidth, double );
+
+  /** Number of rounds of the 2^D parallel sweeps. Default is 2. */
+  itkSetClampMacro( NumberOfRounds, unsigned int, 1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro( NumberOfRounds, unsigned int );
+
+  /** Number of reinitializations so far */
+  itkGetConstMacro( NumberOfReinitializations, SizeValueType );
+
+  /** Reinitialize the level-set now */
+  void Reinitialize();
+
+  virtual void Execute( const Object* caller, const EventObject& event );
+  virtual void Execute( Object* caller, const EventObject& event );
+
+protected:
+  LevelSetFastSweepingReinitializer();
+  virtual ~LevelSetFastSweepingReinitializer() {}
+
+  /** Step of the threads */
+  enum StageType { FindBand, InitializeBand, Sweep, Merge, WriteBack };
+
+  /** Piece iPiece of iNumberOfPieces of iRegion, split along the last
+   * axis; false if the piece is empty */
+  static bool SplitRegion( const RegionType& iRegion, ThreadIdType iPiece,
+                           ThreadIdType iNumberOfPieces, RegionType& oPiece );
+
+  /** Does the pixel at iOffset have a neighbor of the other sign */
+  bool IsOnZeroSet( const IndexType& iIndex, OffsetValueType iOffset ) const;
+
+  /** Distance of the pixel at iOffset to the zero set, interpolated
+   * between it and its neighbors of the other sign */
+  ValueType ComputeZeroSetDistance( const IndexType& iIndex, OffsetValueType iOffset ) const;
+
+  /** Godunov upwind solution of |grad u| = 1 in iDistances, at the
+   * position iPosition of the band, i.e. at iBandOffset */
+  ValueType SolveEikonal( const std::vector< ValueType >& iDistances,
+                          const IndexType& iPosition, OffsetValueType iBandOffset ) const;
+
+  /** Mark the pixels of the box within the band radius of the frozen
+   * ones, and list them as spans of the rows of the box */
+  void ComputeBandSpans();
+
+  /** Copy the distances of the band from iSource to ioTarget */
+  void CopyBand( const std::vector< ValueType >& iSource, std::vector< ValueType >& ioTarget ) const;
+
+  /** Sweep the band of ioDistances in the axis orders given by the bits
+   * of iDirection */
+  void SweepBand( unsigned int iDirection, std::vector< ValueType >& ioDistances ) const;
+
+  void ThreadedFindBand( ThreadIdType iThreadId, ThreadIdType iNumberOfThreads );
+  void ThreadedInitializeBand( ThreadIdType iThreadId, ThreadIdType iNumberOfThreads );
+  void ThreadedMerge( ThreadIdType iThreadId, ThreadIdType iNumberOfThreads );
+  void ThreadedWriteBack( ThreadIdType iThreadId, ThreadIdType iNumberOfThreads );
+
+  /** Run iStage on iNumberOfThreads threads */
+  void RunStage( StageType iStage, ThreadIdType iNumberOfThreads );
+
+  static ITK_THREAD_RETURN_TYPE StageThreadCallback( void* arg );
+
+private:
+  LevelSetFastSweepingReinitializer( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  LevelSetPointer     m_LevelSet;
+  unsigned int        m_Period;
+  double              m_BandWidth;
+  unsigned int        m_NumberOfRounds;
+
+  SizeValueType       m_NumberOfIterations;
+  SizeValueType       m_NumberOfReinitializations;
+
+  /** State of a reinitialization */
+  StageType           m_Stage;
+  ImageType*          m_Image;
+  RegionType          m_Region;
+  OffsetValueType     m_Strides[ImageDimension];
+  double              m_Spacing[ImageDimension];
+  ValueType           m_MaximumDistance;
+
+  /** Bounding box of the zero set found by each thread */
+  std::vector< RegionType >   m_ThreadBands;
+  std::vector< unsigned char > m_ThreadHasBand;
+
+  /** Run of band pixels [m_Begin, m_End) of a row of the box, as offsets
+   * in the box */
+  struct SpanType
+    {
+    OffsetValueType m_Begin;
+    OffsetValueType m_End;
+    };
+
+  /** Bounding box of the band, its strides, and its distances: the merged
+   * ones, and one copy per sweep direction */
+  RegionType                  m_Band;
+  OffsetValueType             m_BandStrides[ImageDimension];
+  SizeType                    m_BandRadius;
+  std::vector< ValueType >    m_Distances;
+  std::vector< unsigned char > m_Frozen;
+  std::vector< std::vector< ValueType > > m_SweepDistances;
+
+  /** Band pixels of the box, and their spans: the spans of row r are
+   * m_Spans[m_RowSpans[r]] to m_Spans[m_RowSpans[r + 1] - 1] */
+  std::vector< unsigned char > m_InBand;
+  std::vector< SpanType >     m_Spans;
+  std::vector< size_t >       m_RowSpans;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetFastSweepingReinitializer.hxx"
+#endif
+
+#endif // __itkLevelSetFastSweepingReinitializer_h
@@ -0,0 +1,756 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetFastSweepingReinitializer_hxx
+#define __itkLevelSetFastSweepingReinitializer_hxx
+
+#include "itkLevelSetFastSweepingReinitializer.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+template< class TLevelSet >
+LevelSetFastSweepingReinitializer< TLevelSet >
+::LevelSetFastSweepingReinitializer() :
+  m_Period( 10 ),
+  m_BandWidth( 3. ),
+  m_NumberOfRounds( 2 ),
+  m_NumberOfIterations( 0 ),
+  m_NumberOfReinitializations( 0 ),
+  m_Stage( FindBand ),
+  m_Image( NULL ),
+  m_MaximumDistance( NumericTraits< ValueType >::Zero )
+{
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    this->m_Strides[dim] = 0;
+    this->m_Spacing[dim] = 1.;
+    this->m_BandStrides[dim] = 0;
+    this->m_BandRadius[dim] = 0;
+    }
+}
+
+template< class TLevelSet >
+bool
+LevelSetFastSweepingReinitializer< TLevelSet >
+::SplitRegion( const RegionType& iRegion, ThreadIdType iPiece,
+               ThreadIdType iNumberOfPieces, RegionType& oPiece )
+{
+  const unsigned int last = ImageDimension - 1;
+  const SizeValueType length = iRegion.GetSize()[last];
+  const SizeValueType begin = ( length * iPiece ) / iNumberOfPieces;
+  const SizeValueType end = ( length * ( iPiece + 1 ) ) / iNumberOfPieces;
+
+  oPiece = iRegion;
+  oPiece.SetIndex( last, iRegion.GetIndex()[last] + static_cast< OffsetValueType >( begin ) );
+  oPiece.SetSize( last, end - begin );
+
+  return ( end > begin ) && ( iRegion.GetNumberOfPixels() > 0 );
+}
+
+template< class TLevelSet >
+bool
+LevelSetFastSweepingReinitializer< TLevelSet >
+::IsOnZeroSet( const IndexType& iIndex, OffsetValueType iOffset ) const
+{
+  const ValueType* buffer = this->m_Image->GetBufferPointer();
+  const bool positive = ( buffer[iOffset] > NumericTraits< ValueType >::Zero );
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    const OffsetValueType begin = this->m_Region.GetIndex()[dim];
+    const OffsetValueType end = begin + static_cast< OffsetValueType >( this->m_Region.GetSize()[dim] );
+
+    if( ( iIndex[dim] > begin ) &&
+        ( ( buffer[iOffset - this->m_Strides[dim]] > NumericTraits< ValueType >::Zero ) != positive ) )
+      {
+      return true;
+      }
+    if( ( iIndex[dim] + 1 < end ) &&
+        ( ( buffer[iOffset + this->m_Strides[dim]] > NumericTraits< ValueType >::Zero ) != positive ) )
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+template< class TLevelSet >
+typename LevelSetFastSweepingReinitializer< TLevelSet >::ValueType
+LevelSetFastSweepingReinitializer< TLevelSet >
+::ComputeZeroSetDistance( const IndexType& iIndex, OffsetValueType iOffset ) const
+{
+  const ValueType* buffer = this->m_Image->GetBufferPointer();
+  const double value = static_cast< double >( buffer[iOffset] );
+  const bool positive = ( value > 0. );
+
+  // The zero set crosses the segment to a neighbor of the other sign at
+  // the root of the linear interpolation; the distances along the axes
+  // combine as the distance to the plane through these crossings.
+  double sumOfInverseSquares = 0.;
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    const OffsetValueType begin = this->m_Region.GetIndex()[dim];
+    const OffsetValueType end = begin + static_cast< OffsetValueType >( this->m_Region.GetSize()[dim] );
+
+    double axisDistance = -1.;
+    for( int step = -1; step <= 1; step += 2 )
+      {
+      const OffsetValueType neighbor = iIndex[dim] + step;
+      if( ( neighbor < begin ) || ( neighbor >= end ) )
+        {
+        continue;
+        }
+
+      const double neighborValue = static_cast< double >( buffer[iOffset + step * this->m_Strides[dim]] );
+      if( ( neighborValue > 0. ) == positive )
+        {
+        continue;
+        }
+
+      const double distance = std::fabs( value / ( value - neighborValue ) ) * this->m_Spacing[dim];
+      if( ( axisDistance < 0. ) || ( distance < axisDistance ) )
+        {
+        axisDistance = distance;
+        }
+      }
+
+    if( axisDistance == 0. )
+      {
+      return NumericTraits< ValueType >::Zero;
+      }
+    if( axisDistance > 0. )
+      {
+      sumOfInverseSquares += 1. / ( axisDistance * axisDistance );
+      }
+    }
+
+  if( sumOfInverseSquares == 0. )
+    {
+    return this->m_MaximumDistance;
+    }
+  return std::min( static_cast< ValueType >( 1. / std::sqrt( sumOfInverseSquares ) ),
+                   this->m_MaximumDistance );
+}
+
+template< class TLevelSet >
+typename LevelSetFastSweepingReinitializer< TLevelSet >::ValueType
+LevelSetFastSweepingReinitializer< TLevelSet >
+::SolveEikonal( const std::vector< ValueType >& iDistances,
+                const IndexType& iPosition, OffsetValueType iBandOffset ) const
+{
+  // Smallest neighbor along each axis, with the spacing of the axis
+  double neighbors[ImageDimension];
+  double spacing[ImageDimension];
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    ValueType neighbor = this->m_MaximumDistance;
+    if( iPosition[dim] > 0 )
+      {
+      neighbor = std::min( neighbor, iDistances[iBandOffset - this->m_BandStrides[dim]] );
+      }
+    if( iPosition[dim] + 1 < static_cast< OffsetValueType >( this->m_Band.GetSize()[dim] ) )
+      {
+      neighbor = std::min( neighbor, iDistances[iBandOffset + this->m_BandStrides[dim]] );
+      }
+
+    // insertion sort by increasing neighbor
+    unsigned int i = dim;
+    while( ( i > 0 ) && ( neighbors[i - 1] > neighbor ) )
+      {
+      neighbors[i] = neighbors[i - 1];
+      spacing[i] = spacing[i - 1];
+      --i;
+      }
+    neighbors[i] = static_cast< double >( neighbor );
+    spacing[i] = this->m_Spacing[dim];
+    }
+
+  // Solve sum_i ( ( u - a_i ) / h_i )^2 = 1 with the smallest neighbors
+  // first, adding the next one while it is below the solution.
+  double solution = neighbors[0] + spacing[0];
+  double sumOfWeights = 0.;
+  double sumOfNeighbors = 0.;
+  double sumOfSquares = 0.;
+
+  for( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    if( ( i > 0 ) && ( solution <= neighbors[i] ) )
+      {
+      break;
+      }
+
+    const double weight = 1. / ( spacing[i] * spacing[i] );
+    sumOfWeights += weight;
+    sumOfNeighbors += weight * neighbors[i];
+    sumOfSquares += weight * neighbors[i] * neighbors[i];
+
+    const double discriminant = sumOfNeighbors * sumOfNeighbors - sumOfWeights * ( sumOfSquares - 1. );
+    if( discriminant < 0. )
+      {
+      break;
+      }
+    solution = ( sumOfNeighbors + std::sqrt( discriminant ) ) / sumOfWeights;
+    }
+
+  return static_cast< ValueType >( solution );
+}
+
+template< class TLevelSet >
+void
+LevelSetFastSweepingReinitializer< TLevelSet >
+::ComputeBandSpans()
+{
+  const SizeType & size = this->m_Band.GetSize();
+  const SizeValueType numberOfPixels = this->m_Band.GetNumberOfPixels();
+
+  // Separable dilation of the frozen pixels, one axis after the other: a
+  // pixel is in the band if a marked pixel of its line is within the
+  // radius of the axis.
+  this->m_InBand.assign( this->m_Frozen.begin(), this->m_Frozen.end() );
+  std::vector< unsigned char > line;
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    const OffsetValueType length = static_cast< OffsetValueType >( size[dim] );
+    const OffsetValueType stride = this->m_BandStrides[dim];
+    const OffsetValueType radius = static_cast< OffsetValueType >( this->m_BandRadius[dim] );
+    const SizeValueType numberOfLines = numberOfPixels / size[dim];
+    line.resize( size[dim] );
+
+    IndexType position;
+    position.Fill( 0 );
+
+    for( SizeValueType l = 0; l < numberOfLines; l++ )
+      {
+      OffsetValueType start = 0;
+      for( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        start += position[d] * this->m_BandStrides[d];
+        }
+
+      for( OffsetValueType x = 0; x < length; x++ )
+        {
+        line[x] = this->m_InBand[start + x * stride];
+        }
+
+      OffsetValueType previous = -radius - 1;
+      for( OffsetValueType x = 0; x < length; x++ )
+        {
+        if( line[x] )
+          {
+          previous = x;
+          }
+        if( x - previous <= radius )
+          {
+          this->m_InBand[start + x * stride] = 1;
+          }
+        }
+
+      OffsetValueType next = length + radius;
+      for( OffsetValueType x = length - 1; x >= 0; x-- )
+        {
+        if( line[x] )
+          {
+          next = x;
+          }
+        if( next - x <= radius )
+          {
+          this->m_InBand[start + x * stride] = 1;
+          }
+        }
+
+      // next line along dim
+      for( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        if( d == dim )
+          {
+          continue;
+          }
+        if( position[d] + 1 < static_cast< OffsetValueType >( size[d] ) )
+          {
+          ++position[d];
+          break;
+          }
+        position[d] = 0;
+        }
+      }
+    }
+
+  // The rows of the box are contiguous: row r starts at r * size[0].
+  const OffsetValueType rowLength = static_cast< OffsetValueType >( size[0] );
+  const SizeValueType numberOfRows = numberOfPixels / size[0];
+
+  this->m_Spans.clear();
+  this->m_RowSpans.resize( numberOfRows + 1 );
+
+  for( SizeValueType row = 0; row < numberOfRows; row++ )
+    {
+    this->m_RowSpans[row] = this->m_Spans.size();
+
+    const OffsetValueType rowBegin = static_cast< OffsetValueType >( row ) * rowLength;
+    const OffsetValueType rowEnd = rowBegin + rowLength;
+
+    OffsetValueType offset = rowBegin;
+    while( offset < rowEnd )
+      {
+      if( !this->m_InBand[offset] )
+        {
+        ++offset;
+        continue;
+        }
+
+      SpanType span;
+      span.m_Begin = offset;
+      while( ( offset < rowEnd ) && this->m_InBand[offset] )
+        {
+        ++offset;
+        }
+      span.m_End = offset;
+      this->m_Spans.push_back( span );
+      }
+    }
+  this->m_RowSpans[numberOfRows] = this->m_Spans.size();
+}
+
+template< class TLevelSet >
+void
+LevelSetFastSweepingReinitializer< TLevelSet >
+::CopyBand( const std::vector< ValueType >& iSource, std::vector< ValueType >& ioTarget ) const
+{
+  for( size_t s = 0; s < this->m_Spans.size(); s++ )
+    {
+    std::copy( iSource.begin() + this->m_Spans[s].m_Begin,
+               iSource.begin() + this->m_Spans[s].m_End,
+               ioTarget.begin() + this->m_Spans[s].m_Begin );
+    }
+}
+
+template< class TLevelSet >
+void
+LevelSetFastSweepingReinitializer< TLevelSet >
+::SweepBand( unsigned int iDirection, std::vector< ValueType >& ioDistances ) const
+{
+  const SizeType & size = this->m_Band.GetSize();
+  const OffsetValueType rowLength = static_cast< OffsetValueType >( size[0] );
+
+  // Bit dim of iDirection set: axis dim is visited backward. The rows are
+  // visited in the order of the axes 1 to D-1, and the spans of a row, and
+  // the pixels of a span, in the order of the axis 0.
+  const bool backward = ( ( iDirection & 1u ) != 0 );
+
+  IndexType position;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    position[dim] = ( iDirection & ( 1u << dim ) ) ? static_cast< OffsetValueType >( size[dim] ) - 1 : 0;
+    }
+
+  const SizeValueType numberOfRows = this->m_Band.GetNumberOfPixels() / size[0];
+
+  for( SizeValueType n = 0; n < numberOfRows; n++ )
+    {
+    OffsetValueType rowOffset = 0;
+    for( unsigned int dim = 1; dim < ImageDimension; dim++ )
+      {
+      rowOffset += position[dim] * this->m_BandStrides[dim];
+      }
+
+    const size_t row = static_cast< size_t >( rowOffset / rowLength );
+    const size_t firstSpan = this->m_RowSpans[row];
+    const size_t endSpan = this->m_RowSpans[row + 1];
+
+    for( size_t s = firstSpan; s < endSpan; s++ )
+      {
+      const SpanType & span = this->m_Spans[backward ? firstSpan + endSpan - 1 - s : s];
+
+      for( OffsetValueType k = span.m_Begin; k < span.m_End; k++ )
+        {
+        const OffsetValueType offset = backward ? span.m_Begin + span.m_End - 1 - k : k;
+        if( this->m_Frozen[offset] )
+          {
+          continue;
+          }
+
+        position[0] = offset - rowOffset;
+        const ValueType solution = this->SolveEikonal( ioDistances, position, offset );
+        if( solution < ioDistances[offset] )
+          {
+          ioDistances[offset] = solution;
+          }
+        }
+      }
+
+    for( unsigned int dim = 1; dim < ImageDimension; dim++ )
+      {
+      if( iDirection & ( 1u << dim ) )
+        {
+        if( position[dim] > 0 )
+          {
+          --position[dim];
+          break;
+          }
+        position[dim] = static_cast< OffsetValueType >( size[dim] ) - 1;
+        }
+      else
+        {
+        if( position[dim] + 1 < static_cast< OffsetValueType >( size[dim] ) )
+          {
+          ++position[dim];
+          break;
+          }
+        position[dim] = 0;
+        }
+      }
+    }
+}
+
+template< class TLevelSet >
+void
+LevelSetFastSweepingReinitializer< TLevelSet >
+::ThreadedFindBand( ThreadIdType iThreadId, ThreadIdType iNumberOfThreads )
+{
+  this->m_ThreadHasBand[iThreadId] = 0;
+
+  RegionType piece;
+  if( !SplitRegion( this->m_Region, iThreadId, iNumberOfThreads, piece ) )
+    {
+    return;
+    }
+
+  IndexType lower;
+  IndexType upper;
+
+  ImageRegionConstIteratorWithIndex< ImageType > it( this->m_Image, piece );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const IndexType & index = it.GetIndex();
+    if( !this->IsOnZeroSet( index, this->m_Image->ComputeOffset( index ) ) )
+      {
+      continue;
+      }
+
+    if( !this->m_ThreadHasBand[iThreadId] )
+      {
+      lower = index;
+      upper = index;
+      this->m_ThreadHasBand[iThreadId] = 1;
+      }
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      lower[dim] = std::min( lower[dim], index[dim] );
+      upper[dim] = std::max( upper[dim], index[dim] );
+      }
+    }
+
+  if( this->m_ThreadHasBand[iThreadId] )
+    {
+    RegionType & band = this->m_ThreadBands[iThreadId];
+    band.SetIndex( lower );
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      band.SetSize( dim, static_cast< SizeValueType >( upper[dim] - lower[dim] + 1 ) );
+      }
+    }
+}
+
+template< class TLevelSet >
+void
+LevelSetFastSweepingReinitializer< TLevelSet >
+::ThreadedInitializeBand( ThreadIdType iThreadId, ThreadIdType iNumberOfThreads )
+{
+  RegionType piece;
+  if( !SplitRegion( this->m_Band, iThreadId, iNumberOfThreads, piece ) )
+    {
+    return;
+    }
+
+  ImageRegionConstIteratorWithIndex< ImageType > it( this->m_Image, piece );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const IndexType & index = it.GetIndex();
+
+    OffsetValueType bandOffset = 0;
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      bandOffset += ( index[dim] - this->m_Band.GetIndex()[dim] ) * this->m_BandStrides[dim];
+      }
+
+    const OffsetValueType offset = this->m_Image->ComputeOffset( index );
+    if( this->IsOnZeroSet( index, offset ) )
+      {
+      this->m_Frozen[bandOffset] = 1;
+      this->m_Distances[bandOffset] = this->ComputeZeroSetDistance( index, offset );
+      }
+    else
+      {
+      this->m_Frozen[bandOffset] = 0;
+      this->m_Distances[bandOffset] = this->m_MaximumDistance;
+      }
+    }
+}
+
+template< class TLevelSet >
+void
+LevelSetFastSweepingReinitializer< TLevelSet >
+::ThreadedMerge( ThreadIdType iThreadId, ThreadIdType iNumberOfThreads )
+{
+  // the pixels out of the band keep the maximum distance in every copy
+  const size_t numberOfSpans = this->m_Spans.size();
+  const size_t begin = ( numberOfSpans * iThreadId ) / iNumberOfThreads;
+  const size_t end = ( numberOfSpans * ( iThreadId + 1 ) ) / iNumberOfThreads;
+
+  for( size_t i = begin; i < end; i++ )
+    {
+    const SpanType & span = this->m_Spans[i];
+    for( OffsetValueType offset = span.m_Begin; offset < span.m_End; offset++ )
+      {
+      ValueType distance = this->m_Distances[offset];
+      for( size_t s = 0; s < this->m_SweepDistances.size(); s++ )
+        {
+        distance = std::min( distance, this->m_SweepDistances[s][offset] );
+        }
+      this->m_Distances[offset] = distance;
+      }
+    }
+}
+
+template< class TLevelSet >
+void
+LevelSetFastSweepingReinitializer< TLevelSet >
+::ThreadedWriteBack( ThreadIdType iThreadId, ThreadIdType iNumberOfThreads )
+{
+  RegionType piece;
+  if( !SplitRegion( this->m_Region, iThreadId, iNumberOfThreads, piece ) )
+    {
+    return;
+    }
+
+  ValueType* buffer = this->m_Image->GetBufferPointer();
+
+  ImageRegionConstIteratorWithIndex< ImageType > it( this->m_Image, piece );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const IndexType & index = it.GetIndex();
+
+    ValueType distance = this->m_MaximumDistance;
+    if( this->m_Band.IsInside( index ) )
+      {
+      OffsetValueType bandOffset = 0;
+      for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+        {
+        bandOffset += ( index[dim] - this->m_Band.GetIndex()[dim] ) * this->m_BandStrides[dim];
+        }
+      distance = this->m_Distances[bandOffset];
+      }
+
+    ValueType & value = buffer[this->m_Image->ComputeOffset( index )];
+    value = ( value > NumericTraits< ValueType >::Zero ) ? distance : -distance;
+    }
+}
+
+template< class TLevelSet >
+ITK_THREAD_RETURN_TYPE
+LevelSetFastSweepingReinitializer< TLevelSet >
+::StageThreadCallback( void* arg )
+{
+  MultiThreader::ThreadInfoStruct* info = static_cast< MultiThreader::ThreadInfoStruct* >( arg );
+  Self* self = static_cast< Self* >( info->UserData );
+
+  const ThreadIdType threadId = info->ThreadID;
+  const ThreadIdType numberOfThreads = info->NumberOfThreads;
+
+  switch( self->m_Stage )
+    {
+    case FindBand:
+      self->ThreadedFindBand( threadId, numberOfThreads );
+      break;
+    case InitializeBand:
+      self->ThreadedInitializeBand( threadId, numberOfThreads );
+      break;
+    case Sweep:
+      // each thread sweeps its own copy, in one or more directions
+      for( size_t direction = threadId; direction < self->m_SweepDistances.size();
+           direction += numberOfThreads )
+        {
+        self->CopyBand( self->m_Distances, self->m_SweepDistances[direction] );
+        self->SweepBand( static_cast< unsigned int >( direction ), self->m_SweepDistances[direction] );
+        }
+      break;
+    case Merge:
+      self->ThreadedMerge( threadId, numberOfThreads );
+      break;
+    case WriteBack:
+      self->ThreadedWriteBack( threadId, numberOfThreads );
+      break;
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TLevelSet >
+void
+LevelSetFastSweepingReinitializer< TLevelSet >
+::RunStage( StageType iStage, ThreadIdType iNumberOfThreads )
+{
+  this->m_Stage = iStage;
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( iNumberOfThreads );
+
+  this->m_ThreadBands.resize( threader->GetNumberOfThreads() );
+  this->m_ThreadHasBand.resize( threader->GetNumberOfThreads() );
+
+  threader->SetSingleMethod( StageThreadCallback, this );
+  threader->SingleMethodExecute();
+}
+
+template< class TLevelSet >
+void
+LevelSetFastSweepingReinitializer< TLevelSet >
+::Reinitialize()
+{
+  if( this->m_LevelSet.IsNull() )
+    {
+    itkGenericExceptionMacro( << "m_LevelSet is NULL" );
+    }
+
+  this->m_Image = this->m_LevelSet->GetImage();
+  this->m_Region = this->m_Image->GetBufferedRegion();
+
+  double smallestSpacing = NumericTraits< double >::max();
+  OffsetValueType stride = 1;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    this->m_Strides[dim] = stride;
+    stride *= static_cast< OffsetValueType >( this->m_Region.GetSize()[dim] );
+
+    this->m_Spacing[dim] = this->m_Image->GetSpacing()[dim];
+    smallestSpacing = std::min( smallestSpacing, this->m_Spacing[dim] );
+    }
+  this->m_MaximumDistance = static_cast< ValueType >( this->m_BandWidth * smallestSpacing );
+
+  const ThreadIdType numberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  // Bounding box of the zero set, grown by the band
+  this->RunStage( FindBand, numberOfThreads );
+
+  bool hasBand = false;
+  for( size_t t = 0; t < this->m_ThreadBands.size(); t++ )
+    {
+    if( !this->m_ThreadHasBand[t] )
+      {
+      continue;
+      }
+    if( !hasBand )
+      {
+      this->m_Band = this->m_ThreadBands[t];
+      hasBand = true;
+      continue;
+      }
+
+    const RegionType & band = this->m_ThreadBands[t];
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      const OffsetValueType begin = std::min( this->m_Band.GetIndex()[dim], band.GetIndex()[dim] );
+      const OffsetValueType end = std::max(
+        this->m_Band.GetIndex()[dim] + static_cast< OffsetValueType >( this->m_Band.GetSize()[dim] ),
+        band.GetIndex()[dim] + static_cast< OffsetValueType >( band.GetSize()[dim] ) );
+      this->m_Band.SetIndex( dim, begin );
+      this->m_Band.SetSize( dim, static_cast< SizeValueType >( end - begin ) );
+      }
+    }
+
+  if( hasBand )
+    {
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      this->m_BandRadius[dim] = static_cast< SizeValueType >(
+        std::ceil( this->m_MaximumDistance / this->m_Spacing[dim] ) ) + 1;
+      }
+    this->m_Band.PadByRadius( this->m_BandRadius );
+    this->m_Band.Crop( this->m_Region );
+
+    OffsetValueType bandStride = 1;
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      this->m_BandStrides[dim] = bandStride;
+      bandStride *= static_cast< OffsetValueType >( this->m_Band.GetSize()[dim] );
+      }
+
+    this->m_Distances.resize( this->m_Band.GetNumberOfPixels() );
+    this->m_Frozen.resize( this->m_Band.GetNumberOfPixels() );
+    this->RunStage( InitializeBand, numberOfThreads );
+    this->ComputeBandSpans();
+
+    // The copies are filled once; each sweep then only refreshes the band.
+    this->m_SweepDistances.assign( 1u << ImageDimension, this->m_Distances );
+    for( unsigned int round = 0; round < this->m_NumberOfRounds; round++ )
+      {
+      this->RunStage( Sweep, static_cast< ThreadIdType >( this->m_SweepDistances.size() ) );
+      this->RunStage( Merge, numberOfThreads );
+      }
+    }
+  else
+    {
+    // no zero set: every pixel is outside the band
+    SizeType size;
+    size.Fill( 0 );
+    this->m_Band.SetIndex( this->m_Region.GetIndex() );
+    this->m_Band.SetSize( size );
+    }
+
+  this->RunStage( WriteBack, numberOfThreads );
+
+  this->m_Image->Modified();
+  ++this->m_NumberOfReinitializations;
+}
+
+template< class TLevelSet >
+void
+LevelSetFastSweepingReinitializer< TLevelSet >
+::Execute( const Object* itkNotUsed( caller ), const EventObject& event )
+{
+  if( !IterationEvent().CheckEvent( &event ) )
+    {
+    return;
+    }
+
+  ++this->m_NumberOfIterations;
+  if( ( this->m_Period == 0 ) || ( this->m_NumberOfIterations % this->m_Period != 0 ) )
+    {
+    return;
+    }
+
+  this->Reinitialize();
+}
+
+template< class TLevelSet >
+void
+LevelSetFastSweepingReinitializer< TLevelSet >
+::Execute( Object* caller, const EventObject& event )
+{
+  this->Execute( const_cast< const Object* >( caller ), event );
+}
+
+}
+#endif // __itkLevelSetFastSweepingReinitializer_hxx
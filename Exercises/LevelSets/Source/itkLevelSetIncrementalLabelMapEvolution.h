@@ -0,0 +1,120 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetIncrementalLabelMapEvolution_h
+#define __itkLevelSetIncrementalLabelMapEvolution_h
+
+#include "itkLevelSetEvolution.h"
+#include "itkWhitakerSparseLevelSetImage.h"
+#include "itkShiSparseLevelSetImage.h"
+#include "itkMalcolmSparseLevelSetImage.h"
+#include "itkIncrementalUpdateWhitakerSparseLevelSet.h"
+
+#include <map>
+
+namespace itk
+{
+/**
+ *  \class LevelSetIncrementalLabelMapEvolution
+ *  \brief Evolution updating the label map of Whitaker level-sets by the
+ *  nodes which changed layer, instead of rebuilding it.
+ *
+ *  LevelSetEvolution updates the layers of each Whitaker level-set with
+ *  UpdateWhitakerSparseLevelSet, which converts the whole label map to an
+ *  image and back at every iteration. Here UpdateLevelSets() uses one
+ *  IncrementalUpdateWhitakerSparseLevelSet per level-set instead, kept
+ *  for the whole evolution: the label image it needs is built once, then
+ *  edited with the layer moves, and only the run-length lines of the label
+ *  map at the moved nodes are split, merged, grown or shrunk, in place. The
+ *  bookkeeping then follows the number of nodes which changed layer rather
+ *  than the size of the image.
+ *
+ *  The layers are moved by the sparse field method; the RMS change is the
+ *  one of the zero layer nodes.
+ *
+ *  The layer updates of Shi and Malcolm level-sets are left to
+ *  LevelSetEvolution.
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TEquationContainer, class TLevelSet >
+class LevelSetIncrementalLabelMapEvolution :
+  public LevelSetEvolution< TEquationContainer, TLevelSet >
+{
+public:
+  typedef LevelSetIncrementalLabelMapEvolution               Self;
+  typedef LevelSetEvolution< TEquationContainer, TLevelSet > Superclass;
+  typedef SmartPointer< Self >                              Pointer;
+  typedef SmartPointer< const Self >                        ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetIncrementalLabelMapEvolution, LevelSetEvolution );
+
+  typedef IncrementalUpdateWhitakerSparseLevelSet< TEquationContainer, TLevelSet >
+                                                            IncrementalUpdateType;
+  typedef SmartPointer< IncrementalUpdateType >             IncrementalUpdatePointer;
+
+  /** Number of nodes, over all the level-sets, which changed label at the
+   * last iteration */
+  SizeValueType GetNumberOfLabelChanges() const
+    {
+    return this->m_NumberOfLabelChanges;
+    }
+
+protected:
+  LevelSetIncrementalLabelMapEvolution() : m_NumberOfLabelChanges( 0 ) {}
+  virtual ~LevelSetIncrementalLabelMapEvolution() {}
+
+  virtual void AllocateUpdateBuffer();
+
+  virtual void UpdateLevelSets();
+
+  /** Layer updates, by representation */
+  template< typename TOutput, unsigned int VDimension >
+  void UpdateLevelSetsIncrementally( WhitakerSparseLevelSetImage< TOutput, VDimension >* );
+
+  template< unsigned int VDimension >
+  void UpdateLevelSetsIncrementally( ShiSparseLevelSetImage< VDimension >* )
+    {
+    Superclass::UpdateLevelSets();
+    }
+  template< unsigned int VDimension >
+  void UpdateLevelSetsIncrementally( MalcolmSparseLevelSetImage< VDimension >* )
+    {
+    Superclass::UpdateLevelSets();
+    }
+
+private:
+  LevelSetIncrementalLabelMapEvolution( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  typedef std::map< IdentifierType, IncrementalUpdatePointer > IncrementalUpdateMapType;
+
+  IncrementalUpdateMapType  m_IncrementalUpdates;
+  SizeValueType             m_NumberOfLabelChanges;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetIncrementalLabelMapEvolution.hxx"
+#endif
+
+#endif // __itkLevelSetIncrementalLabelMapEvolution_h
@@ -0,0 +1,80 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetIncrementalLabelMapEvolution_hxx
+#define __itkLevelSetIncrementalLabelMapEvolution_hxx
+
+#include "itkLevelSetIncrementalLabelMapEvolution.h"
+
+namespace itk
+{
+template< class TEquationContainer, class TLevelSet >
+void
+LevelSetIncrementalLabelMapEvolution< TEquationContainer, TLevelSet >
+::AllocateUpdateBuffer()
+{
+  // called once at the beginning of each evolution: the level-sets may
+  // have been replaced since the last one
+  Superclass::AllocateUpdateBuffer();
+  this->m_IncrementalUpdates.clear();
+  this->m_NumberOfLabelChanges = 0;
+}
+
+template< class TEquationContainer, class TLevelSet >
+void
+LevelSetIncrementalLabelMapEvolution< TEquationContainer, TLevelSet >
+::UpdateLevelSets()
+{
+  this->UpdateLevelSetsIncrementally( static_cast< TLevelSet* >( NULL ) );
+}
+
+template< class TEquationContainer, class TLevelSet >
+template< typename TOutput, unsigned int VDimension >
+void
+LevelSetIncrementalLabelMapEvolution< TEquationContainer, TLevelSet >
+::UpdateLevelSetsIncrementally( WhitakerSparseLevelSetImage< TOutput, VDimension >* )
+{
+  typedef typename Superclass::LevelSetContainerType LevelSetContainerType;
+
+  this->m_NumberOfLabelChanges = 0;
+
+  typename LevelSetContainerType::Iterator it = this->m_LevelSetContainer->Begin();
+  while( it != this->m_LevelSetContainer->End() )
+    {
+    const IdentifierType id = it->GetIdentifier();
+
+    IncrementalUpdatePointer & update = this->m_IncrementalUpdates[id];
+    if( update.IsNull() )
+      {
+      update = IncrementalUpdateType::New();
+      }
+    update->SetEquationContainer( this->m_EquationContainer );
+    update->SetCurrentLevelSetId( id );
+    update->SetTimeStep( this->m_Dt );
+    update->Update( it->GetLevelSet(), *this->m_UpdateBuffer[id] );
+
+    this->m_RMSChangeAccumulator = update->GetRMSChangeAccumulator();
+    this->m_NumberOfLabelChanges += update->GetNumberOfLabelChanges();
+
+    this->m_UpdateBuffer[id]->clear();
+    ++it;
+    }
+}
+
+}
+#endif // __itkLevelSetIncrementalLabelMapEvolution_hxx
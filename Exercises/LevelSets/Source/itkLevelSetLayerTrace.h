@@ -0,0 +1,141 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetLayerTrace_h
+#define __itkLevelSetLayerTrace_h
+
+#include "itkIntTypes.h"
+#include "itkMacro.h"
+
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class LevelSetLayerTrace
+ *  \brief Binary format of the traces of sparse level-set layers.
+ *
+ *  A trace is a single append-only file, in host byte order:
+ *
+ *  - file header: the 8 characters "LSTRACE1", uint32 image dimension D,
+ *    uint32 number of layers L, D int64 region index, D uint64 region size
+ *    and L int8 layer identifiers, ordered from the inside to the outside.
+ *  - then one frame per recorded iteration: uint32 frame magic, uint32
+ *    frame type, uint64 iteration, uint64 number of layer nodes after the
+ *    iteration, uint64 payload size in bytes, followed by the payload.
+ *
+ *  The payload of a key frame holds the nodes of every layer. The payload
+ *  of a delta frame holds the nodes which left the layers, then for each
+ *  layer the nodes which entered it from outside of the layers, then for
+ *  each layer the nodes which moved to it from another layer.
+ *
+ *  Nodes are linear offsets in the region, the first dimension varying
+ *  fastest. Each list of nodes is written as its varint-encoded length,
+ *  followed by its sorted offsets as varint-encoded gaps to the previous
+ *  offset (the first one to 0).
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+class LevelSetLayerTrace
+{
+public:
+  typedef uint64_t                                OffsetType;
+  typedef std::vector< OffsetType >               OffsetListType;
+  typedef std::vector< unsigned char >            BufferType;
+
+  /** Node and position of its layer in the list of layer identifiers */
+  typedef std::pair< OffsetType, unsigned char >  NodeType;
+  typedef std::vector< NodeType >                 NodeListType;
+
+  enum FrameType { KeyFrame = 0, DeltaFrame = 1 };
+
+  static const char * GetFileMagic() { return "LSTRACE1"; }
+  static uint32_t GetFrameMagic() { return 0x5246534c; } // "LSFR"
+
+  /** Size in bytes of the header of a frame */
+  static size_t GetFrameHeaderSize()
+    {
+    return 2 * sizeof( uint32_t ) + 3 * sizeof( uint64_t );
+    }
+
+  static void EncodeVarint( OffsetType iValue, BufferType& ioBuffer )
+    {
+    while( iValue >= 0x80 )
+      {
+      ioBuffer.push_back( static_cast< unsigned char >( ( iValue & 0x7f ) | 0x80 ) );
+      iValue >>= 7;
+      }
+    ioBuffer.push_back( static_cast< unsigned char >( iValue ) );
+    }
+
+  static OffsetType DecodeVarint( const unsigned char*& ioPosition, const unsigned char* iEnd )
+    {
+    OffsetType value = 0;
+    unsigned int shift = 0;
+    while( ioPosition < iEnd )
+      {
+      const unsigned char byte = *ioPosition++;
+      value |= static_cast< OffsetType >( byte & 0x7f ) << shift;
+      if( ( byte & 0x80 ) == 0 )
+        {
+        return value;
+        }
+      shift += 7;
+      if( shift >= 64 )
+        {
+        break;
+        }
+      }
+    itkGenericExceptionMacro( << "Corrupted level-set trace: truncated varint" );
+    }
+
+  /** Append the sorted offsets of [iBegin, iEnd) to ioBuffer */
+  template< class TIterator >
+  static void EncodeOffsets( TIterator iBegin, TIterator iEnd, BufferType& ioBuffer )
+    {
+    EncodeVarint( static_cast< OffsetType >( iEnd - iBegin ), ioBuffer );
+    OffsetType previous = 0;
+    for( TIterator it = iBegin; it != iEnd; ++it )
+      {
+      EncodeVarint( *it - previous, ioBuffer );
+      previous = *it;
+      }
+    }
+
+  static void DecodeOffsets( const unsigned char*& ioPosition, const unsigned char* iEnd,
+                             OffsetListType& oOffsets )
+    {
+    const OffsetType numberOfOffsets = DecodeVarint( ioPosition, iEnd );
+    if( numberOfOffsets > static_cast< OffsetType >( iEnd - ioPosition ) )
+      {
+      itkGenericExceptionMacro( << "Corrupted level-set trace: list longer than its frame" );
+      }
+
+    oOffsets.resize( static_cast< size_t >( numberOfOffsets ) );
+    OffsetType previous = 0;
+    for( size_t i = 0; i < oOffsets.size(); i++ )
+      {
+      previous += DecodeVarint( ioPosition, iEnd );
+      oOffsets[i] = previous;
+      }
+    }
+};
+}
+
+#endif // __itkLevelSetLayerTrace_h
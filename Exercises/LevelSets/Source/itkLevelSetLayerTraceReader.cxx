@@ -0,0 +1,323 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkLevelSetLayerTraceReader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#if !defined( _WIN32 )
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace itk
+{
+LevelSetLayerTraceReader
+::LevelSetLayerTraceReader() :
+  m_Data( NULL ),
+  m_Size( 0 ),
+  m_Dimension( 0 )
+{}
+
+LevelSetLayerTraceReader
+::~LevelSetLayerTraceReader()
+{
+  this->Close();
+}
+
+template< typename T >
+T
+LevelSetLayerTraceReader
+::Read( size_t& ioPosition ) const
+{
+  if( ioPosition + sizeof( T ) > this->m_Size )
+    {
+    itkExceptionMacro( << "Corrupted level-set trace: unexpected end of " << this->m_FileName );
+    }
+  T value;
+  std::memcpy( &value, this->m_Data + ioPosition, sizeof( T ) );
+  ioPosition += sizeof( T );
+  return value;
+}
+
+void
+LevelSetLayerTraceReader
+::Open()
+{
+  this->Close();
+
+#if defined( _WIN32 )
+  std::ifstream stream( this->m_FileName.c_str(), std::ios::in | std::ios::binary );
+  if( !stream.is_open() )
+    {
+    itkExceptionMacro( << "Could not open " << this->m_FileName );
+    }
+  this->m_Buffer.assign( std::istreambuf_iterator< char >( stream ), std::istreambuf_iterator< char >() );
+  this->m_Size = this->m_Buffer.size();
+  this->m_Data = this->m_Buffer.empty() ? NULL : &this->m_Buffer[0];
+#else
+  const int fd = open( this->m_FileName.c_str(), O_RDONLY );
+  if( fd < 0 )
+    {
+    itkExceptionMacro( << "Could not open " << this->m_FileName );
+    }
+
+  struct stat status;
+  if( fstat( fd, &status ) != 0 )
+    {
+    close( fd );
+    itkExceptionMacro( << "Could not stat " << this->m_FileName );
+    }
+
+  this->m_Size = static_cast< size_t >( status.st_size );
+  if( this->m_Size > 0 )
+    {
+    void* data = mmap( NULL, this->m_Size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if( data == MAP_FAILED )
+      {
+      close( fd );
+      this->m_Size = 0;
+      itkExceptionMacro( << "Could not map " << this->m_FileName );
+      }
+    this->m_Data = static_cast< const unsigned char* >( data );
+    }
+  close( fd );
+#endif
+
+  // File header
+  size_t position = 0;
+  if( ( this->m_Size < 8 ) ||
+      ( std::memcmp( this->m_Data, LevelSetLayerTrace::GetFileMagic(), 8 ) != 0 ) )
+    {
+    this->Close();
+    itkExceptionMacro( << this->m_FileName << " is not a level-set trace" );
+    }
+  position = 8;
+
+  this->m_Dimension = this->Read< uint32_t >( position );
+  const uint32_t numberOfLayers = this->Read< uint32_t >( position );
+
+  this->m_RegionIndex.resize( this->m_Dimension );
+  this->m_RegionSize.resize( this->m_Dimension );
+  for( unsigned int dim = 0; dim < this->m_Dimension; dim++ )
+    {
+    this->m_RegionIndex[dim] = this->Read< int64_t >( position );
+    }
+  for( unsigned int dim = 0; dim < this->m_Dimension; dim++ )
+    {
+    this->m_RegionSize[dim] = this->Read< uint64_t >( position );
+    }
+
+  this->m_LayerIds.resize( numberOfLayers );
+  for( uint32_t i = 0; i < numberOfLayers; i++ )
+    {
+    this->m_LayerIds[i] = static_cast< int >( this->Read< int8_t >( position ) );
+    }
+
+  // Index the frames, jumping from header to header. A frame cut by the end
+  // of the file (e.g. from a run which was killed) is ignored.
+  this->m_Frames.clear();
+  while( position + LevelSetLayerTrace::GetFrameHeaderSize() <= this->m_Size )
+    {
+    if( this->Read< uint32_t >( position ) != LevelSetLayerTrace::GetFrameMagic() )
+      {
+      itkExceptionMacro( << "Corrupted level-set trace: bad frame in " << this->m_FileName );
+      }
+
+    FrameInfo frame;
+    frame.Type = this->Read< uint32_t >( position );
+    frame.Iteration = this->Read< uint64_t >( position );
+    frame.NumberOfNodes = this->Read< uint64_t >( position );
+    frame.PayloadSize = this->Read< uint64_t >( position );
+    frame.PayloadOffset = position;
+
+    if( frame.PayloadSize > this->m_Size - position )
+      {
+      break;
+      }
+    position += static_cast< size_t >( frame.PayloadSize );
+
+    this->m_Frames.push_back( frame );
+    }
+
+  if( this->m_Frames.empty() || ( this->m_Frames[0].Type != LevelSetLayerTrace::KeyFrame ) )
+    {
+    itkExceptionMacro( << "Level-set trace " << this->m_FileName << " has no initial key frame" );
+    }
+}
+
+void
+LevelSetLayerTraceReader
+::Close()
+{
+#if !defined( _WIN32 )
+  if( ( this->m_Data != NULL ) && this->m_Buffer.empty() )
+    {
+    munmap( const_cast< unsigned char* >( this->m_Data ), this->m_Size );
+    }
+#endif
+  this->m_Buffer.clear();
+  this->m_Data = NULL;
+  this->m_Size = 0;
+  this->m_Frames.clear();
+}
+
+void
+LevelSetLayerTraceReader
+::ReadKeyFrame( const FrameInfo & iFrame, NodeListType& oNodes ) const
+{
+  const unsigned char* position = this->m_Data + iFrame.PayloadOffset;
+  const unsigned char* end = position + iFrame.PayloadSize;
+
+  oNodes.clear();
+  oNodes.reserve( static_cast< size_t >( iFrame.NumberOfNodes ) );
+
+  OffsetListType offsets;
+  for( size_t layer = 0; layer < this->m_LayerIds.size(); layer++ )
+    {
+    LevelSetLayerTrace::DecodeOffsets( position, end, offsets );
+    for( OffsetListType::const_iterator it = offsets.begin(); it != offsets.end(); ++it )
+      {
+      oNodes.push_back( NodeType( *it, static_cast< unsigned char >( layer ) ) );
+      }
+    }
+
+  std::sort( oNodes.begin(), oNodes.end() );
+}
+
+void
+LevelSetLayerTraceReader
+::ApplyDeltaFrame( const FrameInfo & iFrame, NodeListType& ioNodes ) const
+{
+  const unsigned char* position = this->m_Data + iFrame.PayloadOffset;
+  const unsigned char* end = position + iFrame.PayloadSize;
+
+  // Changes sorted by offset; the removed nodes get an invalid layer.
+  const unsigned char removedLayer = static_cast< unsigned char >( 255 );
+  NodeListType changes;
+
+  OffsetListType offsets;
+  LevelSetLayerTrace::DecodeOffsets( position, end, offsets );
+  for( OffsetListType::const_iterator it = offsets.begin(); it != offsets.end(); ++it )
+    {
+    changes.push_back( NodeType( *it, removedLayer ) );
+    }
+
+  // added, then moved nodes
+  for( unsigned int pass = 0; pass < 2; pass++ )
+    {
+    for( size_t layer = 0; layer < this->m_LayerIds.size(); layer++ )
+      {
+      LevelSetLayerTrace::DecodeOffsets( position, end, offsets );
+      for( OffsetListType::const_iterator it = offsets.begin(); it != offsets.end(); ++it )
+        {
+        changes.push_back( NodeType( *it, static_cast< unsigned char >( layer ) ) );
+        }
+      }
+    }
+
+  std::sort( changes.begin(), changes.end() );
+
+  NodeListType nodes;
+  nodes.reserve( static_cast< size_t >( iFrame.NumberOfNodes ) );
+
+  NodeListType::const_iterator nIt = ioNodes.begin();
+  NodeListType::const_iterator cIt = changes.begin();
+
+  while( ( nIt != ioNodes.end() ) || ( cIt != changes.end() ) )
+    {
+    if( ( cIt == changes.end() ) || ( ( nIt != ioNodes.end() ) && ( nIt->first < cIt->first ) ) )
+      {
+      nodes.push_back( *nIt );
+      ++nIt;
+      }
+    else
+      {
+      if( ( nIt != ioNodes.end() ) && ( nIt->first == cIt->first ) )
+        {
+        ++nIt;
+        }
+      if( cIt->second != removedLayer )
+        {
+        nodes.push_back( *cIt );
+        }
+      ++cIt;
+      }
+    }
+
+  ioNodes.swap( nodes );
+}
+
+uint64_t
+LevelSetLayerTraceReader
+::ReadNodes( uint64_t iIteration, NodeListType& oNodes ) const
+{
+  if( this->m_Frames.empty() )
+    {
+    itkExceptionMacro( << "No level-set trace is open" );
+    }
+
+  // last frame not after iIteration, iterations are increasing
+  size_t lower = 0;
+  size_t upper = this->m_Frames.size();
+  while( upper - lower > 1 )
+    {
+    const size_t middle = ( lower + upper ) / 2;
+    if( this->m_Frames[middle].Iteration <= iIteration )
+      {
+      lower = middle;
+      }
+    else
+      {
+      upper = middle;
+      }
+    }
+  const size_t last = lower;
+
+  size_t key = last;
+  while( this->m_Frames[key].Type != LevelSetLayerTrace::KeyFrame )
+    {
+    --key;
+    }
+
+  this->ReadKeyFrame( this->m_Frames[key], oNodes );
+  for( size_t frame = key + 1; frame <= last; frame++ )
+    {
+    this->ApplyDeltaFrame( this->m_Frames[frame], oNodes );
+    }
+
+  return this->m_Frames[last].Iteration;
+}
+
+void
+LevelSetLayerTraceReader
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "FileName: " << this->m_FileName << std::endl;
+  os << indent << "Dimension: " << this->m_Dimension << std::endl;
+  os << indent << "NumberOfFrames: " << this->m_Frames.size() << std::endl;
+  os << indent << "FileSize: " << this->m_Size << std::endl;
+}
+
+}
@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetLayerTraceReader_h
+#define __itkLevelSetLayerTraceReader_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkLevelSetLayerTrace.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class LevelSetLayerTraceReader
+ *  \brief Read the layers of any iteration from a level-set trace.
+ *
+ *  The trace written by LevelSetLayerTraceRecorder is memory mapped (read
+ *  in memory on Windows), and the headers of its frames are indexed when it
+ *  is opened. The layers of an iteration are rebuilt from the closest key
+ *  frame before it, so the cost of a seek does not depend on the length of
+ *  the trace.
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+class LevelSetLayerTraceReader : public Object
+{
+public:
+  typedef LevelSetLayerTraceReader    Self;
+  typedef Object                      Superclass;
+  typedef SmartPointer< Self >        Pointer;
+  typedef SmartPointer< const Self >  ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetLayerTraceReader, Object );
+
+  typedef LevelSetLayerTrace::OffsetType      OffsetType;
+  typedef LevelSetLayerTrace::OffsetListType  OffsetListType;
+  typedef LevelSetLayerTrace::NodeType        NodeType;
+  typedef LevelSetLayerTrace::NodeListType    NodeListType;
+
+  /** Description of one frame */
+  struct FrameInfo
+    {
+    uint32_t    Type;
+    uint64_t    Iteration;
+    uint64_t    NumberOfNodes;
+    uint64_t    PayloadSize;
+    size_t      PayloadOffset;
+    };
+
+  itkSetStringMacro( FileName );
+  itkGetStringMacro( FileName );
+
+  /** Map the trace and index its frames */
+  void Open();
+
+  /** Unmap the trace */
+  void Close();
+
+  unsigned int GetDimension() const { return this->m_Dimension; }
+  const std::vector< int64_t > & GetRegionIndex() const { return this->m_RegionIndex; }
+  const std::vector< uint64_t > & GetRegionSize() const { return this->m_RegionSize; }
+
+  /** Layer identifiers, from the inside to the outside */
+  const std::vector< int > & GetLayerIds() const { return this->m_LayerIds; }
+
+  size_t GetNumberOfFrames() const { return this->m_Frames.size(); }
+  const FrameInfo & GetFrame( size_t iFrame ) const { return this->m_Frames[iFrame]; }
+
+  /** Size of the trace in bytes */
+  size_t GetFileSize() const { return this->m_Size; }
+
+  /** Nodes of the layers after the last recorded iteration not after
+   * iIteration, sorted by offset; returns that iteration. */
+  uint64_t ReadNodes( uint64_t iIteration, NodeListType& oNodes ) const;
+
+protected:
+  LevelSetLayerTraceReader();
+  virtual ~LevelSetLayerTraceReader();
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Apply the delta frame iFrame to ioNodes */
+  void ApplyDeltaFrame( const FrameInfo & iFrame, NodeListType& ioNodes ) const;
+
+  /** Replace oNodes by the nodes of the key frame iFrame */
+  void ReadKeyFrame( const FrameInfo & iFrame, NodeListType& oNodes ) const;
+
+  template< typename T >
+  T Read( size_t& ioPosition ) const;
+
+private:
+  LevelSetLayerTraceReader( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  std::string                 m_FileName;
+
+  const unsigned char*        m_Data;
+  size_t                      m_Size;
+  std::vector< unsigned char > m_Buffer; // used instead of mmap on Windows
+
+  unsigned int                m_Dimension;
+  std::vector< int64_t >      m_RegionIndex;
+  std::vector< uint64_t >     m_RegionSize;
+  std::vector< int >          m_LayerIds;
+
+  std::vector< FrameInfo >    m_Frames;
+};
+}
+
+#endif // __itkLevelSetLayerTraceReader_h
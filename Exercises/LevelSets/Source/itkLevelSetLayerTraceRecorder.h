@@ -0,0 +1,160 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetLayerTraceRecorder_h
+#define __itkLevelSetLayerTraceRecorder_h
+
+#include "itkCommand.h"
+#include "itkLevelSetLayerTrace.h"
+#include "itkSparseLevelSetSortedLayer.h"
+#include "itkSparseLevelSetLayerTraits.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class LevelSetLayerTraceRecorder
+ *  \brief Record the layers of an evolving sparse level-set into a trace.
+ *
+ *  Open() writes the header of the trace and a key frame of the initial
+ *  layers. Then, on each IterationEvent, the layers are compared to the
+ *  ones of the previous iteration and only the nodes which were added,
+ *  removed or moved between layers are appended, see LevelSetLayerTrace.
+ *  A key frame is written every KeyFramePeriod iterations so that a
+ *  reader can seek to any iteration. Layer values are not recorded.
+ *
+ *  \tparam TLevelSet Whitaker, Shi or Malcolm sparse level-set image
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TLevelSet >
+class LevelSetLayerTraceRecorder : public Command
+{
+public:
+  typedef LevelSetLayerTraceRecorder  Self;
+  typedef Command                     Superclass;
+  typedef SmartPointer< Self >        Pointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetLayerTraceRecorder, Command );
+
+  typedef TLevelSet                                 LevelSetType;
+  typedef typename LevelSetType::Pointer            LevelSetPointer;
+  typedef typename LevelSetType::LayerType          LayerType;
+  typedef typename LayerType::const_iterator        LayerConstIterator;
+  typedef typename LevelSetType::LabelMapType       LabelMapType;
+  typedef typename LabelMapType::RegionType         RegionType;
+  typedef typename LabelMapType::IndexType          IndexType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, LevelSetType::Dimension );
+
+  typedef SparseLevelSetLayerTraits< LevelSetType > LayerTraitsType;
+  typedef typename LayerTraitsType::LayerIdListType LayerIdListType;
+
+  typedef LevelSetLayerTrace::OffsetType            OffsetType;
+  typedef LevelSetLayerTrace::OffsetListType        OffsetListType;
+  typedef LevelSetLayerTrace::BufferType            BufferType;
+  typedef LevelSetLayerTrace::NodeListType          NodeListType;
+
+  typedef SparseLevelSetSortedLayer< LevelSetType > SortedLayerType;
+
+  /** File the trace is written to */
+  itkSetStringMacro( FileName );
+  itkGetStringMacro( FileName );
+
+  /** Level-set being evolved */
+  itkSetObjectMacro( LevelSet, LevelSetType );
+  itkGetObjectMacro( LevelSet, LevelSetType );
+
+  /** Write a key frame every KeyFramePeriod iterations. Default is 100. */
+  itkSetMacro( KeyFramePeriod, IdentifierType );
+  itkGetConstMacro( KeyFramePeriod, IdentifierType );
+
+  /** Number of bytes written so far */
+  itkGetConstMacro( NumberOfBytesWritten, SizeValueType );
+
+  /** Create the trace and record the current layers as iteration 0 */
+  void Open();
+
+  /** Flush and close the trace */
+  void Close();
+
+  virtual void Execute( const Object* caller, const EventObject& event );
+
+  virtual void Execute( Object* caller, const EventObject& event );
+
+protected:
+  LevelSetLayerTraceRecorder();
+  virtual ~LevelSetLayerTraceRecorder();
+
+  /** Sorted nodes of all the layers */
+  void CollectNodes( NodeListType& oNodes );
+
+  /** Append one frame, from m_Nodes and m_PreviousNodes */
+  void WriteFrame( IdentifierType iIteration, bool iKeyFrame );
+
+  void WriteHeader();
+
+  template< typename T >
+  void Write( const T& iValue )
+    {
+    this->m_Stream.write( reinterpret_cast< const char* >( &iValue ), sizeof( T ) );
+    this->m_NumberOfBytesWritten += sizeof( T );
+    }
+
+private:
+  LevelSetLayerTraceRecorder( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  std::string       m_FileName;
+  LevelSetPointer   m_LevelSet;
+  IdentifierType    m_KeyFramePeriod;
+  IdentifierType    m_Iteration;
+  SizeValueType     m_NumberOfBytesWritten;
+
+  RegionType        m_Region;
+  LayerIdListType   m_LayerIds;
+
+  /** Layers of the current iteration, sorted by offset; their memory is
+   * reused from one iteration to the next */
+  std::vector< SortedLayerType > m_Layers;
+
+  /** Changes of the last frame */
+  OffsetListType                m_Removed;
+  std::vector< OffsetListType > m_Added;
+  std::vector< OffsetListType > m_Moved;
+
+  std::ofstream     m_Stream;
+
+  NodeListType      m_Nodes;
+  NodeListType      m_PreviousNodes;
+  BufferType        m_Buffer;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetLayerTraceRecorder.hxx"
+#endif
+
+#endif // __itkLevelSetLayerTraceRecorder_h
@@ -0,0 +1,258 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetLayerTraceRecorder_hxx
+#define __itkLevelSetLayerTraceRecorder_hxx
+
+#include "itkLevelSetLayerTraceRecorder.h"
+
+namespace itk
+{
+template< class TLevelSet >
+LevelSetLayerTraceRecorder< TLevelSet >
+::LevelSetLayerTraceRecorder() :
+  m_KeyFramePeriod( 100 ),
+  m_Iteration( 0 ),
+  m_NumberOfBytesWritten( 0 )
+{
+  this->m_LayerIds = LayerTraitsType::GetLayerIds();
+  this->m_Layers.resize( this->m_LayerIds.size() );
+  this->m_Added.resize( this->m_LayerIds.size() );
+  this->m_Moved.resize( this->m_LayerIds.size() );
+}
+
+template< class TLevelSet >
+LevelSetLayerTraceRecorder< TLevelSet >
+::~LevelSetLayerTraceRecorder()
+{
+  this->Close();
+}
+
+template< class TLevelSet >
+void
+LevelSetLayerTraceRecorder< TLevelSet >
+::Open()
+{
+  if( this->m_LevelSet.IsNull() )
+    {
+    itkExceptionMacro( << "m_LevelSet is NULL" );
+    }
+
+  this->Close();
+
+  this->m_Stream.open( this->m_FileName.c_str(),
+                       std::ios::out | std::ios::binary | std::ios::trunc );
+  if( !this->m_Stream.is_open() )
+    {
+    itkExceptionMacro( << "Could not open " << this->m_FileName << " for writing" );
+    }
+
+  this->m_Region = this->m_LevelSet->GetLabelMap()->GetLargestPossibleRegion();
+
+  for( size_t position = 0; position < this->m_Layers.size(); position++ )
+    {
+    this->m_Layers[position].SetRegion( this->m_Region );
+    }
+
+  this->m_Iteration = 0;
+  this->m_NumberOfBytesWritten = 0;
+  this->WriteHeader();
+
+  this->CollectNodes( this->m_Nodes );
+  this->WriteFrame( 0, true );
+  this->m_Nodes.swap( this->m_PreviousNodes );
+
+  this->m_Stream.flush();
+}
+
+template< class TLevelSet >
+void
+LevelSetLayerTraceRecorder< TLevelSet >
+::Close()
+{
+  if( this->m_Stream.is_open() )
+    {
+    this->m_Stream.close();
+    }
+}
+
+template< class TLevelSet >
+void
+LevelSetLayerTraceRecorder< TLevelSet >
+::WriteHeader()
+{
+  this->m_Stream.write( LevelSetLayerTrace::GetFileMagic(), 8 );
+  this->m_NumberOfBytesWritten += 8;
+
+  this->Write( static_cast< uint32_t >( ImageDimension ) );
+  this->Write( static_cast< uint32_t >( this->m_LayerIds.size() ) );
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    this->Write( static_cast< int64_t >( this->m_Region.GetIndex()[dim] ) );
+    }
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    this->Write( static_cast< uint64_t >( this->m_Region.GetSize()[dim] ) );
+    }
+  for( typename LayerIdListType::const_iterator it = this->m_LayerIds.begin();
+       it != this->m_LayerIds.end(); ++it )
+    {
+    this->Write( static_cast< int8_t >( *it ) );
+    }
+}
+
+template< class TLevelSet >
+void
+LevelSetLayerTraceRecorder< TLevelSet >
+::CollectNodes( NodeListType& oNodes )
+{
+  const LevelSetType* levelSet = this->m_LevelSet.GetPointer();
+
+  for( size_t position = 0; position < this->m_LayerIds.size(); position++ )
+    {
+    this->m_Layers[position].AssignOffsets( levelSet, this->m_LayerIds[position] );
+    }
+
+  SortedLayerType::Merge( &this->m_Layers[0], this->m_Layers.size(), oNodes );
+}
+
+template< class TLevelSet >
+void
+LevelSetLayerTraceRecorder< TLevelSet >
+::WriteFrame( IdentifierType iIteration, bool iKeyFrame )
+{
+  const size_t numberOfLayers = this->m_LayerIds.size();
+
+  this->m_Buffer.clear();
+
+  if( iKeyFrame )
+    {
+    // the sorted layers of m_Nodes
+    for( size_t i = 0; i < numberOfLayers; i++ )
+      {
+      const OffsetListType & offsets = this->m_Layers[i].GetOffsets();
+      LevelSetLayerTrace::EncodeOffsets( offsets.begin(), offsets.end(), this->m_Buffer );
+      }
+    }
+  else
+    {
+    // Both node lists are sorted: one merge gives every change.
+    OffsetListType & removed = this->m_Removed;
+    std::vector< OffsetListType > & added = this->m_Added;
+    std::vector< OffsetListType > & moved = this->m_Moved;
+
+    removed.clear();
+    for( size_t i = 0; i < numberOfLayers; i++ )
+      {
+      added[i].clear();
+      moved[i].clear();
+      }
+
+    typename NodeListType::const_iterator pIt = this->m_PreviousNodes.begin();
+    typename NodeListType::const_iterator cIt = this->m_Nodes.begin();
+
+    while( ( pIt != this->m_PreviousNodes.end() ) || ( cIt != this->m_Nodes.end() ) )
+      {
+      if( ( cIt == this->m_Nodes.end() ) ||
+          ( ( pIt != this->m_PreviousNodes.end() ) && ( pIt->first < cIt->first ) ) )
+        {
+        removed.push_back( pIt->first );
+        ++pIt;
+        }
+      else if( ( pIt == this->m_PreviousNodes.end() ) || ( cIt->first < pIt->first ) )
+        {
+        added[cIt->second].push_back( cIt->first );
+        ++cIt;
+        }
+      else
+        {
+        if( cIt->second != pIt->second )
+          {
+          moved[cIt->second].push_back( cIt->first );
+          }
+        ++pIt;
+        ++cIt;
+        }
+      }
+
+    LevelSetLayerTrace::EncodeOffsets( removed.begin(), removed.end(), this->m_Buffer );
+    for( size_t i = 0; i < numberOfLayers; i++ )
+      {
+      LevelSetLayerTrace::EncodeOffsets( added[i].begin(), added[i].end(), this->m_Buffer );
+      }
+    for( size_t i = 0; i < numberOfLayers; i++ )
+      {
+      LevelSetLayerTrace::EncodeOffsets( moved[i].begin(), moved[i].end(), this->m_Buffer );
+      }
+    }
+
+  this->Write( LevelSetLayerTrace::GetFrameMagic() );
+  this->Write( static_cast< uint32_t >( iKeyFrame ? LevelSetLayerTrace::KeyFrame : LevelSetLayerTrace::DeltaFrame ) );
+  this->Write( static_cast< uint64_t >( iIteration ) );
+  this->Write( static_cast< uint64_t >( this->m_Nodes.size() ) );
+  this->Write( static_cast< uint64_t >( this->m_Buffer.size() ) );
+
+  if( !this->m_Buffer.empty() )
+    {
+    this->m_Stream.write( reinterpret_cast< const char* >( &this->m_Buffer[0] ),
+                          static_cast< std::streamsize >( this->m_Buffer.size() ) );
+    this->m_NumberOfBytesWritten += this->m_Buffer.size();
+    }
+
+  if( !this->m_Stream.good() )
+    {
+    itkExceptionMacro( << "Could not write to " << this->m_FileName );
+    }
+}
+
+template< class TLevelSet >
+void
+LevelSetLayerTraceRecorder< TLevelSet >
+::Execute( const Object* itkNotUsed( caller ), const EventObject& event )
+{
+  if( !IterationEvent().CheckEvent( &event ) || !this->m_Stream.is_open() )
+    {
+    return;
+    }
+
+  ++this->m_Iteration;
+
+  const bool keyFrame = ( this->m_KeyFramePeriod > 0 ) &&
+    ( this->m_Iteration % this->m_KeyFramePeriod == 0 );
+
+  this->CollectNodes( this->m_Nodes );
+  this->WriteFrame( this->m_Iteration, keyFrame );
+  this->m_Nodes.swap( this->m_PreviousNodes );
+
+  if( keyFrame )
+    {
+    this->m_Stream.flush();
+    }
+}
+
+template< class TLevelSet >
+void
+LevelSetLayerTraceRecorder< TLevelSet >
+::Execute( Object* caller, const EventObject& event )
+{
+  this->Execute( const_cast< const Object* >( caller ), event );
+}
+
+}
+#endif // __itkLevelSetLayerTraceRecorder_hxx
@@ -0,0 +1,77 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetProfilingClock_h
+#define __itkLevelSetProfilingClock_h
+
+#if defined( _WIN32 )
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace itk
+{
+/**
+ *  \class LevelSetProfilingClock
+ *  \brief Monotonic clock for timing calls of a fraction of a microsecond.
+ *
+ *  RealTimeClock has a resolution of a microsecond, about the cost of
+ *  evaluating a term at a few nodes. This clock reads the monotonic
+ *  counter of the system instead, and estimates the cost of reading it,
+ *  to be subtracted from the times accumulated over many calls.
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+class LevelSetProfilingClock
+{
+public:
+  /** Current time in seconds, from an arbitrary origin */
+  static double GetTime()
+    {
+#if defined( _WIN32 )
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter( &counter );
+    QueryPerformanceFrequency( &frequency );
+    return static_cast< double >( counter.QuadPart ) / static_cast< double >( frequency.QuadPart );
+#else
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return static_cast< double >( now.tv_sec ) + 1e-9 * static_cast< double >( now.tv_nsec );
+#endif
+    }
+
+  /** Time measured for an empty interval, i.e. the cost of one timed call
+   * beyond the call itself */
+  static double EstimateOverhead()
+    {
+    const unsigned int numberOfSamples = 100000;
+
+    double total = 0.;
+    for( unsigned int i = 0; i < numberOfSamples; i++ )
+      {
+      const double start = GetTime();
+      total += GetTime() - start;
+      }
+    return total / numberOfSamples;
+    }
+};
+}
+
+#endif // __itkLevelSetProfilingClock_h
@@ -0,0 +1,184 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetSegmentationEngine_h
+#define __itkLevelSetSegmentationEngine_h
+
+#include "itkObject.h"
+#include "itkImage.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkLevelSetDomainMapImageFilter.h"
+#include "itkTabulatedHeavisideStepFunction.h"
+
+#include <list>
+#include <string>
+
+namespace itk
+{
+/**
+ *  \class LevelSetSegmentationEngine
+ *  \brief Segment a sequence of images with the same Chan and Vese settings.
+ *
+ *  The engine is configured once and then segments any number of images
+ *  with Segment(). The Heaviside function, and the identifier image and
+ *  domain map, which only depend on the size of the images, are built
+ *  once and shared by all the runs; the sparse level-set, the terms, the
+ *  containers, the evolution and its stopping criteria are small and
+ *  rebuilt for every image, so that no state leaks from one run to the
+ *  next.
+ *
+ *  Segment() may be called from several threads at once. Process() runs a
+ *  whole batch on a pool of NumberOfThreads threads, each thread taking
+ *  the next image of the batch as soon as it is done with the previous one.
+ *
+ *  \tparam TInputImage Input image type
+ *  \tparam TLevelSet Whitaker, Shi or Malcolm sparse level-set image
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TInputImage, class TLevelSet >
+class LevelSetSegmentationEngine : public Object
+{
+public:
+  typedef LevelSetSegmentationEngine  Self;
+  typedef Object                      Superclass;
+  typedef SmartPointer< Self >        Pointer;
+  typedef SmartPointer< const Self >  ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetSegmentationEngine, Object );
+
+  typedef TInputImage                               InputImageType;
+  typedef typename InputImageType::Pointer          InputImagePointer;
+  typedef typename InputImageType::RegionType       RegionType;
+
+  typedef TLevelSet                                 LevelSetType;
+  typedef typename LevelSetType::Pointer            LevelSetPointer;
+  typedef typename LevelSetType::OutputRealType     LevelSetOutputRealType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, InputImageType::ImageDimension );
+
+  typedef TabulatedHeavisideStepFunction<
+    LevelSetOutputRealType, LevelSetOutputRealType >  HeavisideType;
+
+  typedef std::list< IdentifierType >                 IdListType;
+  typedef Image< IdListType, ImageDimension >         IdListImageType;
+  typedef Image< short, ImageDimension >              CacheImageType;
+  typedef LevelSetDomainMapImageFilter< IdListImageType, CacheImageType >
+                                                      DomainMapImageFilterType;
+
+  /** Source of the images of a batch, and sink of their level-sets. Its
+   * methods are called from the threads of Process(), each time for a
+   * different image index. */
+  class Batch
+  {
+  public:
+    virtual ~Batch() {}
+
+    virtual SizeValueType GetNumberOfImages() const = 0;
+
+    virtual InputImagePointer GetImage( SizeValueType iIndex ) = 0;
+
+    virtual void SetLevelSet( SizeValueType iIndex, InputImageType* iImage,
+                              LevelSetType* iLevelSet, unsigned int iNumberOfIterations ) = 0;
+  };
+
+  /** Seed box, in the index space of the images. By default, the central
+   * half of each image. */
+  void SetSeedRegion( const RegionType& iRegion );
+  void UseCentralSeedRegion();
+
+  /** Maximum number of iterations */
+  itkSetMacro( NumberOfIterations, unsigned int );
+  itkGetConstMacro( NumberOfIterations, unsigned int );
+
+  /** The evolution stops once the RMS change stays below this threshold
+   * for NumberOfConsecutiveIterations */
+  itkSetMacro( RMSChangeThreshold, double );
+  itkGetConstMacro( RMSChangeThreshold, double );
+
+  itkSetMacro( NumberOfConsecutiveIterations, unsigned int );
+  itkGetConstMacro( NumberOfConsecutiveIterations, unsigned int );
+
+  /** Number of images segmented at once by Process() */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Segment one image. oNumberOfIterations, if not NULL, receives the
+   * number of iterations of the evolution. Thread safe. */
+  LevelSetPointer Segment( InputImageType* iImage, unsigned int* oNumberOfIterations = NULL );
+
+  /** Segment every image of the batch */
+  void Process( Batch* ioBatch );
+
+  /** Number of times the domain map had to be built */
+  SizeValueType GetNumberOfDomainMapBuilds() const
+    {
+    return this->m_NumberOfDomainMapBuilds;
+    }
+
+protected:
+  LevelSetSegmentationEngine();
+  virtual ~LevelSetSegmentationEngine() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Domain map of images of region iRegion, built on the first request */
+  typename DomainMapImageFilterType::Pointer GetDomainMap( const RegionType& iRegion );
+
+  /** Seed box for an image of region iRegion */
+  RegionType GetSeedRegion( const RegionType& iRegion ) const;
+
+  static ITK_THREAD_RETURN_TYPE ProcessThreadCallback( void* arg );
+
+private:
+  LevelSetSegmentationEngine( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  typename HeavisideType::Pointer             m_Heaviside;
+
+  SimpleFastMutexLock                         m_DomainMapMutex;
+  typename DomainMapImageFilterType::Pointer  m_DomainMapFilter;
+  RegionType                                  m_DomainMapRegion;
+  SizeValueType                               m_NumberOfDomainMapBuilds;
+
+  RegionType                                  m_SeedRegion;
+  bool                                        m_UseCentralSeedRegion;
+
+  unsigned int                                m_NumberOfIterations;
+  double                                      m_RMSChangeThreshold;
+  unsigned int                                m_NumberOfConsecutiveIterations;
+  ThreadIdType                                m_NumberOfThreads;
+
+  /** State of the batch being processed */
+  SimpleFastMutexLock                         m_BatchMutex;
+  Batch*                                      m_Batch;
+  SizeValueType                               m_NextImage;
+  std::string                                 m_BatchError;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetSegmentationEngine.hxx"
+#endif
+
+#endif // __itkLevelSetSegmentationEngine_h
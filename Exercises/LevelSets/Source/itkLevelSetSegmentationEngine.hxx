@@ -0,0 +1,320 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetSegmentationEngine_hxx
+#define __itkLevelSetSegmentationEngine_hxx
+
+#include "itkLevelSetSegmentationEngine.h"
+
+#include "itkLevelSetContainer.h"
+#include "itkLevelSetEquationChanAndVeseInternalTerm.h"
+#include "itkLevelSetEquationChanAndVeseExternalTerm.h"
+#include "itkLevelSetEquationTermContainer.h"
+#include "itkLevelSetEquationContainer.h"
+#include "itkLevelSetEvolution.h"
+#include "itkLevelSetEvolutionNumberOfIterationsStoppingCriterion.h"
+#include "itkLevelSetEvolutionRMSChangeStoppingCriterion.h"
+#include "itkLevelSetEvolutionCompositeStoppingCriterion.h"
+#include "itkSeedToSparseLevelSetImageAdaptor.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace itk
+{
+template< class TInputImage, class TLevelSet >
+LevelSetSegmentationEngine< TInputImage, TLevelSet >
+::LevelSetSegmentationEngine() :
+  m_NumberOfDomainMapBuilds( 0 ),
+  m_UseCentralSeedRegion( true ),
+  m_NumberOfIterations( 100 ),
+  m_RMSChangeThreshold( 1e-3 ),
+  m_NumberOfConsecutiveIterations( 3 ),
+  m_NumberOfThreads( 1 ),
+  m_Batch( NULL ),
+  m_NextImage( 0 )
+{
+  this->m_Heaviside = HeavisideType::New();
+  this->m_Heaviside->SetEpsilon( 1.0 );
+}
+
+template< class TInputImage, class TLevelSet >
+void
+LevelSetSegmentationEngine< TInputImage, TLevelSet >
+::SetSeedRegion( const RegionType& iRegion )
+{
+  this->m_SeedRegion = iRegion;
+  this->m_UseCentralSeedRegion = false;
+  this->Modified();
+}
+
+template< class TInputImage, class TLevelSet >
+void
+LevelSetSegmentationEngine< TInputImage, TLevelSet >
+::UseCentralSeedRegion()
+{
+  this->m_UseCentralSeedRegion = true;
+  this->Modified();
+}
+
+template< class TInputImage, class TLevelSet >
+typename LevelSetSegmentationEngine< TInputImage, TLevelSet >::RegionType
+LevelSetSegmentationEngine< TInputImage, TLevelSet >
+::GetSeedRegion( const RegionType& iRegion ) const
+{
+  if( !this->m_UseCentralSeedRegion )
+    {
+    return this->m_SeedRegion;
+    }
+
+  RegionType region = iRegion;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    const SizeValueType size = std::max( iRegion.GetSize()[dim] / 2, SizeValueType( 1 ) );
+    region.SetIndex( dim, iRegion.GetIndex()[dim] +
+                     static_cast< OffsetValueType >( ( iRegion.GetSize()[dim] - size ) / 2 ) );
+    region.SetSize( dim, size );
+    }
+  return region;
+}
+
+template< class TInputImage, class TLevelSet >
+typename LevelSetSegmentationEngine< TInputImage, TLevelSet >::DomainMapImageFilterType::Pointer
+LevelSetSegmentationEngine< TInputImage, TLevelSet >
+::GetDomainMap( const RegionType& iRegion )
+{
+  this->m_DomainMapMutex.Lock();
+
+  if( this->m_DomainMapFilter.IsNull() || ( this->m_DomainMapRegion != iRegion ) )
+    {
+    // There is only one level-set, defined on the whole image.
+    IdListType listIds;
+    listIds.push_back( 1 );
+
+    typename IdListImageType::Pointer idImage = IdListImageType::New();
+    idImage->SetRegions( iRegion );
+    idImage->Allocate();
+    idImage->FillBuffer( listIds );
+
+    typename DomainMapImageFilterType::Pointer domainMapFilter = DomainMapImageFilterType::New();
+    domainMapFilter->SetInput( idImage );
+    domainMapFilter->Update();
+
+    // Runs still holding the previous domain map keep it alive.
+    this->m_DomainMapFilter = domainMapFilter;
+    this->m_DomainMapRegion = iRegion;
+    ++this->m_NumberOfDomainMapBuilds;
+    }
+
+  typename DomainMapImageFilterType::Pointer domainMapFilter = this->m_DomainMapFilter;
+
+  this->m_DomainMapMutex.Unlock();
+
+  return domainMapFilter;
+}
+
+template< class TInputImage, class TLevelSet >
+typename LevelSetSegmentationEngine< TInputImage, TLevelSet >::LevelSetPointer
+LevelSetSegmentationEngine< TInputImage, TLevelSet >
+::Segment( InputImageType* iImage, unsigned int* oNumberOfIterations )
+{
+  if( iImage == NULL )
+    {
+    itkExceptionMacro( << "iImage is NULL" );
+    }
+
+  const RegionType region = iImage->GetLargestPossibleRegion();
+
+  typedef SeedToSparseLevelSetImageAdaptor< LevelSetType > SeedToSparseAdaptorType;
+  typename SeedToSparseAdaptorType::Pointer adaptor = SeedToSparseAdaptorType::New();
+  adaptor->SetReferenceImage( iImage );
+  adaptor->AddRegion( this->GetSeedRegion( region ) );
+  adaptor->Initialize();
+
+  LevelSetPointer levelSet = adaptor->GetLevelSet();
+
+  typedef LevelSetContainer< IdentifierType, LevelSetType > LevelSetContainerType;
+  typename LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
+  lscontainer->SetHeaviside( this->m_Heaviside );
+  lscontainer->SetDomainMapFilter( this->GetDomainMap( region ) );
+  lscontainer->AddLevelSet( 0, levelSet );
+
+  typedef LevelSetEquationChanAndVeseInternalTerm<
+    InputImageType, LevelSetContainerType > InternalTermType;
+  typename InternalTermType::Pointer cvInternalTerm = InternalTermType::New();
+  cvInternalTerm->SetInput( iImage );
+  cvInternalTerm->SetCoefficient( 1.0 );
+  cvInternalTerm->SetCurrentLevelSetId( 0 );
+  cvInternalTerm->SetLevelSetContainer( lscontainer );
+
+  typedef LevelSetEquationChanAndVeseExternalTerm<
+    InputImageType, LevelSetContainerType > ExternalTermType;
+  typename ExternalTermType::Pointer cvExternalTerm = ExternalTermType::New();
+  cvExternalTerm->SetInput( iImage );
+  cvExternalTerm->SetCoefficient( 1.0 );
+  cvExternalTerm->SetCurrentLevelSetId( 0 );
+  cvExternalTerm->SetLevelSetContainer( lscontainer );
+
+  typedef LevelSetEquationTermContainer< InputImageType, LevelSetContainerType > TermContainerType;
+  typename TermContainerType::Pointer termContainer = TermContainerType::New();
+  termContainer->SetInput( iImage );
+  termContainer->SetCurrentLevelSetId( 0 );
+  termContainer->SetLevelSetContainer( lscontainer );
+  termContainer->AddTerm( 0, cvInternalTerm );
+  termContainer->AddTerm( 1, cvExternalTerm );
+
+  typedef LevelSetEquationContainer< TermContainerType > EquationContainerType;
+  typename EquationContainerType::Pointer equationContainer = EquationContainerType::New();
+  equationContainer->SetLevelSetContainer( lscontainer );
+  equationContainer->AddEquation( 0, termContainer );
+
+  typedef LevelSetEvolutionNumberOfIterationsStoppingCriterion<
+    LevelSetContainerType > NumberOfIterationsCriterionType;
+  typename NumberOfIterationsCriterionType::Pointer numberOfIterationsCriterion =
+    NumberOfIterationsCriterionType::New();
+  numberOfIterationsCriterion->SetNumberOfIterations( this->m_NumberOfIterations );
+
+  typedef LevelSetEvolutionRMSChangeStoppingCriterion< LevelSetContainerType > RMSChangeCriterionType;
+  typename RMSChangeCriterionType::Pointer rmsChangeCriterion = RMSChangeCriterionType::New();
+  rmsChangeCriterion->SetRMSChangeThreshold( this->m_RMSChangeThreshold );
+  rmsChangeCriterion->SetNumberOfConsecutiveIterations( this->m_NumberOfConsecutiveIterations );
+
+  typedef LevelSetEvolutionCompositeStoppingCriterion< LevelSetContainerType > StoppingCriterionType;
+  typename StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
+  criterion->SetLevelSetContainer( lscontainer );
+  criterion->AddCriterion( numberOfIterationsCriterion );
+  criterion->AddCriterion( rmsChangeCriterion );
+
+  typedef LevelSetEvolution< EquationContainerType, LevelSetType > LevelSetEvolutionType;
+  typename LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+  evolution->SetEquationContainer( equationContainer );
+  evolution->SetStoppingCriterion( criterion );
+  evolution->SetLevelSetContainer( lscontainer );
+  evolution->Update();
+
+  if( oNumberOfIterations != NULL )
+    {
+    *oNumberOfIterations = static_cast< unsigned int >( criterion->GetCurrentIteration() );
+    }
+
+  return levelSet;
+}
+
+template< class TInputImage, class TLevelSet >
+void
+LevelSetSegmentationEngine< TInputImage, TLevelSet >
+::Process( Batch* ioBatch )
+{
+  if( ioBatch == NULL )
+    {
+    itkExceptionMacro( << "ioBatch is NULL" );
+    }
+
+  this->m_Batch = ioBatch;
+  this->m_NextImage = 0;
+  this->m_BatchError.clear();
+
+  const ThreadIdType numberOfThreads = static_cast< ThreadIdType >(
+    std::min( static_cast< SizeValueType >( this->m_NumberOfThreads ),
+              std::max( ioBatch->GetNumberOfImages(), SizeValueType( 1 ) ) ) );
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( ProcessThreadCallback, this );
+  threader->SingleMethodExecute();
+
+  this->m_Batch = NULL;
+
+  if( !this->m_BatchError.empty() )
+    {
+    itkExceptionMacro( << this->m_BatchError );
+    }
+}
+
+template< class TInputImage, class TLevelSet >
+ITK_THREAD_RETURN_TYPE
+LevelSetSegmentationEngine< TInputImage, TLevelSet >
+::ProcessThreadCallback( void* arg )
+{
+  MultiThreader::ThreadInfoStruct* info = static_cast< MultiThreader::ThreadInfoStruct* >( arg );
+  Self* self = static_cast< Self* >( info->UserData );
+
+  const SizeValueType numberOfImages = self->m_Batch->GetNumberOfImages();
+
+  while( true )
+    {
+    // Take the next image, unless every image is taken or a run failed.
+    self->m_BatchMutex.Lock();
+    const SizeValueType index = self->m_NextImage;
+    const bool done = ( index >= numberOfImages ) || !self->m_BatchError.empty();
+    if( !done )
+      {
+      ++self->m_NextImage;
+      }
+    self->m_BatchMutex.Unlock();
+
+    if( done )
+      {
+      break;
+      }
+
+    try
+      {
+      InputImagePointer image = self->m_Batch->GetImage( index );
+
+      unsigned int numberOfIterations = 0;
+      LevelSetPointer levelSet = self->Segment( image, &numberOfIterations );
+
+      self->m_Batch->SetLevelSet( index, image, levelSet, numberOfIterations );
+      }
+    catch( ExceptionObject& err )
+      {
+      self->m_BatchMutex.Lock();
+      if( self->m_BatchError.empty() )
+        {
+        std::ostringstream message;
+        message << "Image " << index << ": " << err.GetDescription();
+        self->m_BatchError = message.str();
+        }
+      self->m_BatchMutex.Unlock();
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TLevelSet >
+void
+LevelSetSegmentationEngine< TInputImage, TLevelSet >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfIterations: " << this->m_NumberOfIterations << std::endl;
+  os << indent << "RMSChangeThreshold: " << this->m_RMSChangeThreshold << std::endl;
+  os << indent << "NumberOfConsecutiveIterations: " << this->m_NumberOfConsecutiveIterations << std::endl;
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "UseCentralSeedRegion: " << this->m_UseCentralSeedRegion << std::endl;
+  if( !this->m_UseCentralSeedRegion )
+    {
+    os << indent << "SeedRegion: " << this->m_SeedRegion << std::endl;
+    }
+  os << indent << "NumberOfDomainMapBuilds: " << this->m_NumberOfDomainMapBuilds << std::endl;
+}
+
+}
+#endif // __itkLevelSetSegmentationEngine_hxx
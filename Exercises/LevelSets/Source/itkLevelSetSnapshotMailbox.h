@@ -0,0 +1,79 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetSnapshotMailbox_h
+#define __itkLevelSetSnapshotMailbox_h
+
+#include "itkMacro.h"
+
+namespace itk
+{
+/**
+ *  \class LevelSetSnapshotMailbox
+ *  \brief Lock-free single-slot mailbox handing level-set snapshots from
+ *  one producer thread to one consumer thread.
+ *
+ *  The slot holds at most one snapshot; publishing into a full slot drops
+ *  the stale snapshot. The consumer raises a request flag when it is ready
+ *  for a new snapshot, so that the producer only pays for a copy when it
+ *  will be consumed. Both the slot and the flag are only ever accessed
+ *  through atomic exchanges.
+ *
+ *  \tparam TLevelSet Level-set type of the snapshots
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TLevelSet >
+class LevelSetSnapshotMailbox
+{
+public:
+  typedef TLevelSet                       LevelSetType;
+  typedef typename LevelSetType::Pointer  LevelSetPointer;
+
+  LevelSetSnapshotMailbox();
+  ~LevelSetSnapshotMailbox();
+
+  /** Producer: put iSnapshot in the slot, dropping the snapshot it held */
+  void Publish( LevelSetType* iSnapshot );
+
+  /** Consumer: take the snapshot out of the slot, NULL if empty */
+  LevelSetPointer Take();
+
+  /** Consumer: ask for a new snapshot */
+  void Request();
+
+  /** Producer: return true, and clear the flag, if a snapshot was asked */
+  bool TakeRequest();
+
+private:
+  LevelSetSnapshotMailbox( const LevelSetSnapshotMailbox& ); // purposely not implemented
+  void operator = ( const LevelSetSnapshotMailbox& ); // purposely not implemented
+
+  static void* ExchangePointer( void* volatile* ioTarget, void* iValue );
+  static long ExchangeFlag( volatile long* ioTarget, long iValue );
+
+  void* volatile  m_Slot;
+  volatile long   m_Requested;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetSnapshotMailbox.hxx"
+#endif
+
+#endif // __itkLevelSetSnapshotMailbox_h
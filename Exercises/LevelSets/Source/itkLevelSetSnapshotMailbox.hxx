@@ -0,0 +1,120 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetSnapshotMailbox_hxx
+#define __itkLevelSetSnapshotMailbox_hxx
+
+#include "itkLevelSetSnapshotMailbox.h"
+
+#if defined( _WIN32 )
+#include "itkWindows.h"
+#endif
+
+namespace itk
+{
+template< class TLevelSet >
+LevelSetSnapshotMailbox< TLevelSet >
+::LevelSetSnapshotMailbox() :
+  m_Slot( NULL ),
+  m_Requested( 0 )
+{}
+
+template< class TLevelSet >
+LevelSetSnapshotMailbox< TLevelSet >
+::~LevelSetSnapshotMailbox()
+{
+  // Release the snapshot left in the slot, if any.
+  this->Take();
+}
+
+template< class TLevelSet >
+void*
+LevelSetSnapshotMailbox< TLevelSet >
+::ExchangePointer( void* volatile* ioTarget, void* iValue )
+{
+#if defined( _WIN32 )
+  return InterlockedExchangePointer( ioTarget, iValue );
+#else
+  return __atomic_exchange_n( ioTarget, iValue, __ATOMIC_ACQ_REL );
+#endif
+}
+
+template< class TLevelSet >
+long
+LevelSetSnapshotMailbox< TLevelSet >
+::ExchangeFlag( volatile long* ioTarget, long iValue )
+{
+#if defined( _WIN32 )
+  return InterlockedExchange( ioTarget, iValue );
+#else
+  return __atomic_exchange_n( ioTarget, iValue, __ATOMIC_ACQ_REL );
+#endif
+}
+
+template< class TLevelSet >
+void
+LevelSetSnapshotMailbox< TLevelSet >
+::Publish( LevelSetType* iSnapshot )
+{
+  if( iSnapshot != NULL )
+    {
+    // the slot owns one reference
+    iSnapshot->Register();
+    }
+
+  LevelSetType* stale = static_cast< LevelSetType* >( ExchangePointer( &this->m_Slot, iSnapshot ) );
+
+  if( stale != NULL )
+    {
+    stale->UnRegister();
+    }
+}
+
+template< class TLevelSet >
+typename LevelSetSnapshotMailbox< TLevelSet >::LevelSetPointer
+LevelSetSnapshotMailbox< TLevelSet >
+::Take()
+{
+  LevelSetType* snapshot = static_cast< LevelSetType* >( ExchangePointer( &this->m_Slot, NULL ) );
+
+  LevelSetPointer output = snapshot;
+  if( snapshot != NULL )
+    {
+    snapshot->UnRegister();
+    }
+  return output;
+}
+
+template< class TLevelSet >
+void
+LevelSetSnapshotMailbox< TLevelSet >
+::Request()
+{
+  ExchangeFlag( &this->m_Requested, 1 );
+}
+
+template< class TLevelSet >
+bool
+LevelSetSnapshotMailbox< TLevelSet >
+::TakeRequest()
+{
+  return ( ExchangeFlag( &this->m_Requested, 0 ) != 0 );
+}
+
+}
+#endif // __itkLevelSetSnapshotMailbox_hxx
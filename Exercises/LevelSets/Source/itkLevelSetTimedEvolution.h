@@ -0,0 +1,116 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkLevelSetTimedEvolution_h
+#define __itkLevelSetTimedEvolution_h
+
+#include "itkLevelSetEvolution.h"
+#include "itkLevelSetProfilingClock.h"
+
+namespace itk
+{
+/**
+ *  \class LevelSetTimedEvolution
+ *  \brief Evolution measuring the time spent in each step of its iterations.
+ *
+ *  Behaves as TEvolution, and accumulates the time spent:
+ *  - computing the updates of the nodes (ComputeIteration), where the
+ *  terms are evaluated for a Whitaker level-set;
+ *  - updating the layers (UpdateLevelSets), including the UpdatePixel
+ *  calls of the terms; Shi and Malcolm level-sets also evaluate their
+ *  terms there;
+ *  - updating the equations (UpdateEquations), i.e. the statistics of the
+ *  terms.
+ *
+ *  \tparam TEvolution Evolution timed, LevelSetEvolution by default
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TEquationContainer, class TLevelSet,
+          class TEvolution = LevelSetEvolution< TEquationContainer, TLevelSet > >
+class LevelSetTimedEvolution : public TEvolution
+{
+public:
+  typedef LevelSetTimedEvolution                            Self;
+  typedef TEvolution                                        Superclass;
+  typedef SmartPointer< Self >                              Pointer;
+  typedef SmartPointer< const Self >                        ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( LevelSetTimedEvolution, LevelSetEvolution );
+
+  /** Reset the times */
+  void ResetTimes()
+    {
+    this->m_ComputeIterationTime = 0.;
+    this->m_UpdateLevelSetsTime = 0.;
+    this->m_UpdateEquationsTime = 0.;
+    }
+
+  /** Seconds spent computing the updates of the nodes */
+  double GetComputeIterationTime() const { return this->m_ComputeIterationTime; }
+
+  /** Seconds spent updating the layers */
+  double GetUpdateLevelSetsTime() const { return this->m_UpdateLevelSetsTime; }
+
+  /** Seconds spent updating the equations */
+  double GetUpdateEquationsTime() const { return this->m_UpdateEquationsTime; }
+
+protected:
+  LevelSetTimedEvolution()
+    {
+    this->ResetTimes();
+    }
+
+  virtual ~LevelSetTimedEvolution() {}
+
+  virtual void ComputeIteration()
+    {
+    const double start = LevelSetProfilingClock::GetTime();
+    Superclass::ComputeIteration();
+    this->m_ComputeIterationTime += LevelSetProfilingClock::GetTime() - start;
+    }
+
+  virtual void UpdateLevelSets()
+    {
+    const double start = LevelSetProfilingClock::GetTime();
+    Superclass::UpdateLevelSets();
+    this->m_UpdateLevelSetsTime += LevelSetProfilingClock::GetTime() - start;
+    }
+
+  virtual void UpdateEquations()
+    {
+    const double start = LevelSetProfilingClock::GetTime();
+    Superclass::UpdateEquations();
+    this->m_UpdateEquationsTime += LevelSetProfilingClock::GetTime() - start;
+    }
+
+private:
+  LevelSetTimedEvolution( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  double m_ComputeIterationTime;
+  double m_UpdateLevelSetsTime;
+  double m_UpdateEquationsTime;
+};
+}
+
+#endif // __itkLevelSetTimedEvolution_h
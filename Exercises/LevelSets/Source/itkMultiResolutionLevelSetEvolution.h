@@ -0,0 +1,179 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkMultiResolutionLevelSetEvolution_h
+#define __itkMultiResolutionLevelSetEvolution_h
+
+#include "itkObject.h"
+#include "itkImage.h"
+#include "itkSeedToSparseLevelSetImageAdaptor.h"
+
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class MultiResolutionLevelSetEvolution
+ *  \brief Evolve a sparse level-set coarse to fine on an image pyramid.
+ *
+ *  The input is shrunk by each of the shrink factors, from the largest to
+ *  the smallest which must be 1. The level-set is seeded on the coarsest
+ *  image and evolved there with a Chan and Vese equation, until it
+ *  converges or reaches the maximum number of iterations. The interior of
+ *  the resulting level-set is then upsampled, line by line, to seed the
+ *  level-set of the next finer image, so that most of the travel of the
+ *  front happens on the coarse images and only a few iterations are left
+ *  to refine it at full resolution.
+ *
+ *  An IterationEvent is invoked at the end of each level.
+ *
+ *  \tparam TInputImage Input image type
+ *  \tparam TLevelSet Whitaker, Shi or Malcolm sparse level-set image
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TInputImage, class TLevelSet >
+class MultiResolutionLevelSetEvolution : public Object
+{
+public:
+  typedef MultiResolutionLevelSetEvolution  Self;
+  typedef Object                            Superclass;
+  typedef SmartPointer< Self >              Pointer;
+  typedef SmartPointer< const Self >        ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( MultiResolutionLevelSetEvolution, Object );
+
+  typedef TInputImage                               InputImageType;
+  typedef typename InputImageType::Pointer          InputImagePointer;
+  typedef typename InputImageType::ConstPointer     InputImageConstPointer;
+  typedef typename InputImageType::RegionType       RegionType;
+  typedef typename InputImageType::IndexType        IndexType;
+
+  typedef TLevelSet                                 LevelSetType;
+  typedef typename LevelSetType::Pointer            LevelSetPointer;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, InputImageType::ImageDimension );
+
+  typedef SeedToSparseLevelSetImageAdaptor< LevelSetType >  SeedAdaptorType;
+  typedef typename SeedAdaptorType::Pointer                 SeedAdaptorPointer;
+
+  typedef std::vector< unsigned int >               ShrinkFactorListType;
+  typedef std::vector< unsigned int >               IterationListType;
+
+  /** Full resolution input image */
+  itkSetConstObjectMacro( Input, InputImageType );
+  itkGetConstObjectMacro( Input, InputImageType );
+
+  /** Shrink factors from the coarsest to the finest level; the last one
+   * must be 1. Default is 4, 2, 1. */
+  void SetShrinkFactors( const ShrinkFactorListType& iFactors );
+  const ShrinkFactorListType& GetShrinkFactors() const
+    {
+    return this->m_ShrinkFactors;
+    }
+
+  /** Maximum number of iterations of each level */
+  itkSetMacro( NumberOfIterations, unsigned int );
+  itkGetConstMacro( NumberOfIterations, unsigned int );
+
+  /** A level stops before the maximum number of iterations once the RMS
+   * change stays below this threshold for NumberOfConsecutiveIterations */
+  itkSetMacro( RMSChangeThreshold, double );
+  itkGetConstMacro( RMSChangeThreshold, double );
+
+  itkSetMacro( NumberOfConsecutiveIterations, unsigned int );
+  itkGetConstMacro( NumberOfConsecutiveIterations, unsigned int );
+
+  /** Seed boxes, in the index space of the full resolution input */
+  void AddSeedRegion( const RegionType& iRegion );
+  void ClearSeedRegions();
+
+  /** Run every level */
+  void Update();
+
+  /** Level being evolved, or last level evolved */
+  itkGetConstMacro( CurrentLevel, unsigned int );
+
+  unsigned int GetNumberOfLevels() const
+    {
+    return static_cast< unsigned int >( this->m_ShrinkFactors.size() );
+    }
+
+  /** Number of iterations run at each level */
+  const IterationListType& GetNumberOfIterationsPerLevel() const
+    {
+    return this->m_NumberOfIterationsPerLevel;
+    }
+
+  /** Image of the current level */
+  itkGetConstObjectMacro( CurrentImage, InputImageType );
+
+  /** Level-set of the current level; at full resolution once Update() has
+   * returned */
+  itkGetObjectMacro( LevelSet, LevelSetType );
+
+protected:
+  MultiResolutionLevelSetEvolution();
+  virtual ~MultiResolutionLevelSetEvolution() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Input shrunk by iFactor */
+  InputImagePointer ShrinkInput( unsigned int iFactor ) const;
+
+  /** Evolve the level-set on the image, return the number of iterations */
+  unsigned int EvolveLevel( InputImageType* iImage, LevelSetType* ioLevelSet ) const;
+
+  /** Pixels of iTo covered by the pixels of the region iRegion of iFrom.
+   * The images must only differ by their spacing and origin. */
+  RegionType MapRegion( const InputImageType* iFrom, const InputImageType* iTo,
+                        const RegionType& iRegion ) const;
+
+  /** Level-set of iTo seeded with the interior of the level-set of iFrom */
+  LevelSetPointer UpsampleLevelSet( const InputImageType* iFrom, const InputImageType* iTo,
+                                    LevelSetType* iLevelSet ) const;
+
+private:
+  MultiResolutionLevelSetEvolution( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  InputImageConstPointer  m_Input;
+  InputImagePointer       m_CurrentImage;
+  LevelSetPointer         m_LevelSet;
+
+  ShrinkFactorListType    m_ShrinkFactors;
+  std::vector< RegionType > m_SeedRegions;
+
+  unsigned int            m_NumberOfIterations;
+  double                  m_RMSChangeThreshold;
+  unsigned int            m_NumberOfConsecutiveIterations;
+
+  unsigned int            m_CurrentLevel;
+  IterationListType       m_NumberOfIterationsPerLevel;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMultiResolutionLevelSetEvolution.hxx"
+#endif
+
+#endif // __itkMultiResolutionLevelSetEvolution_h
@@ -0,0 +1,372 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkMultiResolutionLevelSetEvolution_hxx
+#define __itkMultiResolutionLevelSetEvolution_hxx
+
+#include "itkMultiResolutionLevelSetEvolution.h"
+
+#include "itkShrinkImageFilter.h"
+#include "itkContinuousIndex.h"
+#include "itkLevelSetDomainMapImageFilter.h"
+#include "itkLevelSetContainer.h"
+#include "itkLevelSetEquationChanAndVeseInternalTerm.h"
+#include "itkLevelSetEquationChanAndVeseExternalTerm.h"
+#include "itkLevelSetEquationTermContainer.h"
+#include "itkLevelSetEquationContainer.h"
+#include "itkTabulatedHeavisideStepFunction.h"
+#include "itkLevelSetEvolution.h"
+#include "itkLevelSetEvolutionNumberOfIterationsStoppingCriterion.h"
+#include "itkLevelSetEvolutionRMSChangeStoppingCriterion.h"
+#include "itkLevelSetEvolutionCompositeStoppingCriterion.h"
+
+#include <cmath>
+#include <list>
+
+namespace itk
+{
+template< class TInputImage, class TLevelSet >
+MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >
+::MultiResolutionLevelSetEvolution() :
+  m_NumberOfIterations( 100 ),
+  m_RMSChangeThreshold( 1e-3 ),
+  m_NumberOfConsecutiveIterations( 3 ),
+  m_CurrentLevel( 0 )
+{
+  this->m_ShrinkFactors.push_back( 4 );
+  this->m_ShrinkFactors.push_back( 2 );
+  this->m_ShrinkFactors.push_back( 1 );
+}
+
+template< class TInputImage, class TLevelSet >
+void
+MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >
+::SetShrinkFactors( const ShrinkFactorListType& iFactors )
+{
+  if( iFactors.empty() || ( iFactors.back() != 1 ) )
+    {
+    itkExceptionMacro( << "The last shrink factor must be 1" );
+    }
+  for( size_t i = 1; i < iFactors.size(); i++ )
+    {
+    if( iFactors[i] > iFactors[i-1] )
+      {
+      itkExceptionMacro( << "Shrink factors must go from the coarsest to the finest level" );
+      }
+    }
+  this->m_ShrinkFactors = iFactors;
+  this->Modified();
+}
+
+template< class TInputImage, class TLevelSet >
+void
+MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >
+::AddSeedRegion( const RegionType& iRegion )
+{
+  this->m_SeedRegions.push_back( iRegion );
+  this->Modified();
+}
+
+template< class TInputImage, class TLevelSet >
+void
+MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >
+::ClearSeedRegions()
+{
+  this->m_SeedRegions.clear();
+  this->Modified();
+}
+
+template< class TInputImage, class TLevelSet >
+typename MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >::InputImagePointer
+MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >
+::ShrinkInput( unsigned int iFactor ) const
+{
+  if( iFactor == 1 )
+    {
+    // the terms take a non const input, but never modify it
+    return const_cast< InputImageType* >( this->m_Input.GetPointer() );
+    }
+
+  typedef ShrinkImageFilter< InputImageType, InputImageType > ShrinkFilterType;
+  typename ShrinkFilterType::Pointer shrinkFilter = ShrinkFilterType::New();
+  shrinkFilter->SetInput( this->m_Input );
+  shrinkFilter->SetShrinkFactors( iFactor );
+  shrinkFilter->Update();
+
+  InputImagePointer output = shrinkFilter->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+
+template< class TInputImage, class TLevelSet >
+typename MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >::RegionType
+MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >
+::MapRegion( const InputImageType* iFrom, const InputImageType* iTo,
+             const RegionType& iRegion ) const
+{
+  typedef typename InputImageType::PointType          PointType;
+  typedef ContinuousIndex< double, ImageDimension >   ContinuousIndexType;
+
+  IndexType first = iRegion.GetIndex();
+  IndexType last = first;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    last[dim] += static_cast< OffsetValueType >( iRegion.GetSize()[dim] ) - 1;
+    }
+
+  PointType point;
+  ContinuousIndexType toFirst;
+  ContinuousIndexType toLast;
+
+  iFrom->TransformIndexToPhysicalPoint( first, point );
+  iTo->TransformPhysicalPointToContinuousIndex( point, toFirst );
+  iFrom->TransformIndexToPhysicalPoint( last, point );
+  iTo->TransformPhysicalPointToContinuousIndex( point, toLast );
+
+  // A pixel of iFrom covers a box of iTo centered on its center; keep the
+  // pixels of iTo whose center lies in that box.
+  const double tolerance = 1e-6;
+
+  RegionType region;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    const double halfWidth = 0.5 * iFrom->GetSpacing()[dim] / iTo->GetSpacing()[dim];
+
+    OffsetValueType begin =
+      static_cast< OffsetValueType >( std::ceil( toFirst[dim] - halfWidth - tolerance ) );
+    OffsetValueType end =
+      static_cast< OffsetValueType >( std::ceil( toLast[dim] + halfWidth - tolerance ) );
+
+    if( end <= begin )
+      {
+      // seeds smaller than a pixel of iTo still give one pixel
+      begin = static_cast< OffsetValueType >( std::floor( toFirst[dim] + 0.5 ) );
+      end = begin + 1;
+      }
+
+    region.SetIndex( dim, begin );
+    region.SetSize( dim, static_cast< SizeValueType >( end - begin ) );
+    }
+
+  return region;
+}
+
+template< class TInputImage, class TLevelSet >
+typename MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >::LevelSetPointer
+MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >
+::UpsampleLevelSet( const InputImageType* iFrom, const InputImageType* iTo,
+                    LevelSetType* iLevelSet ) const
+{
+  typedef typename LevelSetType::LabelMapType           LabelMapType;
+  typedef typename LabelMapType::LabelObjectVectorType  LabelObjectVectorType;
+  typedef typename LabelMapType::LabelObjectType        LabelObjectType;
+  typedef typename LabelObjectType::LineType            LineType;
+
+  SeedAdaptorPointer adaptor = SeedAdaptorType::New();
+  adaptor->SetReferenceImage( iTo );
+
+  // The interior is the union of the label objects with a non positive
+  // label; each of their lines becomes a box of the finer image.
+  const LabelObjectVectorType labelObjects = iLevelSet->GetLabelMap()->GetLabelObjects();
+
+  for( typename LabelObjectVectorType::const_iterator oIt = labelObjects.begin();
+       oIt != labelObjects.end(); ++oIt )
+    {
+    if( ( *oIt )->GetLabel() > 0 )
+      {
+      continue;
+      }
+
+    for( SizeValueType l = 0; l < ( *oIt )->GetNumberOfLines(); l++ )
+      {
+      const LineType & line = ( *oIt )->GetLine( l );
+
+      RegionType lineRegion;
+      lineRegion.SetIndex( line.GetIndex() );
+      for( unsigned int dim = 1; dim < ImageDimension; dim++ )
+        {
+        lineRegion.SetSize( dim, 1 );
+        }
+      lineRegion.SetSize( 0, line.GetLength() );
+
+      adaptor->AddRegion( this->MapRegion( iFrom, iTo, lineRegion ) );
+      }
+    }
+
+  adaptor->Initialize();
+  return adaptor->GetLevelSet();
+}
+
+template< class TInputImage, class TLevelSet >
+unsigned int
+MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >
+::EvolveLevel( InputImageType* iImage, LevelSetType* ioLevelSet ) const
+{
+  const unsigned int Dimension = ImageDimension;
+
+  typedef std::list< IdentifierType > IdListType;
+
+  IdListType listIds;
+  listIds.push_back( 1 );
+
+  typedef Image< IdListType, Dimension >  IdListImageType;
+  typename IdListImageType::Pointer idImage = IdListImageType::New();
+  idImage->SetRegions( iImage->GetLargestPossibleRegion() );
+  idImage->Allocate();
+  idImage->FillBuffer( listIds );
+
+  typedef Image< short, Dimension >       CacheImageType;
+  typedef LevelSetDomainMapImageFilter< IdListImageType, CacheImageType > DomainMapImageFilterType;
+  typename DomainMapImageFilterType::Pointer domainMapFilter = DomainMapImageFilterType::New();
+  domainMapFilter->SetInput( idImage );
+  domainMapFilter->Update();
+
+  typedef typename LevelSetType::OutputRealType LevelSetOutputRealType;
+
+  typedef TabulatedHeavisideStepFunction<
+    LevelSetOutputRealType, LevelSetOutputRealType > HeavisideFunctionBaseType;
+  typename HeavisideFunctionBaseType::Pointer heaviside = HeavisideFunctionBaseType::New();
+  heaviside->SetEpsilon( 1.0 );
+
+  typedef LevelSetContainer< IdentifierType, LevelSetType > LevelSetContainerType;
+  typename LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
+  lscontainer->SetHeaviside( heaviside );
+  lscontainer->SetDomainMapFilter( domainMapFilter );
+  lscontainer->AddLevelSet( 0, ioLevelSet );
+
+  typedef LevelSetEquationChanAndVeseInternalTerm<
+    InputImageType, LevelSetContainerType > InternalTermType;
+  typename InternalTermType::Pointer cvInternalTerm = InternalTermType::New();
+  cvInternalTerm->SetInput( iImage );
+  cvInternalTerm->SetCoefficient( 1.0 );
+  cvInternalTerm->SetCurrentLevelSetId( 0 );
+  cvInternalTerm->SetLevelSetContainer( lscontainer );
+
+  typedef LevelSetEquationChanAndVeseExternalTerm<
+    InputImageType, LevelSetContainerType > ExternalTermType;
+  typename ExternalTermType::Pointer cvExternalTerm = ExternalTermType::New();
+  cvExternalTerm->SetInput( iImage );
+  cvExternalTerm->SetCoefficient( 1.0 );
+  cvExternalTerm->SetCurrentLevelSetId( 0 );
+  cvExternalTerm->SetLevelSetContainer( lscontainer );
+
+  typedef LevelSetEquationTermContainer< InputImageType, LevelSetContainerType > TermContainerType;
+  typename TermContainerType::Pointer termContainer = TermContainerType::New();
+  termContainer->SetInput( iImage );
+  termContainer->SetCurrentLevelSetId( 0 );
+  termContainer->SetLevelSetContainer( lscontainer );
+  termContainer->AddTerm( 0, cvInternalTerm );
+  termContainer->AddTerm( 1, cvExternalTerm );
+
+  typedef LevelSetEquationContainer< TermContainerType > EquationContainerType;
+  typename EquationContainerType::Pointer equationContainer = EquationContainerType::New();
+  equationContainer->SetLevelSetContainer( lscontainer );
+  equationContainer->AddEquation( 0, termContainer );
+
+  typedef LevelSetEvolutionNumberOfIterationsStoppingCriterion<
+    LevelSetContainerType > NumberOfIterationsCriterionType;
+  typename NumberOfIterationsCriterionType::Pointer numberOfIterationsCriterion =
+    NumberOfIterationsCriterionType::New();
+  numberOfIterationsCriterion->SetNumberOfIterations( this->m_NumberOfIterations );
+
+  typedef LevelSetEvolutionRMSChangeStoppingCriterion< LevelSetContainerType > RMSChangeCriterionType;
+  typename RMSChangeCriterionType::Pointer rmsChangeCriterion = RMSChangeCriterionType::New();
+  rmsChangeCriterion->SetRMSChangeThreshold( this->m_RMSChangeThreshold );
+  rmsChangeCriterion->SetNumberOfConsecutiveIterations( this->m_NumberOfConsecutiveIterations );
+
+  typedef LevelSetEvolutionCompositeStoppingCriterion< LevelSetContainerType > StoppingCriterionType;
+  typename StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
+  criterion->SetLevelSetContainer( lscontainer );
+  criterion->AddCriterion( numberOfIterationsCriterion );
+  criterion->AddCriterion( rmsChangeCriterion );
+
+  typedef LevelSetEvolution< EquationContainerType, LevelSetType > LevelSetEvolutionType;
+  typename LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+  evolution->SetEquationContainer( equationContainer );
+  evolution->SetStoppingCriterion( criterion );
+  evolution->SetLevelSetContainer( lscontainer );
+  evolution->Update();
+
+  return static_cast< unsigned int >( criterion->GetCurrentIteration() );
+}
+
+template< class TInputImage, class TLevelSet >
+void
+MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >
+::Update()
+{
+  if( this->m_Input.IsNull() )
+    {
+    itkExceptionMacro( << "Input is not set" );
+    }
+  if( this->m_SeedRegions.empty() )
+    {
+    itkExceptionMacro( << "No seed region" );
+    }
+
+  this->m_NumberOfIterationsPerLevel.clear();
+
+  InputImagePointer previousImage;
+
+  for( unsigned int level = 0; level < this->m_ShrinkFactors.size(); level++ )
+    {
+    this->m_CurrentLevel = level;
+
+    InputImagePointer image = this->ShrinkInput( this->m_ShrinkFactors[level] );
+
+    if( level == 0 )
+      {
+      SeedAdaptorPointer adaptor = SeedAdaptorType::New();
+      adaptor->SetReferenceImage( image );
+      for( size_t i = 0; i < this->m_SeedRegions.size(); i++ )
+        {
+        adaptor->AddRegion( this->MapRegion( this->m_Input, image, this->m_SeedRegions[i] ) );
+        }
+      adaptor->Initialize();
+      this->m_LevelSet = adaptor->GetLevelSet();
+      }
+    else
+      {
+      this->m_LevelSet = this->UpsampleLevelSet( previousImage, image, this->m_LevelSet );
+      }
+
+    this->m_CurrentImage = image;
+    this->m_NumberOfIterationsPerLevel.push_back( this->EvolveLevel( image, this->m_LevelSet ) );
+
+    this->InvokeEvent( IterationEvent() );
+
+    previousImage = image;
+    }
+}
+
+template< class TInputImage, class TLevelSet >
+void
+MultiResolutionLevelSetEvolution< TInputImage, TLevelSet >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfLevels: " << this->m_ShrinkFactors.size() << std::endl;
+  os << indent << "NumberOfIterations: " << this->m_NumberOfIterations << std::endl;
+  os << indent << "RMSChangeThreshold: " << this->m_RMSChangeThreshold << std::endl;
+  os << indent << "NumberOfConsecutiveIterations: " << this->m_NumberOfConsecutiveIterations << std::endl;
+  os << indent << "NumberOfSeedRegions: " << this->m_SeedRegions.size() << std::endl;
+  os << indent << "CurrentLevel: " << this->m_CurrentLevel << std::endl;
+}
+
+}
+#endif // __itkMultiResolutionLevelSetEvolution_hxx
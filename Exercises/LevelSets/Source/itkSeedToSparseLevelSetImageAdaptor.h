@@ -0,0 +1,216 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkSeedToSparseLevelSetImageAdaptor_h
+#define __itkSeedToSparseLevelSetImageAdaptor_h
+
+#include "itkObject.h"
+#include "itkImageBase.h"
+#include "itkSparseLevelSetLayerTraits.h"
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class SeedToSparseLevelSetImageAdaptor
+ *  \brief Build a sparse level-set directly from geometric seeds.
+ *
+ *  The interior of the level-set is given as a union of seeds: boxes,
+ *  spheres, single indices, label objects or whole label maps. Seeds are
+ *  stored as run-length lines along the first dimension, and the layers
+ *  are grown from the boundary of these lines. No image of the size of the
+ *  domain is ever allocated or scanned, so the cost depends on the surface
+ *  of the seeds rather than on the size of the domain.
+ *
+ *  The layers follow the conventions of BinaryImageToLevelSetImageAdaptor:
+ *  the front is made of the interior pixels which have an exterior
+ *  neighbor along one of the axes.
+ *
+ *  \tparam TLevelSet Whitaker, Shi or Malcolm sparse level-set image
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TLevelSet >
+class SeedToSparseLevelSetImageAdaptor : public Object
+{
+public:
+  typedef SeedToSparseLevelSetImageAdaptor  Self;
+  typedef Object                            Superclass;
+  typedef SmartPointer< Self >              Pointer;
+  typedef SmartPointer< const Self >        ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( SeedToSparseLevelSetImageAdaptor, Object );
+
+  typedef TLevelSet                                 LevelSetType;
+  typedef typename LevelSetType::Pointer            LevelSetPointer;
+  typedef typename LevelSetType::InputType          IndexType;
+  typedef typename LevelSetType::OutputType         LevelSetOutputType;
+  typedef typename LevelSetType::LayerIdType        LayerIdType;
+  typedef typename LevelSetType::LayerType          LayerType;
+  typedef typename LayerType::const_iterator        LayerConstIterator;
+  typedef typename LevelSetType::LabelMapType       LabelMapType;
+  typedef typename LabelMapType::Pointer            LabelMapPointer;
+  typedef typename LabelMapType::LabelObjectType    LabelObjectType;
+  typedef typename LabelObjectType::Pointer         LabelObjectPointer;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, LevelSetType::Dimension );
+
+  typedef ImageBase< ImageDimension >               ReferenceImageType;
+  typedef typename ReferenceImageType::RegionType   RegionType;
+  typedef typename ReferenceImageType::SizeType     SizeType;
+  typedef typename ReferenceImageType::OffsetType   OffsetType;
+  typedef typename ReferenceImageType::PointType    PointType;
+  typedef typename ReferenceImageType::SpacingType  SpacingType;
+  typedef typename ReferenceImageType::DirectionType DirectionType;
+
+  typedef SparseLevelSetLayerTraits< LevelSetType > LayerTraitsType;
+
+  /** Set the domain of the level-set (region, spacing, origin and
+   * direction) from a reference image. Must be called before adding
+   * seeds. */
+  void SetReferenceImage( const ReferenceImageType* iImage );
+
+  /** Set the domain of the level-set from a region only; spacing is one,
+   * origin is zero and direction is identity. */
+  void SetRegion( const RegionType& iRegion );
+  itkGetConstReferenceMacro( Region, RegionType );
+
+  /** Add the run of iLength pixels starting at iStart along the first
+   * dimension */
+  void AddRun( const IndexType& iStart, SizeValueType iLength );
+
+  /** Add a box */
+  void AddRegion( const RegionType& iRegion );
+
+  /** Add a sphere given in physical coordinates. The sphere is drawn in
+   * the index space of the domain, direction is not taken into account. */
+  void AddSphere( const PointType& iCenter, double iRadius );
+
+  /** Add a single index, or a list of indices */
+  void AddIndex( const IndexType& iIndex );
+  void AddIndices( const std::vector< IndexType >& iIndices );
+
+  /** Add every line of a label object, or of every label object of a
+   * label map */
+  template< class TLabelObject >
+  void AddLabelObject( const TLabelObject* iLabelObject )
+    {
+    const SizeValueType numberOfLines = iLabelObject->GetNumberOfLines();
+    for( SizeValueType i = 0; i < numberOfLines; i++ )
+      {
+      this->AddRun( iLabelObject->GetLine( i ).GetIndex(),
+                    iLabelObject->GetLine( i ).GetLength() );
+      }
+    }
+
+  template< class TLabelMap >
+  void AddLabelMap( const TLabelMap* iLabelMap )
+    {
+    typedef typename TLabelMap::LabelObjectVectorType LabelObjectVectorType;
+    const LabelObjectVectorType labelObjects = iLabelMap->GetLabelObjects();
+    for( typename LabelObjectVectorType::const_iterator it = labelObjects.begin();
+         it != labelObjects.end(); ++it )
+      {
+      this->AddLabelObject( it->GetPointer() );
+      }
+    }
+
+  /** Remove all seeds */
+  void ClearSeeds();
+
+  /** Build the level-set from the seeds */
+  void Initialize();
+
+  /** Get the level-set built by Initialize() */
+  itkGetObjectMacro( LevelSet, LevelSetType );
+
+protected:
+  SeedToSparseLevelSetImageAdaptor();
+  virtual ~SeedToSparseLevelSetImageAdaptor() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** [begin, end) spans of one row, sorted and disjoint once merged */
+  typedef std::pair< OffsetValueType, OffsetValueType >   SpanType;
+  typedef std::vector< SpanType >                         SpanListType;
+
+  /** Rows are indexed by their first pixel, with a zero first coordinate */
+  typedef Functor::IndexLexicographicCompare< ImageDimension > IndexCompareType;
+  typedef std::map< IndexType, SpanListType, IndexCompareType > RowMapType;
+  typedef std::set< IndexType, IndexCompareType >               IndexSetType;
+  typedef std::map< IndexType, LayerIdType, IndexCompareType >  StatusMapType;
+
+  /** Sort and merge the spans of every row */
+  void MergeSpans();
+
+  /** Is iIndex covered by the seeds */
+  bool IsInside( const IndexType& iIndex ) const;
+
+  /** Interior pixels with an exterior neighbor along one axis */
+  void FindBoundary( IndexSetType& oBoundary ) const;
+
+  /** Put the nodes of iNodes in the layer iLayerId */
+  void FillLayer( const IndexSetType& iNodes, LayerIdType iLayerId,
+                  StatusMapType& ioStatus );
+
+  /** Add the neighbors of the nodes of the layer iLayerId, which are inside
+   * (or outside) and not yet in ioStatus, to the layer oLayerId */
+  void GrowLayer( LayerIdType iLayerId, LayerIdType oLayerId, bool iInside,
+                  StatusMapType& ioStatus );
+
+  /** Layers of each representation, grown from the boundary of the seeds.
+   * ioStatus records the layer of every node. */
+  template< typename TOutput >
+  void InitializeLayers( WhitakerSparseLevelSetImage< TOutput, ImageDimension >*,
+                         StatusMapType& ioStatus );
+  void InitializeLayers( ShiSparseLevelSetImage< ImageDimension >*,
+                         StatusMapType& ioStatus );
+  void InitializeLayers( MalcolmSparseLevelSetImage< ImageDimension >*,
+                         StatusMapType& ioStatus );
+
+  /** Create the label map from the seeds and the layer nodes */
+  void InitializeLabelMap( const StatusMapType& iStatus );
+
+private:
+  SeedToSparseLevelSetImageAdaptor( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  LevelSetPointer m_LevelSet;
+
+  RegionType      m_Region;
+  SpacingType     m_Spacing;
+  PointType       m_Origin;
+  DirectionType   m_Direction;
+
+  RowMapType      m_Rows;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSeedToSparseLevelSetImageAdaptor.hxx"
+#endif
+
+#endif // __itkSeedToSparseLevelSetImageAdaptor_h
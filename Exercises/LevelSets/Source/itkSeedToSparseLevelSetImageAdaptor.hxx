@@ -0,0 +1,594 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkSeedToSparseLevelSetImageAdaptor_hxx
+#define __itkSeedToSparseLevelSetImageAdaptor_hxx
+
+#include "itkSeedToSparseLevelSetImageAdaptor.h"
+#include "itkMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+template< class TLevelSet >
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::SeedToSparseLevelSetImageAdaptor()
+{
+  this->m_Spacing.Fill( 1. );
+  this->m_Origin.Fill( 0. );
+  this->m_Direction.SetIdentity();
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::SetReferenceImage( const ReferenceImageType* iImage )
+{
+  if( iImage == NULL )
+    {
+    itkExceptionMacro( << "iImage is NULL" );
+    }
+
+  this->m_Region = iImage->GetLargestPossibleRegion();
+  this->m_Spacing = iImage->GetSpacing();
+  this->m_Origin = iImage->GetOrigin();
+  this->m_Direction = iImage->GetDirection();
+  this->Modified();
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::SetRegion( const RegionType& iRegion )
+{
+  this->m_Region = iRegion;
+  this->m_Spacing.Fill( 1. );
+  this->m_Origin.Fill( 0. );
+  this->m_Direction.SetIdentity();
+  this->Modified();
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::AddRun( const IndexType& iStart, SizeValueType iLength )
+{
+  const IndexType & regionIndex = this->m_Region.GetIndex();
+  const SizeType & regionSize = this->m_Region.GetSize();
+
+  for( unsigned int dim = 1; dim < ImageDimension; dim++ )
+    {
+    if( ( iStart[dim] < regionIndex[dim] ) ||
+        ( iStart[dim] >= regionIndex[dim] + static_cast< OffsetValueType >( regionSize[dim] ) ) )
+      {
+      return;
+      }
+    }
+
+  const OffsetValueType begin = std::max( iStart[0], regionIndex[0] );
+  const OffsetValueType end = std::min(
+    iStart[0] + static_cast< OffsetValueType >( iLength ),
+    regionIndex[0] + static_cast< OffsetValueType >( regionSize[0] ) );
+
+  if( begin >= end )
+    {
+    return;
+    }
+
+  IndexType rowKey = iStart;
+  rowKey[0] = 0;
+
+  this->m_Rows[rowKey].push_back( SpanType( begin, end ) );
+  this->Modified();
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::AddRegion( const RegionType& iRegion )
+{
+  RegionType region = iRegion;
+  if( !region.Crop( this->m_Region ) )
+    {
+    return;
+    }
+
+  const IndexType & index = region.GetIndex();
+  const SizeType & size = region.GetSize();
+  const SizeValueType numberOfRows = region.GetNumberOfPixels() / size[0];
+
+  IndexType rowIndex = index;
+  for( SizeValueType row = 0; row < numberOfRows; row++ )
+    {
+    this->AddRun( rowIndex, size[0] );
+
+    for( unsigned int dim = 1; dim < ImageDimension; dim++ )
+      {
+      ++rowIndex[dim];
+      if( rowIndex[dim] < index[dim] + static_cast< OffsetValueType >( size[dim] ) )
+        {
+        break;
+        }
+      rowIndex[dim] = index[dim];
+      }
+    }
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::AddSphere( const PointType& iCenter, double iRadius )
+{
+  if( iRadius <= 0. )
+    {
+    return;
+    }
+
+  // Center and radii of the ellipsoid in index space
+  double center[ImageDimension];
+  double radius[ImageDimension];
+
+  RegionType box;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    center[dim] = ( iCenter[dim] - this->m_Origin[dim] ) / this->m_Spacing[dim];
+    radius[dim] = iRadius / this->m_Spacing[dim];
+
+    const OffsetValueType lower = Math::Ceil< OffsetValueType >( center[dim] - radius[dim] );
+    const OffsetValueType upper = Math::Floor< OffsetValueType >( center[dim] + radius[dim] );
+
+    if( upper < lower )
+      {
+      return;
+      }
+    box.SetIndex( dim, lower );
+    box.SetSize( dim, static_cast< SizeValueType >( upper - lower + 1 ) );
+    }
+
+  if( !box.Crop( this->m_Region ) )
+    {
+    return;
+    }
+
+  const IndexType & index = box.GetIndex();
+  const SizeType & size = box.GetSize();
+  const SizeValueType numberOfRows = box.GetNumberOfPixels() / size[0];
+
+  IndexType rowIndex = index;
+  for( SizeValueType row = 0; row < numberOfRows; row++ )
+    {
+    double s = 1.;
+    for( unsigned int dim = 1; dim < ImageDimension; dim++ )
+      {
+      const double d = ( static_cast< double >( rowIndex[dim] ) - center[dim] ) / radius[dim];
+      s -= d * d;
+      }
+
+    if( s >= 0. )
+      {
+      const double halfLength = radius[0] * std::sqrt( s );
+      const OffsetValueType begin = Math::Ceil< OffsetValueType >( center[0] - halfLength );
+      const OffsetValueType end = Math::Floor< OffsetValueType >( center[0] + halfLength ) + 1;
+
+      if( begin < end )
+        {
+        IndexType start = rowIndex;
+        start[0] = begin;
+        this->AddRun( start, static_cast< SizeValueType >( end - begin ) );
+        }
+      }
+
+    for( unsigned int dim = 1; dim < ImageDimension; dim++ )
+      {
+      ++rowIndex[dim];
+      if( rowIndex[dim] < index[dim] + static_cast< OffsetValueType >( size[dim] ) )
+        {
+        break;
+        }
+      rowIndex[dim] = index[dim];
+      }
+    }
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::AddIndex( const IndexType& iIndex )
+{
+  this->AddRun( iIndex, 1 );
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::AddIndices( const std::vector< IndexType >& iIndices )
+{
+  for( typename std::vector< IndexType >::const_iterator it = iIndices.begin();
+       it != iIndices.end(); ++it )
+    {
+    this->AddRun( *it, 1 );
+    }
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::ClearSeeds()
+{
+  this->m_Rows.clear();
+  this->Modified();
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::MergeSpans()
+{
+  for( typename RowMapType::iterator rIt = this->m_Rows.begin(); rIt != this->m_Rows.end(); ++rIt )
+    {
+    SpanListType & spans = rIt->second;
+    if( spans.empty() )
+      {
+      continue;
+      }
+    std::sort( spans.begin(), spans.end() );
+
+    typename SpanListType::iterator last = spans.begin();
+    for( typename SpanListType::iterator sIt = spans.begin(); sIt != spans.end(); ++sIt )
+      {
+      if( sIt == last )
+        {
+        continue;
+        }
+      if( sIt->first <= last->second )
+        {
+        last->second = std::max( last->second, sIt->second );
+        }
+      else
+        {
+        *( ++last ) = *sIt;
+        }
+      }
+    spans.erase( ++last, spans.end() );
+    }
+}
+
+template< class TLevelSet >
+bool
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::IsInside( const IndexType& iIndex ) const
+{
+  IndexType rowKey = iIndex;
+  rowKey[0] = 0;
+
+  typename RowMapType::const_iterator rIt = this->m_Rows.find( rowKey );
+  if( rIt == this->m_Rows.end() )
+    {
+    return false;
+    }
+
+  // last span starting at or before iIndex[0]
+  const SpanListType & spans = rIt->second;
+  typename SpanListType::const_iterator sIt =
+    std::upper_bound( spans.begin(), spans.end(),
+                      SpanType( iIndex[0], NumericTraits< OffsetValueType >::max() ) );
+
+  if( sIt == spans.begin() )
+    {
+    return false;
+    }
+  --sIt;
+  return ( iIndex[0] < sIt->second );
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::FindBoundary( IndexSetType& oBoundary ) const
+{
+  const IndexType & regionIndex = this->m_Region.GetIndex();
+  const SizeType & regionSize = this->m_Region.GetSize();
+
+  for( typename RowMapType::const_iterator rIt = this->m_Rows.begin(); rIt != this->m_Rows.end(); ++rIt )
+    {
+    const SpanListType & spans = rIt->second;
+    IndexType node = rIt->first;
+
+    // Along the rows, only both ends of each span can be on the boundary.
+    for( typename SpanListType::const_iterator sIt = spans.begin(); sIt != spans.end(); ++sIt )
+      {
+      if( sIt->first > regionIndex[0] )
+        {
+        node[0] = sIt->first;
+        oBoundary.insert( node );
+        }
+      if( sIt->second < regionIndex[0] + static_cast< OffsetValueType >( regionSize[0] ) )
+        {
+        node[0] = sIt->second - 1;
+        oBoundary.insert( node );
+        }
+      }
+
+    // Across the rows, the parts of each span not covered by the
+    // neighboring row are on the boundary.
+    for( unsigned int dim = 1; dim < ImageDimension; dim++ )
+      {
+      for( int direction = -1; direction <= 1; direction += 2 )
+        {
+        IndexType neighborKey = rIt->first;
+        neighborKey[dim] += direction;
+
+        if( ( neighborKey[dim] < regionIndex[dim] ) ||
+            ( neighborKey[dim] >= regionIndex[dim] + static_cast< OffsetValueType >( regionSize[dim] ) ) )
+          {
+          continue;
+          }
+
+        typename RowMapType::const_iterator nIt = this->m_Rows.find( neighborKey );
+        const bool hasNeighbor = ( nIt != this->m_Rows.end() );
+
+        typename SpanListType::const_iterator nsIt;
+        if( hasNeighbor )
+          {
+          nsIt = nIt->second.begin();
+          }
+
+        for( typename SpanListType::const_iterator sIt = spans.begin(); sIt != spans.end(); ++sIt )
+          {
+          OffsetValueType cursor = sIt->first;
+
+          if( hasNeighbor )
+            {
+            while( ( nsIt != nIt->second.end() ) && ( nsIt->second <= cursor ) )
+              {
+              ++nsIt;
+              }
+            typename SpanListType::const_iterator it = nsIt;
+            while( ( it != nIt->second.end() ) && ( it->first < sIt->second ) )
+              {
+              for( node[0] = cursor; node[0] < it->first; ++node[0] )
+                {
+                oBoundary.insert( node );
+                }
+              cursor = std::max( cursor, it->second );
+              ++it;
+              }
+            }
+
+          for( node[0] = cursor; node[0] < sIt->second; ++node[0] )
+            {
+            oBoundary.insert( node );
+            }
+          }
+        }
+      }
+    }
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::FillLayer( const IndexSetType& iNodes, LayerIdType iLayerId, StatusMapType& ioStatus )
+{
+  typedef typename LayerType::mapped_type LayerValueType;
+
+  LayerType & layer = this->m_LevelSet->GetLayer( iLayerId );
+  const LayerValueType value = static_cast< LayerValueType >( iLayerId );
+
+  for( typename IndexSetType::const_iterator it = iNodes.begin(); it != iNodes.end(); ++it )
+    {
+    layer.insert( layer.end(), typename LayerType::value_type( *it, value ) );
+    ioStatus.insert( ioStatus.end(), typename StatusMapType::value_type( *it, iLayerId ) );
+    }
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::GrowLayer( LayerIdType iLayerId, LayerIdType oLayerId, bool iInside,
+             StatusMapType& ioStatus )
+{
+  const LayerType & inputLayer = this->m_LevelSet->GetLayer( iLayerId );
+
+  IndexSetType nodes;
+
+  for( LayerConstIterator it = inputLayer.begin(); it != inputLayer.end(); ++it )
+    {
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      for( int direction = -1; direction <= 1; direction += 2 )
+        {
+        IndexType neighbor = it->first;
+        neighbor[dim] += direction;
+
+        if( this->m_Region.IsInside( neighbor ) &&
+            ( ioStatus.find( neighbor ) == ioStatus.end() ) &&
+            ( this->IsInside( neighbor ) == iInside ) )
+          {
+          nodes.insert( neighbor );
+          }
+        }
+      }
+    }
+
+  this->FillLayer( nodes, oLayerId, ioStatus );
+}
+
+template< class TLevelSet >
+template< typename TOutput >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::InitializeLayers( WhitakerSparseLevelSetImage< TOutput, ImageDimension >*,
+                    StatusMapType& ioStatus )
+{
+  IndexSetType boundary;
+  this->FindBoundary( boundary );
+
+  this->FillLayer( boundary, LevelSetType::ZeroLayer(), ioStatus );
+
+  this->GrowLayer( LevelSetType::ZeroLayer(), LevelSetType::MinusOneLayer(), true, ioStatus );
+  this->GrowLayer( LevelSetType::ZeroLayer(), LevelSetType::PlusOneLayer(), false, ioStatus );
+  this->GrowLayer( LevelSetType::MinusOneLayer(), LevelSetType::MinusTwoLayer(), true, ioStatus );
+  this->GrowLayer( LevelSetType::PlusOneLayer(), LevelSetType::PlusTwoLayer(), false, ioStatus );
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::InitializeLayers( ShiSparseLevelSetImage< ImageDimension >*, StatusMapType& ioStatus )
+{
+  IndexSetType boundary;
+  this->FindBoundary( boundary );
+
+  this->FillLayer( boundary, LevelSetType::MinusOneLayer(), ioStatus );
+
+  this->GrowLayer( LevelSetType::MinusOneLayer(), LevelSetType::PlusOneLayer(), false, ioStatus );
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::InitializeLayers( MalcolmSparseLevelSetImage< ImageDimension >*, StatusMapType& ioStatus )
+{
+  IndexSetType boundary;
+  this->FindBoundary( boundary );
+
+  this->FillLayer( boundary, LevelSetType::ZeroLayer(), ioStatus );
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::InitializeLabelMap( const StatusMapType& iStatus )
+{
+  LabelMapPointer labelMap = LabelMapType::New();
+  labelMap->SetRegions( this->m_Region );
+  labelMap->SetSpacing( this->m_Spacing );
+  labelMap->SetOrigin( this->m_Origin );
+  labelMap->SetDirection( this->m_Direction );
+  labelMap->SetBackgroundValue( LayerTraitsType::GetExteriorLabel() );
+
+  // Interior layers (non positive identifiers) are cut out of the spans.
+  typedef std::map< IndexType, std::vector< OffsetValueType >, IndexCompareType > HoleMapType;
+  HoleMapType holes;
+
+  for( typename StatusMapType::const_iterator it = iStatus.begin(); it != iStatus.end(); ++it )
+    {
+    if( it->second <= 0 )
+      {
+      IndexType rowKey = it->first;
+      rowKey[0] = 0;
+      holes[rowKey].push_back( it->first[0] );
+      }
+    }
+
+  LabelObjectPointer interior = LabelObjectType::New();
+  interior->SetLabel( LayerTraitsType::GetInteriorLabel() );
+
+  for( typename RowMapType::const_iterator rIt = this->m_Rows.begin(); rIt != this->m_Rows.end(); ++rIt )
+    {
+    std::vector< OffsetValueType > rowHoles;
+    typename HoleMapType::iterator hIt = holes.find( rIt->first );
+    if( hIt != holes.end() )
+      {
+      rowHoles.swap( hIt->second );
+      std::sort( rowHoles.begin(), rowHoles.end() );
+      }
+
+    IndexType start = rIt->first;
+    typename std::vector< OffsetValueType >::const_iterator holeIt = rowHoles.begin();
+
+    for( typename SpanListType::const_iterator sIt = rIt->second.begin(); sIt != rIt->second.end(); ++sIt )
+      {
+      OffsetValueType cursor = sIt->first;
+      while( ( holeIt != rowHoles.end() ) && ( *holeIt < sIt->second ) )
+        {
+        if( *holeIt > cursor )
+          {
+          start[0] = cursor;
+          interior->AddLine( start, static_cast< SizeValueType >( *holeIt - cursor ) );
+          }
+        cursor = *holeIt + 1;
+        ++holeIt;
+        }
+      if( cursor < sIt->second )
+        {
+        start[0] = cursor;
+        interior->AddLine( start, static_cast< SizeValueType >( sIt->second - cursor ) );
+        }
+      }
+    }
+
+  labelMap->AddLabelObject( interior );
+
+  // One label object per layer
+  typedef typename LayerTraitsType::LayerIdListType LayerIdListType;
+  const LayerIdListType layerIds = LayerTraitsType::GetLayerIds();
+
+  for( typename LayerIdListType::const_iterator lIt = layerIds.begin(); lIt != layerIds.end(); ++lIt )
+    {
+    LabelObjectPointer labelObject = LabelObjectType::New();
+    labelObject->SetLabel( *lIt );
+
+    const LayerType & layer = this->m_LevelSet->GetLayer( *lIt );
+    for( LayerConstIterator nIt = layer.begin(); nIt != layer.end(); ++nIt )
+      {
+      labelObject->AddIndex( nIt->first );
+      }
+    labelObject->Optimize();
+
+    labelMap->AddLabelObject( labelObject );
+    }
+
+  this->m_LevelSet->SetLabelMap( labelMap );
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::Initialize()
+{
+  if( this->m_Region.GetNumberOfPixels() == 0 )
+    {
+    itkExceptionMacro( << "The region of the level-set is empty" );
+    }
+
+  this->MergeSpans();
+
+  this->m_LevelSet = LevelSetType::New();
+
+  StatusMapType status;
+  this->InitializeLayers( this->m_LevelSet.GetPointer(), status );
+  this->InitializeLabelMap( status );
+}
+
+template< class TLevelSet >
+void
+SeedToSparseLevelSetImageAdaptor< TLevelSet >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Region: " << this->m_Region << std::endl;
+  os << indent << "NumberOfRows: " << this->m_Rows.size() << std::endl;
+  os << indent << "LevelSet: " << this->m_LevelSet.GetPointer() << std::endl;
+}
+
+}
+#endif // __itkSeedToSparseLevelSetImageAdaptor_hxx
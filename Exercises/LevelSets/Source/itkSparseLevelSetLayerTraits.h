@@ -0,0 +1,120 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkSparseLevelSetLayerTraits_h
+#define __itkSparseLevelSetLayerTraits_h
+
+#include "itkWhitakerSparseLevelSetImage.h"
+#include "itkShiSparseLevelSetImage.h"
+#include "itkMalcolmSparseLevelSetImage.h"
+
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class SparseLevelSetLayerTraits
+ *  \brief Layer identifiers of a sparse level-set representation.
+ *
+ *  Gives, for each sparse representation, the identifiers of the layers
+ *  it maintains, the layer holding the front, and the labels used in its
+ *  label map for the interior and the exterior of the level-set.
+ *
+ *  \tparam TLevelSet Whitaker, Shi or Malcolm sparse level-set image
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TLevelSet >
+class SparseLevelSetLayerTraits
+{};
+
+template< typename TOutput, unsigned int VDimension >
+class SparseLevelSetLayerTraits< WhitakerSparseLevelSetImage< TOutput, VDimension > >
+{
+public:
+  typedef WhitakerSparseLevelSetImage< TOutput, VDimension > LevelSetType;
+  typedef typename LevelSetType::LayerIdType                LayerIdType;
+  typedef std::vector< LayerIdType >                        LayerIdListType;
+
+  static const char * GetName() { return "Whitaker"; }
+
+  /** Layers ordered from the inside to the outside */
+  static LayerIdListType GetLayerIds()
+    {
+    LayerIdListType ids;
+    ids.push_back( LevelSetType::MinusTwoLayer() );
+    ids.push_back( LevelSetType::MinusOneLayer() );
+    ids.push_back( LevelSetType::ZeroLayer() );
+    ids.push_back( LevelSetType::PlusOneLayer() );
+    ids.push_back( LevelSetType::PlusTwoLayer() );
+    return ids;
+    }
+
+  static LayerIdType GetFrontLayerId() { return LevelSetType::ZeroLayer(); }
+  static LayerIdType GetInteriorLabel() { return LevelSetType::MinusThreeLayer(); }
+  static LayerIdType GetExteriorLabel() { return LevelSetType::PlusThreeLayer(); }
+};
+
+template< unsigned int VDimension >
+class SparseLevelSetLayerTraits< ShiSparseLevelSetImage< VDimension > >
+{
+public:
+  typedef ShiSparseLevelSetImage< VDimension >  LevelSetType;
+  typedef typename LevelSetType::LayerIdType    LayerIdType;
+  typedef std::vector< LayerIdType >            LayerIdListType;
+
+  static const char * GetName() { return "Shi"; }
+
+  static LayerIdListType GetLayerIds()
+    {
+    LayerIdListType ids;
+    ids.push_back( LevelSetType::MinusOneLayer() );
+    ids.push_back( LevelSetType::PlusOneLayer() );
+    return ids;
+    }
+
+  /** Shi has no zero layer; the front is its inner layer */
+  static LayerIdType GetFrontLayerId() { return LevelSetType::MinusOneLayer(); }
+  static LayerIdType GetInteriorLabel() { return LevelSetType::MinusThreeLayer(); }
+  static LayerIdType GetExteriorLabel() { return LevelSetType::PlusThreeLayer(); }
+};
+
+template< unsigned int VDimension >
+class SparseLevelSetLayerTraits< MalcolmSparseLevelSetImage< VDimension > >
+{
+public:
+  typedef MalcolmSparseLevelSetImage< VDimension >  LevelSetType;
+  typedef typename LevelSetType::LayerIdType        LayerIdType;
+  typedef std::vector< LayerIdType >                LayerIdListType;
+
+  static const char * GetName() { return "Malcolm"; }
+
+  static LayerIdListType GetLayerIds()
+    {
+    LayerIdListType ids;
+    ids.push_back( LevelSetType::ZeroLayer() );
+    return ids;
+    }
+
+  static LayerIdType GetFrontLayerId() { return LevelSetType::ZeroLayer(); }
+  static LayerIdType GetInteriorLabel() { return LevelSetType::MinusOneLayer(); }
+  static LayerIdType GetExteriorLabel() { return LevelSetType::PlusOneLayer(); }
+};
+
+}
+#endif // __itkSparseLevelSetLayerTraits_h
@@ -0,0 +1,147 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkSparseLevelSetSortedLayer_h
+#define __itkSparseLevelSetSortedLayer_h
+
+#include "itkLevelSetLayerTrace.h"
+#include "itkSparseLevelSetLayerTraits.h"
+
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class SparseLevelSetSortedLayer
+ *  \brief Nodes of a layer of a sparse level-set sorted by offset, for the
+ *  writers encoding the layers.
+ *
+ *  The layers of a sparse level-set are maps from the index of a node to
+ *  its value, ordered lexicographically by index, i.e. along the first
+ *  axis first. LevelSetLayerTraceRecorder and LevelSetCheckpointWriter
+ *  encode the nodes as increasing offsets in a region, i.e. in the order of
+ *  the image buffer. This class gives them the offsets of the nodes of one
+ *  layer in that order, and their values when they need them.
+ *
+ *  This is not a storage of the level-set: the evolution reads and updates
+ *  the maps, which are defined by ITK, and this class is a sorted snapshot
+ *  of one of them, taken when a writer encodes it.
+ *
+ *  Assign() and AssignOffsets() read a layer in one pass, then order it
+ *  with a radix sort on the offsets, in linear time. The arrays and the
+ *  scratch space of the sort are kept from one call to the next, so that
+ *  sorting a layer every iteration does not allocate once the layer stops
+ *  growing. Merge() interleaves several sorted layers into one sorted node
+ *  list.
+ *
+ *  \tparam TLevelSet Whitaker, Shi or Malcolm sparse level-set image
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TLevelSet >
+class SparseLevelSetSortedLayer
+{
+public:
+  typedef SparseLevelSetSortedLayer                 Self;
+
+  typedef TLevelSet                                 LevelSetType;
+  typedef typename LevelSetType::OutputType         LevelSetOutputType;
+  typedef typename LevelSetType::LayerType          LayerType;
+  typedef typename LayerType::const_iterator        LayerConstIterator;
+  typedef typename LevelSetType::LabelMapType       LabelMapType;
+  typedef typename LabelMapType::RegionType         RegionType;
+  typedef typename LabelMapType::IndexType          IndexType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, LevelSetType::Dimension );
+
+  typedef SparseLevelSetLayerTraits< LevelSetType > LayerTraitsType;
+  typedef typename LayerTraitsType::LayerIdType     LayerIdType;
+
+  typedef LevelSetLayerTrace::OffsetType            OffsetType;
+  typedef LevelSetLayerTrace::OffsetListType        OffsetListType;
+  typedef LevelSetLayerTrace::NodeListType          NodeListType;
+  typedef std::vector< LevelSetOutputType >         ValueListType;
+
+  SparseLevelSetSortedLayer();
+
+  /** Region the offsets are computed in */
+  void SetRegion( const RegionType& iRegion );
+  const RegionType & GetRegion() const { return this->m_Region; }
+
+  /** Replace the nodes by the ones of the layer iLayerId of iLevelSet */
+  void Assign( const LevelSetType* iLevelSet, LayerIdType iLayerId );
+
+  /** Same as Assign(), without the values */
+  void AssignOffsets( const LevelSetType* iLevelSet, LayerIdType iLayerId );
+
+  /** Remove the nodes, keeping the memory */
+  void Clear();
+
+  /** Number of nodes */
+  size_t Size() const { return this->m_Offsets.size(); }
+
+  /** Offsets of the nodes, sorted */
+  const OffsetListType & GetOffsets() const { return this->m_Offsets; }
+
+  /** Values of the nodes, in the order of the offsets; empty after
+   * AssignOffsets() */
+  const ValueListType & GetValues() const { return this->m_Values; }
+
+  /** Offset of iIndex in the region */
+  OffsetType ComputeOffset( const IndexType& iIndex ) const
+    {
+    OffsetType offset = 0;
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      offset += static_cast< OffsetType >( iIndex[dim] - this->m_Region.GetIndex()[dim] ) * this->m_Strides[dim];
+      }
+    return offset;
+    }
+
+  /** Index of iOffset in the region */
+  IndexType ComputeIndex( OffsetType iOffset ) const;
+
+  /** Nodes of the iNumberOfLayers sorted layers iLayers, in one list
+   * sorted by offset; the second member of a node is the position of its
+   * layer in iLayers */
+  static void Merge( const Self* iLayers, size_t iNumberOfLayers, NodeListType& oNodes );
+
+protected:
+  /** Sort m_Offsets, and m_Values alike unless it is empty */
+  void Sort();
+
+private:
+  RegionType      m_Region;
+  OffsetType      m_Strides[ImageDimension];
+  unsigned int    m_NumberOfOffsetBits;
+
+  OffsetListType  m_Offsets;
+  ValueListType   m_Values;
+
+  // scratch space of the sort
+  OffsetListType        m_SortedOffsets;
+  ValueListType         m_SortedValues;
+  std::vector< size_t > m_Counts;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSparseLevelSetSortedLayer.hxx"
+#endif
+
+#endif // __itkSparseLevelSetSortedLayer_h
@@ -0,0 +1,229 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkSparseLevelSetSortedLayer_hxx
+#define __itkSparseLevelSetSortedLayer_hxx
+
+#include "itkSparseLevelSetSortedLayer.h"
+
+#include <algorithm>
+
+namespace itk
+{
+template< class TLevelSet >
+SparseLevelSetSortedLayer< TLevelSet >
+::SparseLevelSetSortedLayer() :
+  m_NumberOfOffsetBits( 0 )
+{
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    this->m_Strides[dim] = 0;
+    }
+}
+
+template< class TLevelSet >
+void
+SparseLevelSetSortedLayer< TLevelSet >
+::SetRegion( const RegionType& iRegion )
+{
+  this->m_Region = iRegion;
+
+  OffsetType stride = 1;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    this->m_Strides[dim] = stride;
+    stride *= static_cast< OffsetType >( iRegion.GetSize()[dim] );
+    }
+
+  // the largest offset is stride - 1
+  this->m_NumberOfOffsetBits = 0;
+  for( OffsetType largest = ( stride > 0 ) ? stride - 1 : 0; largest > 0; largest >>= 1 )
+    {
+    ++this->m_NumberOfOffsetBits;
+    }
+
+  this->Clear();
+}
+
+template< class TLevelSet >
+void
+SparseLevelSetSortedLayer< TLevelSet >
+::Clear()
+{
+  this->m_Offsets.clear();
+  this->m_Values.clear();
+}
+
+template< class TLevelSet >
+void
+SparseLevelSetSortedLayer< TLevelSet >
+::Assign( const LevelSetType* iLevelSet, LayerIdType iLayerId )
+{
+  const LayerType & layer = iLevelSet->GetLayer( iLayerId );
+
+  this->m_Offsets.resize( layer.size() );
+  this->m_Values.resize( layer.size() );
+
+  size_t i = 0;
+  for( LayerConstIterator it = layer.begin(); it != layer.end(); ++it, ++i )
+    {
+    this->m_Offsets[i] = this->ComputeOffset( it->first );
+    this->m_Values[i] = it->second;
+    }
+
+  this->Sort();
+}
+
+template< class TLevelSet >
+void
+SparseLevelSetSortedLayer< TLevelSet >
+::AssignOffsets( const LevelSetType* iLevelSet, LayerIdType iLayerId )
+{
+  const LayerType & layer = iLevelSet->GetLayer( iLayerId );
+
+  this->m_Offsets.resize( layer.size() );
+  this->m_Values.clear();
+
+  size_t i = 0;
+  for( LayerConstIterator it = layer.begin(); it != layer.end(); ++it, ++i )
+    {
+    this->m_Offsets[i] = this->ComputeOffset( it->first );
+    }
+
+  this->Sort();
+}
+
+template< class TLevelSet >
+void
+SparseLevelSetSortedLayer< TLevelSet >
+::Sort()
+{
+  const size_t numberOfNodes = this->m_Offsets.size();
+  const bool withValues = !this->m_Values.empty();
+
+  // A layer is sorted when it lies along the first axis, e.g. in 1D.
+  bool sorted = true;
+  for( size_t i = 1; ( i < numberOfNodes ) && sorted; i++ )
+    {
+    sorted = ( this->m_Offsets[i - 1] < this->m_Offsets[i] );
+    }
+  if( sorted )
+    {
+    return;
+    }
+
+  // Least significant digit first radix sort, on the bits the offsets of
+  // the region need. Each pass is stable, and swaps the arrays with the
+  // scratch ones.
+  const unsigned int digitBits = 11;
+  const size_t numberOfBuckets = size_t( 1 ) << digitBits;
+  const OffsetType digitMask = static_cast< OffsetType >( numberOfBuckets - 1 );
+
+  this->m_Counts.resize( numberOfBuckets );
+  this->m_SortedOffsets.resize( numberOfNodes );
+  this->m_SortedValues.resize( withValues ? numberOfNodes : 0 );
+
+  for( unsigned int shift = 0; shift < this->m_NumberOfOffsetBits; shift += digitBits )
+    {
+    std::fill( this->m_Counts.begin(), this->m_Counts.end(), 0 );
+    for( size_t i = 0; i < numberOfNodes; i++ )
+      {
+      ++this->m_Counts[( this->m_Offsets[i] >> shift ) & digitMask];
+      }
+
+    size_t position = 0;
+    for( size_t b = 0; b < numberOfBuckets; b++ )
+      {
+      const size_t count = this->m_Counts[b];
+      this->m_Counts[b] = position;
+      position += count;
+      }
+
+    for( size_t i = 0; i < numberOfNodes; i++ )
+      {
+      const size_t target = this->m_Counts[( this->m_Offsets[i] >> shift ) & digitMask]++;
+      this->m_SortedOffsets[target] = this->m_Offsets[i];
+      if( withValues )
+        {
+        this->m_SortedValues[target] = this->m_Values[i];
+        }
+      }
+
+    this->m_Offsets.swap( this->m_SortedOffsets );
+    this->m_Values.swap( this->m_SortedValues );
+    }
+}
+
+template< class TLevelSet >
+typename SparseLevelSetSortedLayer< TLevelSet >::IndexType
+SparseLevelSetSortedLayer< TLevelSet >
+::ComputeIndex( OffsetType iOffset ) const
+{
+  IndexType index;
+  for( int dim = ImageDimension - 1; dim >= 0; dim-- )
+    {
+    index[dim] = this->m_Region.GetIndex()[dim] + static_cast< OffsetValueType >( iOffset / this->m_Strides[dim] );
+    iOffset %= this->m_Strides[dim];
+    }
+  return index;
+}
+
+template< class TLevelSet >
+void
+SparseLevelSetSortedLayer< TLevelSet >
+::Merge( const Self* iLayers, size_t iNumberOfLayers, NodeListType& oNodes )
+{
+  oNodes.clear();
+
+  // the position of a layer is stored on one byte
+  if( iNumberOfLayers > 256 )
+    {
+    itkGenericExceptionMacro( << "Too many layers to merge: " << iNumberOfLayers );
+    }
+
+  // A node belongs to one layer only: take the smallest head each time.
+  // There are at most five layers, a linear scan of the heads is enough.
+  size_t heads[256];
+  size_t numberOfNodes = 0;
+  for( size_t l = 0; l < iNumberOfLayers; l++ )
+    {
+    heads[l] = 0;
+    numberOfNodes += iLayers[l].Size();
+    }
+  oNodes.reserve( numberOfNodes );
+
+  for( size_t n = 0; n < numberOfNodes; n++ )
+    {
+    size_t smallest = iNumberOfLayers;
+    for( size_t l = 0; l < iNumberOfLayers; l++ )
+      {
+      if( ( heads[l] < iLayers[l].Size() ) &&
+          ( ( smallest == iNumberOfLayers ) ||
+            ( iLayers[l].m_Offsets[heads[l]] < iLayers[smallest].m_Offsets[heads[smallest]] ) ) )
+        {
+        smallest = l;
+        }
+      }
+    oNodes.push_back( LevelSetLayerTrace::NodeType( iLayers[smallest].m_Offsets[heads[smallest]],
+                                                    static_cast< unsigned char >( smallest ) ) );
+    ++heads[smallest];
+    }
+}
+
+}
+#endif // __itkSparseLevelSetSortedLayer_hxx
@@ -0,0 +1,160 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkSparseLevelSetToImageFilter_h
+#define __itkSparseLevelSetToImageFilter_h
+
+#include "itkImageSource.h"
+#include "itkSparseLevelSetLayerTraits.h"
+
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class SparseLevelSetToImageFilter
+ *  \brief Rasterize a sparse level-set into an image.
+ *
+ *  The label map of the sparse level-set is walked line by line, and each
+ *  run-length line is written as one contiguous span of the output row;
+ *  the output is never queried pixel by pixel. The lines are sorted into
+ *  buckets, one per output row, once before the threads start; the work is
+ *  then split over threads by output region, and each thread only visits
+ *  the buckets of its own rows.
+ *
+ *  By default the output holds the layer identifier of each pixel (as
+ *  LevelSetType::GetLabelMap()->GetPixel() would). With ExportLayerValues
+ *  on, the nodes of the layers are written with their signed level-set
+ *  values instead.
+ *
+ *  \tparam TLevelSet    Whitaker, Shi or Malcolm sparse level-set image
+ *  \tparam TOutputImage Output image type
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TLevelSet, class TOutputImage >
+class SparseLevelSetToImageFilter : public ImageSource< TOutputImage >
+{
+public:
+  typedef SparseLevelSetToImageFilter     Self;
+  typedef ImageSource< TOutputImage >     Superclass;
+  typedef SmartPointer< Self >            Pointer;
+  typedef SmartPointer< const Self >      ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( SparseLevelSetToImageFilter, ImageSource );
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::Pointer           OutputImagePointer;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::IndexType         OutputIndexType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef ImageBase< ImageDimension >                 ReferenceImageType;
+
+  typedef TLevelSet                                   LevelSetType;
+  typedef typename LevelSetType::ConstPointer         LevelSetConstPointer;
+  typedef typename LevelSetType::LayerIdType          LayerIdType;
+  typedef typename LevelSetType::LayerType            LayerType;
+  typedef typename LayerType::const_iterator          LayerConstIterator;
+  typedef typename LevelSetType::LabelMapType         LabelMapType;
+  typedef typename LabelMapType::LabelObjectType      LabelObjectType;
+  typedef typename LabelObjectType::LineType          LineType;
+
+  typedef SparseLevelSetLayerTraits< LevelSetType >   LayerTraitsType;
+  typedef typename LayerTraitsType::LayerIdListType   LayerIdListType;
+
+  /** Set/Get the level-set to rasterize */
+  void SetLevelSet( const LevelSetType* iLevelSet );
+  itkGetConstObjectMacro( LevelSet, LevelSetType );
+
+  /** Write the signed values of the layer nodes instead of their layer
+   * identifiers. Default is off. */
+  itkSetMacro( ExportLayerValues, bool );
+  itkGetConstMacro( ExportLayerValues, bool );
+  itkBooleanMacro( ExportLayerValues );
+
+  /** Take the output region, spacing, origin and direction from a
+   * reference image instead of the label map of the level-set. */
+  void SetOutputParametersFromImage( const ReferenceImageType* iImage );
+
+protected:
+  SparseLevelSetToImageFilter();
+  virtual ~SparseLevelSetToImageFilter() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  virtual void GenerateOutputInformation();
+
+  /** Sort the lines, and the layer nodes, into the buckets of the rows */
+  virtual void BeforeThreadedGenerateData();
+
+  virtual void AfterThreadedGenerateData();
+
+  virtual void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                                     ThreadIdType threadId );
+
+  /** Fill the iLength pixels of the row starting at iIndex with iValue,
+   * clipped to iRegion */
+  void FillSpan( OutputImageType* ioOutput, const OutputImageRegionType & iRegion,
+                 const OutputIndexType & iIndex, SizeValueType iLength,
+                 const OutputPixelType & iValue ) const;
+
+  /** Span of a row to fill: its first index along the row, its length and
+   * its value */
+  struct SpanType
+    {
+    OffsetValueType m_Begin;
+    SizeValueType   m_Length;
+    OutputPixelType m_Value;
+    };
+
+  /** Bucket of the row of iIndex in the requested region; false if the
+   * row is out of it */
+  bool ComputeRow( const OutputIndexType & iIndex, SizeValueType & oRow ) const;
+
+private:
+  SparseLevelSetToImageFilter( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  LevelSetConstPointer            m_LevelSet;
+  bool                            m_ExportLayerValues;
+
+  bool                            m_UseReferenceImage;
+  OutputImageRegionType           m_ReferenceRegion;
+  typename OutputImageType::SpacingType   m_ReferenceSpacing;
+  typename OutputImageType::PointType     m_ReferenceOrigin;
+  typename OutputImageType::DirectionType m_ReferenceDirection;
+
+  // spans of the row r are m_Spans[m_RowStarts[r]] to m_Spans[m_RowStarts[r+1]-1],
+  // in the order they are written
+  OutputImageRegionType           m_RowRegion;
+  std::vector< SpanType >         m_Spans;
+  std::vector< SizeValueType >    m_RowStarts;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSparseLevelSetToImageFilter.hxx"
+#endif
+
+#endif // __itkSparseLevelSetToImageFilter_h
@@ -0,0 +1,320 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkSparseLevelSetToImageFilter_hxx
+#define __itkSparseLevelSetToImageFilter_hxx
+
+#include "itkSparseLevelSetToImageFilter.h"
+
+#include <algorithm>
+
+namespace itk
+{
+template< class TLevelSet, class TOutputImage >
+SparseLevelSetToImageFilter< TLevelSet, TOutputImage >
+::SparseLevelSetToImageFilter() :
+  m_ExportLayerValues( false ),
+  m_UseReferenceImage( false )
+{
+  this->SetNumberOfRequiredInputs( 0 );
+}
+
+template< class TLevelSet, class TOutputImage >
+void
+SparseLevelSetToImageFilter< TLevelSet, TOutputImage >
+::SetLevelSet( const LevelSetType* iLevelSet )
+{
+  if( this->m_LevelSet != iLevelSet )
+    {
+    this->m_LevelSet = iLevelSet;
+    this->Modified();
+    }
+}
+
+template< class TLevelSet, class TOutputImage >
+void
+SparseLevelSetToImageFilter< TLevelSet, TOutputImage >
+::SetOutputParametersFromImage( const ReferenceImageType* iImage )
+{
+  this->m_ReferenceRegion = iImage->GetLargestPossibleRegion();
+  this->m_ReferenceSpacing = iImage->GetSpacing();
+  this->m_ReferenceOrigin = iImage->GetOrigin();
+  this->m_ReferenceDirection = iImage->GetDirection();
+  this->m_UseReferenceImage = true;
+  this->Modified();
+}
+
+template< class TLevelSet, class TOutputImage >
+void
+SparseLevelSetToImageFilter< TLevelSet, TOutputImage >
+::GenerateOutputInformation()
+{
+  if( this->m_LevelSet.IsNull() )
+    {
+    itkExceptionMacro( << "m_LevelSet is NULL" );
+    }
+
+  OutputImageType* output = this->GetOutput();
+
+  if( this->m_UseReferenceImage )
+    {
+    output->SetLargestPossibleRegion( this->m_ReferenceRegion );
+    output->SetSpacing( this->m_ReferenceSpacing );
+    output->SetOrigin( this->m_ReferenceOrigin );
+    output->SetDirection( this->m_ReferenceDirection );
+    }
+  else
+    {
+    const LabelMapType* labelMap =
+      const_cast< LevelSetType* >( this->m_LevelSet.GetPointer() )->GetLabelMap();
+
+    output->SetLargestPossibleRegion( labelMap->GetLargestPossibleRegion() );
+    output->SetSpacing( labelMap->GetSpacing() );
+    output->SetOrigin( labelMap->GetOrigin() );
+    output->SetDirection( labelMap->GetDirection() );
+    }
+}
+
+template< class TLevelSet, class TOutputImage >
+void
+SparseLevelSetToImageFilter< TLevelSet, TOutputImage >
+::FillSpan( OutputImageType* ioOutput, const OutputImageRegionType & iRegion,
+            const OutputIndexType & iIndex, SizeValueType iLength,
+            const OutputPixelType & iValue ) const
+{
+  const OutputIndexType & regionIndex = iRegion.GetIndex();
+  const typename OutputImageRegionType::SizeType & regionSize = iRegion.GetSize();
+
+  for( unsigned int dim = 1; dim < ImageDimension; dim++ )
+    {
+    if( ( iIndex[dim] < regionIndex[dim] ) ||
+        ( iIndex[dim] >= regionIndex[dim] + static_cast< OffsetValueType >( regionSize[dim] ) ) )
+      {
+      return;
+      }
+    }
+
+  const OffsetValueType begin = std::max( iIndex[0], regionIndex[0] );
+  const OffsetValueType end = std::min(
+    iIndex[0] + static_cast< OffsetValueType >( iLength ),
+    regionIndex[0] + static_cast< OffsetValueType >( regionSize[0] ) );
+
+  if( begin >= end )
+    {
+    return;
+    }
+
+  OutputIndexType start = iIndex;
+  start[0] = begin;
+
+  OutputPixelType* buffer = ioOutput->GetBufferPointer() + ioOutput->ComputeOffset( start );
+  std::fill( buffer, buffer + ( end - begin ), iValue );
+}
+
+template< class TLevelSet, class TOutputImage >
+bool
+SparseLevelSetToImageFilter< TLevelSet, TOutputImage >
+::ComputeRow( const OutputIndexType & iIndex, SizeValueType & oRow ) const
+{
+  const OutputIndexType & regionIndex = this->m_RowRegion.GetIndex();
+  const typename OutputImageRegionType::SizeType & regionSize = this->m_RowRegion.GetSize();
+
+  oRow = 0;
+  SizeValueType stride = 1;
+  for( unsigned int dim = 1; dim < ImageDimension; dim++ )
+    {
+    const OffsetValueType offset = iIndex[dim] - regionIndex[dim];
+    if( ( offset < 0 ) || ( offset >= static_cast< OffsetValueType >( regionSize[dim] ) ) )
+      {
+      return false;
+      }
+    oRow += static_cast< SizeValueType >( offset ) * stride;
+    stride *= regionSize[dim];
+    }
+  return true;
+}
+
+template< class TLevelSet, class TOutputImage >
+void
+SparseLevelSetToImageFilter< TLevelSet, TOutputImage >
+::BeforeThreadedGenerateData()
+{
+  this->m_RowRegion = this->GetOutput()->GetRequestedRegion();
+  this->m_Spans.clear();
+  this->m_RowStarts.clear();
+
+  if( this->m_RowRegion.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  const SizeValueType numberOfRows =
+    this->m_RowRegion.GetNumberOfPixels() / this->m_RowRegion.GetSize()[0];
+
+  const LevelSetType* levelSet = this->m_LevelSet.GetPointer();
+  const LabelMapType* labelMap = const_cast< LevelSetType* >( levelSet )->GetLabelMap();
+
+  // Spans with their row, in the order they are written: every run-length
+  // line of every label object, then the layer nodes if their values are
+  // exported.
+  typedef std::pair< SizeValueType, SpanType > RowSpanType;
+  std::vector< RowSpanType > rowSpans;
+
+  SizeValueType row;
+  SpanType span;
+
+  typedef typename LabelMapType::LabelObjectVectorType LabelObjectVectorType;
+  const LabelObjectVectorType labelObjects = labelMap->GetLabelObjects();
+
+  for( typename LabelObjectVectorType::const_iterator oIt = labelObjects.begin();
+       oIt != labelObjects.end(); ++oIt )
+    {
+    const LabelObjectType* labelObject = *oIt;
+    span.m_Value = static_cast< OutputPixelType >( labelObject->GetLabel() );
+
+    const SizeValueType numberOfLines = labelObject->GetNumberOfLines();
+    for( SizeValueType i = 0; i < numberOfLines; i++ )
+      {
+      const LineType & line = labelObject->GetLine( i );
+      if( this->ComputeRow( line.GetIndex(), row ) )
+        {
+        span.m_Begin = line.GetIndex()[0];
+        span.m_Length = line.GetLength();
+        rowSpans.push_back( RowSpanType( row, span ) );
+        }
+      }
+    }
+
+  if( this->m_ExportLayerValues )
+    {
+    const LayerIdListType layerIds = LayerTraitsType::GetLayerIds();
+
+    span.m_Length = 1;
+    for( typename LayerIdListType::const_iterator lIt = layerIds.begin();
+         lIt != layerIds.end(); ++lIt )
+      {
+      const LayerType & layer = levelSet->GetLayer( *lIt );
+
+      for( LayerConstIterator nIt = layer.begin(); nIt != layer.end(); ++nIt )
+        {
+        if( this->ComputeRow( nIt->first, row ) )
+          {
+          span.m_Begin = nIt->first[0];
+          span.m_Value = static_cast< OutputPixelType >( nIt->second );
+          rowSpans.push_back( RowSpanType( row, span ) );
+          }
+        }
+      }
+    }
+
+  // Counting sort by row, which keeps the order of the spans of a row.
+  this->m_RowStarts.assign( numberOfRows + 1, 0 );
+  for( size_t i = 0; i < rowSpans.size(); i++ )
+    {
+    ++this->m_RowStarts[rowSpans[i].first + 1];
+    }
+  for( SizeValueType r = 0; r < numberOfRows; r++ )
+    {
+    this->m_RowStarts[r + 1] += this->m_RowStarts[r];
+    }
+
+  std::vector< SizeValueType > next( this->m_RowStarts.begin(), this->m_RowStarts.end() - 1 );
+  this->m_Spans.resize( rowSpans.size() );
+  for( size_t i = 0; i < rowSpans.size(); i++ )
+    {
+    this->m_Spans[next[rowSpans[i].first]++] = rowSpans[i].second;
+    }
+}
+
+template< class TLevelSet, class TOutputImage >
+void
+SparseLevelSetToImageFilter< TLevelSet, TOutputImage >
+::AfterThreadedGenerateData()
+{
+  // release the buckets
+  std::vector< SpanType >().swap( this->m_Spans );
+  std::vector< SizeValueType >().swap( this->m_RowStarts );
+}
+
+template< class TLevelSet, class TOutputImage >
+void
+SparseLevelSetToImageFilter< TLevelSet, TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        ThreadIdType itkNotUsed( threadId ) )
+{
+  OutputImageType* output = this->GetOutput();
+
+  if( outputRegionForThread.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  const LabelMapType* labelMap =
+    const_cast< LevelSetType* >( this->m_LevelSet.GetPointer() )->GetLabelMap();
+
+  const OutputPixelType background =
+    static_cast< OutputPixelType >( labelMap->GetBackgroundValue() );
+
+  const OutputIndexType & regionIndex = outputRegionForThread.GetIndex();
+  const typename OutputImageRegionType::SizeType & regionSize = outputRegionForThread.GetSize();
+  const SizeValueType rowLength = regionSize[0];
+  const SizeValueType numberOfRows = outputRegionForThread.GetNumberOfPixels() / rowLength;
+
+  // Each row gets the background, then the spans of its bucket.
+  OutputIndexType rowIndex = regionIndex;
+  for( SizeValueType r = 0; r < numberOfRows; r++ )
+    {
+    this->FillSpan( output, outputRegionForThread, rowIndex, rowLength, background );
+
+    SizeValueType row;
+    if( this->ComputeRow( rowIndex, row ) )
+      {
+      OutputIndexType start = rowIndex;
+      for( SizeValueType i = this->m_RowStarts[row]; i < this->m_RowStarts[row + 1]; i++ )
+        {
+        const SpanType & span = this->m_Spans[i];
+        start[0] = span.m_Begin;
+        this->FillSpan( output, outputRegionForThread, start, span.m_Length, span.m_Value );
+        }
+      }
+
+    for( unsigned int dim = 1; dim < ImageDimension; dim++ )
+      {
+      ++rowIndex[dim];
+      if( rowIndex[dim] < regionIndex[dim] + static_cast< OffsetValueType >( regionSize[dim] ) )
+        {
+        break;
+        }
+      rowIndex[dim] = regionIndex[dim];
+      }
+    }
+}
+
+template< class TLevelSet, class TOutputImage >
+void
+SparseLevelSetToImageFilter< TLevelSet, TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "LevelSet: " << this->m_LevelSet.GetPointer() << std::endl;
+  os << indent << "ExportLayerValues: " << this->m_ExportLayerValues << std::endl;
+  os << indent << "UseReferenceImage: " << this->m_UseReferenceImage << std::endl;
+}
+
+}
+#endif // __itkSparseLevelSetToImageFilter_hxx
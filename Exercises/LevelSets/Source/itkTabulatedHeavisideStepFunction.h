@@ -0,0 +1,151 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkTabulatedHeavisideStepFunction_h
+#define __itkTabulatedHeavisideStepFunction_h
+
+#include "itkRegularizedHeavisideStepFunction.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class TabulatedHeavisideStepFunction
+ *  \brief Sin regularized Heaviside step function, tabulated.
+ *
+ *  Same function as SinRegularizedHeavisideStepFunction, but the Heaviside
+ *  and its derivative (the Dirac) are sampled once over [-epsilon, epsilon]
+ *  and evaluated by linear interpolation in the tables, without any call
+ *  to sin or cos.
+ *
+ *  The number of samples is either given directly, or derived from the
+ *  maximum interpolation error: the error on the Heaviside, and the error
+ *  on the Dirac relative to its maximum 1/epsilon, are both below
+ *  MaximumError.
+ *
+ *  The array versions of Evaluate() and EvaluateDerivative() process a
+ *  contiguous buffer of level-set values. Their loop has no branch, so that
+ *  the compiler can vectorize it. LevelSetEvolutionChanAndVeseEnergyStoppingCriterion
+ *  uses them to weight the nodes of every layer after each iteration.
+ *
+ *  The tables are rebuilt by SetEpsilon(), which must be called on this
+ *  class rather than on its superclass.
+ *
+ *  \tparam TInput Input type
+ *  \tparam TOutput Output type
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TInput = float, class TOutput = double >
+class TabulatedHeavisideStepFunction :
+  public RegularizedHeavisideStepFunction< TInput, TOutput >
+{
+public:
+  typedef TabulatedHeavisideStepFunction                      Self;
+  typedef RegularizedHeavisideStepFunction< TInput, TOutput > Superclass;
+  typedef SmartPointer< Self >                                Pointer;
+  typedef SmartPointer< const Self >                          ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( TabulatedHeavisideStepFunction, RegularizedHeavisideStepFunction );
+
+  typedef typename Superclass::InputType  InputType;
+  typedef typename Superclass::OutputType OutputType;
+  typedef typename Superclass::RealType   RealType;
+
+  /** Set epsilon and rebuild the tables */
+  void SetEpsilon( const RealType & iEpsilon );
+
+  /** Set the maximum interpolation error, and the number of samples
+   * accordingly. Default is 1e-5. */
+  void SetMaximumError( double iError );
+  double GetMaximumError() const
+    {
+    return this->m_MaximumError;
+    }
+
+  /** Set the number of intervals of the tables directly */
+  void SetNumberOfSamples( SizeValueType iNumberOfSamples );
+  SizeValueType GetNumberOfSamples() const
+    {
+    return this->m_NumberOfSamples;
+    }
+
+  /** Evaluate the Heaviside function */
+  virtual OutputType Evaluate( const InputType & iInput ) const;
+
+  /** Evaluate the derivative of the Heaviside function, the Dirac */
+  virtual OutputType EvaluateDerivative( const InputType & iInput ) const;
+
+  /** Evaluate the Heaviside function at iSize contiguous values */
+  void Evaluate( const InputType* iInput, OutputType* oOutput, SizeValueType iSize ) const;
+
+  /** Evaluate the Dirac at iSize contiguous values */
+  void EvaluateDerivative( const InputType* iInput, OutputType* oOutput, SizeValueType iSize ) const;
+
+protected:
+  TabulatedHeavisideStepFunction();
+  virtual ~TabulatedHeavisideStepFunction() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Sample the Heaviside and the Dirac over [-epsilon, epsilon] */
+  void BuildTables();
+
+  /** Interpolate iTable at iInput */
+  inline OutputType Interpolate( const std::vector< OutputType >& iTable, const InputType & iInput ) const
+    {
+    RealType u = ( static_cast< RealType >( iInput ) + this->GetEpsilon() ) * this->m_Scale;
+    u = std::min( std::max( u, NumericTraits< RealType >::Zero ), this->m_LastSample );
+
+    // the last sample is duplicated, so that u == m_LastSample reads it
+    const SizeValueType i = static_cast< SizeValueType >( u );
+    const RealType t = u - static_cast< RealType >( i );
+
+    return static_cast< OutputType >( iTable[i] + t * ( iTable[i+1] - iTable[i] ) );
+    }
+
+  /** Interpolate iTable at iSize contiguous values */
+  void Interpolate( const std::vector< OutputType >& iTable,
+                    const InputType* iInput, OutputType* oOutput, SizeValueType iSize ) const;
+
+private:
+  TabulatedHeavisideStepFunction( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  double                    m_MaximumError;
+  SizeValueType             m_NumberOfSamples;
+
+  RealType                  m_Scale;
+  RealType                  m_LastSample;
+
+  std::vector< OutputType > m_Heaviside;
+  std::vector< OutputType > m_Dirac;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkTabulatedHeavisideStepFunction.hxx"
+#endif
+
+#endif // __itkTabulatedHeavisideStepFunction_h
@@ -0,0 +1,195 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkTabulatedHeavisideStepFunction_hxx
+#define __itkTabulatedHeavisideStepFunction_hxx
+
+#include "itkTabulatedHeavisideStepFunction.h"
+#include "vnl/vnl_math.h"
+
+#include <cmath>
+
+namespace itk
+{
+template< class TInput, class TOutput >
+TabulatedHeavisideStepFunction< TInput, TOutput >
+::TabulatedHeavisideStepFunction() :
+  m_MaximumError( 1e-5 ),
+  m_NumberOfSamples( 0 ),
+  m_Scale( NumericTraits< RealType >::Zero ),
+  m_LastSample( NumericTraits< RealType >::Zero )
+{
+  this->SetMaximumError( this->m_MaximumError );
+}
+
+template< class TInput, class TOutput >
+void
+TabulatedHeavisideStepFunction< TInput, TOutput >
+::SetEpsilon( const RealType & iEpsilon )
+{
+  this->Superclass::SetEpsilon( iEpsilon );
+  this->BuildTables();
+  this->Modified();
+}
+
+template< class TInput, class TOutput >
+void
+TabulatedHeavisideStepFunction< TInput, TOutput >
+::SetMaximumError( double iError )
+{
+  if( iError <= 0. )
+    {
+    itkExceptionMacro( << "The maximum error must be positive" );
+    }
+
+  // Linear interpolation with a step h is off by at most h^2 / 8 times the
+  // second derivative. The second derivative of the Dirac, at most
+  // pi^2 / ( 2 epsilon^3 ), gives the tightest bound relative to 1/epsilon:
+  // over the 2 epsilon of the table, pi / ( 2 sqrt( error ) ) intervals.
+  this->m_MaximumError = iError;
+  this->m_NumberOfSamples = std::max( static_cast< SizeValueType >(
+    std::ceil( vnl_math::pi / ( 2. * std::sqrt( iError ) ) ) ), SizeValueType( 2 ) );
+
+  this->BuildTables();
+  this->Modified();
+}
+
+template< class TInput, class TOutput >
+void
+TabulatedHeavisideStepFunction< TInput, TOutput >
+::SetNumberOfSamples( SizeValueType iNumberOfSamples )
+{
+  if( iNumberOfSamples < 2 )
+    {
+    itkExceptionMacro( << "At least 2 samples are required" );
+    }
+
+  const double step = 2. / static_cast< double >( iNumberOfSamples );
+
+  this->m_NumberOfSamples = iNumberOfSamples;
+  this->m_MaximumError = step * step * vnl_math::pi * vnl_math::pi / 16.;
+
+  this->BuildTables();
+  this->Modified();
+}
+
+template< class TInput, class TOutput >
+void
+TabulatedHeavisideStepFunction< TInput, TOutput >
+::BuildTables()
+{
+  const RealType epsilon = this->GetEpsilon();
+  const RealType oneOverEpsilon = this->GetOneOverEpsilon();
+  const SizeValueType n = this->m_NumberOfSamples;
+
+  this->m_Scale = static_cast< RealType >( n ) * 0.5 * oneOverEpsilon;
+  this->m_LastSample = static_cast< RealType >( n );
+
+  // one more sample than intervals, plus a copy of the last one
+  this->m_Heaviside.resize( n + 2 );
+  this->m_Dirac.resize( n + 2 );
+
+  for( SizeValueType i = 0; i <= n; i++ )
+    {
+    const RealType x = -epsilon + 2. * epsilon * static_cast< RealType >( i ) / static_cast< RealType >( n );
+    const RealType t = vnl_math::pi * x * oneOverEpsilon;
+
+    this->m_Heaviside[i] = static_cast< OutputType >( 0.5 * ( 1. + x * oneOverEpsilon + std::sin( t ) * vnl_math::one_over_pi ) );
+    this->m_Dirac[i] = static_cast< OutputType >( 0.5 * oneOverEpsilon * ( 1. + std::cos( t ) ) );
+    }
+
+  // the end points are exact
+  this->m_Heaviside[0] = NumericTraits< OutputType >::Zero;
+  this->m_Heaviside[n] = NumericTraits< OutputType >::One;
+  this->m_Dirac[0] = NumericTraits< OutputType >::Zero;
+  this->m_Dirac[n] = NumericTraits< OutputType >::Zero;
+
+  this->m_Heaviside[n+1] = this->m_Heaviside[n];
+  this->m_Dirac[n+1] = this->m_Dirac[n];
+}
+
+template< class TInput, class TOutput >
+typename TabulatedHeavisideStepFunction< TInput, TOutput >::OutputType
+TabulatedHeavisideStepFunction< TInput, TOutput >
+::Evaluate( const InputType & iInput ) const
+{
+  return this->Interpolate( this->m_Heaviside, iInput );
+}
+
+template< class TInput, class TOutput >
+typename TabulatedHeavisideStepFunction< TInput, TOutput >::OutputType
+TabulatedHeavisideStepFunction< TInput, TOutput >
+::EvaluateDerivative( const InputType & iInput ) const
+{
+  return this->Interpolate( this->m_Dirac, iInput );
+}
+
+template< class TInput, class TOutput >
+void
+TabulatedHeavisideStepFunction< TInput, TOutput >
+::Evaluate( const InputType* iInput, OutputType* oOutput, SizeValueType iSize ) const
+{
+  this->Interpolate( this->m_Heaviside, iInput, oOutput, iSize );
+}
+
+template< class TInput, class TOutput >
+void
+TabulatedHeavisideStepFunction< TInput, TOutput >
+::EvaluateDerivative( const InputType* iInput, OutputType* oOutput, SizeValueType iSize ) const
+{
+  this->Interpolate( this->m_Dirac, iInput, oOutput, iSize );
+}
+
+template< class TInput, class TOutput >
+void
+TabulatedHeavisideStepFunction< TInput, TOutput >
+::Interpolate( const std::vector< OutputType >& iTable,
+               const InputType* iInput, OutputType* oOutput, SizeValueType iSize ) const
+{
+  // Hoist everything out of the loop: its body is a clamp, a truncation,
+  // two table reads and a multiply-add, with no branch.
+  const OutputType* table = &iTable[0];
+  const RealType epsilon = this->GetEpsilon();
+  const RealType scale = this->m_Scale;
+  const RealType lastSample = this->m_LastSample;
+  const RealType zero = NumericTraits< RealType >::Zero;
+
+  for( SizeValueType k = 0; k < iSize; k++ )
+    {
+    RealType u = ( static_cast< RealType >( iInput[k] ) + epsilon ) * scale;
+    u = std::min( std::max( u, zero ), lastSample );
+
+    const SizeValueType i = static_cast< SizeValueType >( u );
+    const RealType t = u - static_cast< RealType >( i );
+
+    oOutput[k] = static_cast< OutputType >( table[i] + t * ( table[i+1] - table[i] ) );
+    }
+}
+
+template< class TInput, class TOutput >
+void
+TabulatedHeavisideStepFunction< TInput, TOutput >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "MaximumError: " << this->m_MaximumError << std::endl;
+  os << indent << "NumberOfSamples: " << this->m_NumberOfSamples << std::endl;
+}
+
+}
+#endif // __itkTabulatedHeavisideStepFunction_hxx
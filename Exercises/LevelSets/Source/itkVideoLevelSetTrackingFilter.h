@@ -0,0 +1,234 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef __itkVideoLevelSetTrackingFilter_h
+#define __itkVideoLevelSetTrackingFilter_h
+
+#include "itkVideoToVideoFilter.h"
+#include "itkSeedToSparseLevelSetImageAdaptor.h"
+#include "itkLevelSetDomainMapImageFilter.h"
+#include "itkTabulatedHeavisideStepFunction.h"
+
+#include <list>
+#include <map>
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class VideoLevelSetTrackingFilter
+ *  \brief Track an object through a video with a sparse level-set warm
+ *  started from one frame to the next.
+ *
+ *  The level-set of the first frame, or of any frame which does not follow
+ *  the last one processed, is seeded with the seed boxes and evolved with
+ *  a Chan and Vese equation for up to NumberOfInitialIterations. The
+ *  level-set of each following frame starts from the converged level-set
+ *  of the previous frame, and is evolved for up to NumberOfIterations:
+ *  - without motion, the level-set is evolved as is, so that its layers
+ *  and their values carry over;
+ *  - with a motion shift, the interior of the previous level-set is moved
+ *  by the shift and the layers are rebuilt around it. The shift is
+ *  MotionShift, or, if PredictMotion is on, the displacement of the
+ *  centroid of the interior between the two previous frames once it is
+ *  known. That displacement already includes the shift applied to the
+ *  previous frame, so MotionShift is not added to it.
+ *  A frame stops before its maximum number of iterations once the RMS
+ *  change stays below RMSChangeThreshold for NumberOfConsecutiveIterations.
+ *
+ *  Each output frame is the mask of the interior of the level-set: the
+ *  pixels of the label objects with a non positive label are set to
+ *  InsideValue, the others to zero.
+ *
+ *  The Heaviside function and the domain map of the level-set are built
+ *  with the first frame, and only rebuilt when the region of the frames
+ *  changes: the following frames reuse them.
+ *
+ *  The frames must be requested in increasing order to be warm started,
+ *  as done by VideoFileWriter.
+ *
+ *  \tparam TInputVideoStream Input VideoStream type
+ *  \tparam TOutputVideoStream Output VideoStream type, of masks
+ *  \tparam TLevelSet Whitaker, Shi or Malcolm sparse level-set image
+ *
+ *  \ingroup ITKLevelSetsv4
+ */
+template< class TInputVideoStream, class TOutputVideoStream, class TLevelSet >
+class VideoLevelSetTrackingFilter :
+  public VideoToVideoFilter< TInputVideoStream, TOutputVideoStream >
+{
+public:
+  typedef VideoLevelSetTrackingFilter                                 Self;
+  typedef VideoToVideoFilter< TInputVideoStream, TOutputVideoStream > Superclass;
+  typedef SmartPointer< Self >                                        Pointer;
+  typedef SmartPointer< const Self >                                  ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( VideoLevelSetTrackingFilter, VideoToVideoFilter );
+
+  typedef TInputVideoStream                           InputVideoStreamType;
+  typedef TOutputVideoStream                          OutputVideoStreamType;
+  typedef typename InputVideoStreamType::FrameType    InputFrameType;
+  typedef typename OutputVideoStreamType::FrameType   OutputFrameType;
+  typedef typename OutputFrameType::PixelType         OutputPixelType;
+  typedef typename InputFrameType::RegionType         RegionType;
+  typedef typename InputFrameType::IndexType          IndexType;
+  typedef typename InputFrameType::OffsetType         OffsetType;
+
+  typedef TLevelSet                                   LevelSetType;
+  typedef typename LevelSetType::Pointer              LevelSetPointer;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, InputFrameType::ImageDimension );
+
+  typedef SeedToSparseLevelSetImageAdaptor< LevelSetType >  SeedAdaptorType;
+  typedef typename SeedAdaptorType::Pointer                 SeedAdaptorPointer;
+
+  typedef std::map< SizeValueType, unsigned int >     FrameIterationMapType;
+
+  typedef typename LevelSetType::OutputRealType       LevelSetOutputRealType;
+  typedef TabulatedHeavisideStepFunction<
+    LevelSetOutputRealType, LevelSetOutputRealType >  HeavisideType;
+
+  typedef std::list< IdentifierType >                 IdListType;
+  typedef Image< IdListType, ImageDimension >         IdListImageType;
+  typedef Image< short, ImageDimension >              CacheImageType;
+  typedef LevelSetDomainMapImageFilter< IdListImageType, CacheImageType >
+                                                      DomainMapImageFilterType;
+
+  /** Seed boxes of the first frame */
+  void AddSeedRegion( const RegionType& iRegion );
+  void ClearSeedRegions();
+
+  /** Maximum number of iterations of the first frame. Default is 100. */
+  itkSetMacro( NumberOfInitialIterations, unsigned int );
+  itkGetConstMacro( NumberOfInitialIterations, unsigned int );
+
+  /** Maximum number of iterations of the following frames. Default is
+   * 10. */
+  itkSetMacro( NumberOfIterations, unsigned int );
+  itkGetConstMacro( NumberOfIterations, unsigned int );
+
+  /** A frame stops before the maximum number of iterations once the RMS
+   * change stays below this threshold for NumberOfConsecutiveIterations */
+  itkSetMacro( RMSChangeThreshold, double );
+  itkGetConstMacro( RMSChangeThreshold, double );
+
+  itkSetMacro( NumberOfConsecutiveIterations, unsigned int );
+  itkGetConstMacro( NumberOfConsecutiveIterations, unsigned int );
+
+  /** Shift of the interior from one frame to the next. Default is zero. */
+  itkSetMacro( MotionShift, OffsetType );
+  itkGetConstMacro( MotionShift, OffsetType );
+
+  /** Shift by the last displacement of the centroid of the interior,
+   * instead of MotionShift, once it is known. Default is off. */
+  itkSetMacro( PredictMotion, bool );
+  itkGetConstMacro( PredictMotion, bool );
+  itkBooleanMacro( PredictMotion );
+
+  /** Value of the interior in the output masks. Default is the maximum
+   * of the output pixel type. */
+  itkSetMacro( InsideValue, OutputPixelType );
+  itkGetConstMacro( InsideValue, OutputPixelType );
+
+  /** Number of iterations run on each frame processed */
+  const FrameIterationMapType& GetNumberOfIterationsPerFrame() const
+    {
+    return this->m_NumberOfIterationsPerFrame;
+    }
+
+  /** Level-set of the last frame processed */
+  itkGetObjectMacro( LevelSet, LevelSetType );
+
+  /** Number of times the domain map was built */
+  itkGetConstMacro( NumberOfDomainMapBuilds, SizeValueType );
+
+protected:
+  VideoLevelSetTrackingFilter();
+  virtual ~VideoLevelSetTrackingFilter() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Track the object in the requested frame */
+  virtual void TemporalStreamingGenerateData();
+
+  /** Level-set of iFrame seeded with the seed boxes */
+  LevelSetPointer SeedLevelSet( const InputFrameType* iFrame ) const;
+
+  /** Level-set of iFrame seeded with the interior of iLevelSet moved by
+   * iShift */
+  LevelSetPointer ShiftLevelSet( const InputFrameType* iFrame, LevelSetType* iLevelSet,
+                                 const OffsetType& iShift ) const;
+
+  /** Centroid of the interior of iLevelSet, in index space; false if the
+   * interior is empty */
+  bool ComputeCentroid( LevelSetType* iLevelSet, std::vector< double >& oCentroid ) const;
+
+  /** Build the domain map of the level-set for iRegion, unless it is
+   * already built for that region */
+  void UpdateDomainMap( const RegionType& iRegion );
+
+  /** Evolve ioLevelSet on iFrame, return the number of iterations */
+  unsigned int EvolveFrame( const InputFrameType* iFrame, LevelSetType* ioLevelSet,
+                            unsigned int iNumberOfIterations ) const;
+
+  /** Write the interior of iLevelSet in oFrame */
+  void RasterizeInterior( LevelSetType* iLevelSet, OutputFrameType* oFrame ) const;
+
+private:
+  VideoLevelSetTrackingFilter( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  std::vector< RegionType > m_SeedRegions;
+
+  unsigned int              m_NumberOfInitialIterations;
+  unsigned int              m_NumberOfIterations;
+  double                    m_RMSChangeThreshold;
+  unsigned int              m_NumberOfConsecutiveIterations;
+  OffsetType                m_MotionShift;
+  bool                      m_PredictMotion;
+  OutputPixelType           m_InsideValue;
+
+  /** State carried from one frame to the next */
+  LevelSetPointer           m_LevelSet;
+  bool                      m_HasPreviousFrame;
+  SizeValueType             m_PreviousFrame;
+  bool                      m_HasPreviousCentroid;
+  std::vector< double >     m_PreviousCentroid;
+  bool                      m_HasPredictedShift;
+  OffsetType                m_PredictedShift;
+
+  FrameIterationMapType     m_NumberOfIterationsPerFrame;
+
+  /** Built once, shared by the evolutions of all the frames */
+  typename HeavisideType::Pointer             m_Heaviside;
+  typename DomainMapImageFilterType::Pointer  m_DomainMapFilter;
+  RegionType                                  m_DomainMapRegion;
+  SizeValueType                               m_NumberOfDomainMapBuilds;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkVideoLevelSetTrackingFilter.hxx"
+#endif
+
+#endif // __itkVideoLevelSetTrackingFilter_h
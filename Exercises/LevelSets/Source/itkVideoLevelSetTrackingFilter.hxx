@@ -0,0 +1,434 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#ifndef __itkVideoLevelSetTrackingFilter_hxx
+#define __itkVideoLevelSetTrackingFilter_hxx
+
+#include "itkVideoLevelSetTrackingFilter.h"
+
+#include "itkLevelSetContainer.h"
+#include "itkLevelSetEquationChanAndVeseInternalTerm.h"
+#include "itkLevelSetEquationChanAndVeseExternalTerm.h"
+#include "itkLevelSetEquationTermContainer.h"
+#include "itkLevelSetEquationContainer.h"
+#include "itkLevelSetEvolution.h"
+#include "itkLevelSetEvolutionNumberOfIterationsStoppingCriterion.h"
+#include "itkLevelSetEvolutionRMSChangeStoppingCriterion.h"
+#include "itkLevelSetEvolutionCompositeStoppingCriterion.h"
+#include "itkMath.h"
+
+#include <algorithm>
+
+namespace itk
+{
+template< class TInputVideoStream, class TOutputVideoStream, class TLevelSet >
+VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >
+::VideoLevelSetTrackingFilter() :
+  m_NumberOfInitialIterations( 100 ),
+  m_NumberOfIterations( 10 ),
+  m_RMSChangeThreshold( 1e-3 ),
+  m_NumberOfConsecutiveIterations( 2 ),
+  m_PredictMotion( false ),
+  m_InsideValue( NumericTraits< OutputPixelType >::max() ),
+  m_HasPreviousFrame( false ),
+  m_PreviousFrame( 0 ),
+  m_HasPreviousCentroid( false ),
+  m_HasPredictedShift( false ),
+  m_NumberOfDomainMapBuilds( 0 )
+{
+  this->m_MotionShift.Fill( 0 );
+  this->m_PredictedShift.Fill( 0 );
+
+  this->m_Heaviside = HeavisideType::New();
+  this->m_Heaviside->SetEpsilon( 1.0 );
+}
+
+template< class TInputVideoStream, class TOutputVideoStream, class TLevelSet >
+void
+VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >
+::AddSeedRegion( const RegionType& iRegion )
+{
+  this->m_SeedRegions.push_back( iRegion );
+  this->Modified();
+}
+
+template< class TInputVideoStream, class TOutputVideoStream, class TLevelSet >
+void
+VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >
+::ClearSeedRegions()
+{
+  this->m_SeedRegions.clear();
+  this->Modified();
+}
+
+template< class TInputVideoStream, class TOutputVideoStream, class TLevelSet >
+typename VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >::LevelSetPointer
+VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >
+::SeedLevelSet( const InputFrameType* iFrame ) const
+{
+  if( this->m_SeedRegions.empty() )
+    {
+    itkExceptionMacro( << "No seed region" );
+    }
+
+  SeedAdaptorPointer adaptor = SeedAdaptorType::New();
+  adaptor->SetReferenceImage( iFrame );
+  for( size_t i = 0; i < this->m_SeedRegions.size(); i++ )
+    {
+    adaptor->AddRegion( this->m_SeedRegions[i] );
+    }
+  adaptor->Initialize();
+  return adaptor->GetLevelSet();
+}
+
+template< class TInputVideoStream, class TOutputVideoStream, class TLevelSet >
+typename VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >::LevelSetPointer
+VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >
+::ShiftLevelSet( const InputFrameType* iFrame, LevelSetType* iLevelSet,
+                 const OffsetType& iShift ) const
+{
+  typedef typename LevelSetType::LabelMapType           LabelMapType;
+  typedef typename LabelMapType::LabelObjectVectorType  LabelObjectVectorType;
+  typedef typename LabelMapType::LabelObjectType        LabelObjectType;
+  typedef typename LabelObjectType::LineType            LineType;
+
+  SeedAdaptorPointer adaptor = SeedAdaptorType::New();
+  adaptor->SetReferenceImage( iFrame );
+
+  // The interior is the union of the label objects with a non positive
+  // label; the runs out of the frame are clipped by the adaptor.
+  const LabelObjectVectorType labelObjects = iLevelSet->GetLabelMap()->GetLabelObjects();
+
+  for( typename LabelObjectVectorType::const_iterator oIt = labelObjects.begin();
+       oIt != labelObjects.end(); ++oIt )
+    {
+    if( ( *oIt )->GetLabel() > 0 )
+      {
+      continue;
+      }
+
+    for( SizeValueType l = 0; l < ( *oIt )->GetNumberOfLines(); l++ )
+      {
+      const LineType & line = ( *oIt )->GetLine( l );
+      adaptor->AddRun( line.GetIndex() + iShift, line.GetLength() );
+      }
+    }
+
+  adaptor->Initialize();
+  return adaptor->GetLevelSet();
+}
+
+template< class TInputVideoStream, class TOutputVideoStream, class TLevelSet >
+bool
+VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >
+::ComputeCentroid( LevelSetType* iLevelSet, std::vector< double >& oCentroid ) const
+{
+  typedef typename LevelSetType::LabelMapType           LabelMapType;
+  typedef typename LabelMapType::LabelObjectVectorType  LabelObjectVectorType;
+  typedef typename LabelMapType::LabelObjectType        LabelObjectType;
+  typedef typename LabelObjectType::LineType            LineType;
+
+  oCentroid.assign( ImageDimension, 0. );
+  double numberOfPixels = 0.;
+
+  const LabelObjectVectorType labelObjects = iLevelSet->GetLabelMap()->GetLabelObjects();
+
+  for( typename LabelObjectVectorType::const_iterator oIt = labelObjects.begin();
+       oIt != labelObjects.end(); ++oIt )
+    {
+    if( ( *oIt )->GetLabel() > 0 )
+      {
+      continue;
+      }
+
+    for( SizeValueType l = 0; l < ( *oIt )->GetNumberOfLines(); l++ )
+      {
+      const LineType & line = ( *oIt )->GetLine( l );
+      const double length = static_cast< double >( line.GetLength() );
+
+      // the pixels of a line are consecutive along the first axis
+      oCentroid[0] += length * ( static_cast< double >( line.GetIndex()[0] ) + 0.5 * ( length - 1. ) );
+      for( unsigned int dim = 1; dim < ImageDimension; dim++ )
+        {
+        oCentroid[dim] += length * static_cast< double >( line.GetIndex()[dim] );
+        }
+      numberOfPixels += length;
+      }
+    }
+
+  if( numberOfPixels == 0. )
+    {
+    return false;
+    }
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    oCentroid[dim] /= numberOfPixels;
+    }
+  return true;
+}
+
+template< class TInputVideoStream, class TOutputVideoStream, class TLevelSet >
+void
+VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >
+::UpdateDomainMap( const RegionType& iRegion )
+{
+  if( this->m_DomainMapFilter.IsNotNull() && ( this->m_DomainMapRegion == iRegion ) )
+    {
+    return;
+    }
+
+  // There is only one level-set, defined on the whole frame.
+  IdListType listIds;
+  listIds.push_back( 1 );
+
+  typename IdListImageType::Pointer idImage = IdListImageType::New();
+  idImage->SetRegions( iRegion );
+  idImage->Allocate();
+  idImage->FillBuffer( listIds );
+
+  this->m_DomainMapFilter = DomainMapImageFilterType::New();
+  this->m_DomainMapFilter->SetInput( idImage );
+  this->m_DomainMapFilter->Update();
+
+  this->m_DomainMapRegion = iRegion;
+  ++this->m_NumberOfDomainMapBuilds;
+}
+
+template< class TInputVideoStream, class TOutputVideoStream, class TLevelSet >
+unsigned int
+VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >
+::EvolveFrame( const InputFrameType* iFrame, LevelSetType* ioLevelSet,
+               unsigned int iNumberOfIterations ) const
+{
+  // the terms take a non const input, but never modify it
+  InputFrameType* frame = const_cast< InputFrameType* >( iFrame );
+
+  typedef LevelSetContainer< IdentifierType, LevelSetType > LevelSetContainerType;
+  typename LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
+  lscontainer->SetHeaviside( this->m_Heaviside );
+  lscontainer->SetDomainMapFilter( this->m_DomainMapFilter );
+  lscontainer->AddLevelSet( 0, ioLevelSet );
+
+  typedef LevelSetEquationChanAndVeseInternalTerm<
+    InputFrameType, LevelSetContainerType > InternalTermType;
+  typename InternalTermType::Pointer cvInternalTerm = InternalTermType::New();
+  cvInternalTerm->SetInput( frame );
+  cvInternalTerm->SetCoefficient( 1.0 );
+  cvInternalTerm->SetCurrentLevelSetId( 0 );
+  cvInternalTerm->SetLevelSetContainer( lscontainer );
+
+  typedef LevelSetEquationChanAndVeseExternalTerm<
+    InputFrameType, LevelSetContainerType > ExternalTermType;
+  typename ExternalTermType::Pointer cvExternalTerm = ExternalTermType::New();
+  cvExternalTerm->SetInput( frame );
+  cvExternalTerm->SetCoefficient( 1.0 );
+  cvExternalTerm->SetCurrentLevelSetId( 0 );
+  cvExternalTerm->SetLevelSetContainer( lscontainer );
+
+  typedef LevelSetEquationTermContainer< InputFrameType, LevelSetContainerType > TermContainerType;
+  typename TermContainerType::Pointer termContainer = TermContainerType::New();
+  termContainer->SetInput( frame );
+  termContainer->SetCurrentLevelSetId( 0 );
+  termContainer->SetLevelSetContainer( lscontainer );
+  termContainer->AddTerm( 0, cvInternalTerm );
+  termContainer->AddTerm( 1, cvExternalTerm );
+
+  typedef LevelSetEquationContainer< TermContainerType > EquationContainerType;
+  typename EquationContainerType::Pointer equationContainer = EquationContainerType::New();
+  equationContainer->SetLevelSetContainer( lscontainer );
+  equationContainer->AddEquation( 0, termContainer );
+
+  typedef LevelSetEvolutionNumberOfIterationsStoppingCriterion<
+    LevelSetContainerType > NumberOfIterationsCriterionType;
+  typename NumberOfIterationsCriterionType::Pointer numberOfIterationsCriterion =
+    NumberOfIterationsCriterionType::New();
+  numberOfIterationsCriterion->SetNumberOfIterations( iNumberOfIterations );
+
+  typedef LevelSetEvolutionRMSChangeStoppingCriterion< LevelSetContainerType > RMSChangeCriterionType;
+  typename RMSChangeCriterionType::Pointer rmsChangeCriterion = RMSChangeCriterionType::New();
+  rmsChangeCriterion->SetRMSChangeThreshold( this->m_RMSChangeThreshold );
+  rmsChangeCriterion->SetNumberOfConsecutiveIterations( this->m_NumberOfConsecutiveIterations );
+
+  typedef LevelSetEvolutionCompositeStoppingCriterion< LevelSetContainerType > StoppingCriterionType;
+  typename StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
+  criterion->SetLevelSetContainer( lscontainer );
+  criterion->AddCriterion( numberOfIterationsCriterion );
+  criterion->AddCriterion( rmsChangeCriterion );
+
+  typedef LevelSetEvolution< EquationContainerType, LevelSetType > LevelSetEvolutionType;
+  typename LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+  evolution->SetEquationContainer( equationContainer );
+  evolution->SetStoppingCriterion( criterion );
+  evolution->SetLevelSetContainer( lscontainer );
+  evolution->Update();
+
+  return static_cast< unsigned int >( criterion->GetCurrentIteration() );
+}
+
+template< class TInputVideoStream, class TOutputVideoStream, class TLevelSet >
+void
+VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >
+::RasterizeInterior( LevelSetType* iLevelSet, OutputFrameType* oFrame ) const
+{
+  typedef typename LevelSetType::LabelMapType           LabelMapType;
+  typedef typename LabelMapType::LabelObjectVectorType  LabelObjectVectorType;
+  typedef typename LabelMapType::LabelObjectType        LabelObjectType;
+  typedef typename LabelObjectType::LineType            LineType;
+
+  oFrame->FillBuffer( NumericTraits< OutputPixelType >::Zero );
+
+  const RegionType region = oFrame->GetBufferedRegion();
+  const OffsetValueType regionBegin = region.GetIndex()[0];
+  const OffsetValueType regionEnd = regionBegin + static_cast< OffsetValueType >( region.GetSize()[0] );
+
+  const LabelObjectVectorType labelObjects = iLevelSet->GetLabelMap()->GetLabelObjects();
+
+  for( typename LabelObjectVectorType::const_iterator oIt = labelObjects.begin();
+       oIt != labelObjects.end(); ++oIt )
+    {
+    if( ( *oIt )->GetLabel() > 0 )
+      {
+      continue;
+      }
+
+    for( SizeValueType l = 0; l < ( *oIt )->GetNumberOfLines(); l++ )
+      {
+      const LineType & line = ( *oIt )->GetLine( l );
+
+      IndexType index = line.GetIndex();
+      index[0] = regionBegin;
+      if( !region.IsInside( index ) )
+        {
+        continue;
+        }
+
+      const OffsetValueType begin = std::max( line.GetIndex()[0], regionBegin );
+      const OffsetValueType end = std::min(
+        line.GetIndex()[0] + static_cast< OffsetValueType >( line.GetLength() ), regionEnd );
+
+      for( index[0] = begin; index[0] < end; index[0]++ )
+        {
+        oFrame->SetPixel( index, this->m_InsideValue );
+        }
+      }
+    }
+}
+
+template< class TInputVideoStream, class TOutputVideoStream, class TLevelSet >
+void
+VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >
+::TemporalStreamingGenerateData()
+{
+  this->AllocateOutputs();
+
+  const InputVideoStreamType* input = this->GetInput();
+  OutputVideoStreamType* output = this->GetOutput();
+
+  // one input frame gives one output frame
+  const SizeValueType inputStart = input->GetRequestedTemporalRegion().GetFrameStart();
+  const SizeValueType outputStart = output->GetRequestedTemporalRegion().GetFrameStart();
+
+  const InputFrameType* frame = input->GetFrame( inputStart );
+
+  unsigned int numberOfIterations;
+
+  if( this->m_LevelSet.IsNotNull() && this->m_HasPreviousFrame &&
+      ( inputStart == this->m_PreviousFrame + 1 ) )
+    {
+    // The displacement of the centroid includes the shift applied to the
+    // previous frame: it replaces MotionShift rather than adding to it.
+    OffsetType shift = this->m_MotionShift;
+    if( this->m_PredictMotion && this->m_HasPredictedShift )
+      {
+      shift = this->m_PredictedShift;
+      }
+
+    bool moved = false;
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      moved = moved || ( shift[dim] != 0 );
+      }
+
+    // Without motion, the converged layers are evolved as they are.
+    if( moved )
+      {
+      this->m_LevelSet = this->ShiftLevelSet( frame, this->m_LevelSet, shift );
+      }
+    numberOfIterations = this->m_NumberOfIterations;
+    }
+  else
+    {
+    this->m_LevelSet = this->SeedLevelSet( frame );
+    this->m_HasPreviousCentroid = false;
+    this->m_HasPredictedShift = false;
+    this->m_PredictedShift.Fill( 0 );
+    numberOfIterations = this->m_NumberOfInitialIterations;
+    }
+
+  this->UpdateDomainMap( frame->GetLargestPossibleRegion() );
+  this->m_NumberOfIterationsPerFrame[inputStart] =
+    this->EvolveFrame( frame, this->m_LevelSet, numberOfIterations );
+
+  this->m_HasPreviousFrame = true;
+  this->m_PreviousFrame = inputStart;
+
+  if( this->m_PredictMotion )
+    {
+    std::vector< double > centroid;
+    if( this->ComputeCentroid( this->m_LevelSet, centroid ) )
+      {
+      if( this->m_HasPreviousCentroid )
+        {
+        for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+          {
+          this->m_PredictedShift[dim] =
+            Math::Round< OffsetValueType >( centroid[dim] - this->m_PreviousCentroid[dim] );
+          }
+        this->m_HasPredictedShift = true;
+        }
+      this->m_PreviousCentroid = centroid;
+      this->m_HasPreviousCentroid = true;
+      }
+    }
+
+  this->RasterizeInterior( this->m_LevelSet, output->GetFrame( outputStart ) );
+}
+
+template< class TInputVideoStream, class TOutputVideoStream, class TLevelSet >
+void
+VideoLevelSetTrackingFilter< TInputVideoStream, TOutputVideoStream, TLevelSet >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfSeedRegions: " << this->m_SeedRegions.size() << std::endl;
+  os << indent << "NumberOfInitialIterations: " << this->m_NumberOfInitialIterations << std::endl;
+  os << indent << "NumberOfIterations: " << this->m_NumberOfIterations << std::endl;
+  os << indent << "RMSChangeThreshold: " << this->m_RMSChangeThreshold << std::endl;
+  os << indent << "NumberOfConsecutiveIterations: " << this->m_NumberOfConsecutiveIterations << std::endl;
+  os << indent << "MotionShift: " << this->m_MotionShift << std::endl;
+  os << indent << "PredictMotion: " << this->m_PredictMotion << std::endl;
+  os << indent << "InsideValue: "
+     << static_cast< typename NumericTraits< OutputPixelType >::PrintType >( this->m_InsideValue ) << std::endl;
+  os << indent << "NumberOfFramesProcessed: " << this->m_NumberOfIterationsPerFrame.size() << std::endl;
+  os << indent << "NumberOfDomainMapBuilds: " << this->m_NumberOfDomainMapBuilds << std::endl;
+}
+
+}
+#endif // __itkVideoLevelSetTrackingFilter_hxx
@@ -21,13 +21,19 @@
 #include "itkCastImageFilter.h"
 #include "itkImageMomentsCalculator.h"
 
-#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkCachedMeanSquaresImageToImageMetricv4.h"
 #include "itkEuler2DTransform.h"
 #include "itkCompositeTransform.h"
 #include "itkGradientDescentOptimizerv4.h"
 #include "itkImageRegistrationMethodv4.h"
 #include "itkRegistrationParameterScalesFromPhysicalShift.h"
 
+#include "RegistrationLevels.h"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
 template<class TOptimizer>
 class CommandIterationUpdate : public itk::Command
 {
@@ -66,11 +72,95 @@ public:
     }
 };
 
+// Set the number of iterations of the optimizer at the beginning of each
+// level of the registration.
+template<class TRegistration, class TOptimizer>
+class CommandLevelUpdate : public itk::Command
+{
+public:
+  typedef CommandLevelUpdate       Self;
+  typedef itk::Command             Superclass;
+  typedef itk::SmartPointer<Self>  Pointer;
+  itkNewMacro( Self );
+protected:
+  CommandLevelUpdate() {};
+
+public:
+  void SetOptimizer( TOptimizer * optimizer )
+    {
+    m_Optimizer = optimizer;
+    }
+
+  void SetIterationsPerLevel( const std::vector< unsigned int > & iterations )
+    {
+    m_IterationsPerLevel = iterations;
+    }
+
+  void Execute(itk::Object *caller, const itk::EventObject & event)
+    {
+    TRegistration * registration =
+      dynamic_cast< TRegistration * >( caller );
+
+    if( typeid( event ) != typeid( itk::MultiResolutionIterationEvent ) )
+      {
+      return;
+      }
+
+    const unsigned int level = registration->GetCurrentLevel();
+    m_Optimizer->SetNumberOfIterations( m_IterationsPerLevel[level] );
+
+    std::cout << "Level " << level << ": "
+              << m_IterationsPerLevel[level] << " iterations" << std::endl;
+    }
+
+  void Execute(const itk::Object * object, const itk::EventObject & event)
+    {
+    itkExceptionMacro( "Should not be here." );
+    }
+
+private:
+  typename TOptimizer::Pointer     m_Optimizer;
+  std::vector< unsigned int >      m_IterationsPerLevel;
+};
+
 int main( int argc, char *argv[] )
 {
   if( argc < 5 )
     {
-    std::cerr << argv[0] << " fixedImage movingImage outputImage numberIterations " << std::endl;
+    std::cerr << argv[0] << " fixedImage movingImage outputImage numberIterations "
+              << "[shrinkFactorsPerLevel] [smoothingSigmasPerLevel]" << std::endl;
+    std::cerr << "The lists of levels are separated by 'x', from the coarsest level, "
+              << "e.g. 4x2x1 and 2x1x0; numberIterations is a single value or a list." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Shrink factors, smoothing sigmas and iterations of each level of the
+  // pyramid. By default the registration runs at full resolution only.
+  std::vector< unsigned int > shrinkFactors( 1, 1 );
+  if( argc > 5 )
+    {
+    shrinkFactors = ParseList< unsigned int >( argv[5] );
+    }
+
+  const unsigned int numberOfLevels = shrinkFactors.size();
+
+  std::vector< double > smoothingSigmas( numberOfLevels, 0.0 );
+  if( argc > 6 )
+    {
+    smoothingSigmas = ParseList< double >( argv[6] );
+    }
+
+  std::vector< unsigned int > iterations = ParseList< unsigned int >( argv[4] );
+  if( iterations.size() == 1 )
+    {
+    iterations.resize( numberOfLevels, iterations[0] );
+    }
+
+  if( !CheckLevels( shrinkFactors, smoothingSigmas, iterations ) )
+    {
+    std::cerr << "Invalid levels: give one shrink factor, smoothing sigma "
+              << "and number of iterations per level, with positive shrink factors "
+              << "and finite, non negative sigmas" << std::endl;
     return EXIT_FAILURE;
     }
 
@@ -135,18 +225,26 @@ int main( int argc, char *argv[] )
 
 
   // The metric is the objective function for the optimization problem.
-  typedef itk::MeanSquaresImageToImageMetricv4< FixedImageType, MovingImageType >     MetricType;
+  // The sampled fixed points and their fixed values are cached at the
+  // beginning of each level instead of being recomputed at every
+  // iteration.
+  typedef itk::CachedMeanSquaresImageToImageMetricv4< FixedImageType, MovingImageType >     MetricType;
   MetricType::Pointer metric = MetricType::New();
   // Improve metric smoothness.
   const bool gaussianSmooth = false;
   metric->SetUseMovingImageGradientFilter( gaussianSmooth );
   metric->SetUseFixedImageGradientFilter( gaussianSmooth );
+  // Compute the moving gradient once per level, interleaved with the
+  // intensity, instead of by central differences at every sample and
+  // iteration. The interleaved gradient is not smoothed: with
+  // gaussianSmooth, the gradient filters are used instead.
+  metric->SetUseInterleavedMovingImage( !gaussianSmooth );
 
   // The optimizer adjusts the parameters of the transform to improve the
   // metric.
   typedef itk::GradientDescentOptimizerv4 OptimizerType;
   OptimizerType::Pointer optimizer = OptimizerType::New();
-  optimizer->SetNumberOfIterations( atoi( argv[4] ) );
+  optimizer->SetNumberOfIterations( iterations[0] );
   optimizer->SetDoEstimateLearningRateOnce( true );
   optimizer->SetMinimumConvergenceValue( 1e-16 );
   optimizer->SetConvergenceWindowSize( 20 );
@@ -177,7 +275,30 @@ int main( int argc, char *argv[] )
   registrationMethod->SetMovingImage( movingImage );
   registrationMethod->SetFixedInitialTransform( initialFixedTransform );
   registrationMethod->SetMovingInitialTransform( initialMovingTransform );
-  registrationMethod->SetNumberOfLevels( 1 );
+
+  // The images are smoothed and shrunk at each level, and the transform
+  // found at a level is the initial transform of the next one. Most
+  // iterations thus run on small images, and the smoothing of the coarse
+  // levels widens the capture range.
+  RegistrationMethodType::ShrinkFactorsArrayType shrinkFactorsPerLevel;
+  shrinkFactorsPerLevel.SetSize( numberOfLevels );
+  RegistrationMethodType::SmoothingSigmasArrayType smoothingSigmasPerLevel;
+  smoothingSigmasPerLevel.SetSize( numberOfLevels );
+  for( unsigned int level = 0; level < numberOfLevels; ++level )
+    {
+    shrinkFactorsPerLevel[level] = shrinkFactors[level];
+    smoothingSigmasPerLevel[level] = smoothingSigmas[level];
+    }
+  registrationMethod->SetNumberOfLevels( numberOfLevels );
+  registrationMethod->SetShrinkFactorsPerLevel( shrinkFactorsPerLevel );
+  registrationMethod->SetSmoothingSigmasPerLevel( smoothingSigmasPerLevel );
+
+  typedef CommandLevelUpdate< RegistrationMethodType, OptimizerType > LevelCommandType;
+  LevelCommandType::Pointer levelObserver = LevelCommandType::New();
+  levelObserver->SetOptimizer( optimizer );
+  levelObserver->SetIterationsPerLevel( iterations );
+  registrationMethod->AddObserver( itk::MultiResolutionIterationEvent(), levelObserver );
+
   registrationMethod->SetMetric( metric );
   registrationMethod->SetMetricSamplingStrategy( RegistrationMethodType::REGULAR );
   registrationMethod->SetMetricSamplingPercentage( 0.1 );
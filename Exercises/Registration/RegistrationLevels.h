@@ -0,0 +1,112 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#ifndef __RegistrationLevels_h
+#define __RegistrationLevels_h
+
+// Parsing and checking of the levels of the multi-resolution pyramid given
+// on the command line of the registration exercises.
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Parse a value of a list: the whole text must be the value.
+inline bool ParseValue( const std::string & text, unsigned int & value )
+{
+  // strtoul accepts a sign and leading spaces, which are not valid here
+  if( text.empty() || !isdigit( static_cast< unsigned char >( text[0] ) ) )
+    {
+    return false;
+    }
+  char * end;
+  errno = 0;
+  const unsigned long parsed = strtoul( text.c_str(), &end, 10 );
+  if( ( *end != '\0' ) || ( errno == ERANGE ) || ( parsed > UINT_MAX ) )
+    {
+    return false;
+    }
+  value = static_cast< unsigned int >( parsed );
+  return true;
+}
+
+// strtod also reads "nan" and "inf", which are not valid values.
+inline bool ParseValue( const std::string & text, double & value )
+{
+  char * end;
+  errno = 0;
+  value = strtod( text.c_str(), &end );
+  return ( end != text.c_str() ) && ( *end == '\0' ) && ( errno != ERANGE ) &&
+         ( std::fabs( value ) <= DBL_MAX );
+}
+
+// Parse a list of values separated by 'x', e.g. "4x2x1". The list is
+// empty if any of the values is not valid.
+template< class TValue >
+std::vector< TValue > ParseList( const char * text )
+{
+  std::vector< TValue > values;
+  const std::string list( text );
+  std::string::size_type begin = 0;
+  while( true )
+    {
+    const std::string::size_type end = list.find( 'x', begin );
+    TValue value;
+    if( !ParseValue( list.substr( begin, end - begin ), value ) )
+      {
+      return std::vector< TValue >();
+      }
+    values.push_back( value );
+    if( end == std::string::npos )
+      {
+      return values;
+      }
+    begin = end + 1;
+    }
+}
+
+// Each level needs a shrink factor, a smoothing sigma and a number of
+// iterations; the shrink factors must be positive, the sigmas non negative.
+inline bool CheckLevels( const std::vector< unsigned int > & shrinkFactors,
+                         const std::vector< double > & smoothingSigmas,
+                         const std::vector< unsigned int > & iterations )
+{
+  const size_t numberOfLevels = shrinkFactors.size();
+  if( ( numberOfLevels == 0 ) ||
+      ( smoothingSigmas.size() != numberOfLevels ) ||
+      ( iterations.size() != numberOfLevels ) )
+    {
+    return false;
+    }
+  for( size_t level = 0; level < numberOfLevels; level++ )
+    {
+    if( ( shrinkFactors[level] == 0 ) || !( smoothingSigmas[level] >= 0.0 ) )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+#endif // __RegistrationLevels_h
@@ -27,6 +27,15 @@
 #include "itkResampleImageFilter.h"
 #include "itkSubtractImageFilter.h"
 #include "itkRescaleIntensityImageFilter.h"
+#include "itkCastImageFilter.h"
+#include "itkSmoothingRecursiveGaussianImageFilter.h"
+#include "itkShrinkImageFilter.h"
+
+#include "RegistrationLevels.h"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
 
 
 #include "itkCommand.h"
@@ -62,6 +71,41 @@ public:
     }
 };
 
+// Image of a level of the pyramid: the input smoothed by a Gaussian of
+// the given sigma, in physical units, then shrunk by the given factor.
+template< class TInputImage, class TOutputImage >
+typename TOutputImage::Pointer
+ComputeLevelImage( const TInputImage * image, unsigned int shrinkFactor, double sigma )
+{
+  typedef itk::CastImageFilter< TInputImage, TOutputImage > CastFilterType;
+  typename CastFilterType::Pointer caster = CastFilterType::New();
+  caster->SetInput( image );
+
+  typedef itk::SmoothingRecursiveGaussianImageFilter<
+                                    TOutputImage,
+                                    TOutputImage >   SmoothingFilterType;
+  typename SmoothingFilterType::Pointer smoother = SmoothingFilterType::New();
+  smoother->SetInput( caster->GetOutput() );
+  smoother->SetSigma( sigma );
+
+  typedef itk::ShrinkImageFilter< TOutputImage, TOutputImage > ShrinkFilterType;
+  typename ShrinkFilterType::Pointer shrinker = ShrinkFilterType::New();
+  if( sigma > 0.0 )
+    {
+    shrinker->SetInput( smoother->GetOutput() );
+    }
+  else
+    {
+    shrinker->SetInput( caster->GetOutput() );
+    }
+  shrinker->SetShrinkFactors( shrinkFactor );
+  shrinker->Update();
+
+  typename TOutputImage::Pointer levelImage = shrinker->GetOutput();
+  levelImage->DisconnectPipeline();
+  return levelImage;
+}
+
 int main( int argc, char *argv[] )
 {
   if( argc < 4 )
@@ -71,7 +115,10 @@ int main( int argc, char *argv[] )
     std::cerr << " fixedImageFile  movingImageFile ";
     std::cerr << " outputImagefile  [differenceAfterRegistration] ";
     std::cerr << " [differenceBeforeRegistration] ";
-    std::cerr << " [initialStepLength] "<< std::endl;
+    std::cerr << " [initialStepLength] ";
+    std::cerr << " [shrinkFactorsPerLevel, e.g. 4x2x1 (default: 1)] ";
+    std::cerr << " [smoothingSigmasPerLevel, e.g. 2x1x0 (default: 0)] ";
+    std::cerr << " [iterationsPerLevel, e.g. 200x100x50 (default: 200)] "<< std::endl;
     return EXIT_FAILURE;
     }
 
@@ -81,21 +128,24 @@ int main( int argc, char *argv[] )
   typedef itk::Image< PixelType, Dimension >  FixedImageType;
   typedef itk::Image< PixelType, Dimension >  MovingImageType;
 
+  // The levels of the pyramid are smoothed, hence real, images.
+  typedef itk::Image< float, Dimension >      InternalImageType;
+
   typedef itk::Rigid2DTransform< double > TransformType;
 
   typedef itk::RegularStepGradientDescentOptimizer       OptimizerType;
 
   typedef itk::MeanSquaresImageToImageMetric<
-                                    FixedImageType,
-                                    MovingImageType >    MetricType;
+                                    InternalImageType,
+                                    InternalImageType >  MetricType;
 
   typedef itk:: LinearInterpolateImageFunction<
-                                    MovingImageType,
+                                    InternalImageType,
                                     double          >    InterpolatorType;
 
   typedef itk::ImageRegistrationMethod<
-                                    FixedImageType,
-                                    MovingImageType >    RegistrationType;
+                                    InternalImageType,
+                                    InternalImageType >  RegistrationType;
 
   MetricType::Pointer         metric        = MetricType::New();
   OptimizerType::Pointer      optimizer     = OptimizerType::New();
@@ -118,14 +168,9 @@ int main( int argc, char *argv[] )
   fixedImageReader->SetFileName(  argv[1] );
   movingImageReader->SetFileName( argv[2] );
 
-  registration->SetFixedImage(    fixedImageReader->GetOutput()    );
-  registration->SetMovingImage(   movingImageReader->GetOutput()   );
-
   fixedImageReader->Update();
   movingImageReader->Update();
 
-  registration->SetFixedImageRegion( fixedImageReader->GetOutput()->GetBufferedRegion() );
-
   typedef FixedImageType::SpacingType    SpacingType;
   typedef FixedImageType::PointType      OriginType;
   typedef FixedImageType::RegionType     RegionType;
@@ -161,8 +206,6 @@ int main( int argc, char *argv[] )
 
   transform->SetAngle( 0.0 );
 
-  registration->SetInitialTransformParameters( transform->GetParameters() );
-
 
 
   typedef OptimizerType::ScalesType       OptimizerScalesType;
@@ -183,10 +226,41 @@ int main( int argc, char *argv[] )
     initialStepLength = atof( argv[6] );
     }
 
+  // Shrink factors, smoothing sigmas and iterations of each level of the
+  // pyramid, from the coarsest to the finest.
+  std::vector< unsigned int > shrinkFactors( 1, 1 );
+  if( argc > 7 )
+    {
+    shrinkFactors = ParseList< unsigned int >( argv[7] );
+    }
+
+  const unsigned int numberOfLevels = shrinkFactors.size();
+
+  std::vector< double > smoothingSigmas( numberOfLevels, 0.0 );
+  if( argc > 8 )
+    {
+    smoothingSigmas = ParseList< double >( argv[8] );
+    }
+
+  std::vector< unsigned int > iterations( numberOfLevels, 200 );
+  if( argc > 9 )
+    {
+    iterations = ParseList< unsigned int >( argv[9] );
+    if( iterations.size() == 1 )
+      {
+      iterations.resize( numberOfLevels, iterations[0] );
+      }
+    }
+
+  if( !CheckLevels( shrinkFactors, smoothingSigmas, iterations ) )
+    {
+    std::cerr << "Invalid levels: give one shrink factor, smoothing sigma "
+              << "and number of iterations per level, with positive shrink factors "
+              << "and finite, non negative sigmas" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   optimizer->SetRelaxationFactor( 0.9 );
-  optimizer->SetMaximumStepLength( initialStepLength );
-  optimizer->SetMinimumStepLength( 0.0001 );
-  optimizer->SetNumberOfIterations( 200 );
 
 
   // Create the Command observer and register it with the optimizer.
@@ -194,29 +268,62 @@ int main( int argc, char *argv[] )
   CommandIterationUpdate::Pointer observer = CommandIterationUpdate::New();
   optimizer->AddObserver( itk::IterationEvent(), observer );
 
-  try
-    {
-    registration->Update();
-    std::cout << "Optimizer stop condition: "
-              << registration->GetOptimizer()->GetStopConditionDescription()
-              << std::endl;
-    }
-  catch( itk::ExceptionObject & err )
+  // Register the levels of the pyramid from the coarsest to the finest,
+  // each one starting from the transform found at the previous level.
+  // Most iterations thus run on small images, and the smoothing of the
+  // coarse levels widens the capture range. The pixels of a level are
+  // shrinkFactor times larger than the input pixels: the step lengths are
+  // scaled accordingly.
+  OptimizerType::ParametersType finalParameters = transform->GetParameters();
+  unsigned int numberOfIterations = 0;
+
+  for( unsigned int level = 0; level < numberOfLevels; ++level )
     {
-    std::cerr << "ExceptionObject caught !" << std::endl;
-    std::cerr << err << std::endl;
-    return EXIT_FAILURE;
-    }
+    InternalImageType::Pointer fixedLevelImage =
+      ComputeLevelImage< FixedImageType, InternalImageType >(
+        fixedImage, shrinkFactors[level], smoothingSigmas[level] );
+    InternalImageType::Pointer movingLevelImage =
+      ComputeLevelImage< MovingImageType, InternalImageType >(
+        movingImage, shrinkFactors[level], smoothingSigmas[level] );
+
+    registration->SetFixedImage(  fixedLevelImage  );
+    registration->SetMovingImage( movingLevelImage );
+    registration->SetFixedImageRegion( fixedLevelImage->GetBufferedRegion() );
+    registration->SetInitialTransformParameters( finalParameters );
+
+    const double levelScale =
+      static_cast< double >( shrinkFactors[level] ) / shrinkFactors[0];
+
+    optimizer->SetMaximumStepLength( initialStepLength * levelScale );
+    optimizer->SetMinimumStepLength( 0.0001 * shrinkFactors[level] );
+    optimizer->SetNumberOfIterations( iterations[level] );
+
+    std::cout << "Level " << level << ": shrink factor " << shrinkFactors[level]
+              << ", smoothing sigma " << smoothingSigmas[level]
+              << ", size " << fixedLevelImage->GetBufferedRegion().GetSize() << std::endl;
+
+    try
+      {
+      registration->Update();
+      std::cout << "Optimizer stop condition: "
+                << registration->GetOptimizer()->GetStopConditionDescription()
+                << std::endl;
+      }
+    catch( itk::ExceptionObject & err )
+      {
+      std::cerr << "ExceptionObject caught !" << std::endl;
+      std::cerr << err << std::endl;
+      return EXIT_FAILURE;
+      }
 
-  OptimizerType::ParametersType finalParameters =
-                    registration->GetLastTransformParameters();
+    finalParameters = registration->GetLastTransformParameters();
+    numberOfIterations += optimizer->GetCurrentIteration();
+    }
 
   const double finalAngle           = finalParameters[0];
   const double finalTranslationX    = finalParameters[1];
   const double finalTranslationY    = finalParameters[2];
 
-  const unsigned int numberOfIterations = optimizer->GetCurrentIteration();
-
   const double bestValue = optimizer->GetValue();
 
 
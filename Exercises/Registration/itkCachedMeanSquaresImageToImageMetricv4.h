@@ -0,0 +1,233 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkCachedMeanSquaresImageToImageMetricv4_h
+#define __itkCachedMeanSquaresImageToImageMetricv4_h
+
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkMatrixOffsetTransformBase.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
+
+namespace itk
+{
+/**
+ *  \class CachedMeanSquaresImageToImageMetricv4
+ *  \brief Mean squares metric evaluated on samples cached once per level.
+ *
+ *  The samples of the metric, i.e. the virtual sampled point set or every
+ *  pixel of the virtual domain, their fixed values and, when the gradient
+ *  source includes the fixed image, their fixed gradients only depend on
+ *  the fixed image and transform, which do not change during an
+ *  optimization. They are computed once by Initialize(), which the
+ *  registration method calls at the beginning of each level, and stored
+ *  as a structure of arrays: one contiguous array per coordinate of the
+ *  points, one for the fixed values and one per component of the fixed
+ *  gradients. Samples out of the fixed image or mask are dropped.
+ *
+ *  At each iteration, the threads stream contiguous ranges of the arrays;
+ *  there are at most MaximumNumberOfThreads of them.
+ *  When the moving transform is a matrix and an offset, or a composite of
+ *  such transforms, it is reduced to a single matrix and offset, and the
+ *  samples are mapped by blocks in a loop the compiler can vectorize.
+ *  The moving values and gradients are then interpolated as by
+ *  MeanSquaresImageToImageMetricv4.
+ *
+ *  The gradients are taken in the moving image when the gradient source
+ *  includes it, as by the superclass, and otherwise are the cached fixed
+ *  gradients mapped by the moving transform, an approximation valid close
+ *  to alignment.
+ *
+ *  With UseInterleavedMovingImage, Initialize() also computes the gradient
+ *  of the moving image once, by GradientImageFilter, and interleaves it
+ *  with the intensity in a float buffer: the D + 1 values of a pixel are
+ *  contiguous. The value and the gradient of a sample are then fetched
+ *  together, by a single linear interpolation of the D + 1 channels
+ *  which reads each of the 2^D neighbors once, instead of an interpolation
+ *  of the value and central differences around the sample. This mode is
+ *  only used when the moving interpolator is a LinearInterpolateImageFunction
+ *  and UseMovingImageGradientFilter is off; otherwise the samples are
+ *  evaluated with the interpolator and the gradient of the superclass.
+ *
+ *  Transforms with local support, e.g. displacement fields, are evaluated
+ *  by the superclass, as is any metric with UseSampleCache off.
+ *
+ *  \tparam TFixedImage Fixed image type
+ *  \tparam TMovingImage Moving image type, of the dimension of the fixed
+ *  image
+ *  \tparam TVirtualImage Virtual image type
+ *
+ *  \ingroup ITKRegistrationMethodsv4
+ */
+template< class TFixedImage, class TMovingImage, class TVirtualImage = TFixedImage >
+class CachedMeanSquaresImageToImageMetricv4 :
+  public MeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+{
+public:
+  typedef CachedMeanSquaresImageToImageMetricv4   Self;
+  typedef MeanSquaresImageToImageMetricv4<
+    TFixedImage, TMovingImage, TVirtualImage >    Superclass;
+  typedef SmartPointer< Self >                    Pointer;
+  typedef SmartPointer< const Self >              ConstPointer;
+
+  /** Method for creation through object factory */
+  itkNewMacro( Self );
+
+  /** Run-time type information */
+  itkTypeMacro( CachedMeanSquaresImageToImageMetricv4, MeanSquaresImageToImageMetricv4 );
+
+  typedef typename Superclass::MeasureType                    MeasureType;
+  typedef typename Superclass::DerivativeType                 DerivativeType;
+  typedef typename Superclass::InternalComputationValueType   InternalComputationValueType;
+  typedef typename Superclass::NumberOfParametersType         NumberOfParametersType;
+  typedef typename Superclass::VirtualPointType               VirtualPointType;
+  typedef typename Superclass::VirtualIndexType               VirtualIndexType;
+  typedef typename Superclass::VirtualRegionType              VirtualRegionType;
+  typedef typename Superclass::VirtualImageType               VirtualImageType;
+  typedef typename Superclass::VirtualPointSetType            VirtualPointSetType;
+  typedef typename Superclass::FixedImagePointType            FixedImagePointType;
+  typedef typename Superclass::FixedImagePixelType            FixedImagePixelType;
+  typedef typename Superclass::FixedImageGradientType         FixedImageGradientType;
+  typedef typename Superclass::MovingImagePointType           MovingImagePointType;
+  typedef typename Superclass::MovingImageGradientType        MovingImageGradientType;
+  typedef typename Superclass::MovingTransformType            MovingTransformType;
+  typedef typename Superclass::JacobianType                   JacobianType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, Superclass::VirtualImageDimension );
+
+  typedef MatrixOffsetTransformBase< InternalComputationValueType,
+    ImageDimension, ImageDimension >                          LinearTransformType;
+  typedef typename LinearTransformType::MatrixType            LinearMatrixType;
+  typedef typename LinearTransformType::OutputVectorType      LinearOffsetType;
+
+  /** One contiguous array per cached quantity */
+  typedef std::vector< InternalComputationValueType >         CacheArrayType;
+
+  /** Moving values and gradients, interleaved */
+  typedef float                                               InterleavedValueType;
+  typedef std::vector< InterleavedValueType >                 InterleavedArrayType;
+  typedef typename Superclass::MovingImageType                MovingImageType;
+  typedef typename MovingImageType::IndexType                 MovingIndexType;
+  typedef typename MovingImageType::DirectionType             MovingDirectionType;
+
+  itkStaticConstMacro( NumberOfChannels, unsigned int, ImageDimension + 1 );
+
+  /** Evaluate the metric on the cached samples. Default is on. */
+  itkSetMacro( UseSampleCache, bool );
+  itkGetConstMacro( UseSampleCache, bool );
+  itkBooleanMacro( UseSampleCache );
+
+  /** Fetch the moving values and gradients from a buffer where they are
+   * interleaved, computed once per level. Only used with the sample cache,
+   * a linear moving interpolator and no moving gradient filter. Default is
+   * off. */
+  itkSetMacro( UseInterleavedMovingImage, bool );
+  itkGetConstMacro( UseInterleavedMovingImage, bool );
+  itkBooleanMacro( UseInterleavedMovingImage );
+
+  /** Initialize the superclass, then cache the samples */
+  virtual void Initialize( void ) throw ( ExceptionObject );
+
+  virtual MeasureType GetValue() const;
+
+  virtual void GetValueAndDerivative( MeasureType & value, DerivativeType & derivative ) const;
+
+  /** Number of samples cached by the last Initialize() */
+  SizeValueType GetNumberOfCachedSamples() const
+    {
+    return static_cast< SizeValueType >( this->m_SampleFixedValues.size() );
+    }
+
+protected:
+  CachedMeanSquaresImageToImageMetricv4();
+  virtual ~CachedMeanSquaresImageToImageMetricv4() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Fill the arrays of the cache */
+  void CacheSamples();
+  void CacheSample( const VirtualPointType & iVirtualPoint );
+
+  /** Fill the interleaved buffer of the moving image */
+  void CacheMovingImage();
+
+  /** Value followed by the gradient of the moving image at a continuous
+   * index, relative to the start of the buffer; false if out of it */
+  bool InterpolateMovingImage( const InternalComputationValueType iContinuousIndex[],
+                               InterleavedValueType oValues[] ) const;
+
+  /** True if the cache may be used with the current moving transform */
+  bool CanUseSampleCache() const;
+
+  /** Moving transform as a single matrix and offset, when it is one */
+  bool GetLinearMovingTransform( LinearMatrixType & oMatrix, LinearOffsetType & oOffset ) const;
+
+  /** Mean of the squared differences, and its derivative if
+   * iComputeDerivative, over the cached samples */
+  MeasureType EvaluateSampleCache( bool iComputeDerivative, DerivativeType & oDerivative ) const;
+
+  /** Partial sums of a thread */
+  struct EvaluationThreadStruct
+  {
+    const Self*                     Metric;
+    bool                            ComputeDerivative;
+    bool                            IsLinear;
+    LinearMatrixType                Matrix;
+    LinearOffsetType                Offset;
+    std::vector< MeasureType >      Sums;
+    std::vector< SizeValueType >    Counts;
+    std::vector< DerivativeType >   Derivatives;
+  };
+
+  static ITK_THREAD_RETURN_TYPE EvaluationThreadCallback( void* arg );
+
+  /** Accumulate the samples [iBegin, iEnd) */
+  void EvaluateSamples( const EvaluationThreadStruct & iStruct,
+                        SizeValueType iBegin, SizeValueType iEnd,
+                        MeasureType & ioSum, SizeValueType & ioCount,
+                        DerivativeType & ioDerivative ) const;
+
+  /** Samples mapped at once from the cache */
+  itkStaticConstMacro( BlockSize, unsigned int, 64 );
+
+private:
+  CachedMeanSquaresImageToImageMetricv4( const Self& ); // purposely not implemented
+  void operator = ( const Self& ); // purposely not implemented
+
+  bool                    m_UseSampleCache;
+  bool                    m_UseInterleavedMovingImage;
+
+  CacheArrayType          m_SamplePoints[ImageDimension];
+  CacheArrayType          m_SampleFixedValues;
+  CacheArrayType          m_SampleFixedGradients[ImageDimension];
+
+  InterleavedArrayType    m_InterleavedMovingImage;
+  SizeValueType           m_InterleavedSize[ImageDimension];
+  OffsetValueType         m_InterleavedStrides[ImageDimension];
+  MovingIndexType         m_InterleavedStart;
+  MovingImagePointType    m_InterleavedOrigin;
+  MovingDirectionType     m_PhysicalPointToIndex;
+};
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkCachedMeanSquaresImageToImageMetricv4.hxx"
+#endif
+
+#endif // __itkCachedMeanSquaresImageToImageMetricv4_h
@@ -0,0 +1,658 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __itkCachedMeanSquaresImageToImageMetricv4_hxx
+#define __itkCachedMeanSquaresImageToImageMetricv4_hxx
+
+#include "itkCachedMeanSquaresImageToImageMetricv4.h"
+
+#include "itkCompositeTransform.h"
+#include "itkGradientImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkLinearInterpolateImageFunction.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::CachedMeanSquaresImageToImageMetricv4() :
+  m_UseSampleCache( true ),
+  m_UseInterleavedMovingImage( false )
+{
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+void
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::Initialize( void ) throw ( ExceptionObject )
+{
+  Superclass::Initialize();
+  this->CacheSamples();
+  this->CacheMovingImage();
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+void
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::CacheSamples()
+{
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    this->m_SamplePoints[dim].clear();
+    this->m_SampleFixedGradients[dim].clear();
+    }
+  this->m_SampleFixedValues.clear();
+
+  if( !this->m_UseSampleCache )
+    {
+    return;
+    }
+
+  if( this->m_UseFixedSampledPointSet )
+    {
+    // the sampled points, already mapped to the virtual domain
+    typedef typename VirtualPointSetType::PointsContainer PointsContainerType;
+    const PointsContainerType* points = this->m_VirtualSampledPointSet->GetPoints();
+
+    const SizeValueType numberOfPoints = points->Size();
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      this->m_SamplePoints[dim].reserve( numberOfPoints );
+      }
+    this->m_SampleFixedValues.reserve( numberOfPoints );
+
+    for( typename PointsContainerType::ConstIterator pIt = points->Begin();
+         pIt != points->End(); ++pIt )
+      {
+      this->CacheSample( pIt.Value() );
+      }
+    }
+  else
+    {
+    // every pixel of the virtual domain
+    const VirtualRegionType region = this->GetVirtualRegion();
+
+    const SizeValueType numberOfPixels = region.GetNumberOfPixels();
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      this->m_SamplePoints[dim].reserve( numberOfPixels );
+      }
+    this->m_SampleFixedValues.reserve( numberOfPixels );
+
+    typedef ImageRegionConstIteratorWithIndex< VirtualImageType > VirtualIteratorType;
+    VirtualIteratorType it( this->GetVirtualImage(), region );
+
+    VirtualPointType virtualPoint;
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      this->TransformVirtualIndexToPhysicalPoint( it.GetIndex(), virtualPoint );
+      this->CacheSample( virtualPoint );
+      }
+    }
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+void
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::CacheSample( const VirtualPointType & iVirtualPoint )
+{
+  FixedImagePointType mappedFixedPoint;
+  FixedImagePixelType fixedValue;
+
+  // out of the fixed image or mask
+  if( !this->TransformAndEvaluateFixedPoint( iVirtualPoint, mappedFixedPoint, fixedValue ) )
+    {
+    return;
+    }
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    this->m_SamplePoints[dim].push_back( iVirtualPoint[dim] );
+    }
+  this->m_SampleFixedValues.push_back( static_cast< InternalComputationValueType >( fixedValue ) );
+
+  if( this->GetGradientSourceIncludesFixed() )
+    {
+    FixedImageGradientType fixedGradient;
+    this->ComputeFixedImageGradientAtPoint( mappedFixedPoint, fixedGradient );
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      this->m_SampleFixedGradients[dim].push_back( fixedGradient[dim] );
+      }
+    }
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+void
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::CacheMovingImage()
+{
+  this->m_InterleavedMovingImage.clear();
+
+  if( !this->m_UseSampleCache || !this->m_UseInterleavedMovingImage )
+    {
+    return;
+    }
+
+  // The buffer is interpolated linearly, and holds the unsmoothed
+  // gradient: with another interpolator or with the moving gradient
+  // filter, the samples are evaluated one by one, as by the superclass.
+  typedef LinearInterpolateImageFunction< MovingImageType,
+    typename Superclass::CoordinateRepresentationType >     LinearInterpolatorType;
+  if( !dynamic_cast< const LinearInterpolatorType* >( this->m_MovingInterpolator.GetPointer() ) ||
+      this->GetUseMovingImageGradientFilter() )
+    {
+    return;
+    }
+
+  // gradient in the physical space, as the one of the superclass
+  typedef GradientImageFilter< MovingImageType,
+    InterleavedValueType, InterleavedValueType >            GradientFilterType;
+  typedef typename GradientFilterType::OutputImageType      GradientImageType;
+
+  typename GradientFilterType::Pointer gradientFilter = GradientFilterType::New();
+  gradientFilter->SetInput( this->m_MovingImage );
+  gradientFilter->SetUseImageDirection( true );
+  gradientFilter->Update();
+
+  const typename MovingImageType::RegionType region = this->m_MovingImage->GetBufferedRegion();
+
+  this->m_InterleavedStart = region.GetIndex();
+  this->m_InterleavedOrigin = this->m_MovingImage->GetOrigin();
+  this->m_PhysicalPointToIndex = this->m_MovingImage->GetPhysicalPointToIndex();
+
+  OffsetValueType stride = 1;
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    this->m_InterleavedSize[dim] = region.GetSize()[dim];
+    this->m_InterleavedStrides[dim] = stride;
+    stride *= static_cast< OffsetValueType >( region.GetSize()[dim] );
+    }
+
+  this->m_InterleavedMovingImage.resize( region.GetNumberOfPixels() * NumberOfChannels );
+
+  typedef ImageRegionConstIterator< MovingImageType >   MovingIteratorType;
+  typedef ImageRegionConstIterator< GradientImageType > GradientIteratorType;
+  MovingIteratorType mIt( this->m_MovingImage, region );
+  GradientIteratorType gIt( gradientFilter->GetOutput(), region );
+
+  InterleavedValueType* out = &( this->m_InterleavedMovingImage[0] );
+  for( mIt.GoToBegin(), gIt.GoToBegin(); !mIt.IsAtEnd(); ++mIt, ++gIt )
+    {
+    *out++ = static_cast< InterleavedValueType >( mIt.Get() );
+
+    const typename GradientImageType::PixelType & gradient = gIt.Get();
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      *out++ = gradient[dim];
+      }
+    }
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+bool
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::InterpolateMovingImage( const InternalComputationValueType iContinuousIndex[],
+                          InterleavedValueType oValues[] ) const
+{
+  IndexValueType base[ImageDimension];
+  InterleavedValueType fraction[ImageDimension];
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    const InternalComputationValueType index = iContinuousIndex[dim];
+
+    // same bounds as the interpolators; also false for NaN
+    if( !( ( index >= -0.5 ) &&
+           ( index < static_cast< InternalComputationValueType >( this->m_InterleavedSize[dim] ) - 0.5 ) ) )
+      {
+      return false;
+      }
+
+    const InternalComputationValueType lower = std::floor( index );
+    base[dim] = static_cast< IndexValueType >( lower );
+    fraction[dim] = static_cast< InterleavedValueType >( index - lower );
+    }
+
+  for( unsigned int c = 0; c < NumberOfChannels; c++ )
+    {
+    oValues[c] = NumericTraits< InterleavedValueType >::Zero;
+    }
+
+  // the channels of a neighbor are contiguous: one read per neighbor
+  for( unsigned int corner = 0; corner < ( 1u << ImageDimension ); corner++ )
+    {
+    InterleavedValueType weight = NumericTraits< InterleavedValueType >::One;
+    OffsetValueType offset = 0;
+
+    for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      IndexValueType index = base[dim];
+      if( corner & ( 1u << dim ) )
+        {
+        ++index;
+        weight *= fraction[dim];
+        }
+      else
+        {
+        weight *= NumericTraits< InterleavedValueType >::One - fraction[dim];
+        }
+      index = std::max( std::min( index,
+        static_cast< IndexValueType >( this->m_InterleavedSize[dim] ) - 1 ), IndexValueType( 0 ) );
+      offset += index * this->m_InterleavedStrides[dim];
+      }
+
+    const InterleavedValueType* neighbor = &( this->m_InterleavedMovingImage[offset * NumberOfChannels] );
+    for( unsigned int c = 0; c < NumberOfChannels; c++ )
+      {
+      oValues[c] += weight * neighbor[c];
+      }
+    }
+
+  return true;
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+bool
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::CanUseSampleCache() const
+{
+  // a transform with local support has a derivative per pixel
+  return this->m_UseSampleCache &&
+    ( this->m_MovingTransform->GetNumberOfLocalParameters() ==
+      this->m_MovingTransform->GetNumberOfParameters() );
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+bool
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::GetLinearMovingTransform( LinearMatrixType & oMatrix, LinearOffsetType & oOffset ) const
+{
+  const MovingTransformType* transform = this->m_MovingTransform.GetPointer();
+
+  const LinearTransformType* linear = dynamic_cast< const LinearTransformType* >( transform );
+  if( linear )
+    {
+    oMatrix = linear->GetMatrix();
+    oOffset = linear->GetOffset();
+    return true;
+    }
+
+  typedef CompositeTransform< InternalComputationValueType, ImageDimension > CompositeTransformType;
+  const CompositeTransformType* composite = dynamic_cast< const CompositeTransformType* >( transform );
+  if( !composite )
+    {
+    return false;
+    }
+
+  // The first transform of the queue is applied last:
+  // T0( T1( x ) ) = M0 M1 x + M0 o1 + o0
+  oMatrix.SetIdentity();
+  oOffset.Fill( NumericTraits< InternalComputationValueType >::Zero );
+
+  for( SizeValueType n = 0; n < composite->GetNumberOfTransforms(); n++ )
+    {
+    const LinearTransformType* nth =
+      dynamic_cast< const LinearTransformType* >( composite->GetNthTransform( n ).GetPointer() );
+    if( !nth )
+      {
+      return false;
+      }
+    oOffset = oMatrix * nth->GetOffset() + oOffset;
+    oMatrix = oMatrix * nth->GetMatrix();
+    }
+
+  return true;
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+typename CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >::MeasureType
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::GetValue() const
+{
+  if( !this->CanUseSampleCache() )
+    {
+    return Superclass::GetValue();
+    }
+
+  DerivativeType derivative;
+  return this->EvaluateSampleCache( false, derivative );
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+void
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::GetValueAndDerivative( MeasureType & value, DerivativeType & derivative ) const
+{
+  if( !this->CanUseSampleCache() )
+    {
+    Superclass::GetValueAndDerivative( value, derivative );
+    return;
+    }
+
+  value = this->EvaluateSampleCache( true, derivative );
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+typename CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >::MeasureType
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::EvaluateSampleCache( bool iComputeDerivative, DerivativeType & oDerivative ) const
+{
+  const NumberOfParametersType numberOfParameters = this->GetNumberOfParameters();
+  const SizeValueType numberOfSamples = this->GetNumberOfCachedSamples();
+
+  // At most one thread per block of samples, within the thread limit of
+  // the metric. The count is computed for each call, and the threader is
+  // local, so that GetValue() leaves no state behind.
+  const ThreadIdType numberOfThreads = static_cast< ThreadIdType >(
+    std::max( std::min( static_cast< SizeValueType >( this->GetMaximumNumberOfThreads() ),
+                        numberOfSamples / BlockSize ), SizeValueType( 1 ) ) );
+
+  EvaluationThreadStruct str;
+  str.Metric = this;
+  str.ComputeDerivative = iComputeDerivative;
+  str.IsLinear = this->GetLinearMovingTransform( str.Matrix, str.Offset );
+  str.Sums.resize( numberOfThreads, NumericTraits< MeasureType >::Zero );
+  str.Counts.resize( numberOfThreads, 0 );
+  if( iComputeDerivative )
+    {
+    str.Derivatives.resize( numberOfThreads );
+    for( ThreadIdType t = 0; t < numberOfThreads; t++ )
+      {
+      str.Derivatives[t].SetSize( numberOfParameters );
+      str.Derivatives[t].Fill( NumericTraits< typename DerivativeType::ValueType >::Zero );
+      }
+    }
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( Self::EvaluationThreadCallback, &str );
+  threader->SingleMethodExecute();
+
+  MeasureType value = NumericTraits< MeasureType >::Zero;
+  SizeValueType count = 0;
+  if( iComputeDerivative )
+    {
+    oDerivative.SetSize( numberOfParameters );
+    oDerivative.Fill( NumericTraits< typename DerivativeType::ValueType >::Zero );
+    }
+
+  for( ThreadIdType t = 0; t < numberOfThreads; t++ )
+    {
+    value += str.Sums[t];
+    count += str.Counts[t];
+    if( iComputeDerivative )
+      {
+      oDerivative += str.Derivatives[t];
+      }
+    }
+
+  this->m_NumberOfValidPoints = count;
+
+  if( !this->VerifyNumberOfValidPoints( value, oDerivative ) )
+    {
+    return value;
+    }
+
+  value /= static_cast< MeasureType >( count );
+  if( iComputeDerivative )
+    {
+    oDerivative /= static_cast< typename DerivativeType::ValueType >( count );
+    }
+
+  return value;
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+ITK_THREAD_RETURN_TYPE
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::EvaluationThreadCallback( void* arg )
+{
+  MultiThreader::ThreadInfoStruct* info = static_cast< MultiThreader::ThreadInfoStruct* >( arg );
+  EvaluationThreadStruct* str = static_cast< EvaluationThreadStruct* >( info->UserData );
+
+  const ThreadIdType threadId = info->ThreadID;
+  const ThreadIdType numberOfThreads = info->NumberOfThreads;
+
+  // contiguous ranges of the arrays, one per thread
+  const SizeValueType numberOfSamples = str->Metric->GetNumberOfCachedSamples();
+  const SizeValueType begin = ( numberOfSamples * threadId ) / numberOfThreads;
+  const SizeValueType end = ( numberOfSamples * ( threadId + 1 ) ) / numberOfThreads;
+
+  DerivativeType unused;
+  str->Metric->EvaluateSamples( *str, begin, end,
+                                str->Sums[threadId], str->Counts[threadId],
+                                str->ComputeDerivative ? str->Derivatives[threadId] : unused );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+void
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::EvaluateSamples( const EvaluationThreadStruct & iStruct,
+                   SizeValueType iBegin, SizeValueType iEnd,
+                   MeasureType & ioSum, SizeValueType & ioCount,
+                   DerivativeType & ioDerivative ) const
+{
+  if( iBegin >= iEnd )
+    {
+    return;
+    }
+
+  const NumberOfParametersType numberOfParameters = this->GetNumberOfParameters();
+  const bool gradientFromMoving = this->GetGradientSourceIncludesMoving();
+  const bool interleaved = !this->m_InterleavedMovingImage.empty();
+
+  JacobianType jacobian( ImageDimension, numberOfParameters );
+
+  const InternalComputationValueType* points[ImageDimension];
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    points[dim] = &( this->m_SamplePoints[dim][0] );
+    }
+  const InternalComputationValueType* fixedValues = &( this->m_SampleFixedValues[0] );
+
+  // samples of a block, mapped to the moving domain, and their continuous
+  // indices in the interleaved buffer
+  InternalComputationValueType mapped[ImageDimension][BlockSize];
+  InternalComputationValueType continuousIndex[ImageDimension][BlockSize];
+  InternalComputationValueType sampleIndex[ImageDimension];
+  InterleavedValueType         movingValues[NumberOfChannels];
+
+  VirtualPointType virtualPoint;
+  MovingImagePointType mappedPoint;
+  MovingImageGradientType movingGradient;
+
+  for( SizeValueType blockBegin = iBegin; blockBegin < iEnd; blockBegin += BlockSize )
+    {
+    const unsigned int blockSize = static_cast< unsigned int >(
+      std::min( static_cast< SizeValueType >( BlockSize ), iEnd - blockBegin ) );
+
+    if( iStruct.IsLinear )
+      {
+      // y = M x + o on the arrays of the block
+      for( unsigned int i = 0; i < ImageDimension; i++ )
+        {
+        InternalComputationValueType* out = mapped[i];
+        const InternalComputationValueType o = iStruct.Offset[i];
+        for( unsigned int k = 0; k < blockSize; k++ )
+          {
+          out[k] = o;
+          }
+        for( unsigned int j = 0; j < ImageDimension; j++ )
+          {
+          const InternalComputationValueType m = iStruct.Matrix( i, j );
+          const InternalComputationValueType* in = points[j] + blockBegin;
+          for( unsigned int k = 0; k < blockSize; k++ )
+            {
+            out[k] += m * in[k];
+            }
+          }
+        }
+      }
+    else
+      {
+      for( unsigned int k = 0; k < blockSize; k++ )
+        {
+        for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+          {
+          virtualPoint[dim] = points[dim][blockBegin + k];
+          }
+        mappedPoint = this->m_MovingTransform->TransformPoint( virtualPoint );
+        for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+          {
+          mapped[dim][k] = mappedPoint[dim];
+          }
+        }
+      }
+
+    if( interleaved )
+      {
+      // c = A ( y - origin ) - start on the arrays of the block
+      for( unsigned int i = 0; i < ImageDimension; i++ )
+        {
+        InternalComputationValueType* out = continuousIndex[i];
+        const InternalComputationValueType start =
+          static_cast< InternalComputationValueType >( this->m_InterleavedStart[i] );
+        for( unsigned int k = 0; k < blockSize; k++ )
+          {
+          out[k] = -start;
+          }
+        for( unsigned int j = 0; j < ImageDimension; j++ )
+          {
+          const InternalComputationValueType a = this->m_PhysicalPointToIndex( i, j );
+          const InternalComputationValueType o = this->m_InterleavedOrigin[j];
+          const InternalComputationValueType* in = mapped[j];
+          for( unsigned int k = 0; k < blockSize; k++ )
+            {
+            out[k] += a * ( in[k] - o );
+            }
+          }
+        }
+      }
+
+    for( unsigned int k = 0; k < blockSize; k++ )
+      {
+      for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+        {
+        mappedPoint[dim] = mapped[dim][k];
+        }
+
+      if( this->m_MovingImageMask.IsNotNull() && !this->m_MovingImageMask->IsInside( mappedPoint ) )
+        {
+        continue;
+        }
+
+      InternalComputationValueType movingValue;
+      if( interleaved )
+        {
+        for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+          {
+          sampleIndex[dim] = continuousIndex[dim][k];
+          }
+        if( !this->InterpolateMovingImage( sampleIndex, movingValues ) )
+          {
+          continue;
+          }
+        movingValue = movingValues[0];
+        for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+          {
+          movingGradient[dim] = movingValues[dim + 1];
+          }
+        }
+      else
+        {
+        if( !this->m_MovingInterpolator->IsInsideBuffer( mappedPoint ) )
+          {
+          continue;
+          }
+        movingValue = static_cast< InternalComputationValueType >(
+          this->m_MovingInterpolator->Evaluate( mappedPoint ) );
+        }
+
+      const SizeValueType sample = blockBegin + k;
+      const InternalComputationValueType diff = fixedValues[sample] - movingValue;
+
+      ioSum += diff * diff;
+      ++ioCount;
+
+      if( !iStruct.ComputeDerivative )
+        {
+        continue;
+        }
+
+      for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+        {
+        virtualPoint[dim] = points[dim][sample];
+        }
+
+      if( gradientFromMoving )
+        {
+        if( !interleaved )
+          {
+          this->ComputeMovingImageGradientAtPoint( mappedPoint, movingGradient );
+          }
+        }
+      else
+        {
+        typename MovingTransformType::InputCovariantVectorType fixedGradient;
+        for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+          {
+          fixedGradient[dim] = this->m_SampleFixedGradients[dim][sample];
+          }
+        const typename MovingTransformType::OutputCovariantVectorType mappedGradient =
+          this->m_MovingTransform->TransformCovariantVector( fixedGradient, virtualPoint );
+        for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+          {
+          movingGradient[dim] = mappedGradient[dim];
+          }
+        }
+
+      // same convention as MeanSquaresImageToImageMetricv4
+      this->m_MovingTransform->ComputeJacobianWithRespectToParameters( virtualPoint, jacobian );
+      for( NumberOfParametersType par = 0; par < numberOfParameters; par++ )
+        {
+        InternalComputationValueType sum = NumericTraits< InternalComputationValueType >::Zero;
+        for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+          {
+          sum += jacobian( dim, par ) * movingGradient[dim];
+          }
+        ioDerivative[par] += 2.0 * diff * sum;
+        }
+      }
+    }
+}
+
+template< class TFixedImage, class TMovingImage, class TVirtualImage >
+void
+CachedMeanSquaresImageToImageMetricv4< TFixedImage, TMovingImage, TVirtualImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "UseSampleCache: " << this->m_UseSampleCache << std::endl;
+  os << indent << "NumberOfCachedSamples: " << this->GetNumberOfCachedSamples() << std::endl;
+  os << indent << "UseInterleavedMovingImage: " << this->m_UseInterleavedMovingImage << std::endl;
+}
+
+}
+#endif // __itkCachedMeanSquaresImageToImageMetricv4_hxx